@@ -0,0 +1,93 @@
+/*
+ * NOTE: Bridge between the C renderer and TracyVulkan.hpp, see
+ * engine/renderer/vulkan/vulkan_tracy.h. Only built with TRACY_USE=ON.
+ */
+#include <vulkan/vulkan.h>
+#include <new>
+#include <string.h>
+
+#include "TracyVulkan.hpp"
+
+#include "renderer/vulkan/vulkan_tracy.h"
+
+struct VulkanTracyContext
+{
+	tracy::VkCtx*	pCtx;
+	uint32_t		depth;
+
+	// NOTE: Zones are RAII in Tracy, they live here between begin and end
+	alignas(tracy::VkCtxScope) unsigned char pZones[VK_TRACY_MAX_DEPTH][sizeof(tracy::VkCtxScope)];
+};
+
+extern "C" void*
+vkTracyContextCreate(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue,
+		VkCommandBuffer commandBuffer, VkBool32 bCalibrated)
+{
+	PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT	pfnTimeDomains	= nullptr;
+	PFN_vkGetCalibratedTimestampsEXT					pfnTimestamps	= nullptr;
+	if (bCalibrated)
+	{
+		pfnTimeDomains = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)
+			vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+		pfnTimestamps = (PFN_vkGetCalibratedTimestampsEXT)
+			vkGetDeviceProcAddr(device, "vkGetCalibratedTimestampsEXT");
+	}
+
+	VulkanTracyContext* pTracyCtx = new VulkanTracyContext{};
+	pTracyCtx->pCtx = TracyVkContextCalibrated(physicalDevice, device, queue, commandBuffer, pfnTimeDomains, pfnTimestamps);
+	const char* pName = "Graphics queue";
+	TracyVkContextName(pTracyCtx->pCtx, pName, (uint16_t)strlen(pName));
+	return pTracyCtx;
+}
+
+extern "C" void
+vkTracyContextDestroy(void* pContext)
+{
+	VulkanTracyContext* pTracyCtx = (VulkanTracyContext*)pContext;
+	if (!pTracyCtx)
+		return ;
+
+	TracyVkDestroy(pTracyCtx->pCtx);
+	delete pTracyCtx;
+}
+
+extern "C" void
+vkTracyCollect(void* pContext, VkCommandBuffer commandBuffer)
+{
+	VulkanTracyContext* pTracyCtx = (VulkanTracyContext*)pContext;
+	if (!pTracyCtx)
+		return ;
+
+	TracyVkCollect(pTracyCtx->pCtx, commandBuffer);
+}
+
+extern "C" void
+vkTracyZoneBegin(void* pContext, VkCommandBuffer commandBuffer, const char* pName, const char* pFile,
+		const char* pFunction, uint32_t line)
+{
+	VulkanTracyContext* pTracyCtx = (VulkanTracyContext*)pContext;
+	/* NOTE: Depth still counts so the matching end stays balanced */
+	if (!pTracyCtx || pTracyCtx->depth++ >= VK_TRACY_MAX_DEPTH)
+		return ;
+
+	new (pTracyCtx->pZones[pTracyCtx->depth - 1]) tracy::VkCtxScope(
+			pTracyCtx->pCtx,
+			line,
+			pFile, strlen(pFile),
+			pFunction, strlen(pFunction),
+			pName, strlen(pName),
+			commandBuffer,
+			true);
+}
+
+extern "C" void
+vkTracyZoneEnd(void* pContext)
+{
+	VulkanTracyContext* pTracyCtx = (VulkanTracyContext*)pContext;
+	if (!pTracyCtx || pTracyCtx->depth == 0)
+		return ;
+
+	if (--pTracyCtx->depth >= VK_TRACY_MAX_DEPTH)
+		return ;
+	((tracy::VkCtxScope*)pTracyCtx->pZones[pTracyCtx->depth])->~VkCtxScope();
+}
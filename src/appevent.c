@@ -2,6 +2,8 @@
 
 #include "core/ystring.h"
 
+#include <string.h>
+
 extern int32_t gShaderFileIndex;
 /* TODO: Make it a function that looks config file for the folder ?*/
 extern const char *gppShaderFilePath[];
@@ -17,19 +19,159 @@ AddEventCallbackAndInit(void)
 	EventRegister(EVENT_CODE_RESIZED, 0, _OnResized);
 }
 
+/* NOTE: In the order of the positional ones, a bare value fills the next slot */
+typedef enum ArgvOption
+{
+	ARGV_OPTION_RENDERER,
+	ARGV_OPTION_FRAMES_IN_FLIGHT,
+	ARGV_OPTION_GPU_FRAME_TARGET,
+	ARGV_OPTION_PRESENT_MODE,
+	ARGV_OPTION_FRAME_LATENCY,
+	ARGV_OPTION_HEADLESS,
+	ARGV_OPTION_DUMP_INTERVAL,
+	ARGV_OPTION_ASYNC_COMPUTE,
+	ARGV_OPTION_TILES_DEMO,
+	ARGV_OPTION_COUNT,
+} ArgvOption;
+
+static const char* gppArgvOptionNames[ARGV_OPTION_COUNT] = {
+	[ARGV_OPTION_RENDERER]			= "--renderer",
+	[ARGV_OPTION_FRAMES_IN_FLIGHT]	= "--frames-in-flight",
+	[ARGV_OPTION_GPU_FRAME_TARGET]	= "--gpu-frame-target",
+	[ARGV_OPTION_PRESENT_MODE]		= "--present-mode",
+	[ARGV_OPTION_FRAME_LATENCY]		= "--frame-latency",
+	[ARGV_OPTION_HEADLESS]			= "--headless",
+	[ARGV_OPTION_DUMP_INTERVAL]		= "--dump-interval",
+	[ARGV_OPTION_ASYNC_COMPUTE]		= "--async-compute",
+	[ARGV_OPTION_TILES_DEMO]		= "--tiles-demo",
+};
+
+static void
+ArgvOptionSet(RendererConfig* pConfig, ArgvOption option, const char* pValue)
+{
+	int result = yAtoi(pValue);
+	switch (option)
+	{
+		case ARGV_OPTION_RENDERER:
+			if (result < MAX_RENDERER_TYPE && result >= 0)
+			{
+				pConfig->type = result;
+				YINFO("Renderer type chosen -> %s", pRendererType[pConfig->type]);
+			}
+			else
+				YERROR("Unknown rendererType option. Using default %s", pRendererType[pConfig->type]);
+			break;
+		/* NOTE: 0 lets the backend pick, it clamps whatever it gets */
+		case ARGV_OPTION_FRAMES_IN_FLIGHT:
+			if (result >= 0)
+			{
+				pConfig->framesInFlight = result;
+				YINFO("Frames in flight asked -> %d", result);
+			}
+			else
+				YERROR("Unknown framesInFlight option. Using the renderer's default");
+			break;
+		case ARGV_OPTION_GPU_FRAME_TARGET:
+			if (result >= 0)
+			{
+				pConfig->gpuFrameTargetMs = result;
+				YINFO("GPU frame time target -> %d ms", result);
+			}
+			else
+				YERROR("Unknown gpuFrameTargetMs option. Using the renderer's default");
+			break;
+		case ARGV_OPTION_PRESENT_MODE:
+			if (result < MAX_RENDERER_PRESENT_MODE && result >= 0)
+			{
+				pConfig->presentMode = result;
+				YINFO("Present mode asked -> %s", pRendererPresentMode[pConfig->presentMode]);
+			}
+			else
+				YERROR("Unknown presentMode option. Using %s", pRendererPresentMode[pConfig->presentMode]);
+			break;
+		/* NOTE: 0 turns the frame latency limiter off */
+		case ARGV_OPTION_FRAME_LATENCY:
+			if (result >= 0)
+			{
+				pConfig->frameLatency = result;
+				YINFO("Frame latency -> %d", result);
+			}
+			else
+				YERROR("Unknown frameLatency option. Not limiting the frame latency");
+			break;
+		/* NOTE: Anything above 0 runs that many frames without a window, 0 opens one */
+		case ARGV_OPTION_HEADLESS:
+			if (result >= 0)
+			{
+				pConfig->bHeadless		= result > 0;
+				pConfig->headlessFrames	= result;
+				if (pConfig->bHeadless)
+					YINFO("Headless -> %d frames", result);
+			}
+			else
+				YERROR("Unknown headlessFrames option. Opening a window");
+			break;
+		case ARGV_OPTION_DUMP_INTERVAL:
+			if (result >= 0)
+			{
+				pConfig->frameDumpInterval = result;
+				YINFO("Frame dump -> every %d frames", result);
+			}
+			else
+				YERROR("Unknown frameDumpInterval option. Not dumping frames");
+			break;
+		/* NOTE: 0 keeps the backgrounds on the graphics queue */
+		case ARGV_OPTION_ASYNC_COMPUTE:
+			if (result >= 0)
+			{
+				pConfig->bAsyncCompute = result > 0;
+				YINFO("Async compute -> %s", pConfig->bAsyncCompute ? "on" : "off");
+			}
+			else
+				YERROR("Unknown asyncCompute option. Using async compute when available");
+			break;
+		case ARGV_OPTION_TILES_DEMO:
+			if (result >= 0)
+			{
+				pConfig->bTilesDemo = result > 0;
+				YINFO("Tiles demo -> %s", pConfig->bTilesDemo ? "on" : "off");
+			}
+			else
+				YERROR("Unknown tilesDemo option. Not pushing the demo notes");
+			break;
+		default:
+			break;
+	}
+}
+
+/*
+ * NOTE: Named options (`--headless 100`) go anywhere and only set
+ * themselves, bare values still fill the slots in order.
+ */
 void
-ArgvCheck(int argc, char **ppArgv, RendererType *pType)
+ArgvCheck(int argc, char **ppArgv, RendererConfig *pConfig)
 {
-	if (argc >= 2)
+	uint32_t position = 0;
+	for (int i = 1; i < argc; i++)
 	{
-		int result = yAtoi(ppArgv[1]);
-		if (result < MAX_RENDERER_TYPE && result >= 0)
+		if (ppArgv[i][0] != '-' || ppArgv[i][1] != '-')
+		{
+			if (position < ARGV_OPTION_COUNT)
+				ArgvOptionSet(pConfig, position++, ppArgv[i]);
+			else
+				YERROR("Unexpected argument %s. Ignored", ppArgv[i]);
+			continue;
+		}
+
+		uint32_t option = 0;
+		while (option < ARGV_OPTION_COUNT && strcmp(ppArgv[i], gppArgvOptionNames[option]) != 0)
+			option++;
+		if (option == ARGV_OPTION_COUNT || i + 1 >= argc)
 		{
-			*pType = result;
-			YINFO("Renderer type chosen -> %s", pRendererType[*pType]);
+			YERROR("Unknown option %s, or no value after it. Ignored", ppArgv[i]);
+			continue;
 		}
-		else
-			YERROR("Unknown rendererType option. Using default %s", pRendererType[*pType]);
+		ArgvOptionSet(pConfig, option, ppArgv[++i]);
 	}
 }
 
@@ -0,0 +1,162 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#ifdef YBENCH
+
+/*
+ * NOTE: Build with `make BENCH_USE=ON`, run `./build/TileTimeRythm [fileCount] [fileSize]`
+ * from the repo root. Compares the blocking OsFopen/OsFread path against each
+ * async io backend on the same set of generated files. Files are freshly
+ * written so this measures the warm page cache, i.e. syscall and scheduling
+ * overhead rather than the disk.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "os.h"
+#include "core/asyncio.h"
+#include "core/filesystem.h"
+#include "core/job.h"
+#include "core/ymemory.h"
+#include "core/ystring.h"
+#include "core/logger.h"
+
+#define BENCH_ITERATIONS 5
+
+static char**
+BenchFilesCreate(uint32_t fileCount, uint32_t fileSize)
+{
+	char** ppPaths = yAlloc(sizeof(char*) * fileCount, MEMORY_TAG_APPLICATION);
+	char* pData = yAlloc(fileSize, MEMORY_TAG_APPLICATION);
+	for (uint32_t i = 0; i < fileSize; i++)
+		pData[i] = (char)(i * 31);
+	for (uint32_t i = 0; i < fileCount; i++)
+	{
+		ppPaths[i] = yAlloc(64, MEMORY_TAG_APPLICATION);
+		snprintf(ppPaths[i], 64, "./build/bench_%05u.bin", i);
+		FILE* pFile = NULL;
+		if (OsFopen(&pFile, ppPaths[i], "wb") != 0 || !pFile)
+		{
+			YFATAL("Could not create %s", ppPaths[i]);
+			exit(1);
+		}
+		fwrite(pData, 1, fileSize, pFile);
+		OsFclose(pFile);
+	}
+	yFree2(pData, fileSize, MEMORY_TAG_APPLICATION);
+	return ppPaths;
+}
+
+static void
+BenchFilesDestroy(char** ppPaths, uint32_t fileCount)
+{
+	for (uint32_t i = 0; i < fileCount; i++)
+	{
+		remove(ppPaths[i]);
+		yFree2(ppPaths[i], 64, MEMORY_TAG_APPLICATION);
+	}
+	yFree(ppPaths, fileCount, MEMORY_TAG_APPLICATION);
+}
+
+static f64
+BenchSequential(char** ppPaths, uint32_t fileCount, uint32_t fileSize, char* pBuffer)
+{
+	f64 start = OsGetAbsoluteTime(NANOSECONDS);
+	for (uint32_t i = 0; i < fileCount; i++)
+	{
+		FILE* pFile = NULL;
+		if (OsFopen(&pFile, ppPaths[i], "rb") != 0 || !pFile)
+			continue;
+		size_t bytesRead = OsFread(pBuffer + (uint64_t)i * fileSize, fileSize, 1, fileSize, pFile);
+		if (bytesRead != fileSize)
+			YERROR("%s: short read %zu", ppPaths[i], bytesRead);
+		OsFclose(pFile);
+	}
+	return OsGetAbsoluteTime(NANOSECONDS) - start;
+}
+
+static f64
+BenchAsync(AsyncRead* pReads, char** ppPaths, uint32_t fileCount, uint32_t fileSize, char* pBuffer)
+{
+	for (uint32_t i = 0; i < fileCount; i++)
+	{
+		pReads[i] = (AsyncRead){
+			.pFilePath = ppPaths[i],
+			.pBuffer = pBuffer + (uint64_t)i * fileSize,
+			.size = fileSize,
+		};
+	}
+	f64 start = OsGetAbsoluteTime(NANOSECONDS);
+	if (!AsyncReadSubmit(pReads, fileCount))
+		return 0.0;
+	AsyncIoWaitAll();
+	f64 elapsed = OsGetAbsoluteTime(NANOSECONDS) - start;
+	for (uint32_t i = 0; i < fileCount; i++)
+	{
+		if (pReads[i].status != ASYNC_READ_DONE || pReads[i].bytesRead != fileSize)
+			YERROR("%s: failed (%llu bytes)", ppPaths[i], (unsigned long long)pReads[i].bytesRead);
+	}
+	return elapsed;
+}
+
+static void
+BenchReport(const char* pName, f64 bestNs, uint32_t fileCount, uint32_t fileSize)
+{
+	f64 ms = bestNs / (1000.0 * 1000.0);
+	f64 mib = ((f64)fileCount * fileSize) / (1024.0 * 1024.0);
+	YINFO("%-12s %8.3f ms  %8.1f MiB/s  %6.2f us/file", pName, ms, mib / (ms / 1000.0),
+			(bestNs / 1000.0) / fileCount);
+}
+
+int
+main(int argc, char **ppArgv)
+{
+	uint32_t fileCount = 2048;
+	uint32_t fileSize = 16 * 1024;
+	if (argc > 1 && yAtoi(ppArgv[1]) > 0)
+		fileCount = yAtoi(ppArgv[1]);
+	if (argc > 2 && yAtoi(ppArgv[2]) > 0)
+		fileSize = yAtoi(ppArgv[2]);
+
+	if (!JobSystemInit(0))
+		exit(1);
+	YINFO("Bench: %u files of %u bytes, best of %d", fileCount, fileSize, BENCH_ITERATIONS);
+
+	char** ppPaths = BenchFilesCreate(fileCount, fileSize);
+	char* pBuffer = yAlloc((uint64_t)fileCount * fileSize, MEMORY_TAG_IO);
+	AsyncRead* pReads = yAlloc(sizeof(AsyncRead) * fileCount, MEMORY_TAG_IO);
+
+	f64 best = 1e18;
+	for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+	{
+		f64 elapsed = BenchSequential(ppPaths, fileCount, fileSize, pBuffer);
+		best = elapsed < best ? elapsed : best;
+	}
+	BenchReport("OsFread", best, fileCount, fileSize);
+
+	AsyncIoBackendType pTypes[] = {ASYNC_IO_BACKEND_IO_URING, ASYNC_IO_BACKEND_THREAD_POOL};
+	for (uint32_t t = 0; t < COUNT_OF(pTypes); t++)
+	{
+		if (!AsyncIoInit(128, pTypes[t]))
+			continue;
+		best = 1e18;
+		for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+		{
+			f64 elapsed = BenchAsync(pReads, ppPaths, fileCount, fileSize, pBuffer);
+			best = elapsed < best ? elapsed : best;
+		}
+		BenchReport(AsyncIoBackendName(), best, fileCount, fileSize);
+		AsyncIoShutdown();
+	}
+
+	yFree(pReads, fileCount, MEMORY_TAG_IO);
+	yFree2(pBuffer, (uint64_t)fileCount * fileSize, MEMORY_TAG_IO);
+	BenchFilesDestroy(ppPaths, fileCount);
+	JobSystemShutdown();
+	SystemMemoryUsagePrint();
+	return 0;
+}
+
+#endif // YBENCH
+#endif // BENCH_H
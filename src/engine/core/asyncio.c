@@ -0,0 +1,280 @@
+#include "asyncioimpl.h"
+#include "filesystem.h"
+#include "job.h"
+#include "ythread.h"
+#include "ymemory.h"
+#include "darray.h"
+#include "logger.h"
+#include "myassert.h"
+
+#include <errno.h>
+#include <string.h>
+
+#define ASYNC_IO_REAP_COUNT 64
+/* NOTE: Reads per job, amortizes the queue lock and wakeup over small files */
+#define ASYNC_IO_BATCH_SIZE 8
+
+typedef struct AsyncIoState
+{
+	AsyncIoBackend	backend;
+	uint32_t		inflight;
+	b8				bInitialized;
+} AsyncIoState;
+
+static AsyncIoState gAsyncIo = {0};
+
+YND b8
+AsyncReadPrepare(AsyncRead* pRead, int64_t fileSize)
+{
+	if (fileSize < 0)
+	{
+		pRead->error = EIO;
+		return FALSE;
+	}
+	if (pRead->offset > (uint64_t)fileSize)
+	{
+		pRead->error = EINVAL;
+		return FALSE;
+	}
+	if (pRead->size == 0)
+		pRead->size = (uint64_t)fileSize - pRead->offset;
+	if (!pRead->pBuffer && pRead->size)
+	{
+		pRead->pBuffer = yAlloc(pRead->size, MEMORY_TAG_IO);
+		pRead->bOwnsBuffer = TRUE;
+	}
+	return TRUE;
+}
+
+/****************************************************************************/
+/**************************** Thread pool ***********************************/
+/****************************************************************************/
+
+typedef struct ThreadPoolState
+{
+	YMutex			mutex;
+	YCondition		completed;
+	AsyncRead**		ppCompleted;
+} ThreadPoolState;
+
+typedef struct ThreadPoolBatch
+{
+	ThreadPoolState*	pState;
+	AsyncRead*			pReads;
+	uint32_t			count;
+} ThreadPoolBatch;
+
+static void
+ThreadPoolRead(AsyncRead* pRead)
+{
+	FILE* pFile = NULL;
+	if (OsFopen(&pFile, pRead->pFilePath, "rb") != 0 || !pFile)
+	{
+		pRead->error = errno ? errno : ENOENT;
+		return ;
+	}
+	if (AsyncReadPrepare(pRead, OsFileSize(pFile)))
+	{
+		int64_t bytesRead = OsFreadAt(pFile, pRead->pBuffer, pRead->size, pRead->offset);
+		if (bytesRead < 0)
+			pRead->error = errno ? errno : EIO;
+		else
+			pRead->bytesRead = (uint64_t)bytesRead;
+	}
+	OsFclose(pFile);
+}
+
+static void
+ThreadPoolJob(void* pData)
+{
+	ThreadPoolBatch* pBatch = (ThreadPoolBatch*)pData;
+	for (uint32_t i = 0; i < pBatch->count; i++)
+		ThreadPoolRead(&pBatch->pReads[i]);
+
+	ThreadPoolState* pState = pBatch->pState;
+	OsMutexLock(&pState->mutex);
+	for (uint32_t i = 0; i < pBatch->count; i++)
+		DarrayPush(pState->ppCompleted, &pBatch->pReads[i]);
+	OsConditionBroadcast(&pState->completed);
+	OsMutexUnlock(&pState->mutex);
+	yFree(pBatch, 1, MEMORY_TAG_IO);
+}
+
+static b8
+ThreadPoolSubmit(void* pData, AsyncRead* pReads, uint32_t count)
+{
+	ThreadPoolState* pState = (ThreadPoolState*)pData;
+	for (uint32_t i = 0; i < count; i += ASYNC_IO_BATCH_SIZE)
+	{
+		ThreadPoolBatch* pBatch = yAlloc(sizeof(ThreadPoolBatch), MEMORY_TAG_IO);
+		pBatch->pState = pState;
+		pBatch->pReads = &pReads[i];
+		pBatch->count = count - i < ASYNC_IO_BATCH_SIZE ? count - i : ASYNC_IO_BATCH_SIZE;
+		JobSubmit(ThreadPoolJob, pBatch, NULL);
+	}
+	return TRUE;
+}
+
+static uint32_t
+ThreadPoolReap(void* pData, AsyncRead** ppOutReads, uint32_t maxCount, b8 bWait)
+{
+	ThreadPoolState* pState = (ThreadPoolState*)pData;
+	uint32_t count = 0;
+
+	OsMutexLock(&pState->mutex);
+	while (bWait && DarrayLength(pState->ppCompleted) == 0)
+		OsConditionWait(&pState->completed, &pState->mutex);
+	while (count < maxCount && DarrayLength(pState->ppCompleted) > 0)
+		DarrayPop(pState->ppCompleted, &ppOutReads[count++]);
+	OsMutexUnlock(&pState->mutex);
+	return count;
+}
+
+static void
+ThreadPoolShutdown(void* pData)
+{
+	ThreadPoolState* pState = (ThreadPoolState*)pData;
+	DarrayDestroy(pState->ppCompleted);
+	OsConditionDestroy(&pState->completed);
+	OsMutexDestroy(&pState->mutex);
+	yFree(pState, 1, MEMORY_TAG_IO);
+}
+
+YND b8
+AsyncIoThreadPoolCreate(uint32_t queueDepth, AsyncIoBackend* pOutBackend)
+{
+	ThreadPoolState* pState = yAlloc(sizeof(ThreadPoolState), MEMORY_TAG_IO);
+	if (!OsMutexCreate(&pState->mutex) || !OsConditionCreate(&pState->completed))
+	{
+		yFree(pState, 1, MEMORY_TAG_IO);
+		return FALSE;
+	}
+	pState->ppCompleted = DarrayReserve(AsyncRead*, queueDepth);
+
+	pOutBackend->pName = "thread pool";
+	pOutBackend->pState = pState;
+	pOutBackend->pfnSubmit = ThreadPoolSubmit;
+	pOutBackend->pfnReap = ThreadPoolReap;
+	pOutBackend->pfnShutdown = ThreadPoolShutdown;
+	return TRUE;
+}
+
+/****************************************************************************/
+/******************************* Public *************************************/
+/****************************************************************************/
+
+YND b8
+AsyncIoInit(uint32_t queueDepth, AsyncIoBackendType type)
+{
+	YASSERT_MSG(!gAsyncIo.bInitialized, "AsyncIoInit called twice");
+	if (queueDepth == 0)
+		queueDepth = 64;
+
+	b8 bCreated = FALSE;
+	if (type != ASYNC_IO_BACKEND_THREAD_POOL)
+	{
+		bCreated = OsAsyncIoUringCreate(queueDepth, &gAsyncIo.backend);
+		if (!bCreated && type == ASYNC_IO_BACKEND_IO_URING)
+			YWARN("io_uring unavailable, falling back to the thread pool");
+	}
+	if (!bCreated)
+		bCreated = AsyncIoThreadPoolCreate(queueDepth, &gAsyncIo.backend);
+	if (!bCreated)
+	{
+		YERROR("Async io: no backend available");
+		return FALSE;
+	}
+	gAsyncIo.bInitialized = TRUE;
+	YINFO("Async io: %s backend, queue depth %u", gAsyncIo.backend.pName, queueDepth);
+	return TRUE;
+}
+
+void
+AsyncIoShutdown(void)
+{
+	if (!gAsyncIo.bInitialized)
+		return ;
+	AsyncIoWaitAll();
+	gAsyncIo.backend.pfnShutdown(gAsyncIo.backend.pState);
+	gAsyncIo = (AsyncIoState){0};
+}
+
+YND const char*
+AsyncIoBackendName(void)
+{
+	return gAsyncIo.bInitialized ? gAsyncIo.backend.pName : "none";
+}
+
+YND b8
+AsyncReadSubmit(AsyncRead* pReads, uint32_t count)
+{
+	YASSERT_MSG(gAsyncIo.bInitialized, "AsyncIoInit not called");
+	for (uint32_t i = 0; i < count; i++)
+	{
+		pReads[i].bytesRead = 0;
+		pReads[i].error = 0;
+		pReads[i].status = ASYNC_READ_PENDING;
+	}
+	if (!gAsyncIo.backend.pfnSubmit(gAsyncIo.backend.pState, pReads, count))
+	{
+		for (uint32_t i = 0; i < count; i++)
+			pReads[i].status = ASYNC_READ_IDLE;
+		return FALSE;
+	}
+	gAsyncIo.inflight += count;
+	return TRUE;
+}
+
+static uint32_t
+AsyncIoDispatch(b8 bWait)
+{
+	AsyncRead* ppReads[ASYNC_IO_REAP_COUNT];
+	uint32_t count = gAsyncIo.backend.pfnReap(gAsyncIo.backend.pState, ppReads, ASYNC_IO_REAP_COUNT, bWait);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		AsyncRead* pRead = ppReads[i];
+		pRead->status = pRead->error ? ASYNC_READ_FAILED : ASYNC_READ_DONE;
+		if (pRead->error)
+			YERROR("Async read %s: %s", pRead->pFilePath, strerror(pRead->error));
+		gAsyncIo.inflight--;
+		if (pRead->pfnComplete)
+			pRead->pfnComplete(pRead);
+	}
+	return count;
+}
+
+uint32_t
+AsyncIoPoll(void)
+{
+	if (!gAsyncIo.bInitialized || gAsyncIo.inflight == 0)
+		return 0;
+	uint32_t total = 0;
+	uint32_t count = 0;
+	while ((count = AsyncIoDispatch(FALSE)) > 0)
+		total += count;
+	return total;
+}
+
+void
+AsyncIoWait(AsyncRead* pRead)
+{
+	while (pRead->status == ASYNC_READ_PENDING && gAsyncIo.inflight > 0)
+		AsyncIoDispatch(TRUE);
+}
+
+void
+AsyncIoWaitAll(void)
+{
+	while (gAsyncIo.inflight > 0)
+		AsyncIoDispatch(TRUE);
+}
+
+void
+AsyncReadRelease(AsyncRead* pRead)
+{
+	if (pRead->bOwnsBuffer && pRead->pBuffer)
+		yFree2(pRead->pBuffer, pRead->size, MEMORY_TAG_IO);
+	pRead->pBuffer = NULL;
+	pRead->bOwnsBuffer = FALSE;
+	pRead->status = ASYNC_READ_IDLE;
+}
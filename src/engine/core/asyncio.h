@@ -0,0 +1,87 @@
+#ifndef ASYNCIO_H
+#define ASYNCIO_H
+
+#include "mydefines.h"
+
+/*
+ * NOTE: Asynchronous file reads. Requests are submitted in batches and complete
+ * out of order, callbacks only ever run inside AsyncIoPoll / AsyncIoWait* on the
+ * calling thread so game code never has to lock anything.
+ * Backed by io_uring on Linux, a job system thread pool everywhere else.
+ */
+typedef enum AsyncIoBackendType
+{
+	ASYNC_IO_BACKEND_DEFAULT,
+	ASYNC_IO_BACKEND_IO_URING,
+	ASYNC_IO_BACKEND_THREAD_POOL,
+} AsyncIoBackendType;
+
+typedef enum AsyncReadStatus
+{
+	ASYNC_READ_IDLE,
+	ASYNC_READ_PENDING,
+	ASYNC_READ_DONE,
+	ASYNC_READ_FAILED,
+} AsyncReadStatus;
+
+typedef struct AsyncRead AsyncRead;
+
+typedef void (*pfnAsyncReadComplete)(
+		AsyncRead*							pRead);
+
+/**
+ * @brief	`pBuffer` NULL lets the backend allocate it (MEMORY_TAG_IO), release
+ *			it with AsyncReadRelease. `size` 0 reads from `offset` to the end.
+ *			The struct must stay alive until it completes.
+ */
+typedef struct AsyncRead
+{
+	const char*				pFilePath;
+	void*					pBuffer;
+	uint64_t				offset;
+	uint64_t				size;
+	pfnAsyncReadComplete	pfnComplete;
+	void*					pUserData;
+
+	/* NOTE: Filled by the backend */
+	uint64_t				bytesRead;
+	int32_t					error;
+	AsyncReadStatus			status;
+	b8						bOwnsBuffer;
+} AsyncRead;
+
+/**
+ * @brief	`queueDepth` is the amount of reads in flight at once (rounded to a
+ *			power of two for io_uring), requests over it are queued.
+ *			Requires JobSystemInit for the thread pool backend to be parallel.
+ */
+YND b8 AsyncIoInit(
+		uint32_t							queueDepth,
+		AsyncIoBackendType					type);
+
+void AsyncIoShutdown(void);
+
+YND const char* AsyncIoBackendName(void);
+
+/**
+ * @brief	Queues `count` contiguous reads, many small reads should go through
+ *			one call so the backend can batch them.
+ */
+YND b8 AsyncReadSubmit(
+		AsyncRead*							pReads,
+		uint32_t							count);
+
+/**
+ * @brief	Non-blocking, dispatches finished reads and returns how many.
+ */
+uint32_t AsyncIoPoll(void);
+
+void AsyncIoWait(
+		AsyncRead*							pRead);
+
+void AsyncIoWaitAll(void);
+
+void AsyncReadRelease(
+		AsyncRead*							pRead);
+
+#endif // ASYNCIO_H
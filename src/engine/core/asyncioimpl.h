@@ -0,0 +1,41 @@
+#ifndef ASYNCIOIMPL_H
+#define ASYNCIOIMPL_H
+
+#include "core/asyncio.h"
+
+/*
+ * NOTE: Backend table filled by the *Create functions. Backends only fill
+ * bytesRead / error, status and callbacks are handled by asyncio.c.
+ */
+typedef struct AsyncIoBackend
+{
+	const char*		pName;
+	void*			pState;
+
+	b8				(*pfnSubmit)(void* pState, AsyncRead* pReads, uint32_t count);
+	/* NOTE: Returns up to `maxCount` finished reads, blocks for one if bWait */
+	uint32_t		(*pfnReap)(void* pState, AsyncRead** ppOutReads, uint32_t maxCount, b8 bWait);
+	void			(*pfnShutdown)(void* pState);
+} AsyncIoBackend;
+
+/**
+ * @brief	Returns FALSE when the kernel does not support it, the caller falls
+ *			back to the thread pool.
+ */
+YND b8 OsAsyncIoUringCreate(
+		uint32_t							queueDepth,
+		AsyncIoBackend*						pOutBackend);
+
+YND b8 AsyncIoThreadPoolCreate(
+		uint32_t							queueDepth,
+		AsyncIoBackend*						pOutBackend);
+
+/**
+ * @brief	Resolves `size` against the file size and allocates the buffer if
+ *			needed, sets `error` and returns FALSE otherwise.
+ */
+YND b8 AsyncReadPrepare(
+		AsyncRead*							pRead,
+		int64_t								fileSize);
+
+#endif // ASYNCIOIMPL_H
@@ -3,6 +3,7 @@
 #include "event.h"
 
 #include "core/logger.h"
+#include "profiler.h"
 
 typedef struct RegisteredEvent 
 {
@@ -122,16 +123,15 @@ EventFire(uint16_t code, void* pSender, EventContext context)
         return FALSE;
     }
 
+    TracyCZoneN(fireCtx, "EventFire", 1);
+    b8 bHandled = FALSE;
     uint64_t registeredCount = DarrayLength(state.pRegistered[code].pEvents);
-    for(uint64_t i = 0; i < registeredCount; ++i) 
+    for(uint64_t i = 0; i < registeredCount && !bHandled; ++i) 
 	{
         RegisteredEvent eventRegistered = state.pRegistered[code].pEvents[i];
-        if(eventRegistered.callback(code, pSender, eventRegistered.pListener, context))
-		{
-            // Message has been handled, do not send to other pListeners.
-            return TRUE;
-        }
+        // Once handled, do not send to other pListeners.
+        bHandled = eventRegistered.callback(code, pSender, eventRegistered.pListener, context);
     }
-    // Not found.
-    return FALSE;
+    TracyCZoneEnd(fireCtx);
+    return bHandled;
 }
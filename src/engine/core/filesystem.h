@@ -1,7 +1,20 @@
 #ifndef FILESYSTEM_H
 #define FILESYSTEM_H
 
+#include "mydefines.h"
+
 #include <stdio.h>
+#include <stdint.h>
+
+/*
+ * NOTE: Read-only view of a whole file, pages are only faulted in on access
+ */
+typedef struct OsMappedFile
+{
+	const void*		pData;
+	uint64_t		size;
+	void*			pInternal;
+} OsMappedFile;
 
 /**
  * Return 0 for success
@@ -18,9 +31,41 @@ size_t OsFread(
 		size_t								elementCount,
 		FILE*								pStream);
 
+/**
+ * Returns the size in bytes of an opened file or -1 on error
+ */
+int64_t OsFileSize(
+		FILE*								pStream);
+
+/**
+ * Reads up to `size` bytes at `offset` without touching the stream position,
+ * returns the amount read or -1 on error. Safe on different files from
+ * different threads.
+ */
+int64_t OsFreadAt(
+		FILE*								pStream,
+		void*								pBuffer,
+		uint64_t							size,
+		uint64_t							offset);
+
 int OsFclose(
 		FILE*								pStream);
 
+/**
+ * Moves `pSource` over `pDest`, replacing it. Readers see either the old or
+ * the new file, never a partially written one.
+ */
+YND b8 OsFileRename(
+		const char*							pSource,
+		const char*							pDest);
+
+YND b8 OsFileMap(
+		const char*							pFilePath,
+		OsMappedFile*						pOutFile);
+
+void OsFileUnmap(
+		OsMappedFile*						pFile);
+
 int OsStrError(
 		char*								pBuffer,
 		size_t								bufSize,
@@ -0,0 +1,38 @@
+#ifndef FILEWATCH_H
+#define FILEWATCH_H
+
+#include "mydefines.h"
+
+#include <stdint.h>
+
+/*
+ * NOTE: Non recursive watch on a single directory, reports files that were
+ * written and closed or moved in. Implemented with inotify on linux and
+ * ReadDirectoryChangesW on windows.
+ */
+#define FILE_WATCH_MAX_NAME		256
+
+typedef struct OsFileWatch
+{
+	void*	pInternal;
+} OsFileWatch;
+
+YND b8 OsFileWatchCreate(
+		const char*							pDirectory,
+		OsFileWatch*						pOutWatch);
+
+void OsFileWatchDestroy(
+		OsFileWatch*						pWatch);
+
+/**
+ * @brief	Waits up to `timeoutMs` for a change and writes the file name,
+ *			relative to the watched directory, in `pOutName`.
+ *			Returns FALSE on timeout. Same file can be reported more than once.
+ */
+YND b8 OsFileWatchNext(
+		OsFileWatch*						pWatch,
+		uint32_t							timeoutMs,
+		char*								pOutName,
+		uint32_t							nameSize);
+
+#endif // FILEWATCH_H
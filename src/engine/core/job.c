@@ -0,0 +1,195 @@
+#include "job.h"
+#include "ythread.h"
+#include "ymemory.h"
+#include "logger.h"
+
+#include <stddef.h>
+
+#define JOB_QUEUE_CAPACITY 1024
+
+typedef struct Job
+{
+	pfnJob			pfnExecute;
+	void*			pData;
+	JobCounter*		pCounter;
+} Job;
+
+typedef struct JobSystem
+{
+	YThread*		pWorkers;
+	uint32_t		workerCount;
+
+	Job*			pQueue;
+	uint32_t		head;
+	uint32_t		count;
+
+	YMutex			mutex;
+	YCondition		jobAvailable;
+	YCondition		jobDone;
+	b8				bRunning;
+} JobSystem;
+
+static JobSystem gJobSystem = {0};
+
+static void
+JobRun(Job job)
+{
+	job.pfnExecute(job.pData);
+	if (!job.pCounter)
+		return ;
+	if (atomic_fetch_sub(&job.pCounter->pending, 1) != 1 || gJobSystem.workerCount == 0)
+		return ;
+	/* NOTE: Lock so a JobWait between its check and its sleep can't miss it */
+	OsMutexLock(&gJobSystem.mutex);
+	OsConditionBroadcast(&gJobSystem.jobDone);
+	OsMutexUnlock(&gJobSystem.mutex);
+}
+
+/*
+ * NOTE: Must be called with the mutex held
+ */
+static b8
+JobPop(Job* pOutJob)
+{
+	if (gJobSystem.count == 0)
+		return FALSE;
+	*pOutJob = gJobSystem.pQueue[gJobSystem.head];
+	gJobSystem.head = (gJobSystem.head + 1) % JOB_QUEUE_CAPACITY;
+	gJobSystem.count--;
+	return TRUE;
+}
+
+static int32_t
+JobWorkerMain(YMB void* pData)
+{
+	Job job;
+	while (1)
+	{
+		OsMutexLock(&gJobSystem.mutex);
+		while (gJobSystem.count == 0 && gJobSystem.bRunning)
+			OsConditionWait(&gJobSystem.jobAvailable, &gJobSystem.mutex);
+		if (!JobPop(&job))
+		{
+			OsMutexUnlock(&gJobSystem.mutex);
+			break;
+		}
+		OsMutexUnlock(&gJobSystem.mutex);
+		JobRun(job);
+	}
+	return 0;
+}
+
+YND b8
+JobSystemInit(uint32_t workerCount)
+{
+	if (workerCount == 0)
+	{
+		uint32_t processorCount = OsProcessorCount();
+		workerCount = processorCount > 1 ? processorCount - 1 : 0;
+	}
+	if (!OsMutexCreate(&gJobSystem.mutex)
+			|| !OsConditionCreate(&gJobSystem.jobAvailable)
+			|| !OsConditionCreate(&gJobSystem.jobDone))
+	{
+		YERROR("Job system: failed to create sync primitives");
+		return FALSE;
+	}
+	gJobSystem.pQueue = yAlloc(sizeof(Job) * JOB_QUEUE_CAPACITY, MEMORY_TAG_JOB);
+	gJobSystem.bRunning = TRUE;
+
+	if (workerCount == 0)
+	{
+		YINFO("Job system: no worker, jobs run inline");
+		return TRUE;
+	}
+	gJobSystem.pWorkers = yAlloc(sizeof(YThread) * workerCount, MEMORY_TAG_JOB);
+	for (uint32_t i = 0; i < workerCount; i++)
+	{
+		if (!OsThreadCreate(JobWorkerMain, NULL, &gJobSystem.pWorkers[i]))
+			break;
+		gJobSystem.workerCount++;
+	}
+	YINFO("Job system: %u workers", gJobSystem.workerCount);
+	return TRUE;
+}
+
+void
+JobSystemShutdown(void)
+{
+	if (!gJobSystem.pQueue)
+		return ;
+	OsMutexLock(&gJobSystem.mutex);
+	gJobSystem.bRunning = FALSE;
+	OsConditionBroadcast(&gJobSystem.jobAvailable);
+	OsMutexUnlock(&gJobSystem.mutex);
+
+	/* NOTE: Workers drain the queue before exiting */
+	for (uint32_t i = 0; i < gJobSystem.workerCount; i++)
+		OsThreadJoin(&gJobSystem.pWorkers[i]);
+	if (gJobSystem.pWorkers)
+		yFree(gJobSystem.pWorkers, gJobSystem.workerCount, MEMORY_TAG_JOB);
+
+	Job job;
+	while (JobPop(&job))
+		JobRun(job);
+
+	yFree(gJobSystem.pQueue, JOB_QUEUE_CAPACITY, MEMORY_TAG_JOB);
+	OsConditionDestroy(&gJobSystem.jobDone);
+	OsConditionDestroy(&gJobSystem.jobAvailable);
+	OsMutexDestroy(&gJobSystem.mutex);
+	gJobSystem = (JobSystem){0};
+}
+
+YND uint32_t
+JobSystemWorkerCount(void)
+{
+	return gJobSystem.workerCount;
+}
+
+void
+JobSubmit(pfnJob pfnExecute, void* pData, JobCounter* pCounter)
+{
+	Job job = {.pfnExecute = pfnExecute, .pData = pData, .pCounter = pCounter};
+	if (pCounter)
+		atomic_fetch_add(&pCounter->pending, 1);
+
+	if (gJobSystem.workerCount == 0)
+	{
+		JobRun(job);
+		return ;
+	}
+	OsMutexLock(&gJobSystem.mutex);
+	if (gJobSystem.count == JOB_QUEUE_CAPACITY)
+	{
+		OsMutexUnlock(&gJobSystem.mutex);
+		JobRun(job);
+		return ;
+	}
+	uint32_t tail = (gJobSystem.head + gJobSystem.count) % JOB_QUEUE_CAPACITY;
+	gJobSystem.pQueue[tail] = job;
+	gJobSystem.count++;
+	OsConditionSignal(&gJobSystem.jobAvailable);
+	OsMutexUnlock(&gJobSystem.mutex);
+}
+
+void
+JobWait(JobCounter* pCounter)
+{
+	/* NOTE: Without workers everything already ran inline */
+	if (gJobSystem.workerCount == 0)
+		return ;
+	Job job;
+	while (atomic_load(&pCounter->pending) > 0)
+	{
+		OsMutexLock(&gJobSystem.mutex);
+		if (JobPop(&job))
+		{
+			OsMutexUnlock(&gJobSystem.mutex);
+			JobRun(job);
+			continue;
+		}
+		if (atomic_load(&pCounter->pending) > 0)
+			OsConditionWait(&gJobSystem.jobDone, &gJobSystem.mutex);
+		OsMutexUnlock(&gJobSystem.mutex);
+	}
+}
@@ -0,0 +1,46 @@
+#ifndef JOB_H
+#define JOB_H
+
+#include "mydefines.h"
+
+#include <stdatomic.h>
+
+/*
+ * NOTE: Small job system, a fixed pool of workers pulling from one ring queue.
+ * Jobs are fire-and-forget, completion is tracked through a JobCounter.
+ */
+typedef void (*pfnJob)(
+		void*								pData);
+
+typedef struct JobCounter
+{
+	_Atomic int32_t	pending;
+} JobCounter;
+
+/**
+ * @brief	`workerCount` of 0 picks OsProcessorCount() - 1.
+ *			Without workers every job runs inline in JobSubmit.
+ */
+YND b8 JobSystemInit(
+		uint32_t							workerCount);
+
+void JobSystemShutdown(void);
+
+YND uint32_t JobSystemWorkerCount(void);
+
+/**
+ * @brief	`pCounter` can be NULL. When the queue is full the job is run
+ *			inline on the calling thread.
+ */
+void JobSubmit(
+		pfnJob								pfnExecute,
+		void*								pData,
+		JobCounter*							pCounter);
+
+/**
+ * @brief	Blocks until `pCounter` reaches 0, running queued jobs meanwhile.
+ */
+void JobWait(
+		JobCounter*							pCounter);
+
+#endif // JOB_H
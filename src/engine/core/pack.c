@@ -0,0 +1,161 @@
+#include "pack.h"
+#include "ymemory.h"
+#include "logger.h"
+
+#include <string.h>
+
+#ifdef YLZ4
+#include <lz4.h>
+#endif
+#ifdef YZSTD
+#include <zstd.h>
+#endif
+
+static Pack gMountedPack = {0};
+
+YND b8
+PackOpen(const char* pFilePath, Pack* pOutPack)
+{
+	*pOutPack = (Pack){0};
+	if (!OsFileMap(pFilePath, &pOutPack->file))
+		return FALSE;
+
+	const PackHeader* pHeader = pOutPack->file.pData;
+	uint64_t fileSize = pOutPack->file.size;
+	if (fileSize < sizeof(PackHeader)
+			|| pHeader->magic != PACK_MAGIC
+			|| pHeader->version != PACK_VERSION
+			|| pHeader->fileSize != fileSize
+			|| (pHeader->tableSize & (pHeader->tableSize - 1)) != 0
+			|| pHeader->entryCount > pHeader->tableSize
+			|| pHeader->tableOffset + (uint64_t)pHeader->tableSize * sizeof(PackEntry) > fileSize
+			|| pHeader->stringsOffset + pHeader->stringsSize > fileSize)
+	{
+		YERROR("%s: not a valid pack (version %u expected)", pFilePath, PACK_VERSION);
+		PackClose(pOutPack);
+		return FALSE;
+	}
+	pOutPack->pHeader = pHeader;
+	pOutPack->pTable = (const PackEntry*)((const char*)pHeader + pHeader->tableOffset);
+	pOutPack->pStrings = (const char*)pHeader + pHeader->stringsOffset;
+	return TRUE;
+}
+
+void
+PackClose(Pack* pPack)
+{
+	OsFileUnmap(&pPack->file);
+	*pPack = (Pack){0};
+}
+
+YND const PackEntry*
+PackFind(const Pack* pPack, const char* pName)
+{
+	if (!pPack->pHeader || pPack->pHeader->tableSize == 0)
+		return NULL;
+	char pNormalized[PACK_MAX_NAME];
+	uint32_t length = PackNameNormalize(pName, pNormalized, PACK_MAX_NAME);
+	if (length == 0)
+		return NULL;
+
+	uint64_t hash = PackNameHash(pNormalized, length);
+	uint32_t mask = pPack->pHeader->tableSize - 1;
+	for (uint32_t i = 0; i <= mask; i++)
+	{
+		const PackEntry* pEntry = &pPack->pTable[(hash + i) & mask];
+		if (pEntry->hash == 0)
+			return NULL;
+		if (pEntry->hash == hash
+				&& pEntry->nameLength == length
+				&& pEntry->nameOffset + (uint64_t)length <= pPack->pHeader->stringsSize
+				&& memcmp(pPack->pStrings + pEntry->nameOffset, pNormalized, length) == 0)
+			return pEntry;
+	}
+	return NULL;
+}
+
+YND b8
+PackBlobGet(const Pack* pPack, const PackEntry* pEntry, PackBlob* pOutBlob)
+{
+	*pOutBlob = (PackBlob){0};
+	if (pEntry->offset + pEntry->size > pPack->file.size)
+	{
+		YERROR("Pack entry out of bounds");
+		return FALSE;
+	}
+	const char* pSource = (const char*)pPack->file.pData + pEntry->offset;
+	switch (pEntry->compression)
+	{
+		case PACK_COMPRESSION_NONE:
+			pOutBlob->pData = pSource;
+			pOutBlob->size = pEntry->size;
+			return TRUE;
+#ifdef YLZ4
+		case PACK_COMPRESSION_LZ4:
+		{
+			char* pData = yAlloc(pEntry->rawSize, MEMORY_TAG_IO);
+			int result = LZ4_decompress_safe(pSource, pData, (int)pEntry->size, (int)pEntry->rawSize);
+			if (result < 0 || (uint64_t)result != pEntry->rawSize)
+			{
+				YERROR("LZ4_decompress_safe: %d", result);
+				yFree2(pData, pEntry->rawSize, MEMORY_TAG_IO);
+				return FALSE;
+			}
+			*pOutBlob = (PackBlob){.pData = pData, .size = pEntry->rawSize, .bOwned = TRUE};
+			return TRUE;
+		}
+#endif // YLZ4
+#ifdef YZSTD
+		case PACK_COMPRESSION_ZSTD:
+		{
+			char* pData = yAlloc(pEntry->rawSize, MEMORY_TAG_IO);
+			size_t result = ZSTD_decompress(pData, pEntry->rawSize, pSource, pEntry->size);
+			if (ZSTD_isError(result) || result != pEntry->rawSize)
+			{
+				YERROR("ZSTD_decompress: %s", ZSTD_getErrorName(result));
+				yFree2(pData, pEntry->rawSize, MEMORY_TAG_IO);
+				return FALSE;
+			}
+			*pOutBlob = (PackBlob){.pData = pData, .size = pEntry->rawSize, .bOwned = TRUE};
+			return TRUE;
+		}
+#endif // YZSTD
+		default:
+			YERROR("Pack compression %u not built in (LZ4_USE/ZSTD_USE)", pEntry->compression);
+			return FALSE;
+	}
+}
+
+void
+PackBlobRelease(PackBlob* pBlob)
+{
+	if (pBlob->bOwned && pBlob->pData)
+		yFree2((void*)pBlob->pData, pBlob->size, MEMORY_TAG_IO);
+	*pBlob = (PackBlob){0};
+}
+
+YND b8
+PackMount(const char* pFilePath)
+{
+	PackUnmount();
+	if (!PackOpen(pFilePath, &gMountedPack))
+		return FALSE;
+	YINFO("Mounted %s: %u entries", pFilePath, gMountedPack.pHeader->entryCount);
+	return TRUE;
+}
+
+void
+PackUnmount(void)
+{
+	if (gMountedPack.pHeader)
+		PackClose(&gMountedPack);
+}
+
+YND b8
+PackLoad(const char* pName, PackBlob* pOutBlob)
+{
+	const PackEntry* pEntry = PackFind(&gMountedPack, pName);
+	if (!pEntry)
+		return FALSE;
+	return PackBlobGet(&gMountedPack, pEntry, pOutBlob);
+}
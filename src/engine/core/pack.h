@@ -0,0 +1,141 @@
+#ifndef PACK_H
+#define PACK_H
+
+#include "mydefines.h"
+#include "core/filesystem.h"
+
+/*
+ * NOTE: Asset pack layout, written by src/tools/ypack.c (`make pack`)
+ *
+ *	PackHeader
+ *	PackEntry[tableSize]	open addressing table, linear probing, hash 0 = empty
+ *	char[stringsSize]		entry names, not NUL terminated
+ *	blobs					each aligned on PACK_ALIGNMENT
+ *
+ * Names are stored normalized (no leading "./", forward slashes) so the
+ * existing "./build/obj/..." paths resolve as is.
+ */
+#define PACK_MAGIC				0x4B415059u /* "YPAK" */
+#define PACK_VERSION			1
+#define PACK_ALIGNMENT			4096
+#define PACK_MAX_NAME			256
+
+typedef enum PackCompression
+{
+	PACK_COMPRESSION_NONE,
+	PACK_COMPRESSION_LZ4,
+	PACK_COMPRESSION_ZSTD,
+} PackCompression;
+
+typedef struct PackHeader
+{
+	uint32_t		magic;
+	uint32_t		version;
+	uint32_t		entryCount;
+	uint32_t		tableSize;
+	uint64_t		tableOffset;
+	uint64_t		stringsOffset;
+	uint64_t		stringsSize;
+	uint64_t		fileSize;
+} PackHeader;
+
+typedef struct PackEntry
+{
+	uint64_t		hash;
+	uint64_t		offset;
+	uint64_t		size;
+	uint64_t		rawSize;
+	uint32_t		nameOffset;
+	uint32_t		nameLength;
+	uint32_t		compression;
+	uint32_t		reserved;
+} PackEntry;
+
+typedef struct Pack
+{
+	OsMappedFile		file;
+	const PackHeader*	pHeader;
+	const PackEntry*	pTable;
+	const char*			pStrings;
+} Pack;
+
+/**
+ * @brief	`pData` points straight into the mapping unless the blob was
+ *			compressed, then it is owned and PackBlobRelease frees it.
+ */
+typedef struct PackBlob
+{
+	const void*		pData;
+	uint64_t		size;
+	b8				bOwned;
+} PackBlob;
+
+/**
+ * @brief	Writes `pName` without leading "./" and with forward slashes,
+ *			returns the length or 0 if it does not fit.
+ */
+static inline uint32_t
+PackNameNormalize(const char* pName, char* pOut, uint32_t outSize)
+{
+	while (pName[0] == '.' && (pName[1] == '/' || pName[1] == '\\'))
+		pName += 2;
+	uint32_t length = 0;
+	for (; pName[length]; length++)
+	{
+		if (length + 1 >= outSize)
+			return 0;
+		pOut[length] = pName[length] == '\\' ? '/' : pName[length];
+	}
+	pOut[length] = 0;
+	return length;
+}
+
+/* NOTE: FNV-1a, 0 is reserved for empty slots */
+static inline uint64_t
+PackNameHash(const char* pName, uint32_t length)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (uint32_t i = 0; i < length; i++)
+	{
+		hash ^= (uint8_t)pName[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash ? hash : 1;
+}
+
+YND b8 PackOpen(
+		const char*							pFilePath,
+		Pack*								pOutPack);
+
+void PackClose(
+		Pack*								pPack);
+
+YND const PackEntry* PackFind(
+		const Pack*							pPack,
+		const char*							pName);
+
+YND b8 PackBlobGet(
+		const Pack*							pPack,
+		const PackEntry*					pEntry,
+		PackBlob*							pOutBlob);
+
+void PackBlobRelease(
+		PackBlob*							pBlob);
+
+/*
+ * NOTE: Process wide pack the engine looks into before the filesystem
+ */
+YND b8 PackMount(
+		const char*							pFilePath);
+
+void PackUnmount(void);
+
+/**
+ * @brief	Looks `pName` up in the mounted pack, FALSE when there is no pack
+ *			or no such entry so callers can fall back to loose files.
+ */
+YND b8 PackLoad(
+		const char*							pName,
+		PackBlob*							pOutBlob);
+
+#endif // PACK_H
@@ -3,15 +3,18 @@
 #include "ystring.h"
 #include "ymemory.h"
 #include "logger.h"
+#include "profiler.h"
 
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdatomic.h>
 
+/* NOTE: Atomic since worker threads (job system, async io) allocate too */
 struct MemoryStats
 {
-	uint64_t totalAllocated;
-	uint64_t pTaggedAllocations[MEMORY_TAG_MAX_TAGS];
+	_Atomic uint64_t totalAllocated;
+	_Atomic uint64_t pTaggedAllocations[MEMORY_TAG_MAX_TAGS];
 };
 
 static const char *MemoryTagStrings[MEMORY_TAG_MAX_TAGS] = {
@@ -33,10 +36,12 @@ static const char *MemoryTagStrings[MEMORY_TAG_MAX_TAGS] = {
 	"TRANSFORM  ",
 	"ENTITY     ",
 	"ENTITY_NODE",
-	"SCENE      "
+	"SCENE      ",
+	"IO         "
 };
 
 static struct MemoryStats gStats;
+static _Atomic pfnMemoryReport gpfnMemoryReport;
 
 void*
 yZeroMemory(void *pBlock, uint64_t size)
@@ -74,6 +79,23 @@ _yFree(void *pBlock, uint64_t size, MemoryTags tag)
 	pBlock = NULL;
 }
 
+void
+MemoryPlot(void)
+{
+#ifdef TRACY_ENABLE
+	/* NOTE: Tracy keys plots by pointer, the tag strings are static */
+	for (uint32_t i = 0; i < MEMORY_TAG_MAX_TAGS; i++)
+		TracyCPlot(MemoryTagStrings[i], (double)gStats.pTaggedAllocations[i]);
+	TracyCPlot("Memory total", (double)gStats.totalAllocated);
+#endif // TRACY_ENABLE
+}
+
+void
+MemoryReportSet(pfnMemoryReport pfnReport)
+{
+	gpfnMemoryReport = pfnReport;
+}
+
 /**
   * Returns allocated buffer to print
   */
@@ -118,6 +140,9 @@ StrGetMemoryUsage(void)
 		int32_t length = snprintf(pBuffer + offset, 8000, "  %s: %.2f%s\n", MemoryTagStrings[i], fAmount, pUnit);
 		offset += length;
 	}
+	pfnMemoryReport pfnReport = gpfnMemoryReport;
+	if (pfnReport && offset < sizeof(pBuffer))
+		offset += pfnReport(pBuffer + offset, sizeof(pBuffer) - offset);
 	char* pOutString = StrDup(pBuffer);
 	return pOutString;
 }
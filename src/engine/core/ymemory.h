@@ -25,6 +25,7 @@ typedef enum MemoryTags
 	MEMORY_TAG_ENTITY,
 	MEMORY_TAG_ENTITY_NODE,
 	MEMORY_TAG_SCENE,
+	MEMORY_TAG_IO,
 
 	MEMORY_TAG_MAX_TAGS,
 }MemoryTags;
@@ -61,6 +62,22 @@ void _yFree(
 
 YND char* StrGetMemoryUsage(void);
 
+/*
+ * NOTE: Lets a subsystem that tracks memory of its own (GPU allocator) append
+ * to StrGetMemoryUsage. Returns the length written, NULL unregisters.
+ */
+typedef uint64_t (*pfnMemoryReport)(
+		char*								pBuffer,
+		uint64_t							bufferSize);
+
+void MemoryReportSet(
+		pfnMemoryReport						pfnReport);
+
+/**
+ * @brief	Sends the per tag usage to the profiler's plots, no-op without it.
+ */
+void MemoryPlot(void);
+
 void *yZeroMemory(
 		void*								pBlock,
 		uint64_t							size);
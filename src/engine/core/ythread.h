@@ -0,0 +1,71 @@
+#ifndef YTHREAD_H
+#define YTHREAD_H
+
+#include "mydefines.h"
+
+/*
+ * NOTE: Thin platform layer over native threads, implemented in
+ * linux/thread_linux.c and win32/thread_win32.c.
+ * Handles are opaque like OsState, the platform owns what they point to.
+ */
+typedef struct YThread
+{
+	void*	pInternal;
+} YThread;
+
+typedef struct YMutex
+{
+	void*	pInternal;
+} YMutex;
+
+typedef struct YCondition
+{
+	void*	pInternal;
+} YCondition;
+
+typedef int32_t (*pfnThreadStart)(
+		void*								pData);
+
+YND b8 OsThreadCreate(
+		pfnThreadStart						pfnStart,
+		void*								pData,
+		YThread*							pOutThread);
+
+void OsThreadJoin(
+		YThread*							pThread);
+
+YND uint32_t OsProcessorCount(void);
+
+YND b8 OsMutexCreate(
+		YMutex*								pOutMutex);
+
+void OsMutexDestroy(
+		YMutex*								pMutex);
+
+void OsMutexLock(
+		YMutex*								pMutex);
+
+void OsMutexUnlock(
+		YMutex*								pMutex);
+
+YND b8 OsConditionCreate(
+		YCondition*							pOutCondition);
+
+void OsConditionDestroy(
+		YCondition*							pCondition);
+
+/**
+ * @brief	Atomically releases `pMutex` and sleeps until signaled,
+ *			`pMutex` is locked again on return. Spurious wakeups can happen.
+ */
+void OsConditionWait(
+		YCondition*							pCondition,
+		YMutex*								pMutex);
+
+void OsConditionSignal(
+		YCondition*							pCondition);
+
+void OsConditionBroadcast(
+		YCondition*							pCondition);
+
+#endif // YTHREAD_H
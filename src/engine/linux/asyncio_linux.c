@@ -0,0 +1,372 @@
+/* NOTE: syscall/O_CLOEXEC are hidden by -D_POSIX_C_SOURCE=199309L from Makefile.linux */
+#define _GNU_SOURCE
+#include "mydefines.h"
+
+#ifdef YPLATFORM_LINUX
+
+#include "core/asyncioimpl.h"
+#include "core/ymemory.h"
+#include "core/darray.h"
+#include "core/logger.h"
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+/*
+ * NOTE: Raw io_uring without liburing, only IORING_OP_READ is used.
+ * Files are opened synchronously in submit (needed anyway for the size when
+ * `size` is 0), the reads themselves are queued in one io_uring_enter per
+ * batch. Every in-flight read owns a slot, user_data is the slot index.
+ * Reads that don't fit in the ring wait in pPending until slots free up.
+ */
+
+/* NOTE: IORING_OP_READ takes a u32 length, bigger reads are split */
+#define URING_MAX_READ_SIZE (1u << 30)
+
+typedef struct UringSlot
+{
+	AsyncRead*		pRead;
+	int				fd;
+	uint32_t		nextFree;
+} UringSlot;
+
+typedef struct UringState
+{
+	int						ringFd;
+
+	void*					pSqRing;
+	size_t					sqRingSize;
+	_Atomic uint32_t*		pSqHead;
+	_Atomic uint32_t*		pSqTail;
+	uint32_t				sqMask;
+	uint32_t*				pSqArray;
+	struct io_uring_sqe*	pSqes;
+	size_t					sqesSize;
+
+	void*					pCqRing;
+	size_t					cqRingSize;
+	_Atomic uint32_t*		pCqHead;
+	_Atomic uint32_t*		pCqTail;
+	uint32_t				cqMask;
+	struct io_uring_cqe*	pCqes;
+
+	UringSlot*				pSlots;
+	uint32_t				slotCount;
+	uint32_t				freeSlot;
+	uint32_t				usedSlots;
+	uint32_t				toSubmit;
+
+	AsyncRead**				ppPending;
+	uint64_t				pendingHead;
+	AsyncRead**				ppCompleted;
+} UringState;
+
+static int
+UringSetup(uint32_t entries, struct io_uring_params* pParams)
+{
+	return (int)syscall(__NR_io_uring_setup, entries, pParams);
+}
+
+static int
+UringEnter(int ringFd, uint32_t toSubmit, uint32_t minComplete, uint32_t flags)
+{
+	return (int)syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, NULL, 0);
+}
+
+static int
+UringRegister(int ringFd, uint32_t opcode, void* pArg, uint32_t argCount)
+{
+	return (int)syscall(__NR_io_uring_register, ringFd, opcode, pArg, argCount);
+}
+
+static b8
+UringProbeRead(int ringFd)
+{
+	/* NOTE: Probing needs 5.6, which is also when IORING_OP_READ appeared */
+	uint64_t size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+	struct io_uring_probe* pProbe = yAlloc(size, MEMORY_TAG_IO);
+	b8 bSupported = FALSE;
+	if (UringRegister(ringFd, IORING_REGISTER_PROBE, pProbe, 256) == 0)
+		bSupported = pProbe->last_op >= IORING_OP_READ
+			&& (pProbe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+	yFree2(pProbe, size, MEMORY_TAG_IO);
+	return bSupported;
+}
+
+static void
+UringQueueRead(UringState* pState, uint32_t slotIndex)
+{
+	UringSlot* pSlot = &pState->pSlots[slotIndex];
+	AsyncRead* pRead = pSlot->pRead;
+	uint64_t remaining = pRead->size - pRead->bytesRead;
+
+	/* NOTE: Only the submitting thread touches the tail */
+	uint32_t tail = atomic_load_explicit(pState->pSqTail, memory_order_relaxed);
+	uint32_t index = tail & pState->sqMask;
+	struct io_uring_sqe* pSqe = &pState->pSqes[index];
+	memset(pSqe, 0, sizeof(*pSqe));
+	pSqe->opcode = IORING_OP_READ;
+	pSqe->fd = pSlot->fd;
+	pSqe->addr = (uint64_t)(uintptr_t)((char*)pRead->pBuffer + pRead->bytesRead);
+	pSqe->len = remaining > URING_MAX_READ_SIZE ? URING_MAX_READ_SIZE : (uint32_t)remaining;
+	pSqe->off = pRead->offset + pRead->bytesRead;
+	pSqe->user_data = slotIndex;
+	pState->pSqArray[index] = index;
+	atomic_store_explicit(pState->pSqTail, tail + 1, memory_order_release);
+	pState->toSubmit++;
+}
+
+static void
+UringSlotRelease(UringState* pState, uint32_t slotIndex)
+{
+	UringSlot* pSlot = &pState->pSlots[slotIndex];
+	close(pSlot->fd);
+	pSlot->pRead = NULL;
+	pSlot->fd = -1;
+	pSlot->nextFree = pState->freeSlot;
+	pState->freeSlot = slotIndex;
+	pState->usedSlots--;
+}
+
+/*
+ * NOTE: Moves pending reads into free slots then submits everything queued,
+ * failures to open complete right away through ppCompleted.
+ */
+static void
+UringFlush(UringState* pState)
+{
+	while (pState->usedSlots < pState->slotCount && pState->pendingHead < DarrayLength(pState->ppPending))
+	{
+		AsyncRead* pRead = pState->ppPending[pState->pendingHead++];
+		int fd = open(pRead->pFilePath, O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			pRead->error = errno;
+			DarrayPush(pState->ppCompleted, pRead);
+			continue;
+		}
+		struct stat fileStat;
+		int64_t fileSize = fstat(fd, &fileStat) == 0 ? (int64_t)fileStat.st_size : -1;
+		if (!AsyncReadPrepare(pRead, fileSize) || pRead->size == 0)
+		{
+			close(fd);
+			DarrayPush(pState->ppCompleted, pRead);
+			continue;
+		}
+		uint32_t slotIndex = pState->freeSlot;
+		pState->freeSlot = pState->pSlots[slotIndex].nextFree;
+		pState->pSlots[slotIndex].pRead = pRead;
+		pState->pSlots[slotIndex].fd = fd;
+		pState->usedSlots++;
+		UringQueueRead(pState, slotIndex);
+	}
+	if (pState->pendingHead == DarrayLength(pState->ppPending))
+	{
+		DarrayClear(pState->ppPending);
+		pState->pendingHead = 0;
+	}
+
+	while (pState->toSubmit > 0)
+	{
+		int submitted = UringEnter(pState->ringFd, pState->toSubmit, 0, 0);
+		if (submitted < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY))
+			continue;
+		if (submitted < 0)
+		{
+			YERROR("io_uring_enter: %s", strerror(errno));
+			break;
+		}
+		pState->toSubmit -= (uint32_t)submitted;
+	}
+}
+
+static b8
+UringSubmit(void* pData, AsyncRead* pReads, uint32_t count)
+{
+	UringState* pState = (UringState*)pData;
+	for (uint32_t i = 0; i < count; i++)
+		DarrayPush(pState->ppPending, &pReads[i]);
+	UringFlush(pState);
+	return TRUE;
+}
+
+static uint32_t
+UringReap(void* pData, AsyncRead** ppOutReads, uint32_t maxCount, b8 bWait)
+{
+	UringState* pState = (UringState*)pData;
+	uint32_t count = 0;
+
+	while (1)
+	{
+		while (count < maxCount && DarrayLength(pState->ppCompleted) > 0)
+			DarrayPop(pState->ppCompleted, &ppOutReads[count++]);
+
+		uint32_t head = atomic_load_explicit(pState->pCqHead, memory_order_relaxed);
+		uint32_t tail = atomic_load_explicit(pState->pCqTail, memory_order_acquire);
+		for (; head != tail && count < maxCount; head++)
+		{
+			struct io_uring_cqe* pCqe = &pState->pCqes[head & pState->cqMask];
+			uint32_t slotIndex = (uint32_t)pCqe->user_data;
+			AsyncRead* pRead = pState->pSlots[slotIndex].pRead;
+
+			if (pCqe->res == -EINTR || pCqe->res == -EAGAIN)
+			{
+				UringQueueRead(pState, slotIndex);
+				continue;
+			}
+			if (pCqe->res < 0)
+				pRead->error = -pCqe->res;
+			else
+				pRead->bytesRead += (uint64_t)pCqe->res;
+			/* NOTE: Short read, queue the remainder unless it hit the end of file */
+			if (pCqe->res > 0 && pRead->bytesRead < pRead->size)
+			{
+				UringQueueRead(pState, slotIndex);
+				continue;
+			}
+			UringSlotRelease(pState, slotIndex);
+			ppOutReads[count++] = pRead;
+		}
+		atomic_store_explicit(pState->pCqHead, head, memory_order_release);
+
+		UringFlush(pState);
+		if (count > 0 || !bWait)
+			break;
+		if (DarrayLength(pState->ppCompleted) > 0)
+			continue;
+		if (pState->usedSlots == 0)
+			break;
+		if (UringEnter(pState->ringFd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+		{
+			YERROR("io_uring_enter: %s", strerror(errno));
+			break;
+		}
+	}
+	return count;
+}
+
+static void
+UringShutdown(void* pData)
+{
+	UringState* pState = (UringState*)pData;
+	for (uint32_t i = 0; i < pState->slotCount; i++)
+	{
+		if (pState->pSlots[i].fd >= 0)
+			close(pState->pSlots[i].fd);
+	}
+	if (pState->pSqes)
+		munmap(pState->pSqes, pState->sqesSize);
+	if (pState->pCqRing && pState->pCqRing != pState->pSqRing)
+		munmap(pState->pCqRing, pState->cqRingSize);
+	if (pState->pSqRing)
+		munmap(pState->pSqRing, pState->sqRingSize);
+	if (pState->ringFd >= 0)
+		close(pState->ringFd);
+	if (pState->pSlots)
+		yFree(pState->pSlots, pState->slotCount, MEMORY_TAG_IO);
+	if (pState->ppPending)
+		DarrayDestroy(pState->ppPending);
+	if (pState->ppCompleted)
+		DarrayDestroy(pState->ppCompleted);
+	yFree(pState, 1, MEMORY_TAG_IO);
+}
+
+YND b8
+OsAsyncIoUringCreate(uint32_t queueDepth, AsyncIoBackend* pOutBackend)
+{
+	UringState* pState = yAlloc(sizeof(UringState), MEMORY_TAG_IO);
+	struct io_uring_params params = {0};
+
+	pState->ringFd = UringSetup(queueDepth, &params);
+	if (pState->ringFd < 0)
+	{
+		YDEBUG("io_uring_setup: %s", strerror(errno));
+		yFree(pState, 1, MEMORY_TAG_IO);
+		return FALSE;
+	}
+	if (!UringProbeRead(pState->ringFd))
+	{
+		YDEBUG("io_uring: IORING_OP_READ not supported");
+		goto error;
+	}
+
+	pState->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	pState->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		if (pState->cqRingSize > pState->sqRingSize)
+			pState->sqRingSize = pState->cqRingSize;
+		pState->cqRingSize = pState->sqRingSize;
+	}
+	pState->pSqRing = mmap(NULL, pState->sqRingSize, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, pState->ringFd, IORING_OFF_SQ_RING);
+	if (pState->pSqRing == MAP_FAILED)
+	{
+		pState->pSqRing = NULL;
+		goto error;
+	}
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+		pState->pCqRing = pState->pSqRing;
+	else
+	{
+		pState->pCqRing = mmap(NULL, pState->cqRingSize, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE, pState->ringFd, IORING_OFF_CQ_RING);
+		if (pState->pCqRing == MAP_FAILED)
+		{
+			pState->pCqRing = NULL;
+			goto error;
+		}
+	}
+	pState->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	pState->pSqes = mmap(NULL, pState->sqesSize, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, pState->ringFd, IORING_OFF_SQES);
+	if (pState->pSqes == MAP_FAILED)
+	{
+		pState->pSqes = NULL;
+		goto error;
+	}
+
+	char* pSq = (char*)pState->pSqRing;
+	pState->pSqHead = (_Atomic uint32_t*)(pSq + params.sq_off.head);
+	pState->pSqTail = (_Atomic uint32_t*)(pSq + params.sq_off.tail);
+	pState->sqMask = *(uint32_t*)(pSq + params.sq_off.ring_mask);
+	pState->pSqArray = (uint32_t*)(pSq + params.sq_off.array);
+
+	char* pCq = (char*)pState->pCqRing;
+	pState->pCqHead = (_Atomic uint32_t*)(pCq + params.cq_off.head);
+	pState->pCqTail = (_Atomic uint32_t*)(pCq + params.cq_off.tail);
+	pState->cqMask = *(uint32_t*)(pCq + params.cq_off.ring_mask);
+	pState->pCqes = (struct io_uring_cqe*)(pCq + params.cq_off.cqes);
+
+	/* NOTE: One slot per sqe, resubmits of short reads always find room */
+	pState->slotCount = params.sq_entries;
+	pState->pSlots = yAlloc(sizeof(UringSlot) * pState->slotCount, MEMORY_TAG_IO);
+	for (uint32_t i = 0; i < pState->slotCount; i++)
+	{
+		pState->pSlots[i].fd = -1;
+		pState->pSlots[i].nextFree = i + 1;
+	}
+	pState->freeSlot = 0;
+	pState->ppPending = DarrayReserve(AsyncRead*, pState->slotCount);
+	pState->ppCompleted = DarrayReserve(AsyncRead*, pState->slotCount);
+
+	pOutBackend->pName = "io_uring";
+	pOutBackend->pState = pState;
+	pOutBackend->pfnSubmit = UringSubmit;
+	pOutBackend->pfnReap = UringReap;
+	pOutBackend->pfnShutdown = UringShutdown;
+	return TRUE;
+
+error:
+	UringShutdown(pState);
+	return FALSE;
+}
+
+#endif // YPLATFORM_LINUX
@@ -1,3 +1,5 @@
+/* NOTE: pread/fileno are hidden by -D_POSIX_C_SOURCE=199309L from Makefile.linux */
+#define _GNU_SOURCE
 #include "mydefines.h"
 
 #ifdef YPLATFORM_LINUX
@@ -9,12 +11,17 @@
 #include <string.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 
 int
 OsFopen(FILE** pFile, const char* pFilePath, const char* pMode)
 {
 	(*pFile) = fopen(pFilePath, pMode);
-	if (!pFile)
+	if (!(*pFile))
 		return 1;
 	return 0;
 }
@@ -45,12 +52,86 @@ OsFread(void* pBuffer, size_t bufferSize, size_t elementSize, size_t elementCoun
 	return count;
 }
 
+int64_t
+OsFileSize(FILE* pStream)
+{
+	struct stat fileStat;
+	if (fstat(fileno(pStream), &fileStat) != 0)
+		return -1;
+	return (int64_t)fileStat.st_size;
+}
+
+int64_t
+OsFreadAt(FILE* pStream, void* pBuffer, uint64_t size, uint64_t offset)
+{
+	int fd = fileno(pStream);
+	uint64_t count = 0;
+	while (count < size)
+	{
+		ssize_t returnValue = pread(fd, (char*)pBuffer + count, size - count, (off_t)(offset + count));
+		if (returnValue < 0 && errno == EINTR)
+			continue;
+		if (returnValue < 0)
+			return -1;
+		if (returnValue == 0)
+			break;
+		count += returnValue;
+	}
+	return (int64_t)count;
+}
+
 int
 OsFclose(FILE* pStream)
 {
 	return fclose(pStream);
 }
 
+YND b8
+OsFileRename(const char* pSource, const char* pDest)
+{
+	if (rename(pSource, pDest) != 0)
+	{
+		YERROR("rename %s: %s", pDest, strerror(errno));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+YND b8
+OsFileMap(const char* pFilePath, OsMappedFile* pOutFile)
+{
+	int fd = open(pFilePath, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return FALSE;
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		close(fd);
+		return FALSE;
+	}
+	/* NOTE: The mapping keeps the file alive, the descriptor isn't needed anymore */
+	void* pData = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (pData == MAP_FAILED)
+	{
+		YERROR("mmap %s: %s", pFilePath, strerror(errno));
+		return FALSE;
+	}
+	pOutFile->pData = pData;
+	pOutFile->size = (uint64_t)fileStat.st_size;
+	pOutFile->pInternal = NULL;
+	return TRUE;
+}
+
+void
+OsFileUnmap(OsMappedFile* pFile)
+{
+	if (pFile->pData)
+		munmap((void*)pFile->pData, pFile->size);
+	pFile->pData = NULL;
+	pFile->size = 0;
+}
+
 int
 OsStrError(YMB char *pBuffer,YMB  size_t bufSize,YMB  int errnum)
 {
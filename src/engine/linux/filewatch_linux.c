@@ -0,0 +1,103 @@
+/* NOTE: IN_CLOEXEC/poll are hidden by -D_POSIX_C_SOURCE=199309L from Makefile.linux */
+#define _GNU_SOURCE
+#include "mydefines.h"
+
+#ifdef YPLATFORM_LINUX
+
+#include "core/filewatch.h"
+#include "core/ymemory.h"
+#include "core/logger.h"
+
+#include <sys/inotify.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+
+/* NOTE: Enough for a few dozen events, read() never splits one */
+#define WATCH_BUFFER_SIZE (16 * (sizeof(struct inotify_event) + FILE_WATCH_MAX_NAME))
+
+typedef struct LinuxFileWatch
+{
+	int		fd;
+	int		wd;
+	ssize_t	length;
+	ssize_t	offset;
+	char	pBuffer[WATCH_BUFFER_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+} LinuxFileWatch;
+
+YND b8
+OsFileWatchCreate(const char* pDirectory, OsFileWatch* pOutWatch)
+{
+	*pOutWatch = (OsFileWatch){0};
+	int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd < 0)
+	{
+		YERROR("inotify_init1: %s", strerror(errno));
+		return FALSE;
+	}
+	/* NOTE: glslc writes in place, editors and ninja like build tools rename over */
+	int wd = inotify_add_watch(fd, pDirectory, IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (wd < 0)
+	{
+		YERROR("inotify_add_watch %s: %s", pDirectory, strerror(errno));
+		close(fd);
+		return FALSE;
+	}
+	LinuxFileWatch* pWatch = yAlloc(sizeof(LinuxFileWatch), MEMORY_TAG_IO);
+	pWatch->fd = fd;
+	pWatch->wd = wd;
+	pOutWatch->pInternal = pWatch;
+	return TRUE;
+}
+
+void
+OsFileWatchDestroy(OsFileWatch* pWatch)
+{
+	LinuxFileWatch* pInternal = pWatch->pInternal;
+	if (!pInternal)
+		return ;
+	close(pInternal->fd);
+	yFree(pInternal, 1, MEMORY_TAG_IO);
+	pWatch->pInternal = NULL;
+}
+
+YND b8
+OsFileWatchNext(OsFileWatch* pWatch, uint32_t timeoutMs, char* pOutName, uint32_t nameSize)
+{
+	LinuxFileWatch* pInternal = pWatch->pInternal;
+	while (1)
+	{
+		while (pInternal->offset < pInternal->length)
+		{
+			const struct inotify_event* pEvent = (const struct inotify_event*)(pInternal->pBuffer + pInternal->offset);
+			pInternal->offset += sizeof(struct inotify_event) + pEvent->len;
+			if (pEvent->len == 0 || (pEvent->mask & IN_ISDIR))
+				continue;
+			uint32_t length = (uint32_t)strnlen(pEvent->name, pEvent->len);
+			if (length + 1 > nameSize)
+				continue;
+			memcpy(pOutName, pEvent->name, length);
+			pOutName[length] = 0;
+			return TRUE;
+		}
+
+		pInternal->offset = 0;
+		pInternal->length = read(pInternal->fd, pInternal->pBuffer, WATCH_BUFFER_SIZE);
+		if (pInternal->length > 0)
+			continue;
+		pInternal->length = 0;
+		if (errno != EAGAIN && errno != EINTR)
+		{
+			YERROR("inotify read: %s", strerror(errno));
+			return FALSE;
+		}
+
+		struct pollfd pollFd = {.fd = pInternal->fd, .events = POLLIN};
+		int ready = poll(&pollFd, 1, (int)timeoutMs);
+		if (ready <= 0)
+			return FALSE;
+	}
+}
+
+#endif // YPLATFORM_LINUX
@@ -45,7 +45,7 @@ OsInit(OsState *pOsState, AppConfig appConfig)
 		YFATAL("Error glfwInit() in %s at %d: %s", __FILE__, __LINE__, pDesc);
 		return FALSE;
 	}
-	if (!glfwVulkanSupported())
+	if (appConfig.pRendererConfig->type == RENDERER_TYPE_VULKAN && !glfwVulkanSupported())
 	{
 		const char *pDesc; 
 		glfwGetError(&pDesc);
@@ -61,6 +61,11 @@ OsInit(OsState *pOsState, AppConfig appConfig)
 		case RENDERER_TYPE_OPENGL:
 			/* glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE); */
 			YDEBUG("GLFW_OPENGL_API chosen");
+			break;
+		case RENDERER_TYPE_SOFTWARE:
+			/* NOTE: Default GL context, only used to blit the CPU frame */
+			YDEBUG("GLFW_OPENGL_API chosen for the software renderer");
+			break;
 		default:
 			break;
 	}
@@ -81,6 +86,11 @@ OsInit(OsState *pOsState, AppConfig appConfig)
 		return FALSE;
 	}
 	/* glfwMakeContextCurrent(pState->pWindow); */
+	if (appConfig.pRendererConfig->type == RENDERER_TYPE_SOFTWARE)
+	{
+		glfwMakeContextCurrent(pState->pWindow);
+		glfwSwapInterval(appConfig.pRendererConfig->bVsync ? 1 : 0);
+	}
 	pState->windowWidth = appConfig.w;
 	pState->windowHeight = appConfig.h;
     glfwSetKeyCallback(pState->pWindow, _KeyCallback);
@@ -127,6 +137,19 @@ OsSwapBuffers(OsState *pOsState)
 	return TRUE;
 }
 
+YND b8
+OsPresentPixels(OsState* pOsState, const uint32_t* pPixels, uint32_t width, uint32_t height)
+{
+	InternalState *pState = (InternalState *) pOsState->pInternalState;
+	/* NOTE: GL rows go bottom to top, start at the top left corner and flip */
+	glViewport(0, 0, (GLsizei)pState->windowWidth, (GLsizei)pState->windowHeight);
+	glRasterPos2f(-1.0f, 1.0f);
+	glPixelZoom((f32)pState->windowWidth / (f32)width, -(f32)pState->windowHeight / (f32)height);
+	glDrawPixels((GLsizei)width, (GLsizei)height, GL_BGRA, GL_UNSIGNED_BYTE, pPixels);
+	glfwSwapBuffers(pState->pWindow);
+	return TRUE;
+}
+
 void
 FramebufferUpdateInternalDimensions(OsState* pOsState, uint32_t width, uint32_t height)
 {
@@ -168,6 +191,13 @@ OsPumpMessages(YMB OsState* pOsState)
 	glfwPollEvents();
 	return TRUE;
 }
+/* NOTE: clock_gettime needs no setup */
+YND b8
+OsClockInit(void)
+{
+	return TRUE;
+}
+
 /**
  * Get current time in unit
  */
@@ -0,0 +1,143 @@
+#include "mydefines.h"
+
+#ifdef YPLATFORM_LINUX
+
+#include "core/ythread.h"
+#include "core/ymemory.h"
+#include "core/logger.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct ThreadStart
+{
+	pthread_t		handle;
+	pfnThreadStart	pfnStart;
+	void*			pData;
+} ThreadStart;
+
+static void*
+ThreadEntry(void* pArg)
+{
+	ThreadStart* pStart = (ThreadStart*)pArg;
+	int32_t result = pStart->pfnStart(pStart->pData);
+	return (void*)(intptr_t)result;
+}
+
+YND b8
+OsThreadCreate(pfnThreadStart pfnStart, void* pData, YThread* pOutThread)
+{
+	ThreadStart* pStart = yAlloc(sizeof(ThreadStart), MEMORY_TAG_JOB);
+	pStart->pfnStart = pfnStart;
+	pStart->pData = pData;
+
+	int errcode = pthread_create(&pStart->handle, NULL, ThreadEntry, pStart);
+	if (errcode != 0)
+	{
+		YERROR("pthread_create: %s", strerror(errcode));
+		yFree(pStart, 1, MEMORY_TAG_JOB);
+		pOutThread->pInternal = NULL;
+		return FALSE;
+	}
+	pOutThread->pInternal = pStart;
+	return TRUE;
+}
+
+void
+OsThreadJoin(YThread* pThread)
+{
+	ThreadStart* pStart = (ThreadStart*)pThread->pInternal;
+	if (!pStart)
+		return ;
+	pthread_join(pStart->handle, NULL);
+	yFree(pStart, 1, MEMORY_TAG_JOB);
+	pThread->pInternal = NULL;
+}
+
+YND uint32_t
+OsProcessorCount(void)
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (uint32_t)count : 1;
+}
+
+YND b8
+OsMutexCreate(YMutex* pOutMutex)
+{
+	pthread_mutex_t* pMutex = yAlloc(sizeof(pthread_mutex_t), MEMORY_TAG_JOB);
+	if (pthread_mutex_init(pMutex, NULL) != 0)
+	{
+		yFree(pMutex, 1, MEMORY_TAG_JOB);
+		pOutMutex->pInternal = NULL;
+		return FALSE;
+	}
+	pOutMutex->pInternal = pMutex;
+	return TRUE;
+}
+
+void
+OsMutexDestroy(YMutex* pMutex)
+{
+	if (!pMutex->pInternal)
+		return ;
+	pthread_mutex_destroy(pMutex->pInternal);
+	yFree((pthread_mutex_t*)pMutex->pInternal, 1, MEMORY_TAG_JOB);
+	pMutex->pInternal = NULL;
+}
+
+void
+OsMutexLock(YMutex* pMutex)
+{
+	pthread_mutex_lock(pMutex->pInternal);
+}
+
+void
+OsMutexUnlock(YMutex* pMutex)
+{
+	pthread_mutex_unlock(pMutex->pInternal);
+}
+
+YND b8
+OsConditionCreate(YCondition* pOutCondition)
+{
+	pthread_cond_t* pCondition = yAlloc(sizeof(pthread_cond_t), MEMORY_TAG_JOB);
+	if (pthread_cond_init(pCondition, NULL) != 0)
+	{
+		yFree(pCondition, 1, MEMORY_TAG_JOB);
+		pOutCondition->pInternal = NULL;
+		return FALSE;
+	}
+	pOutCondition->pInternal = pCondition;
+	return TRUE;
+}
+
+void
+OsConditionDestroy(YCondition* pCondition)
+{
+	if (!pCondition->pInternal)
+		return ;
+	pthread_cond_destroy(pCondition->pInternal);
+	yFree((pthread_cond_t*)pCondition->pInternal, 1, MEMORY_TAG_JOB);
+	pCondition->pInternal = NULL;
+}
+
+void
+OsConditionWait(YCondition* pCondition, YMutex* pMutex)
+{
+	pthread_cond_wait(pCondition->pInternal, pMutex->pInternal);
+}
+
+void
+OsConditionSignal(YCondition* pCondition)
+{
+	pthread_cond_signal(pCondition->pInternal);
+}
+
+void
+OsConditionBroadcast(YCondition* pCondition)
+{
+	pthread_cond_broadcast(pCondition->pInternal);
+}
+
+#endif // YPLATFORM_LINUX
@@ -1,6 +1,7 @@
 #include "rendererimpl.h"
 
 const char *pRendererType[] = { "Vulkan", "OpenGL", "D3D11", "D3D12", "Metal", "Software" };
+const char *pRendererPresentMode[] = { "Default", "FIFO", "FIFO relaxed", "Mailbox", "Immediate" };
 
 /**
  * @brief	Allocates pOutREnderer Assign pointer to functions for the right backend
@@ -15,14 +16,22 @@ YND YuResult
 RendererInit(OsState* pOsState, YuRenderer** ppOutRenderer, RendererConfig rendererConfig)
 {
 	(*ppOutRenderer) = yAlloc(sizeof(YuRenderer), MEMORY_TAG_RENDERER);
+	/* NOTE: Only Vulkan and the software renderer render without a window */
+	if (rendererConfig.bHeadless && rendererConfig.type != RENDERER_TYPE_VULKAN
+			&& rendererConfig.type != RENDERER_TYPE_SOFTWARE)
+	{
+		YERROR("Renderer type %s cannot run headless", pRendererType[rendererConfig.type]);
+		goto error;
+	}
 	switch (rendererConfig.type)
 	{
 		case RENDERER_TYPE_VULKAN:
-			if (vkErrorToYuseong(vkInit(pOsState, &(*ppOutRenderer)->internalContext)) != YU_SUCCESS)
+			if (vkErrorToYuseong(vkInit(pOsState, &rendererConfig, &(*ppOutRenderer)->internalContext)) != YU_SUCCESS)
 				goto error;
 			(*ppOutRenderer)->YuDraw = vkDraw;
 			(*ppOutRenderer)->YuShutdown = vkShutdown;
 			(*ppOutRenderer)->YuResize = vkResize;
+			(*ppOutRenderer)->YuFrameLatencyWait = vkLatencyWait;
 			goto finish;
 
 		case RENDERER_TYPE_OPENGL:
@@ -61,8 +70,12 @@ RendererInit(OsState* pOsState, YuRenderer** ppOutRenderer, RendererConfig rende
 			goto finish;
 #endif
 		case RENDERER_TYPE_SOFTWARE:
-			YERROR("Renderer type %s has yet to be implemented", pRendererType[rendererConfig.type]);
-			goto error;
+			if (swErrorToYuseong(swInit(pOsState, &rendererConfig, &(*ppOutRenderer)->internalContext)) != YU_SUCCESS)
+				goto error;
+			(*ppOutRenderer)->YuDraw = swDraw;
+			(*ppOutRenderer)->YuShutdown = swShutdown;
+			(*ppOutRenderer)->YuResize = swResize;
+			goto finish;
 
 		default:
 			YFATAL("No renderer found.");
@@ -96,6 +109,13 @@ YuDraw(OsState* pOsState, YuRenderer *pRenderer)
 	return pRenderer->YuDraw(pOsState, pRenderer->internalContext);
 }
 
+void
+YuFrameLatencyWait(YuRenderer *pRenderer)
+{
+	if (pRenderer->YuFrameLatencyWait)
+		pRenderer->YuFrameLatencyWait(pRenderer->internalContext);
+}
+
 /****************************************************************************/
 /******************************* Vulkan *************************************/
 /****************************************************************************/
@@ -105,9 +125,16 @@ vkDraw(YMB OsState* pOsState, void *pCtx)
 	return vkErrorToYuseong(vkDrawImpl(pCtx));
 }
 
+void
+vkLatencyWait(void *pCtx)
+{
+	vkFrameLatencyWait(pCtx);
+}
+
 YND YuResult
-vkResize(YMB OsState* pOsState, YMB uint32_t width, YMB uint32_t height)
+vkResize(YMB OsState* pOsState, uint32_t width, uint32_t height)
 {
+	vkFramebufferResize(width, height);
 	return YU_SUCCESS;
 }
 
@@ -180,3 +207,30 @@ glErrorToYuseong(GlResult result)
 	}
 }
 #endif // YOPENGL
+
+/****************************************************************************/
+/******************************* Software ***********************************/
+/****************************************************************************/
+YND YuResult
+swDraw(YMB OsState* pOsState, void* pCtx)
+{
+	return swErrorToYuseong(swDrawImpl(pCtx));
+}
+
+YND YuResult
+swResize(YMB OsState* pOsState, uint32_t width, uint32_t height)
+{
+	return swErrorToYuseong(swResizeImpl(width, height));
+}
+
+YND YuResult
+swErrorToYuseong(SwResult result)
+{
+	switch (result)
+	{
+		case TRUE:
+			return YU_SUCCESS;
+		default:
+			return YU_FAILURE;
+	}
+}
@@ -7,6 +7,7 @@
 typedef struct OsState OsState;
 
 extern const char *pRendererType[];
+extern const char *pRendererPresentMode[];
 
 typedef enum RendererType
 {
@@ -19,10 +20,41 @@ typedef enum RendererType
 	MAX_RENDERER_TYPE
 } RendererType;
 
+typedef enum RendererPresentMode
+{
+	// NOTE: FIFO with bVsync, MAILBOX without
+	RENDERER_PRESENT_MODE_DEFAULT		= 0x00,
+	RENDERER_PRESENT_MODE_FIFO			= 0x01,
+	RENDERER_PRESENT_MODE_FIFO_RELAXED	= 0x02,
+	RENDERER_PRESENT_MODE_MAILBOX		= 0x03,
+	RENDERER_PRESENT_MODE_IMMEDIATE		= 0x04,
+	MAX_RENDERER_PRESENT_MODE
+} RendererPresentMode;
+
 typedef struct RendererConfig
 {
-	RendererType	type;
-	b8				bVsync;
+	RendererType		type;
+	b8					bVsync;
+	// NOTE: Falls back to the closest mode the surface supports
+	RendererPresentMode	presentMode;
+	// NOTE: Frames the GPU may still have queued when input is sampled, 0 never waits
+	uint32_t			frameLatency;
+	// NOTE: Frames the CPU may record ahead of the GPU, 0 is the backend's default
+	uint32_t			framesInFlight;
+	// NOTE: GPU milliseconds dynamic resolution tries to hold, 0 is the backend's default
+	uint32_t			gpuFrameTargetMs;
+	// NOTE: No window, renders width x height offscreen (Vulkan and software only)
+	b8					bHeadless;
+	uint32_t			width;
+	uint32_t			height;
+	// NOTE: Headless runs stop after that many frames, 0 runs until killed
+	uint32_t			headlessFrames;
+	// NOTE: Writes every that many frames to disk, 0 never does
+	uint32_t			frameDumpInterval;
+	// NOTE: Backgrounds on a compute only queue when the device has one
+	b8					bAsyncCompute;
+	// NOTE: Debug only, scrolls demo notes while nothing else pushes tiles
+	b8					bTilesDemo;
 } RendererConfig;
 
 typedef struct YuRenderer
@@ -30,6 +62,8 @@ typedef struct YuRenderer
 	YuResult	(*YuDraw)(OsState* pOsState, void* pCtx);
 	YuResult	(*YuResize)(OsState* pOsState, uint32_t width, uint32_t height);
 	void		(*YuShutdown)(void* pCtx);
+	// NOTE: NULL when the backend has no latency limiter
+	void		(*YuFrameLatencyWait)(void* pCtx);
 	void*		internalContext;
 } YuRenderer;
 
@@ -61,5 +95,12 @@ YND YuResult YuResizeWindow(
 void		 YuShutdown(
 		YuRenderer*							pRenderer);
 
+/**
+ * @brief	Blocks until the GPU has at most RendererConfig.frameLatency frames
+ *			queued, call it right before sampling input.
+ */
+void		 YuFrameLatencyWait(
+		YuRenderer*							pRenderer);
+
 #endif //RENDERER_H
 
@@ -9,8 +9,10 @@
 
 #include "renderer/vulkan/yvulkan.h"
 #include "renderer/vulkan/vulkan_draw.h"
+#include "renderer/vulkan/vulkan_frame.h"
 #include "renderer/directx/11/directx11.h"
 #include "renderer/metal/metal.h"
+#include "renderer/software/software.h"
 
 typedef b8 GlResult;
 typedef b8 D11Result;
@@ -22,10 +24,13 @@ YND YuResult vkDraw(
 		YMB OsState*							pOsState,
 		void*									pCtx);
 
+void vkLatencyWait(
+		void*									pCtx);
+
 YND YuResult vkResize(
 		YMB OsState*							pOsState,
-		YMB uint32_t							width,
-		YMB uint32_t							height);
+		uint32_t								width,
+		uint32_t								height);
 
 YND YuResult vkErrorToYuseong(
 		VkResult								result);
@@ -60,4 +65,19 @@ YND YuResult glResize(
 YND YuResult glErrorToYuseong(
 		GlResult							result);
 
+/****************************************************************************/
+/******************************* Software ***********************************/
+/****************************************************************************/
+YND YuResult swDraw(
+		YMB OsState*						pOsState,
+		void*								pCtx);
+
+YND YuResult swResize(
+		YMB OsState*						pOsState,
+		uint32_t							width,
+		uint32_t							height);
+
+YND YuResult swErrorToYuseong(
+		SwResult							result);
+
 #endif //RENDERERIMPL_H
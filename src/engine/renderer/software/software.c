@@ -0,0 +1,346 @@
+#include "software.h"
+
+#include "os.h"
+
+#include "core/darray.h"
+#include "core/job.h"
+#include "core/logger.h"
+#include "core/ymemory.h"
+
+#include "profiler.h"
+
+#include <math.h>
+#include <stddef.h>
+
+/* TODO: Make it a function that looks config file for the folder ?*/
+extern int32_t gShaderFileIndex;
+
+/* NOTE: Push constants vkComputePipelineInit gives the same effects */
+static const f32 gpGradientTop[3]		= { 1.0f, 0.0f, 0.0f };
+static const f32 gpGradientBottom[3]	= { 0.0f, 0.0f, 1.0f };
+static const SwSkyParams gSkyParams		= { .base = { 0.1f, 0.2f, 0.4f }, .threshold = 0.97f };
+
+static SwContext gSwContext;
+
+/* NOTE: Pixels [x0, x1) x [y0, y1) */
+typedef struct SwRect
+{
+	int32_t		x0;
+	int32_t		y0;
+	int32_t		x1;
+	int32_t		y1;
+} SwRect;
+
+static inline uint32_t
+ColorToByte(f32 value)
+{
+	value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+	return (uint32_t)(value * 255.0f + 0.5f);
+}
+
+static inline b8
+RectClip(SwRect* pRect, const SwRect* pClip)
+{
+	pRect->x0 = pRect->x0 > pClip->x0 ? pRect->x0 : pClip->x0;
+	pRect->y0 = pRect->y0 > pClip->y0 ? pRect->y0 : pClip->y0;
+	pRect->x1 = pRect->x1 < pClip->x1 ? pRect->x1 : pClip->x1;
+	pRect->y1 = pRect->y1 < pClip->y1 ? pRect->y1 : pClip->y1;
+	return pRect->x0 < pRect->x1 && pRect->y0 < pRect->y1;
+}
+
+/* NOTE: The pixels whose center is inside the tile, like the GPU rasterizer */
+static inline SwRect
+TileRect(const SwTile* pTile)
+{
+	return (SwRect){
+		.x0 = (int32_t)ceilf(pTile->position[0] - 0.5f),
+		.y0 = (int32_t)ceilf(pTile->position[1] - 0.5f),
+		.x1 = (int32_t)ceilf(pTile->position[0] + pTile->size[0] - 0.5f),
+		.y1 = (int32_t)ceilf(pTile->position[1] + pTile->size[1] - 0.5f),
+	};
+}
+
+static inline SwRect
+BinRect(const SwContext* pCtx, uint32_t bin)
+{
+	int32_t	x0 = (int32_t)((bin % pCtx->binCountX) * SW_BIN_SIZE);
+	int32_t	y0 = (int32_t)((bin / pCtx->binCountX) * SW_BIN_SIZE);
+	SwRect	rect = { x0, y0, x0 + SW_BIN_SIZE, y0 + SW_BIN_SIZE };
+	SwRect	frame = { 0, 0, (int32_t)pCtx->width, (int32_t)pCtx->height };
+	RectClip(&rect, &frame);
+	return rect;
+}
+
+static void
+RenderTargetsDestroy(SwContext* pCtx)
+{
+	uint32_t binCount = pCtx->binCountX * pCtx->binCountY;
+	if (pCtx->ppBins)
+	{
+		for (uint32_t i = 0; i < binCount; i++)
+			DarrayDestroy(pCtx->ppBins[i]);
+		yFree2(pCtx->ppBins, sizeof(uint32_t*) * binCount, MEMORY_TAG_RENDERER);
+		yFree2(pCtx->pBinJobs, sizeof(SwBinJob) * binCount, MEMORY_TAG_RENDERER);
+	}
+	if (pCtx->pPixels)
+	{
+		yFree2(pCtx->pPixels, sizeof(uint32_t) * pCtx->width * pCtx->height, MEMORY_TAG_RENDERER);
+		yFree2(pCtx->pSkyColumns, sizeof(f32) * (pCtx->width + 1), MEMORY_TAG_RENDERER);
+		yFree2(pCtx->pSkyRows, sizeof(f32) * (pCtx->height + 1), MEMORY_TAG_RENDERER);
+	}
+	pCtx->ppBins		= NULL;
+	pCtx->pBinJobs		= NULL;
+	pCtx->pPixels		= NULL;
+	pCtx->pSkyColumns	= NULL;
+	pCtx->pSkyRows		= NULL;
+	pCtx->binCountX		= 0;
+	pCtx->binCountY		= 0;
+}
+
+static void
+RenderTargetsCreate(SwContext* pCtx, uint32_t width, uint32_t height)
+{
+	pCtx->width		= width;
+	pCtx->height	= height;
+	pCtx->pPixels	= yAlloc(sizeof(uint32_t) * width * height, MEMORY_TAG_RENDERER);
+
+	/* NOTE: sky.comp's cosines only depend on the column or the row */
+	pCtx->pSkyColumns	= yAlloc(sizeof(f32) * (width + 1), MEMORY_TAG_RENDERER);
+	pCtx->pSkyRows		= yAlloc(sizeof(f32) * (height + 1), MEMORY_TAG_RENDERER);
+	for (uint32_t x = 0; x <= width; x++)
+		pCtx->pSkyColumns[x] = cosf((f32)x * 37.0f);
+	for (uint32_t y = 0; y <= height; y++)
+		pCtx->pSkyRows[y] = cosf(((f32)y - 1.0f) * 57.0f);
+
+	pCtx->binCountX	= (width + SW_BIN_SIZE - 1) / SW_BIN_SIZE;
+	pCtx->binCountY	= (height + SW_BIN_SIZE - 1) / SW_BIN_SIZE;
+	uint32_t binCount = pCtx->binCountX * pCtx->binCountY;
+	pCtx->ppBins	= yAlloc(sizeof(uint32_t*) * binCount, MEMORY_TAG_RENDERER);
+	pCtx->pBinJobs	= yAlloc(sizeof(SwBinJob) * binCount, MEMORY_TAG_RENDERER);
+	for (uint32_t i = 0; i < binCount; i++)
+	{
+		pCtx->ppBins[i]		= DarrayCreate(uint32_t);
+		pCtx->pBinJobs[i]	= (SwBinJob){ .pCtx = pCtx, .bin = i };
+	}
+}
+
+/* NOTE: Same chart as vkTilesDemoPush, the notes off screen are dropped by the binning */
+static void
+TilesDemoPush(SwContext* pCtx)
+{
+	f32			now				= pCtx->nbFrames / 60.0f;
+	f32			laneWidth		= pCtx->width / (f32)(SW_TILE_DEMO_LANES + 2);
+	f32			noteHeight		= laneWidth * 0.25f;
+	f32			pixelsPerSecond	= pCtx->height * 0.5f;
+	f32			hitLine			= pCtx->height * 0.85f;
+	f32			interval		= 0.25f;
+	uint32_t	noteCount		= 64;
+	f32			chartStart		= floorf(now / interval) * interval - 1.0f;
+
+	for (uint32_t lane = 0; lane < SW_TILE_DEMO_LANES; lane++)
+	{
+		f32 laneOffset = interval * lane / SW_TILE_DEMO_LANES;
+		for (uint32_t i = 0; i < noteCount; i++)
+		{
+			f32 time	= chartStart + i * interval + laneOffset;
+			f32 y		= hitLine - (time - now) * pixelsPerSecond - noteHeight;
+			SwTile note = {
+				.position	= { laneWidth * (lane + 1) + 2.0f, y },
+				.size		= { laneWidth - 4.0f, noteHeight },
+				.color		= { 0.2f + 0.2f * lane, 0.6f, 1.0f - 0.2f * lane, 1.0f },
+				.hitState	= fabsf(time - now) < 0.05f,
+			};
+			swTilePush(pCtx, &note);
+		}
+	}
+}
+
+static void
+TilesBin(SwContext* pCtx)
+{
+	TracyCZoneN(binCtx, "swTilesBin", 1);
+	SwRect		frame		= { 0, 0, (int32_t)pCtx->width, (int32_t)pCtx->height };
+	uint32_t	tileCount	= (uint32_t)DarrayLength(pCtx->pTiles);
+	for (uint32_t t = 0; t < tileCount; t++)
+	{
+		SwRect rect = TileRect(&pCtx->pTiles[t]);
+		if (!RectClip(&rect, &frame))
+			continue;
+		for (int32_t by = rect.y0 / SW_BIN_SIZE; by <= (rect.y1 - 1) / SW_BIN_SIZE; by++)
+		{
+			for (int32_t bx = rect.x0 / SW_BIN_SIZE; bx <= (rect.x1 - 1) / SW_BIN_SIZE; bx++)
+				DarrayPush(pCtx->ppBins[by * pCtx->binCountX + bx], t);
+		}
+	}
+	TracyCZoneEnd(binCtx);
+}
+
+static void
+BackgroundDraw(SwContext* pCtx, const SwRect* pBin)
+{
+	SwRasterKernels*	pKernels	= &pCtx->kernels;
+	SwBackground		background	= gShaderFileIndex >= 0 && gShaderFileIndex < MAX_SW_BACKGROUND
+									? (SwBackground)gShaderFileIndex
+									: SW_BACKGROUND_GRADIENT_COLOR;
+	uint32_t			count		= pBin->x1 - pBin->x0;
+	f32					invHeight	= 1.0f / pCtx->height;
+	f32					redScale	= 255.0f / pCtx->width;
+
+	for (int32_t y = pBin->y0; y < pBin->y1; y++)
+	{
+		uint32_t*	pRow	= pCtx->pPixels + (uint64_t)y * pCtx->width + pBin->x0;
+		f32			blend	= y * invHeight;
+		switch (background)
+		{
+			case SW_BACKGROUND_GRADIENT:
+				if ((y & 15) == 0)
+					pKernels->pfnSpanFill(pRow, count, SW_PIXEL(0, 0, 0));
+				else
+					pKernels->pfnSpanGradient(pRow, pBin->x0, count, redScale, ColorToByte(blend));
+				break;
+			case SW_BACKGROUND_SKY:
+				pKernels->pfnSpanSky(pRow, pCtx->pSkyColumns + pBin->x0, count,
+						pCtx->pSkyRows[y], pCtx->pSkyRows[y + 1], blend, &gSkyParams);
+				break;
+			default:
+				pKernels->pfnSpanFill(pRow, count, SW_PIXEL(
+							ColorToByte(gpGradientTop[0] + (gpGradientBottom[0] - gpGradientTop[0]) * blend),
+							ColorToByte(gpGradientTop[1] + (gpGradientBottom[1] - gpGradientTop[1]) * blend),
+							ColorToByte(gpGradientTop[2] + (gpGradientBottom[2] - gpGradientTop[2]) * blend)));
+				break;
+		}
+	}
+}
+
+/* NOTE: tile.frag without textures, darker towards the top, brighter when hit */
+static void
+TilesDraw(SwContext* pCtx, uint32_t bin, const SwRect* pBin)
+{
+	SwRasterKernels*	pKernels	= &pCtx->kernels;
+	uint32_t*			pIndices	= pCtx->ppBins[bin];
+	uint32_t			indexCount	= (uint32_t)DarrayLength(pIndices);
+	for (uint32_t i = 0; i < indexCount; i++)
+	{
+		const SwTile*	pTile	= &pCtx->pTiles[pIndices[i]];
+		SwRect			rect	= TileRect(pTile);
+		uint32_t		alpha	= ColorToByte(pTile->color[3]);
+		if (alpha == 0 || !RectClip(&rect, pBin))
+			continue;
+
+		f32			boost	= pTile->hitState ? 1.6f : 1.0f;
+		f32			invSize	= 1.0f / pTile->size[1];
+		uint32_t	count	= rect.x1 - rect.x0;
+		for (int32_t y = rect.y0; y < rect.y1; y++)
+		{
+			f32 v		= (y + 0.5f - pTile->position[1]) * invSize;
+			f32 shade	= (0.7f + 0.3f * (v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v))) * boost;
+			uint32_t color = SW_PIXEL(
+					ColorToByte(pTile->color[0] * shade),
+					ColorToByte(pTile->color[1] * shade),
+					ColorToByte(pTile->color[2] * shade));
+			uint32_t* pRow = pCtx->pPixels + (uint64_t)y * pCtx->width + rect.x0;
+			if (alpha == 255)
+				pKernels->pfnSpanFill(pRow, count, color);
+			else
+				pKernels->pfnSpanBlend(pRow, count, color, alpha);
+		}
+	}
+}
+
+static void
+BinDrawJob(void* pData)
+{
+	TracyCZoneN(binCtx, "swBinDraw", 1);
+	SwBinJob*	pJob	= pData;
+	SwContext*	pCtx	= pJob->pCtx;
+	SwRect		rect	= BinRect(pCtx, pJob->bin);
+	BackgroundDraw(pCtx, &rect);
+	TilesDraw(pCtx, pJob->bin, &rect);
+	TracyCZoneEnd(binCtx);
+}
+
+SwResult
+swInit(OsState* pOsState, const RendererConfig* pConfig, void** ppOutCtx)
+{
+	SwContext* pCtx = &gSwContext;
+	*pCtx = (SwContext){
+		.pOsState	= pOsState,
+		.bHeadless	= pConfig->bHeadless,
+		.bTilesDemo	= pConfig->bTilesDemo,
+	};
+
+	uint32_t width	= pConfig->width;
+	uint32_t height	= pConfig->height;
+	if (!pCtx->bHeadless)
+		OsFramebufferGetDimensions(pOsState, &width, &height);
+	if (width == 0 || height == 0)
+	{
+		YERROR("Software renderer needs a non empty frame, got %ux%u", width, height);
+		return FALSE;
+	}
+
+	swRasterKernelsSelect(&pCtx->kernels);
+	pCtx->pTiles = DarrayCreate(SwTile);
+	RenderTargetsCreate(pCtx, width, height);
+	*ppOutCtx = pCtx;
+	YDEBUG("Software renderer initialized: %ux%u, %u bins, %u workers",
+			width, height, pCtx->binCountX * pCtx->binCountY, JobSystemWorkerCount());
+	return TRUE;
+}
+
+YND SwResult
+swResizeImpl(uint32_t width, uint32_t height)
+{
+	SwContext* pCtx = &gSwContext;
+	/* NOTE: Minimized, keep the old frame until there is something to draw */
+	if (width == 0 || height == 0 || (width == pCtx->width && height == pCtx->height))
+		return TRUE;
+	RenderTargetsDestroy(pCtx);
+	RenderTargetsCreate(pCtx, width, height);
+	return TRUE;
+}
+
+YND SwResult
+swDrawImpl(void* pData)
+{
+	TracyCZoneN(drawCtx, "swDraw", 1);
+	SwContext* pCtx = pData;
+
+	/* NOTE: Debug only, no gameplay pushes notes yet */
+	if (pCtx->bTilesDemo)
+		TilesDemoPush(pCtx);
+	TilesBin(pCtx);
+
+	/* NOTE: The calling thread runs jobs too while it waits */
+	JobCounter	counter		= {0};
+	uint32_t	binCount	= pCtx->binCountX * pCtx->binCountY;
+	for (uint32_t i = 0; i < binCount; i++)
+		JobSubmit(BinDrawJob, &pCtx->pBinJobs[i], &counter);
+	JobWait(&counter);
+
+	DarrayClear(pCtx->pTiles);
+	for (uint32_t i = 0; i < binCount; i++)
+		DarrayClear(pCtx->ppBins[i]);
+
+	b8 bPresented = pCtx->bHeadless || OsPresentPixels(pCtx->pOsState, pCtx->pPixels, pCtx->width, pCtx->height);
+	pCtx->nbFrames++;
+	TracyCZoneEnd(drawCtx);
+	return bPresented;
+}
+
+void
+swShutdown(void* pData)
+{
+	SwContext* pCtx = pData;
+	RenderTargetsDestroy(pCtx);
+	DarrayDestroy(pCtx->pTiles);
+	pCtx->pTiles = NULL;
+}
+
+void
+swTilePush(SwContext* pCtx, const SwTile* pTile)
+{
+	if (DarrayLength(pCtx->pTiles) >= SW_TILE_MAX)
+		return ;
+	DarrayPush(pCtx->pTiles, *pTile);
+}
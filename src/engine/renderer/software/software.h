@@ -0,0 +1,99 @@
+#ifndef SOFTWARE_H
+#define SOFTWARE_H
+
+#include "mydefines.h"
+#include "renderer/renderer.h"
+#include "software_raster.h"
+
+/*
+ * NOTE: CPU backend for the 2D workload. Tiles pushed during a frame are
+ * binned by their pixel rect into SW_BIN_SIZE squares, those outside the
+ * frame land in no bin. One job per bin then draws the background effect
+ * and the bin's tiles in the order they were pushed, bins never share a
+ * pixel so the workers only meet at the frame's counter.
+ */
+#define SW_BIN_SIZE					64
+#define SW_TILE_MAX					16384
+#define SW_TILE_DEMO_LANES			4
+
+typedef b8 SwResult;
+
+/* NOTE: Same effects as gppShaderFilePath, picked with gShaderFileIndex */
+typedef enum SwBackground
+{
+	SW_BACKGROUND_GRADIENT_COLOR,
+	SW_BACKGROUND_GRADIENT,
+	SW_BACKGROUND_SKY,
+	MAX_SW_BACKGROUND
+} SwBackground;
+
+typedef struct SwTile
+{
+	// NOTE: Top left corner and size, in pixels
+	f32						position[2];
+	f32						size[2];
+	f32						color[4];
+	// NOTE: 0 when not hit, anything else brightens the tile
+	uint32_t				hitState;
+} SwTile;
+
+typedef struct SwBinJob
+{
+	struct SwContext*		pCtx;
+	uint32_t				bin;
+} SwBinJob;
+
+typedef struct SwContext
+{
+	OsState*				pOsState;
+	b8						bHeadless;
+	b8						bTilesDemo;
+	uint32_t				width;
+	uint32_t				height;
+	// NOTE: XRGB8888, top to bottom, width pixels per row
+	uint32_t*				pPixels;
+
+	uint32_t				binCountX;
+	uint32_t				binCountY;
+	// NOTE: One Darray of tile indices per bin, cleared by each swDrawImpl
+	uint32_t**				ppBins;
+	SwBinJob*				pBinJobs;
+
+	// NOTE: Darray, cleared by each swDrawImpl
+	SwTile*					pTiles;
+
+	// NOTE: cos(37 x) for x in [0, width], cos(57 y) for y in [-1, height)
+	f32*					pSkyColumns;
+	f32*					pSkyRows;
+
+	SwRasterKernels			kernels;
+	uint64_t				nbFrames;
+} SwContext;
+
+/**
+ * @brief	Headless contexts take their size from `pConfig`, the others from
+ *			the window.
+ */
+SwResult swInit(
+		OsState*							pOsState,
+		const RendererConfig*				pConfig,
+		void**								ppOutCtx);
+
+YND SwResult swResizeImpl(
+		uint32_t							width,
+		uint32_t							height);
+
+YND SwResult swDrawImpl(
+		void*								pCtx);
+
+void swShutdown(
+		void*								pCtx);
+
+/**
+ * @brief	Queues `pTile` for the next swDrawImpl, dropped when the frame is full.
+ */
+void swTilePush(
+		SwContext*							pCtx,
+		const SwTile*						pTile);
+
+#endif // SOFTWARE_H
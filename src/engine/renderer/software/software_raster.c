@@ -0,0 +1,361 @@
+#include "software_raster.h"
+
+#include "core/logger.h"
+
+#include <math.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#	define SW_X86 1
+#	include <immintrin.h>
+#	define SW_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#	define SW_X86 0
+#endif
+
+/* NOTE: sky.comp samples at fragCoord + (0.2, -0.06), the fractions never change */
+#define SW_SKY_NOISE_SCALE			415.92653f
+#define SW_SKY_FRACT_X				0.2f
+#define SW_SKY_FRACT_Y				0.94f
+#define SW_SKY_W00					((1.0f - SW_SKY_FRACT_X) * (1.0f - SW_SKY_FRACT_Y))
+#define SW_SKY_W01					((1.0f - SW_SKY_FRACT_X) * SW_SKY_FRACT_Y)
+#define SW_SKY_W10					(SW_SKY_FRACT_X * (1.0f - SW_SKY_FRACT_Y))
+#define SW_SKY_W11					(SW_SKY_FRACT_X * SW_SKY_FRACT_Y)
+
+/* NOTE: Exact for `v` in [0, 255 * 255], rounds to nearest */
+static inline uint32_t
+Div255(uint32_t v)
+{
+	v += 128;
+	return (v + (v >> 8)) >> 8;
+}
+
+static inline uint32_t
+ToByte(f32 value)
+{
+	value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+	return (uint32_t)(value * 255.0f + 0.5f);
+}
+
+static inline f32
+SkyStar(f32 column, f32 row, f32 threshold, f32 invRange)
+{
+	f32 noise = SW_SKY_NOISE_SCALE * (column + row);
+	noise -= floorf(noise);
+	f32 star = noise > threshold ? (noise - threshold) * invRange : 0.0f;
+	f32 star2 = star * star;
+	return star2 * star2 * star2;
+}
+
+/****************************************************************************/
+/******************************* Scalar *************************************/
+/****************************************************************************/
+static void
+ScalarSpanFill(uint32_t* pDst, uint32_t count, uint32_t color)
+{
+	for (uint32_t i = 0; i < count; i++)
+		pDst[i] = color;
+}
+
+static void
+ScalarSpanBlend(uint32_t* pDst, uint32_t count, uint32_t color, uint32_t alpha)
+{
+	uint32_t inv	= 255 - alpha;
+	uint32_t r		= ((color >> 16) & 0xFF) * alpha;
+	uint32_t g		= ((color >> 8) & 0xFF) * alpha;
+	uint32_t b		= (color & 0xFF) * alpha;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t dst = pDst[i];
+		pDst[i] = SW_PIXEL(
+				Div255(r + ((dst >> 16) & 0xFF) * inv),
+				Div255(g + ((dst >> 8) & 0xFF) * inv),
+				Div255(b + (dst & 0xFF) * inv));
+	}
+}
+
+static void
+ScalarSpanGradient(uint32_t* pDst, uint32_t x, uint32_t count, f32 redScale, uint32_t green)
+{
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t column = x + i;
+		pDst[i] = (column & 15) ? SW_PIXEL((uint32_t)(column * redScale + 0.5f), green, 0) : SW_PIXEL(0, 0, 0);
+	}
+}
+
+static void
+ScalarSpanSky(uint32_t* pDst, const f32* pColumns, uint32_t count, f32 row0, f32 row1, f32 brightness,
+		const SwSkyParams* pParams)
+{
+	f32 threshold	= pParams->threshold;
+	f32 invRange	= 1.0f / (1.0f - threshold);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		f32 star = SW_SKY_W00 * SkyStar(pColumns[i], row0, threshold, invRange)
+			+ SW_SKY_W01 * SkyStar(pColumns[i], row1, threshold, invRange)
+			+ SW_SKY_W10 * SkyStar(pColumns[i + 1], row0, threshold, invRange)
+			+ SW_SKY_W11 * SkyStar(pColumns[i + 1], row1, threshold, invRange);
+		pDst[i] = SW_PIXEL(
+				ToByte(pParams->base[0] * brightness + star),
+				ToByte(pParams->base[1] * brightness + star),
+				ToByte(pParams->base[2] * brightness + star));
+	}
+}
+
+#if SW_X86
+/****************************************************************************/
+/******************************* SSE2 ***************************************/
+/****************************************************************************/
+/* NOTE: No _mm_floor_ps before SSE4.1, truncates and steps back for negatives */
+static inline __m128
+FloorSse2(__m128 value)
+{
+	__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(value));
+	return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, value), _mm_set1_ps(1.0f)));
+}
+
+static inline __m128
+SkyStarSse2(__m128 column, __m128 row, __m128 threshold, __m128 invRange)
+{
+	__m128 noise = _mm_mul_ps(_mm_set1_ps(SW_SKY_NOISE_SCALE), _mm_add_ps(column, row));
+	noise = _mm_sub_ps(noise, FloorSse2(noise));
+	__m128 star = _mm_mul_ps(_mm_max_ps(_mm_sub_ps(noise, threshold), _mm_setzero_ps()), invRange);
+	__m128 star2 = _mm_mul_ps(star, star);
+	return _mm_mul_ps(_mm_mul_ps(star2, star2), star2);
+}
+
+static inline __m128i
+ToByteSse2(__m128 value)
+{
+	value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+static void
+Sse2SpanFill(uint32_t* pDst, uint32_t count, uint32_t color)
+{
+	__m128i	value	= _mm_set1_epi32((int32_t)color);
+	uint32_t i		= 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_si128((__m128i*)(pDst + i), value);
+	ScalarSpanFill(pDst + i, count - i, color);
+}
+
+/* NOTE: 16 bits per channel, dst * (255 - alpha) + src * alpha fits before the divide */
+static void
+Sse2SpanBlend(uint32_t* pDst, uint32_t count, uint32_t color, uint32_t alpha)
+{
+	int16_t	r		= (int16_t)(((color >> 16) & 0xFF) * alpha + 128);
+	int16_t	g		= (int16_t)(((color >> 8) & 0xFF) * alpha + 128);
+	int16_t	b		= (int16_t)((color & 0xFF) * alpha + 128);
+	int16_t	a		= (int16_t)(255 * alpha + 128);
+	__m128i	source	= _mm_set_epi16(a, r, g, b, a, r, g, b);
+	__m128i	inv		= _mm_set1_epi16((int16_t)(255 - alpha));
+	__m128i	zero	= _mm_setzero_si128();
+	uint32_t i		= 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i dst	= _mm_loadu_si128((const __m128i*)(pDst + i));
+		__m128i lo	= _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), inv), source);
+		__m128i hi	= _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), inv), source);
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+		_mm_storeu_si128((__m128i*)(pDst + i), _mm_packus_epi16(lo, hi));
+	}
+	ScalarSpanBlend(pDst + i, count - i, color, alpha);
+}
+
+static void
+Sse2SpanGradient(uint32_t* pDst, uint32_t x, uint32_t count, f32 redScale, uint32_t green)
+{
+	__m128i	lane	= _mm_setr_epi32(0, 1, 2, 3);
+	__m128i	base	= _mm_set1_epi32((int32_t)(green << 8));
+	__m128i	opaque	= _mm_set1_epi32((int32_t)SW_PIXEL(0, 0, 0));
+	__m128i	mask	= _mm_set1_epi32(15);
+	__m128	scale	= _mm_set1_ps(redScale);
+	__m128	half	= _mm_set1_ps(0.5f);
+	uint32_t i		= 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i	column	= _mm_add_epi32(_mm_set1_epi32((int32_t)(x + i)), lane);
+		__m128i	red		= _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(column), scale), half));
+		__m128i	edge	= _mm_cmpeq_epi32(_mm_and_si128(column, mask), _mm_setzero_si128());
+		__m128i	pixel	= _mm_andnot_si128(edge, _mm_or_si128(_mm_slli_epi32(red, 16), base));
+		_mm_storeu_si128((__m128i*)(pDst + i), _mm_or_si128(pixel, opaque));
+	}
+	ScalarSpanGradient(pDst + i, x + i, count - i, redScale, green);
+}
+
+static void
+Sse2SpanSky(uint32_t* pDst, const f32* pColumns, uint32_t count, f32 row0, f32 row1, f32 brightness,
+		const SwSkyParams* pParams)
+{
+	__m128	threshold	= _mm_set1_ps(pParams->threshold);
+	__m128	invRange	= _mm_set1_ps(1.0f / (1.0f - pParams->threshold));
+	__m128	above		= _mm_set1_ps(row0);
+	__m128	at			= _mm_set1_ps(row1);
+	__m128	baseR		= _mm_set1_ps(pParams->base[0] * brightness);
+	__m128	baseG		= _mm_set1_ps(pParams->base[1] * brightness);
+	__m128	baseB		= _mm_set1_ps(pParams->base[2] * brightness);
+	__m128i	opaque		= _mm_set1_epi32((int32_t)SW_PIXEL(0, 0, 0));
+	uint32_t i			= 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 left		= _mm_loadu_ps(pColumns + i);
+		__m128 right	= _mm_loadu_ps(pColumns + i + 1);
+		__m128 star		= _mm_mul_ps(_mm_set1_ps(SW_SKY_W00), SkyStarSse2(left, above, threshold, invRange));
+		star = _mm_add_ps(star, _mm_mul_ps(_mm_set1_ps(SW_SKY_W01), SkyStarSse2(left, at, threshold, invRange)));
+		star = _mm_add_ps(star, _mm_mul_ps(_mm_set1_ps(SW_SKY_W10), SkyStarSse2(right, above, threshold, invRange)));
+		star = _mm_add_ps(star, _mm_mul_ps(_mm_set1_ps(SW_SKY_W11), SkyStarSse2(right, at, threshold, invRange)));
+
+		__m128i pixel = _mm_or_si128(opaque, _mm_slli_epi32(ToByteSse2(_mm_add_ps(baseR, star)), 16));
+		pixel = _mm_or_si128(pixel, _mm_slli_epi32(ToByteSse2(_mm_add_ps(baseG, star)), 8));
+		pixel = _mm_or_si128(pixel, ToByteSse2(_mm_add_ps(baseB, star)));
+		_mm_storeu_si128((__m128i*)(pDst + i), pixel);
+	}
+	ScalarSpanSky(pDst + i, pColumns + i, count - i, row0, row1, brightness, pParams);
+}
+
+/****************************************************************************/
+/******************************* AVX2 ***************************************/
+/****************************************************************************/
+SW_TARGET_AVX2 static inline __m256
+SkyStarAvx2(__m256 column, __m256 row, __m256 threshold, __m256 invRange)
+{
+	__m256 noise = _mm256_mul_ps(_mm256_set1_ps(SW_SKY_NOISE_SCALE), _mm256_add_ps(column, row));
+	noise = _mm256_sub_ps(noise, _mm256_floor_ps(noise));
+	__m256 star = _mm256_mul_ps(_mm256_max_ps(_mm256_sub_ps(noise, threshold), _mm256_setzero_ps()), invRange);
+	__m256 star2 = _mm256_mul_ps(star, star);
+	return _mm256_mul_ps(_mm256_mul_ps(star2, star2), star2);
+}
+
+SW_TARGET_AVX2 static inline __m256i
+ToByteAvx2(__m256 value)
+{
+	value = _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+	return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(value, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f)));
+}
+
+SW_TARGET_AVX2 static void
+Avx2SpanFill(uint32_t* pDst, uint32_t count, uint32_t color)
+{
+	__m256i	value	= _mm256_set1_epi32((int32_t)color);
+	uint32_t i		= 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_si256((__m256i*)(pDst + i), value);
+	Sse2SpanFill(pDst + i, count - i, color);
+}
+
+/* NOTE: Unpack and pack both work per 128 bit lane, the pixel order comes out unchanged */
+SW_TARGET_AVX2 static void
+Avx2SpanBlend(uint32_t* pDst, uint32_t count, uint32_t color, uint32_t alpha)
+{
+	int16_t	r		= (int16_t)(((color >> 16) & 0xFF) * alpha + 128);
+	int16_t	g		= (int16_t)(((color >> 8) & 0xFF) * alpha + 128);
+	int16_t	b		= (int16_t)((color & 0xFF) * alpha + 128);
+	int16_t	a		= (int16_t)(255 * alpha + 128);
+	__m256i	source	= _mm256_broadcastsi128_si256(_mm_set_epi16(a, r, g, b, a, r, g, b));
+	__m256i	inv		= _mm256_set1_epi16((int16_t)(255 - alpha));
+	__m256i	zero	= _mm256_setzero_si256();
+	uint32_t i		= 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i dst	= _mm256_loadu_si256((const __m256i*)(pDst + i));
+		__m256i lo	= _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(dst, zero), inv), source);
+		__m256i hi	= _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(dst, zero), inv), source);
+		lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+		hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+		_mm256_storeu_si256((__m256i*)(pDst + i), _mm256_packus_epi16(lo, hi));
+	}
+	Sse2SpanBlend(pDst + i, count - i, color, alpha);
+}
+
+SW_TARGET_AVX2 static void
+Avx2SpanGradient(uint32_t* pDst, uint32_t x, uint32_t count, f32 redScale, uint32_t green)
+{
+	__m256i	lane	= _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	__m256i	base	= _mm256_set1_epi32((int32_t)(green << 8));
+	__m256i	opaque	= _mm256_set1_epi32((int32_t)SW_PIXEL(0, 0, 0));
+	__m256i	mask	= _mm256_set1_epi32(15);
+	__m256	scale	= _mm256_set1_ps(redScale);
+	__m256	half	= _mm256_set1_ps(0.5f);
+	uint32_t i		= 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i	column	= _mm256_add_epi32(_mm256_set1_epi32((int32_t)(x + i)), lane);
+		__m256i	red		= _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(column), scale), half));
+		__m256i	edge	= _mm256_cmpeq_epi32(_mm256_and_si256(column, mask), _mm256_setzero_si256());
+		__m256i	pixel	= _mm256_andnot_si256(edge, _mm256_or_si256(_mm256_slli_epi32(red, 16), base));
+		_mm256_storeu_si256((__m256i*)(pDst + i), _mm256_or_si256(pixel, opaque));
+	}
+	Sse2SpanGradient(pDst + i, x + i, count - i, redScale, green);
+}
+
+SW_TARGET_AVX2 static void
+Avx2SpanSky(uint32_t* pDst, const f32* pColumns, uint32_t count, f32 row0, f32 row1, f32 brightness,
+		const SwSkyParams* pParams)
+{
+	__m256	threshold	= _mm256_set1_ps(pParams->threshold);
+	__m256	invRange	= _mm256_set1_ps(1.0f / (1.0f - pParams->threshold));
+	__m256	above		= _mm256_set1_ps(row0);
+	__m256	at			= _mm256_set1_ps(row1);
+	__m256	baseR		= _mm256_set1_ps(pParams->base[0] * brightness);
+	__m256	baseG		= _mm256_set1_ps(pParams->base[1] * brightness);
+	__m256	baseB		= _mm256_set1_ps(pParams->base[2] * brightness);
+	__m256i	opaque		= _mm256_set1_epi32((int32_t)SW_PIXEL(0, 0, 0));
+	uint32_t i			= 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 left		= _mm256_loadu_ps(pColumns + i);
+		__m256 right	= _mm256_loadu_ps(pColumns + i + 1);
+		__m256 star		= _mm256_mul_ps(_mm256_set1_ps(SW_SKY_W00), SkyStarAvx2(left, above, threshold, invRange));
+		star = _mm256_add_ps(star, _mm256_mul_ps(_mm256_set1_ps(SW_SKY_W01), SkyStarAvx2(left, at, threshold, invRange)));
+		star = _mm256_add_ps(star, _mm256_mul_ps(_mm256_set1_ps(SW_SKY_W10), SkyStarAvx2(right, above, threshold, invRange)));
+		star = _mm256_add_ps(star, _mm256_mul_ps(_mm256_set1_ps(SW_SKY_W11), SkyStarAvx2(right, at, threshold, invRange)));
+
+		__m256i pixel = _mm256_or_si256(opaque, _mm256_slli_epi32(ToByteAvx2(_mm256_add_ps(baseR, star)), 16));
+		pixel = _mm256_or_si256(pixel, _mm256_slli_epi32(ToByteAvx2(_mm256_add_ps(baseG, star)), 8));
+		pixel = _mm256_or_si256(pixel, ToByteAvx2(_mm256_add_ps(baseB, star)));
+		_mm256_storeu_si256((__m256i*)(pDst + i), pixel);
+	}
+	Sse2SpanSky(pDst + i, pColumns + i, count - i, row0, row1, brightness, pParams);
+}
+#endif // SW_X86
+
+void
+swRasterKernelsSelect(SwRasterKernels* pOutKernels)
+{
+#if SW_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		*pOutKernels = (SwRasterKernels){
+			.pName				= "AVX2",
+			.pfnSpanFill		= Avx2SpanFill,
+			.pfnSpanBlend		= Avx2SpanBlend,
+			.pfnSpanGradient	= Avx2SpanGradient,
+			.pfnSpanSky			= Avx2SpanSky,
+		};
+	}
+	else
+	{
+		/* NOTE: Part of x86-64, always there */
+		*pOutKernels = (SwRasterKernels){
+			.pName				= "SSE2",
+			.pfnSpanFill		= Sse2SpanFill,
+			.pfnSpanBlend		= Sse2SpanBlend,
+			.pfnSpanGradient	= Sse2SpanGradient,
+			.pfnSpanSky			= Sse2SpanSky,
+		};
+	}
+#else
+	*pOutKernels = (SwRasterKernels){
+		.pName				= "scalar",
+		.pfnSpanFill		= ScalarSpanFill,
+		.pfnSpanBlend		= ScalarSpanBlend,
+		.pfnSpanGradient	= ScalarSpanGradient,
+		.pfnSpanSky			= ScalarSpanSky,
+	};
+#endif // SW_X86
+	YINFO("Software rasterizer kernels: %s", pOutKernels->pName);
+}
@@ -0,0 +1,60 @@
+#ifndef SOFTWARE_RASTER_H
+#define SOFTWARE_RASTER_H
+
+#include "mydefines.h"
+
+#include <stdint.h>
+
+/*
+ * NOTE: Span kernels, everything the software renderer writes goes through
+ * them. Picked once at init: AVX2 when the CPU has it, SSE2 on any other
+ * x86-64, plain C elsewhere. Pixels are XRGB8888, alpha is written as 0xFF.
+ */
+#define SW_PIXEL(r, g, b)			(0xFF000000u | ((uint32_t)(r) << 16) | ((uint32_t)(g) << 8) | (uint32_t)(b))
+
+/* NOTE: Threshold and color of sky.comp, data1 of its push constants */
+typedef struct SwSkyParams
+{
+	f32						base[3];
+	f32						threshold;
+} SwSkyParams;
+
+typedef struct SwRasterKernels
+{
+	const char*				pName;
+
+	void					(*pfnSpanFill)(
+								uint32_t*		pDst,
+								uint32_t		count,
+								uint32_t		color);
+
+	// NOTE: `alpha` in [0, 255], source over
+	void					(*pfnSpanBlend)(
+								uint32_t*		pDst,
+								uint32_t		count,
+								uint32_t		color,
+								uint32_t		alpha);
+
+	// NOTE: gradient.comp, red follows x, black on the first column of each 16 pixels
+	void					(*pfnSpanGradient)(
+								uint32_t*		pDst,
+								uint32_t		x,
+								uint32_t		count,
+								f32				redScale,
+								uint32_t		green);
+
+	// NOTE: sky.comp, `pColumns` starts at x, `row0` and `row1` are the rows above and at y
+	void					(*pfnSpanSky)(
+								uint32_t*		pDst,
+								const f32*		pColumns,
+								uint32_t		count,
+								f32				row0,
+								f32				row1,
+								f32				brightness,
+								const SwSkyParams*	pParams);
+} SwRasterKernels;
+
+void swRasterKernelsSelect(
+		SwRasterKernels*					pOutKernels);
+
+#endif // SOFTWARE_RASTER_H
@@ -38,10 +38,6 @@
 			vkDestroyPipeline(device, pCtx->pComputeShaders[i].pipeline, pCtx->pAllocator); \
 		} \
 		DarrayDestroy(pCtx->pComputeShaders);\
-		vkDestroyPipeline(device, pCtx->triPipeline.pipeline, pCtx->pAllocator); \
-		vkDestroyPipelineLayout(device, pCtx->triPipeline.pipelineLayout, pCtx->pAllocator); \
-		vkDestroyPipeline(device, pCtx->meshPipeline.pipeline, pCtx->pAllocator); \
-		vkDestroyPipelineLayout(device, pCtx->meshPipeline.pipelineLayout, pCtx->pAllocator); \
 	} while(0);
 
 #endif  // MACRO_UTILS_H
@@ -12,12 +12,29 @@
 #include "vulkan_pipeline.h"
 #include "vulkan_timer.h"
 #include "vulkan_memory.h"
+#include "vulkan_shader_reload.h"
+#include "vulkan_pipeline_cache.h"
+#include "vulkan_allocator.h"
+#include "vulkan_staging.h"
+#include "vulkan_transfer.h"
+#include "vulkan_frame.h"
+#include "vulkan_tracy.h"
+#include "vulkan_tiles.h"
+#include "vulkan_bindless.h"
+#include "vulkan_transient.h"
+#include "vulkan_resolution.h"
+#include "vulkan_frame_dump.h"
+#include "vulkan_async_compute.h"
+#include "vulkan_background_cache.h"
+
+#include "renderer/renderer.h"
 
 #include "core/darray.h"
 #include "core/darray_debug.h"
 #include "core/logger.h"
 #include "core/myassert.h"
 #include "core/ymemory.h"
+#include "core/job.h"
 
 #include <math.h>
 #include <stdio.h>
@@ -43,16 +60,27 @@ YMB static inline VkResult DebugCallbackSetup(
 		VkContext*										pCtx);
 
 YND static inline VkResult DefaultDataInit(
-		VulkanDevice						device,
-		VkAllocationCallbacks*				pAllocator,
+		VkContext*							pCtx,
 		GpuMeshBuffers*						pMeshBuffer);
 
+static inline VkPresentModeKHR PresentModeFromConfig(
+		const RendererConfig*				pConfig);
+
+YND static inline VkResult HeadlessSurfaceCreate(
+		VkContext*							pCtx);
+
 /* TODO: Make it a function that looks config file for the folder ?*/
 extern int32_t gShaderFileIndex;
 extern const char *gppShaderFilePath[];
 
+/* NOTE: pipeline_<vendor>_<device>.cache lands here */
+static const char* gpPipelineCacheDirectory = "./build";
+
+/* NOTE: Set to a path like "./build/gpu_profile.csv" to dump every frame's GPU scopes */
+static const char* gpGpuProfileCsvPath = NULL;
+
 YND VkResult
-vkInit(OsState *pOsState, void** ppOutCtx)
+vkInit(OsState *pOsState, const RendererConfig* pConfig, void** ppOutCtx)
 {
 	char*			pGPUName						= "NVIDIA GeForce RTX 3080";
 	const char**	ppRequiredValidationLayerNames	= NULL;
@@ -60,6 +88,7 @@ vkInit(OsState *pOsState, void** ppOutCtx)
 	const char**	ppRequiredExtensions			= NULL;
 	uint32_t		requiredExtensionCount			= 0;
 	VkContext*		pCurrentCtx						= NULL;
+	f64				initStart						= OsGetAbsoluteTime(MILLISECONDS);
 
 	/* 
 	 * NOTE: This is just for fun, multiple context is complex
@@ -72,12 +101,23 @@ vkInit(OsState *pOsState, void** ppOutCtx)
 	pCurrentCtx = gContext.ppCtx[gContext.currentContext];
 
 	/* NOTE: I don't think this could ever fail */
-	uint32_t			count		= 0;
-	const char**		ppSurfaceOs	= OsGetRequiredInstanceExtensions(&count);
 	ppRequiredExtensions			= DarrayCreate(const char *);
-	for (uint32_t i = 0; i < count; i++)
+	pCurrentCtx->bHeadless			= pConfig->bHeadless;
+	pCurrentCtx->bTilesDemo			= pConfig->bTilesDemo;
+	if (pCurrentCtx->bHeadless)
 	{
-		DarrayPush(ppRequiredExtensions, ppSurfaceOs[i]);
+		/* NOTE: No window system, the surface only hands out the images to render to */
+		DarrayPush(ppRequiredExtensions, &VK_KHR_SURFACE_EXTENSION_NAME);
+		DarrayPush(ppRequiredExtensions, &VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+	}
+	else
+	{
+		uint32_t			count		= 0;
+		const char**		ppSurfaceOs	= OsGetRequiredInstanceExtensions(&count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			DarrayPush(ppRequiredExtensions, ppSurfaceOs[i]);
+		}
 	}
 
     /*
@@ -86,7 +126,13 @@ vkInit(OsState *pOsState, void** ppOutCtx)
      */
 
 	pCurrentCtx->MemoryFindIndex = MemoryTypeFindIndex;
-	OsFramebufferGetDimensions(pOsState, &pCurrentCtx->framebufferWidth, &pCurrentCtx->framebufferHeight);
+	if (pCurrentCtx->bHeadless)
+	{
+		pCurrentCtx->framebufferWidth	= pConfig->width;
+		pCurrentCtx->framebufferHeight	= pConfig->height;
+	}
+	else
+		OsFramebufferGetDimensions(pOsState, &pCurrentCtx->framebufferWidth, &pCurrentCtx->framebufferHeight);
 
 #ifdef DEBUG
 	DebugRequiredExtensionValidationLayers(
@@ -120,7 +166,10 @@ vkInit(OsState *pOsState, void** ppOutCtx)
 	VK_ASSERT(vkCreateInstance(&pCreateInfo, pCurrentCtx->pAllocator, &pCurrentCtx->instance));
 
 	/* NOTE: Create vkSurface  */
-	VK_CHECK(OsCreateVkSurface(pOsState, pCurrentCtx));
+	if (pCurrentCtx->bHeadless)
+		VK_CHECK(HeadlessSurfaceCreate(pCurrentCtx));
+	else
+		VK_CHECK(OsCreateVkSurface(pOsState, pCurrentCtx));
 	YDEBUG("Vulkan surface created");
 
 #ifdef DEBUG
@@ -130,16 +179,26 @@ vkInit(OsState *pOsState, void** ppOutCtx)
 	/* NOTE: Creating the device */
 	VK_CHECK(VulkanCreateDevice(pCurrentCtx, &pCurrentCtx->device.handle, pGPUName));
 
-	/* NOTE: Create Swapchain */
+	/* NOTE: Every buffer and image below is sub-allocated from here */
+	VK_CHECK(vkAllocatorCreate(&pCurrentCtx->device, pCurrentCtx->pAllocator));
+	f64 deviceTime = OsGetAbsoluteTime(MILLISECONDS) - initStart;
+	f64 stageStart = OsGetAbsoluteTime(MILLISECONDS);
+
+	/* NOTE: Create Swapchain, it keeps the frame count across recreates */
+	uint32_t framesInFlight = pConfig->framesInFlight ? pConfig->framesInFlight : VK_FRAMES_IN_FLIGHT_DEFAULT;
+	pCurrentCtx->swapchain.maxFrameInFlight = YCLAMP(framesInFlight, VK_FRAMES_IN_FLIGHT_MIN, VK_FRAMES_IN_FLIGHT_MAX);
+	pCurrentCtx->swapchain.desiredPresentMode = PresentModeFromConfig(pConfig);
+	/* NOTE: The present times ring has to go back as far as the oldest pending present */
+	pCurrentCtx->latency.maxQueued = pConfig->frameLatency < VK_PRESENT_TIMES_MAX
+		? pConfig->frameLatency
+		: VK_PRESENT_TIMES_MAX;
+	pCurrentCtx->frameDump.interval = pConfig->frameDumpInterval;
 	int32_t width = pCurrentCtx->framebufferWidth;
 	int32_t height = pCurrentCtx->framebufferHeight;
 	VK_CHECK(vkSwapchainCreate(pCurrentCtx, width, height, &pCurrentCtx->swapchain));
 
-	/* NOTE: Create commandPool */
-	VK_CHECK(vkCommandPoolCreate(pCurrentCtx->device, pCurrentCtx->pAllocator, &pCurrentCtx->device.graphicsCommandPool));
-
-	/* NOTE: Create commandBuffer */
-	VK_CHECK(vkCommandBufferCreate(pCurrentCtx));
+	/* NOTE: Command pool and buffer, descriptor pool, sync and deletion queue per frame */
+	VK_CHECK(vkFramesCreate(pCurrentCtx));
 
 	/* NOTE: Create ImmediateCommandCreate */
 	VK_CHECK(vkImmediateSubmitCommandCreate(
@@ -157,10 +216,6 @@ vkInit(OsState *pOsState, void** ppOutCtx)
 	pCurrentCtx->swapchain.pFramebuffers = DarrayReserve(VulkanFramebuffer, pCurrentCtx->swapchain.imageCount);
 	vkFramebuffersRegenerate(pCurrentCtx, &pCurrentCtx->swapchain, &pCurrentCtx->mainRenderpass);
 
-	pCurrentCtx->pSemaphoresAvailableImage	= DarrayReserve(VkSemaphore, pCurrentCtx->swapchain.maxFrameInFlight);
-	pCurrentCtx->pSemaphoresQueueComplete	= DarrayReserve(VkSemaphore, pCurrentCtx->swapchain.maxFrameInFlight);
-	pCurrentCtx->pFencesInFlight			= DarrayReserve(VulkanFence, pCurrentCtx->swapchain.maxFrameInFlight);
-
 	/*
 	 * NOTE: In flight fences should not yet exist at this point, so clear the list. These are stored in pointers
 	 * because the initial state should be 0, and will be 0 when not in use. Acutal fences are not owned
@@ -172,56 +227,114 @@ vkInit(OsState *pOsState, void** ppOutCtx)
         pCurrentCtx->ppImagesInFlight[i] = 0;
     }
 
-	/* NOTE: Init semaphore and fences */
+	/* NOTE: Init the immediate submit fence */
 	SyncInit(pCurrentCtx, &pCurrentCtx->device);
 
+	/* NOTE: Tracy GPU context, submits on the immediate command buffer once */
+	pCurrentCtx->pTracyContext = vkTracyContextCreate(
+			pCurrentCtx->instance,
+			pCurrentCtx->device.physicalDevice,
+			pCurrentCtx->device.handle,
+			pCurrentCtx->device.graphicsQueue,
+			pCurrentCtx->device.immediateSubmit.commandBuffer.handle,
+			pCurrentCtx->device.bCalibratedTimestamps);
+
+	/* NOTE: Uploads are batched into the frames' command buffers from here */
+	VK_CHECK(vkStagingRingCreate(pCurrentCtx, VK_STAGING_RING_SIZE));
+	VK_CHECK(vkTransferInit(pCurrentCtx));
+	f64 swapchainTime = OsGetAbsoluteTime(MILLISECONDS) - stageStart;
+	stageStart = OsGetAbsoluteTime(MILLISECONDS);
+
 	/* NOTE: DescriptorSets allocation */
 	VK_CHECK(vkDescriptorsInit(pCurrentCtx, pCurrentCtx->device.handle));
+	/* NOTE: Texture heap, its layout is set 0 of the tile pipeline */
+	VK_CHECK(vkBindlessCreate(pCurrentCtx));
+	/* NOTE: Its background slots use the draw image's set layout */
+	VK_CHECK(vkAsyncComputeInit(pCurrentCtx, pConfig->bAsyncCompute));
+	f64 descriptorTime = OsGetAbsoluteTime(MILLISECONDS) - stageStart;
 	/* VK_CHECK(vkPipelineInit(pCurrentCtx, pCurrentCtx->device.logicalDev, gpShaderFilePath[gShaderFileIndex])); */
 
-	/* NOTE: ComputePipeline for shaders */
+	/* NOTE: Every pipeline below goes through the on disk cache */
+	f64 pipelineStart = OsGetAbsoluteTime(MILLISECONDS);
+	VK_CHECK(vkPipelineCacheCreate(pCurrentCtx, gpPipelineCacheDirectory));
+
+	/* NOTE: Layout and push constants for the compute shaders */
 	VK_CHECK(vkComputePipelineInit(pCurrentCtx, pCurrentCtx->device.handle, gppShaderFilePath));
 
-	/* NOTE: TrianglePipeline Setup */
-	pCurrentCtx->triPipeline.pVertexShaderFilePath		= "./build/obj/engine/shaders/colored_triangle.vert.spv";
-	pCurrentCtx->triPipeline.pFragmentShaderFilePath	= "./build/obj/engine/shaders/colored_triangle.frag.spv";
-
-	DrawImage		depthImage	= pCurrentCtx->depthImage;
-	VkBool32		bDepthTest	= VK_FALSE;
-	VK_CHECK(vkGenericPipelineInit(
-				pCurrentCtx,
-				pCurrentCtx->device.handle,
-				&pCurrentCtx->triPipeline,
-				VK_NULL_HANDLE,
-				0,
-				depthImage.format,
-				bDepthTest));
-
-	/* NOTE: MeshPipeline Setup */
-	VkPushConstantRange	bufferRange			= {
+	/* NOTE: TilePipeline Setup, buffers and cull layout included */
+	VK_CHECK(vkTilesCreate(pCurrentCtx));
+	VkPushConstantRange	tileRange			= {
 		.offset		= 0,
-		.size		= sizeof(GpuMeshBuffers),
+		.size		= sizeof(TilePushConstants),
 		.stageFlags	= VK_SHADER_STAGE_VERTEX_BIT,
 	};
-	uint32_t			pushConstantCount	= 1;
-
-	pCurrentCtx->meshPipeline.pVertexShaderFilePath		= "./build/obj/engine/shaders/colored_triangle_mesh.vert.spv";
-	pCurrentCtx->meshPipeline.pFragmentShaderFilePath	= "./build/obj/engine/shaders/colored_triangle.frag.spv";
-	bDepthTest = VK_TRUE;
-	VK_CHECK(vkGenericPipelineInit(
-				pCurrentCtx,
-				pCurrentCtx->device.handle,
-				&pCurrentCtx->meshPipeline,
-				&bufferRange,
-				pushConstantCount,
-				depthImage.format,
-				bDepthTest));
-
-	VK_CHECK(DefaultDataInit(pCurrentCtx->device, pCurrentCtx->pAllocator, &pCurrentCtx->gpuMeshBuffers));
-
-	/* NOTE: Create queryPoolTimer, uses globals */
-	VkQueryPool* pool = NULL;
-	VK_CHECK(vkQueryPoolTimerCreate(pCurrentCtx->device.handle, pCurrentCtx->pAllocator, pool));
+
+	/*
+	 * NOTE: Each pipeline is a job: module load, create info and vkCreate*Pipelines.
+	 * They are joined below, after the mesh upload ran on this thread meanwhile.
+	 */
+	uint32_t			computeCount	= (uint32_t)DarrayCapacity(pCurrentCtx->pComputeShaders);
+	uint32_t			jobCount		= computeCount + 2;
+	PipelineBuildJob*	pJobs			= yAlloc(sizeof(PipelineBuildJob) * jobCount, MEMORY_TAG_RENDERER);
+	JobCounter			pipelineCounter	= {0};
+	for (uint32_t i = 0; i < computeCount; i++)
+	{
+		pJobs[i] = (PipelineBuildJob){
+			.pCtx			= pCurrentCtx,
+			.device			= pCurrentCtx->device.handle,
+			.pCompute		= &pCurrentCtx->pComputeShaders[i],
+		};
+	}
+	pJobs[computeCount] = (PipelineBuildJob){
+		.pCtx				= pCurrentCtx,
+		.device				= pCurrentCtx->device.handle,
+		.pPipeline			= &pCurrentCtx->pTileRenderer->pipeline,
+		.pushConstantRange	= tileRange,
+		.pushConstantCount	= 1,
+		.bDepthTest			= VK_FALSE,
+	};
+	pJobs[computeCount + 1] = (PipelineBuildJob){
+		.pCtx				= pCurrentCtx,
+		.device				= pCurrentCtx->device.handle,
+		.pCompute			= &pCurrentCtx->pTileRenderer->cull,
+	};
+	for (uint32_t i = 0; i < jobCount; i++)
+		JobSubmit(vkPipelineBuildJob, &pJobs[i], &pipelineCounter);
+
+	f64 dataStart = OsGetAbsoluteTime(MILLISECONDS);
+	VkResult dataResult = DefaultDataInit(pCurrentCtx, &pCurrentCtx->gpuMeshBuffers);
+	f64 dataTime = OsGetAbsoluteTime(MILLISECONDS) - dataStart;
+
+	/* NOTE: One timestamp query pool per frame in flight */
+	VkResult timerResult = vkGpuProfilerCreate(pCurrentCtx);
+	if (timerResult == VK_SUCCESS && gpGpuProfileCsvPath)
+		vkGpuProfilerCsvOpen(pCurrentCtx, gpGpuProfileCsvPath);
+	/* NOTE: Fed by the profiler's times, without it the frames stay at full resolution */
+	vkResolutionInit(pCurrentCtx, pConfig->gpuFrameTargetMs);
+
+	/* NOTE: Join before the first frame, jobs point into pJobs */
+	JobWait(&pipelineCounter);
+	f64			pipelineTime	= OsGetAbsoluteTime(MILLISECONDS) - pipelineStart;
+	f64			pipelineWork	= 0.0;
+	VkResult	pipelineResult	= VK_SUCCESS;
+	for (uint32_t i = 0; i < jobCount; i++)
+	{
+		pipelineWork += pJobs[i].elapsedMs;
+		if (pJobs[i].result != VK_SUCCESS)
+			pipelineResult = pJobs[i].result;
+	}
+	yFree(pJobs, jobCount, MEMORY_TAG_RENDERER);
+	VK_CHECK(pipelineResult);
+	VK_CHECK(dataResult);
+	VK_CHECK(timerResult);
+
+	/* NOTE: Rebuilds the compute pipelines when their SPIR-V changes on disk */
+	VK_CHECK(vkShaderReloadInit(pCurrentCtx, "./build/obj/engine/shaders"));
+
+	YINFO("vkInit %.2f ms: device %.2f, swapchain & sync %.2f, descriptors %.2f, pipelines %.2f "
+			"(%u jobs, %.2f ms of work on %u workers), mesh upload %.2f",
+			OsGetAbsoluteTime(MILLISECONDS) - initStart, deviceTime, swapchainTime, descriptorTime,
+			pipelineTime, jobCount, pipelineWork, JobSystemWorkerCount(), dataTime);
 
 	/* NOTE: Cleanup */
 	DarrayDestroy(ppRequiredExtensions);
@@ -234,7 +347,7 @@ vkInit(OsState *pOsState, void** ppOutCtx)
 }
 
 YND VkResult
-DefaultDataInit(VulkanDevice device, VkAllocationCallbacks* pAllocator, GpuMeshBuffers* pMeshBuffer)
+DefaultDataInit(VkContext* pCtx, GpuMeshBuffers* pMeshBuffer)
 {
 	Vertex* pRectVertices = DarrayReserve(Vertex, 4);
 	/* Vertex	pRectVertices[4]; */
@@ -260,7 +373,7 @@ DefaultDataInit(VulkanDevice device, VkAllocationCallbacks* pAllocator, GpuMeshB
 	pRectIndices[4] = 1;
 	pRectIndices[5] = 3;
 
-	VK_RESULT(vkMeshUpload(device, pAllocator, pRectIndices, pRectVertices, pMeshBuffer));
+	VK_RESULT(vkMeshUpload(pCtx, pRectIndices, pRectVertices, pMeshBuffer));
 
 	DarrayDestroy(pRectIndices);
 	DarrayDestroy(pRectVertices);
@@ -286,36 +399,40 @@ vkShutdown(void *pContext)
 
 	VK_ASSERT(vkDeviceWaitIdle(device));
 
-	vkDestroyBuffer(device, pCtx->gpuMeshBuffers.vertexBuffer.handle, pAllocator);
-	vkDestroyBuffer(device, pCtx->gpuMeshBuffers.indexBuffer.handle, pAllocator);
-	vkFreeMemory(device, pCtx->gpuMeshBuffers.vertexBuffer.memory, pAllocator);
-	vkFreeMemory(device, pCtx->gpuMeshBuffers.indexBuffer.memory, pAllocator);
+	vkShaderReloadShutdown(pCtx);
+	if (vkPipelineCacheSave(pCtx, gpPipelineCacheDirectory) == FALSE)
+		YWARN("Next launch will rebuild every pipeline");
+	vkPipelineCacheDestroy(pCtx);
+
+	vkTransferShutdown(pCtx);
+	vkAsyncComputeShutdown(pCtx);
+	vkStagingRingDestroy(pCtx);
+	vkBufferDestroy(myDevice, pAllocator, &pCtx->gpuMeshBuffers.vertexBuffer);
+	vkBufferDestroy(myDevice, pAllocator, &pCtx->gpuMeshBuffers.indexBuffer);
 
 	VulkanImmediateSubmit immediateSubmit = myDevice.immediateSubmit;
 	VK_ASSERT(vkCommandBufferFree(pCtx, &immediateSubmit.commandBuffer, &immediateSubmit.commandPool, 1));
 	VK_ASSERT(vkCommandPoolDestroy(pCtx, &immediateSubmit.commandPool, 1));
 	vkFenceDestroy(pCtx, &immediateSubmit.fence);
 
-	/* NOTE: temporary */
-	VkQueryPool dummy = 0;
-	vkQueryPoolTimerDestroy(device, pAllocator, dummy);
+	vkGpuProfilerDestroy(pCtx);
+	vkTracyContextDestroy(pCtx->pTracyContext);
 
 	vkPipelinesCleanUp(pCtx, device);
+	vkTilesDestroy(pCtx);
+	vkBindlessDestroy(pCtx);
 	vkDestroyDescriptorSetLayout(device, pCtx->drawImageDescriptorSetLayout, pAllocator);
-	vkDestroyDescriptorPool(device, pCtx->descriptorPool.handle, pAllocator);
+	vkDescriptorAllocatorDestroy(pCtx, &pCtx->descriptorAllocator);
 
-	uint32_t poolCount = 1;
-	VK_ASSERT(vkCommandBufferFree(pCtx, pCtx->pGfxCommands, &myDevice.graphicsCommandPool, pCtx->swapchain.imageCount));
-	VK_ASSERT(vkCommandPoolDestroy(pCtx, &myDevice.graphicsCommandPool, poolCount));
+	vkFramesDestroy(pCtx);
 
 	VK_ASSERT(vkSwapchainDestroy(pCtx, &pCtx->swapchain));
 
-	vkDestroyImage(device, pCtx->depthImage.image.handle, pAllocator);
-	vkDestroyImageView(device, pCtx->depthImage.image.view, pAllocator);
-	vkFreeMemory(device, pCtx->depthImage.image.memory, pAllocator);
-	vkDestroyImage(device, pCtx->drawImage.image.handle, pAllocator);
-	vkDestroyImageView(device, pCtx->drawImage.image.view, pAllocator);
-	vkFreeMemory(device, pCtx->drawImage.image.memory, pAllocator);
+	vkFrameDumpDestroy(pCtx);
+	vkDestroyVulkanImage(pCtx, &pCtx->depthImage.image);
+	vkTransientMemoryFree(pCtx, &pCtx->transientMemory);
+	vkDestroyVulkanImage(pCtx, &pCtx->drawImage.image);
+	vkBackgroundCacheDestroy(pCtx);
 
 	vkDestroySurfaceKHR(pCtx->instance, pCtx->surface, pAllocator);
 
@@ -326,19 +443,9 @@ vkShutdown(void *pContext)
 	DarrayDestroy(pCtx->swapchain.pFramebuffers);
 
 	vkRenderPassDestroy(pCtx, &pCtx->mainRenderpass); 
-	for (uint8_t i = 0; i < pCtx->swapchain.maxFrameInFlight; i++)
-	{
-		vkDestroySemaphore(device, pCtx->pSemaphoresAvailableImage[i], pAllocator);
-		vkDestroySemaphore(device, pCtx->pSemaphoresQueueComplete[i], pAllocator);
-		vkFenceDestroy(pCtx, &pCtx->pFencesInFlight[i]);
-	}
 
 	/* NOTE: Destroy Darrays */
-	DarrayDestroy(pCtx->pSemaphoresQueueComplete);
-	DarrayDestroy(pCtx->pSemaphoresAvailableImage);
-	DarrayDestroy(pCtx->pFencesInFlight);
 	DarrayDestroy(pCtx->ppImagesInFlight);
-	DarrayDestroy(pCtx->pGfxCommands);
 
 	/* TODO: Add check if NULL so we dont substract the size and prevent checking here */
 	if (pCtx->device.swapchainSupport.pFormats)
@@ -356,6 +463,8 @@ vkShutdown(void *pContext)
 				MEMORY_TAG_RENDERER);
 	}
 
+	vkAllocatorDestroy(&pCtx->device);
+
 	/* NOTE: Finally destroy device and instance */
 	vkDestroyDevice(pCtx->device.handle, pAllocator);
 	vkDestroyInstance(pCtx->instance, pAllocator);
@@ -363,28 +472,57 @@ vkShutdown(void *pContext)
 	yFree(pCtx, 1, MEMORY_TAG_RENDERER_CONTEXT);
 }
 
-static inline void
-SyncInit(VkContext* pCtx, VulkanDevice* pDevice)
+void
+vkFramebufferResize(uint32_t width, uint32_t height)
 {
-	b8 bSignaled = TRUE;
-    /*
-	 * NOTE: one fence to control when the gpu has finished rendering the frame,
-	 * and 2 semaphores to synchronize rendering with swapchain
-	 * we want the fence to start signalled so we can wait on it on the first frame
-	 * This will prevent the application from waiting indefinitely for the first frame to render since it
-	 * cannot be rendered until a frame is "rendered" before it.
-     */
-	for (uint8_t i = 0; i < pCtx->swapchain.maxFrameInFlight; i++)
+	if (gContext.contextCount == 0)
+		return ;
+
+	VkContext* pCtx = gContext.ppCtx[gContext.currentContext];
+	pCtx->framebufferWidth	= width;
+	pCtx->framebufferHeight	= height;
+	/* NOTE: vkDrawImpl compares it to framebufferSizeLastGeneration */
+	pCtx->framebufferSizeGeneration++;
+}
+
+static inline VkPresentModeKHR
+PresentModeFromConfig(const RendererConfig* pConfig)
+{
+	switch (pConfig->presentMode)
 	{
-		VkSemaphoreCreateInfo semaphoreCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
-		};
-		vkCreateSemaphore(pDevice->handle, &semaphoreCreateInfo, pCtx->pAllocator, &pCtx->pSemaphoresAvailableImage[i]);
-		vkCreateSemaphore(pDevice->handle, &semaphoreCreateInfo, pCtx->pAllocator, &pCtx->pSemaphoresQueueComplete[i]);
+		case RENDERER_PRESENT_MODE_FIFO:			return VK_PRESENT_MODE_FIFO_KHR;
+		case RENDERER_PRESENT_MODE_FIFO_RELAXED:	return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+		case RENDERER_PRESENT_MODE_MAILBOX:			return VK_PRESENT_MODE_MAILBOX_KHR;
+		case RENDERER_PRESENT_MODE_IMMEDIATE:		return VK_PRESENT_MODE_IMMEDIATE_KHR;
+		default:
+			return pConfig->bVsync ? VK_PRESENT_MODE_FIFO_KHR : VK_PRESENT_MODE_MAILBOX_KHR;
+	}
+}
 
-		/* NOTE: Assuming that the app CANNOT run without fences therefore we abort() in case of failure */
-		VK_ASSERT(vkFenceCreate(pDevice->handle, bSignaled, pCtx->pAllocator, &pCtx->pFencesInFlight[i]));
+/* NOTE: Its current extent is undefined, the swapchain takes the size it is given */
+YND static inline VkResult
+HeadlessSurfaceCreate(VkContext* pCtx)
+{
+	PFN_vkCreateHeadlessSurfaceEXT pfnCreateHeadlessSurface = (PFN_vkCreateHeadlessSurfaceEXT)
+		vkGetInstanceProcAddr(pCtx->instance, "vkCreateHeadlessSurfaceEXT");
+	if (!pfnCreateHeadlessSurface)
+	{
+		YERROR("VK_EXT_headless_surface is not available");
+		return VK_ERROR_EXTENSION_NOT_PRESENT;
 	}
+
+	VkHeadlessSurfaceCreateInfoEXT createInfo = {
+		.sType	= VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT,
+	};
+	VK_CHECK(pfnCreateHeadlessSurface(pCtx->instance, &createInfo, pCtx->pAllocator, &pCtx->surface));
+	return VK_SUCCESS;
+}
+
+static inline void
+SyncInit(VkContext* pCtx, VulkanDevice* pDevice)
+{
+	b8 bSignaled = TRUE;
+	/* NOTE: The frames' fences and semaphores live in vkFramesCreate */
 	/* NOTE: Fence for the immediate submit commands */
 	VK_ASSERT(vkFenceCreate(pDevice->handle, bSignaled, pCtx->pAllocator, &pDevice->immediateSubmit.fence))
 }
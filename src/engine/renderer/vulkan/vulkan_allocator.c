@@ -0,0 +1,513 @@
+#include "vulkan_allocator.h"
+
+#include "core/darray.h"
+#include "core/logger.h"
+#include "core/ymemory.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* NOTE: StrGetMemoryUsage's hook has no user data, one device is reported */
+static VulkanAllocator* gpReportedAllocator;
+
+static uint32_t
+OrderFromSize(VkDeviceSize size)
+{
+	uint32_t order = VK_ALLOCATOR_MIN_ORDER;
+	while (((VkDeviceSize)1 << order) < size)
+		order++;
+	return order;
+}
+
+static uint32_t
+KindIndex(VulkanAllocator* pAllocator, VulkanAllocationKind kind)
+{
+	/* NOTE: No granularity constraint, linear and optimal can share blocks */
+	return pAllocator->bufferImageGranularity > 1 ? (uint32_t)kind : VULKAN_ALLOCATION_LINEAR;
+}
+
+static uint64_t
+vkAllocatorReport(char* pBuffer, uint64_t bufferSize)
+{
+	if (!gpReportedAllocator)
+		return 0;
+	return vkAllocatorStatsWrite(gpReportedAllocator, pBuffer, bufferSize);
+}
+
+YND static VkResult
+vkDeviceMemoryAllocate(
+		VulkanAllocator*					pAllocator,
+		VkDeviceSize						size,
+		uint32_t							memoryTypeIndex,
+		b8									bDeviceAddress,
+		const VkMemoryDedicatedAllocateInfo*	pDedicated,
+		VkDeviceMemory*						pOutMemory,
+		void**								ppOutMapped)
+{
+	if (pAllocator->deviceAllocationCount >= pAllocator->maxAllocationCount)
+	{
+		YERROR("maxMemoryAllocationCount (%u) reached", pAllocator->maxAllocationCount);
+		return VK_ERROR_TOO_MANY_OBJECTS;
+	}
+
+	VkMemoryAllocateFlagsInfo allocateFlagsInfo = {
+		.sType	= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+		.pNext	= pDedicated,
+		.flags	= bDeviceAddress ? VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT : 0,
+	};
+	VkMemoryAllocateInfo memoryAllocateInfo = {
+		.sType				= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		.pNext				= &allocateFlagsInfo,
+		.allocationSize		= size,
+		.memoryTypeIndex	= memoryTypeIndex,
+	};
+	VK_CHECK(vkAllocateMemory(pAllocator->device, &memoryAllocateInfo, pAllocator->pAllocator, pOutMemory));
+
+	*ppOutMapped = NULL;
+	VkMemoryPropertyFlags flags = pAllocator->memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+	if (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		VkResult result = vkMapMemory(pAllocator->device, *pOutMemory, 0, VK_WHOLE_SIZE, 0, ppOutMapped);
+		if (result != VK_SUCCESS)
+		{
+			vkFreeMemory(pAllocator->device, *pOutMemory, pAllocator->pAllocator);
+			VK_CHECK(result);
+		}
+	}
+	pAllocator->deviceAllocationCount++;
+	return VK_SUCCESS;
+}
+
+static void
+vkDeviceMemoryFree(VulkanAllocator* pAllocator, VkDeviceMemory memory)
+{
+	/* NOTE: Freeing implicitly unmaps */
+	vkFreeMemory(pAllocator->device, memory, pAllocator->pAllocator);
+	pAllocator->deviceAllocationCount--;
+}
+
+/***************************************************************************** BUDDY ***/
+
+YND static b8
+BuddyAlloc(VulkanMemoryBlock* pBlock, uint32_t level, uint32_t* pOutUnit)
+{
+	uint32_t topLevel = pBlock->order - VK_ALLOCATOR_MIN_ORDER;
+	uint32_t found = level;
+	while (found <= topLevel && DarrayLength(pBlock->ppFreeLists[found]) == 0)
+		found++;
+	if (found > topLevel)
+		return FALSE;
+
+	uint32_t unit;
+	DarrayPop(pBlock->ppFreeLists[found], &unit);
+	/* NOTE: Split down, the upper half of each split stays free */
+	while (found > level)
+	{
+		found--;
+		uint32_t buddy = unit + (1u << found);
+		DarrayPush(pBlock->ppFreeLists[found], buddy);
+	}
+	*pOutUnit = unit;
+	return TRUE;
+}
+
+static void
+BuddyFree(VulkanMemoryBlock* pBlock, uint32_t level, uint32_t unit)
+{
+	uint32_t topLevel = pBlock->order - VK_ALLOCATOR_MIN_ORDER;
+	while (level < topLevel)
+	{
+		uint32_t	buddy		= unit ^ (1u << level);
+		uint32_t*	pFreeList	= pBlock->ppFreeLists[level];
+		uint64_t	length		= DarrayLength(pFreeList);
+		uint64_t	i			= 0;
+		while (i < length && pFreeList[i] != buddy)
+			i++;
+		if (i == length)
+			break;
+		/* NOTE: Buddy is free too, take it out and merge one level up */
+		DarrayPop(pFreeList, &pFreeList[i]);
+		unit = unit < buddy ? unit : buddy;
+		level++;
+	}
+	DarrayPush(pBlock->ppFreeLists[level], unit);
+}
+
+YND static VkResult
+vkMemoryBlockCreate(VulkanAllocator* pAllocator, uint32_t memoryTypeIndex, uint32_t kind, VulkanMemoryBlock** ppOutBlock)
+{
+	uint32_t		order	= pAllocator->pBlockOrders[memoryTypeIndex];
+	VkDeviceSize	size	= (VkDeviceSize)1 << order;
+
+	VkDeviceMemory	memory;
+	void*			pMapped;
+	/* NOTE: Linear blocks hold the buffers read through vkGetBufferDeviceAddress */
+	VK_CHECK(vkDeviceMemoryAllocate(pAllocator, size, memoryTypeIndex, kind == VULKAN_ALLOCATION_LINEAR,
+				NULL, &memory, &pMapped));
+
+	VulkanMemoryBlock* pBlock = yAlloc(sizeof(VulkanMemoryBlock), MEMORY_TAG_RENDERER);
+	pBlock->memory			= memory;
+	pBlock->pMapped			= pMapped;
+	pBlock->memoryTypeIndex	= memoryTypeIndex;
+	pBlock->kind			= kind;
+	pBlock->order			= order;
+	for (uint32_t i = 0; i < VK_ALLOCATOR_ORDER_COUNT; i++)
+		pBlock->ppFreeLists[i] = DarrayCreate(uint32_t);
+	uint32_t whole = 0;
+	DarrayPush(pBlock->ppFreeLists[order - VK_ALLOCATOR_MIN_ORDER], whole);
+
+	DarrayPush(pAllocator->pppBlocks[memoryTypeIndex][kind], pBlock);
+	pAllocator->pStats[memoryTypeIndex].blockCount++;
+	pAllocator->pStats[memoryTypeIndex].blockBytes += size;
+	*ppOutBlock = pBlock;
+	return VK_SUCCESS;
+}
+
+static void
+vkMemoryBlockDestroy(VulkanAllocator* pAllocator, VulkanMemoryBlock* pBlock)
+{
+	vkDeviceMemoryFree(pAllocator, pBlock->memory);
+	for (uint32_t i = 0; i < VK_ALLOCATOR_ORDER_COUNT; i++)
+		DarrayDestroy(pBlock->ppFreeLists[i]);
+	pAllocator->pStats[pBlock->memoryTypeIndex].blockCount--;
+	pAllocator->pStats[pBlock->memoryTypeIndex].blockBytes -= (VkDeviceSize)1 << pBlock->order;
+	yFree(pBlock, 1, MEMORY_TAG_RENDERER);
+}
+
+/*************************************************************************** ALLOCATOR ***/
+
+YND VkResult
+vkAllocatorCreate(VulkanDevice* pDevice, VkAllocationCallbacks* pCallbacks)
+{
+	VulkanAllocator* pAllocator = yAlloc(sizeof(VulkanAllocator), MEMORY_TAG_RENDERER);
+	if (!OsMutexCreate(&pAllocator->mutex))
+	{
+		yFree(pAllocator, 1, MEMORY_TAG_RENDERER);
+		return VK_ERROR_INITIALIZATION_FAILED;
+	}
+
+	VkPhysicalDeviceLimits* pLimits = &pDevice->properties.limits;
+	pAllocator->device					= pDevice->handle;
+	pAllocator->pAllocator				= pCallbacks;
+	pAllocator->bufferImageGranularity	= pLimits->bufferImageGranularity;
+	pAllocator->nonCoherentAtomSize		= pLimits->nonCoherentAtomSize;
+	pAllocator->maxAllocationCount		= pLimits->maxMemoryAllocationCount;
+	vkGetPhysicalDeviceMemoryProperties(pDevice->physicalDevice, &pAllocator->memoryProperties);
+
+	VkPhysicalDeviceMemoryProperties* pProperties = &pAllocator->memoryProperties;
+	for (uint32_t i = 0; i < pProperties->memoryTypeCount; i++)
+	{
+		/* NOTE: Small heaps (256 MiB BAR) get blocks of an eighth of the heap at most */
+		VkDeviceSize	heapSize	= pProperties->memoryHeaps[pProperties->memoryTypes[i].heapIndex].size;
+		uint32_t		order		= VK_ALLOCATOR_MAX_BLOCK_ORDER;
+		while (order > VK_ALLOCATOR_MIN_ORDER + 8 && ((VkDeviceSize)1 << order) > heapSize / 8)
+			order--;
+		pAllocator->pBlockOrders[i] = order;
+		for (uint32_t kind = 0; kind < VULKAN_ALLOCATION_KIND_COUNT; kind++)
+			pAllocator->pppBlocks[i][kind] = DarrayCreate(VulkanMemoryBlock*);
+	}
+
+	pDevice->pMemoryAllocator = pAllocator;
+	gpReportedAllocator = pAllocator;
+	MemoryReportSet(vkAllocatorReport);
+	YINFO("Device memory allocator: %u memory types, granularity %llu, max %u allocations",
+			pProperties->memoryTypeCount, (unsigned long long)pAllocator->bufferImageGranularity,
+			pAllocator->maxAllocationCount);
+	return VK_SUCCESS;
+}
+
+void
+vkAllocatorDestroy(VulkanDevice* pDevice)
+{
+	VulkanAllocator* pAllocator = pDevice->pMemoryAllocator;
+	if (!pAllocator)
+		return ;
+
+	MemoryReportSet(NULL);
+	gpReportedAllocator = NULL;
+	for (uint32_t i = 0; i < pAllocator->memoryProperties.memoryTypeCount; i++)
+	{
+		VulkanMemoryTypeStats* pStats = &pAllocator->pStats[i];
+		if (pStats->allocationCount || pStats->dedicatedCount)
+		{
+			YWARN("Memory type %u: %u allocations and %u dedicated still alive at shutdown",
+					i, pStats->allocationCount, pStats->dedicatedCount);
+		}
+		for (uint32_t kind = 0; kind < VULKAN_ALLOCATION_KIND_COUNT; kind++)
+		{
+			VulkanMemoryBlock** ppBlocks = pAllocator->pppBlocks[i][kind];
+			for (uint64_t j = 0; j < DarrayLength(ppBlocks); j++)
+				vkMemoryBlockDestroy(pAllocator, ppBlocks[j]);
+			DarrayDestroy(ppBlocks);
+		}
+	}
+	OsMutexDestroy(&pAllocator->mutex);
+	yFree(pAllocator, 1, MEMORY_TAG_RENDERER);
+	pDevice->pMemoryAllocator = NULL;
+}
+
+YND static VkResult
+vkMemoryTypeFind(VulkanAllocator* pAllocator, uint32_t typeBits, VkMemoryPropertyFlags propertyFlags, uint32_t* pOutIndex)
+{
+	VkPhysicalDeviceMemoryProperties* pProperties = &pAllocator->memoryProperties;
+	for (uint32_t i = 0; i < pProperties->memoryTypeCount; i++)
+	{
+		if ((typeBits & (1u << i)) && (pProperties->memoryTypes[i].propertyFlags & propertyFlags) == propertyFlags)
+		{
+			*pOutIndex = i;
+			return VK_SUCCESS;
+		}
+	}
+	YWARN("Unable to find suitable memory type.");
+	return VK_ERROR_FEATURE_NOT_PRESENT;
+}
+
+YND static VkResult
+vkMemoryAllocateLocked(
+		VulkanAllocator*					pAllocator,
+		const VkMemoryRequirements*			pRequirements,
+		VkMemoryPropertyFlags				propertyFlags,
+		VulkanAllocationKind				kind,
+		b8									bDedicated,
+		VkMemoryDedicatedAllocateInfo		dedicated,
+		VulkanAllocation*					pOutAllocation)
+{
+	uint32_t memoryTypeIndex;
+	VK_CHECK(vkMemoryTypeFind(pAllocator, pRequirements->memoryTypeBits, propertyFlags, &memoryTypeIndex));
+	VulkanMemoryTypeStats* pStats = &pAllocator->pStats[memoryTypeIndex];
+
+	VkDeviceSize alignment = pRequirements->alignment;
+	VkMemoryPropertyFlags typeFlags = pAllocator->memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+	/* NOTE: Flushes of non coherent memory work on whole atoms, keep neighbours out of ours */
+	if ((typeFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(typeFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		alignment = alignment > pAllocator->nonCoherentAtomSize ? alignment : pAllocator->nonCoherentAtomSize;
+
+	VkDeviceSize	rounded	= pRequirements->size > alignment ? pRequirements->size : alignment;
+	uint32_t		order	= OrderFromSize(rounded);
+	if (bDedicated || order > pAllocator->pBlockOrders[memoryTypeIndex])
+	{
+		VkDeviceMemory	memory;
+		void*			pMapped;
+		b8				bDeviceAddress	= kind == VULKAN_ALLOCATION_LINEAR;
+		VK_CHECK(vkDeviceMemoryAllocate(pAllocator, pRequirements->size, memoryTypeIndex, bDeviceAddress,
+					bDedicated ? &dedicated : NULL, &memory, &pMapped));
+		*pOutAllocation = (VulkanAllocation){
+			.memory				= memory,
+			.offset				= 0,
+			.size				= pRequirements->size,
+			.pMapped			= pMapped,
+			.pBlock				= NULL,
+			.memoryTypeIndex	= memoryTypeIndex,
+		};
+		pStats->dedicatedCount++;
+		pStats->dedicatedBytes += pRequirements->size;
+		return VK_SUCCESS;
+	}
+
+	uint32_t			kindIndex	= KindIndex(pAllocator, kind);
+	uint32_t			level		= order - VK_ALLOCATOR_MIN_ORDER;
+	VulkanMemoryBlock**	ppBlocks	= pAllocator->pppBlocks[memoryTypeIndex][kindIndex];
+	VulkanMemoryBlock*	pBlock		= NULL;
+	uint32_t			unit		= 0;
+	for (uint64_t i = 0; i < DarrayLength(ppBlocks) && !pBlock; i++)
+	{
+		if (BuddyAlloc(ppBlocks[i], level, &unit))
+			pBlock = ppBlocks[i];
+	}
+	if (!pBlock)
+	{
+		VK_CHECK(vkMemoryBlockCreate(pAllocator, memoryTypeIndex, kindIndex, &pBlock));
+		if (!BuddyAlloc(pBlock, level, &unit))
+			return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+
+	VkDeviceSize offset = (VkDeviceSize)unit << VK_ALLOCATOR_MIN_ORDER;
+	*pOutAllocation = (VulkanAllocation){
+		.memory				= pBlock->memory,
+		.offset				= offset,
+		.size				= pRequirements->size,
+		.pMapped			= pBlock->pMapped ? (char*)pBlock->pMapped + offset : NULL,
+		.pBlock				= pBlock,
+		.memoryTypeIndex	= memoryTypeIndex,
+		.order				= order,
+	};
+	pBlock->allocationCount++;
+	pStats->allocationCount++;
+	pStats->usedBytes += (VkDeviceSize)1 << order;
+	pStats->requestedBytes += pRequirements->size;
+	return VK_SUCCESS;
+}
+
+YND VkResult
+vkMemoryAllocate(
+		VulkanAllocator*					pAllocator,
+		const VkMemoryRequirements*			pRequirements,
+		VkMemoryPropertyFlags				propertyFlags,
+		VulkanAllocationKind				kind,
+		b8									bDedicated,
+		VkMemoryDedicatedAllocateInfo		dedicated,
+		VulkanAllocation*					pOutAllocation)
+{
+	OsMutexLock(&pAllocator->mutex);
+	VkResult result = vkMemoryAllocateLocked(pAllocator, pRequirements, propertyFlags, kind, bDedicated,
+			dedicated, pOutAllocation);
+	OsMutexUnlock(&pAllocator->mutex);
+	return result;
+}
+
+void
+vkMemoryFree(VulkanAllocator* pAllocator, VulkanAllocation* pAllocation)
+{
+	if (pAllocation->memory == VK_NULL_HANDLE)
+		return ;
+
+	OsMutexLock(&pAllocator->mutex);
+	VulkanMemoryTypeStats*	pStats	= &pAllocator->pStats[pAllocation->memoryTypeIndex];
+	VulkanMemoryBlock*		pBlock	= pAllocation->pBlock;
+	if (!pBlock)
+	{
+		vkDeviceMemoryFree(pAllocator, pAllocation->memory);
+		pStats->dedicatedCount--;
+		pStats->dedicatedBytes -= pAllocation->size;
+	}
+	else
+	{
+		uint32_t unit = (uint32_t)(pAllocation->offset >> VK_ALLOCATOR_MIN_ORDER);
+		BuddyFree(pBlock, pAllocation->order - VK_ALLOCATOR_MIN_ORDER, unit);
+		pBlock->allocationCount--;
+		pStats->allocationCount--;
+		pStats->usedBytes -= (VkDeviceSize)1 << pAllocation->order;
+		pStats->requestedBytes -= pAllocation->size;
+
+		/* NOTE: Empty blocks go back to the driver, except the last one to avoid thrashing */
+		VulkanMemoryBlock** ppBlocks = pAllocator->pppBlocks[pBlock->memoryTypeIndex][pBlock->kind];
+		uint64_t blockCount = DarrayLength(ppBlocks);
+		if (pBlock->allocationCount == 0 && blockCount > 1)
+		{
+			for (uint64_t i = 0; i < blockCount; i++)
+			{
+				if (ppBlocks[i] != pBlock)
+					continue;
+				DarrayPop(ppBlocks, &ppBlocks[i]);
+				break;
+			}
+			vkMemoryBlockDestroy(pAllocator, pBlock);
+		}
+	}
+	OsMutexUnlock(&pAllocator->mutex);
+	*pAllocation = (VulkanAllocation){0};
+}
+
+YND VkResult
+vkBufferMemoryBind(VulkanDevice* pDevice, VkBuffer buffer, VkMemoryPropertyFlags propertyFlags, VulkanAllocation* pOutAllocation)
+{
+	VkMemoryDedicatedRequirements dedicatedRequirements = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+	};
+	VkMemoryRequirements2 memoryRequirements = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+		.pNext = &dedicatedRequirements,
+	};
+	VkBufferMemoryRequirementsInfo2 requirementsInfo = {
+		.sType	= VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2,
+		.buffer	= buffer,
+	};
+	vkGetBufferMemoryRequirements2(pDevice->handle, &requirementsInfo, &memoryRequirements);
+
+	VkMemoryDedicatedAllocateInfo dedicated = {
+		.sType	= VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+		.buffer	= buffer,
+	};
+	b8 bDedicated = dedicatedRequirements.requiresDedicatedAllocation
+		|| dedicatedRequirements.prefersDedicatedAllocation;
+	VK_CHECK(vkMemoryAllocate(
+				pDevice->pMemoryAllocator,
+				&memoryRequirements.memoryRequirements,
+				propertyFlags,
+				VULKAN_ALLOCATION_LINEAR,
+				bDedicated,
+				dedicated,
+				pOutAllocation));
+
+	VkResult result = vkBindBufferMemory(pDevice->handle, buffer, pOutAllocation->memory, pOutAllocation->offset);
+	if (result != VK_SUCCESS)
+		vkMemoryFree(pDevice->pMemoryAllocator, pOutAllocation);
+	return result;
+}
+
+YND VkResult
+vkImageMemoryBind(
+		VulkanDevice*						pDevice,
+		VkImage								image,
+		VkImageTiling						tiling,
+		VkMemoryPropertyFlags				propertyFlags,
+		VulkanAllocation*					pOutAllocation)
+{
+	VkMemoryDedicatedRequirements dedicatedRequirements = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+	};
+	VkMemoryRequirements2 memoryRequirements = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+		.pNext = &dedicatedRequirements,
+	};
+	VkImageMemoryRequirementsInfo2 requirementsInfo = {
+		.sType	= VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2,
+		.image	= image,
+	};
+	vkGetImageMemoryRequirements2(pDevice->handle, &requirementsInfo, &memoryRequirements);
+
+	VkMemoryDedicatedAllocateInfo dedicated = {
+		.sType	= VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+		.image	= image,
+	};
+	b8 bDedicated = dedicatedRequirements.requiresDedicatedAllocation
+		|| dedicatedRequirements.prefersDedicatedAllocation
+		|| memoryRequirements.memoryRequirements.size >= VK_ALLOCATOR_DEDICATED_SIZE;
+	VulkanAllocationKind kind = tiling == VK_IMAGE_TILING_LINEAR ? VULKAN_ALLOCATION_LINEAR : VULKAN_ALLOCATION_OPTIMAL;
+	VK_CHECK(vkMemoryAllocate(
+				pDevice->pMemoryAllocator,
+				&memoryRequirements.memoryRequirements,
+				propertyFlags,
+				kind,
+				bDedicated,
+				dedicated,
+				pOutAllocation));
+
+	VkResult result = vkBindImageMemory(pDevice->handle, image, pOutAllocation->memory, pOutAllocation->offset);
+	if (result != VK_SUCCESS)
+		vkMemoryFree(pDevice->pMemoryAllocator, pOutAllocation);
+	return result;
+}
+
+uint64_t
+vkAllocatorStatsWrite(VulkanAllocator* pAllocator, char* pBuffer, uint64_t bufferSize)
+{
+	const f64	mib		= 1024.0 * 1024.0;
+	uint64_t	offset	= 0;
+
+	OsMutexLock(&pAllocator->mutex);
+	for (uint32_t i = 0; i < pAllocator->memoryProperties.memoryTypeCount && offset < bufferSize; i++)
+	{
+		VulkanMemoryTypeStats* pStats = &pAllocator->pStats[i];
+		if (pStats->blockCount == 0 && pStats->dedicatedCount == 0)
+			continue;
+		if (offset == 0)
+			offset += snprintf(pBuffer, bufferSize, "Device memory use (per type):\n");
+		if (offset >= bufferSize)
+			break;
+		VkMemoryPropertyFlags flags = pAllocator->memoryProperties.memoryTypes[i].propertyFlags;
+		int32_t length = snprintf(pBuffer + offset, bufferSize - offset,
+				"  type %-2u %s%s%s: %u blocks %.2fMiB, %u allocs %.2fMiB (%.2fMiB asked), %u dedicated %.2fMiB\n",
+				i,
+				flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT ? "D" : "-",
+				flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT ? "V" : "-",
+				flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT ? "C" : "-",
+				pStats->blockCount, pStats->blockBytes / mib,
+				pStats->allocationCount, pStats->usedBytes / mib, pStats->requestedBytes / mib,
+				pStats->dedicatedCount, pStats->dedicatedBytes / mib);
+		if (length > 0)
+			offset += length;
+	}
+	OsMutexUnlock(&pAllocator->mutex);
+	return offset < bufferSize ? offset : bufferSize - 1;
+}
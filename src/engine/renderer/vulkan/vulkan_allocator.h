@@ -0,0 +1,121 @@
+#ifndef VULKAN_ALLOCATOR_H
+#define VULKAN_ALLOCATOR_H
+
+#include "yvulkan.h"
+
+/*
+ * NOTE: Device memory allocator. Each memory type keeps a list of big blocks
+ * (vkAllocateMemory) and hands out power of two ranges from them with a buddy
+ * scheme. Ranges are naturally aligned to their size so any alignment up to
+ * the range size comes for free.
+ * When bufferImageGranularity is above 1, linear resources (buffers, linear
+ * images) and optimal images live in separate blocks so they never share a page.
+ * Resources the driver wants dedicated, or images of VK_ALLOCATOR_DEDICATED_SIZE
+ * and more, get their own vkAllocateMemory.
+ */
+#define VK_ALLOCATOR_MIN_ORDER			8	/* NOTE: 256 bytes */
+#define VK_ALLOCATOR_MAX_BLOCK_ORDER	26	/* NOTE: 64 MiB */
+#define VK_ALLOCATOR_ORDER_COUNT		(VK_ALLOCATOR_MAX_BLOCK_ORDER - VK_ALLOCATOR_MIN_ORDER + 1)
+#define VK_ALLOCATOR_DEDICATED_SIZE		(16ull * 1024 * 1024)
+
+typedef enum VulkanAllocationKind
+{
+	VULKAN_ALLOCATION_LINEAR,
+	VULKAN_ALLOCATION_OPTIMAL,
+	VULKAN_ALLOCATION_KIND_COUNT,
+} VulkanAllocationKind;
+
+struct VulkanMemoryBlock
+{
+	VkDeviceMemory		memory;
+	void*				pMapped;
+	uint32_t			memoryTypeIndex;
+	uint32_t			kind;
+	uint32_t			order;
+	uint32_t			allocationCount;
+
+	// NOTE: Darrays of free ranges per order, offsets in VK_ALLOCATOR_MIN_ORDER units
+	uint32_t*			ppFreeLists[VK_ALLOCATOR_ORDER_COUNT];
+};
+
+typedef struct VulkanMemoryTypeStats
+{
+	uint32_t			blockCount;
+	uint32_t			allocationCount;
+	uint32_t			dedicatedCount;
+	VkDeviceSize		blockBytes;
+	VkDeviceSize		usedBytes;
+	VkDeviceSize		requestedBytes;
+	VkDeviceSize		dedicatedBytes;
+} VulkanMemoryTypeStats;
+
+struct VulkanAllocator
+{
+	VkDevice							device;
+	VkAllocationCallbacks*				pAllocator;
+	VkPhysicalDeviceMemoryProperties	memoryProperties;
+	VkDeviceSize						bufferImageGranularity;
+	VkDeviceSize						nonCoherentAtomSize;
+	uint32_t							maxAllocationCount;
+	uint32_t							deviceAllocationCount;
+	YMutex								mutex;
+
+	// NOTE: Darrays of VulkanMemoryBlock*, per memory type and kind
+	VulkanMemoryBlock**					pppBlocks[VK_MAX_MEMORY_TYPES][VULKAN_ALLOCATION_KIND_COUNT];
+	uint32_t							pBlockOrders[VK_MAX_MEMORY_TYPES];
+	VulkanMemoryTypeStats				pStats[VK_MAX_MEMORY_TYPES];
+};
+
+YND VkResult vkAllocatorCreate(
+		VulkanDevice*						pDevice,
+		VkAllocationCallbacks*				pAllocator);
+
+void vkAllocatorDestroy(
+		VulkanDevice*						pDevice);
+
+/**
+ * @brief	`dedicated` carries the buffer or image for a dedicated allocation,
+ *			it is only used when `bDedicated` is TRUE.
+ */
+YND VkResult vkMemoryAllocate(
+		VulkanAllocator*					pAllocator,
+		const VkMemoryRequirements*			pRequirements,
+		VkMemoryPropertyFlags				propertyFlags,
+		VulkanAllocationKind				kind,
+		b8									bDedicated,
+		VkMemoryDedicatedAllocateInfo		dedicated,
+		VulkanAllocation*					pOutAllocation);
+
+void vkMemoryFree(
+		VulkanAllocator*					pAllocator,
+		VulkanAllocation*					pAllocation);
+
+/**
+ * @brief	Allocates memory for `buffer` and binds it.
+ */
+YND VkResult vkBufferMemoryBind(
+		VulkanDevice*						pDevice,
+		VkBuffer							buffer,
+		VkMemoryPropertyFlags				propertyFlags,
+		VulkanAllocation*					pOutAllocation);
+
+/**
+ * @brief	Allocates memory for `image` and binds it, big images and the ones
+ *			the driver asks for go dedicated.
+ */
+YND VkResult vkImageMemoryBind(
+		VulkanDevice*						pDevice,
+		VkImage								image,
+		VkImageTiling						tiling,
+		VkMemoryPropertyFlags				propertyFlags,
+		VulkanAllocation*					pOutAllocation);
+
+/**
+ * @brief	Appends the per memory type usage to `pBuffer`, returns the length written.
+ */
+uint64_t vkAllocatorStatsWrite(
+		VulkanAllocator*					pAllocator,
+		char*								pBuffer,
+		uint64_t							bufferSize);
+
+#endif // VULKAN_ALLOCATOR_H
@@ -0,0 +1,388 @@
+#include "vulkan_async_compute.h"
+
+#include "vulkan_draw.h"
+#include "vulkan_frame.h"
+#include "vulkan_swapchain.h"
+#include "vulkan_descriptor.h"
+
+#include "core/logger.h"
+
+#include "profiler.h"
+
+extern int32_t gShaderFileIndex;
+
+/* NOTE: Same as the fences, a second is long enough to call it a hang */
+static const uint64_t gAsyncComputeTimeoutNs = 1000 * 1000 * 1000;
+
+YND static VkResult
+TimelineCreate(VkContext* pCtx, VkSemaphore* pOutSemaphore)
+{
+	VkSemaphoreTypeCreateInfo semaphoreTypeInfo = {
+		.sType			= VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+		.semaphoreType	= VK_SEMAPHORE_TYPE_TIMELINE,
+		.initialValue	= 0,
+	};
+	VkSemaphoreCreateInfo semaphoreCreateInfo = {
+		.sType	= VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		.pNext	= &semaphoreTypeInfo,
+	};
+	VK_CHECK(vkCreateSemaphore(pCtx->device.handle, &semaphoreCreateInfo, pCtx->pAllocator, pOutSemaphore));
+	return VK_SUCCESS;
+}
+
+YND static VkResult
+TimelineWait(VkContext* pCtx, VkSemaphore timeline, uint64_t value)
+{
+	if (value == 0)
+		return VK_SUCCESS;
+
+	VkSemaphoreWaitInfo waitInfo = {
+		.sType			= VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+		.semaphoreCount	= 1,
+		.pSemaphores	= &timeline,
+		.pValues		= &value,
+	};
+	VK_CHECK(vkWaitSemaphores(pCtx->device.handle, &waitInfo, gAsyncComputeTimeoutNs));
+	return VK_SUCCESS;
+}
+
+/* NOTE: Both halves of the ownership transfer must use the same barrier values */
+static VkImageMemoryBarrier2
+OwnershipBarrier(VkContext* pCtx, VkImage image)
+{
+	return (VkImageMemoryBarrier2){
+		.sType					= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+		.oldLayout				= VK_IMAGE_LAYOUT_GENERAL,
+		.newLayout				= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		.srcQueueFamilyIndex	= pCtx->device.computeQueueIndex,
+		.dstQueueFamilyIndex	= pCtx->device.graphicsQueueIndex,
+		.image					= image,
+		.subresourceRange		= {
+			.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT,
+			.baseMipLevel	= 0,
+			.levelCount		= 1,
+			.baseArrayLayer	= 0,
+			.layerCount		= 1,
+		},
+	};
+}
+
+static void
+ImageBarrier(VkCommandBuffer commandBuffer, const VkImageMemoryBarrier2* pBarrier)
+{
+	VkDependencyInfo dependencyInfo = {
+		.sType						= VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+		.imageMemoryBarrierCount	= 1,
+		.pImageMemoryBarriers		= pBarrier,
+	};
+	vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
+
+YND VkResult
+vkAsyncComputeInit(VkContext* pCtx, b8 bEnabled)
+{
+	VulkanAsyncCompute*	pAsync	= &pCtx->asyncCompute;
+	VulkanDevice*		pDevice	= &pCtx->device;
+
+	/* NOTE: The transfer family is left to the uploads, they submit from other threads */
+	pAsync->bEnabled = bEnabled
+		&& pDevice->computeQueueIndex >= 0
+		&& pDevice->computeQueueIndex != pDevice->graphicsQueueIndex
+		&& pDevice->computeQueueIndex != pDevice->transferQueueIndex;
+	if (!pAsync->bEnabled)
+	{
+		YINFO("No async compute queue family%s, backgrounds stay on the graphics queue",
+				bEnabled ? "" : " asked");
+		return VK_SUCCESS;
+	}
+
+	/* NOTE: One command buffer per slot, re-recorded once its last submit is done */
+	VkCommandPoolCreateInfo poolCreateInfo = {
+		.sType				= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags				= VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+		.queueFamilyIndex	= pDevice->computeQueueIndex,
+	};
+	VK_CHECK(vkCreateCommandPool(pDevice->handle, &poolCreateInfo, pCtx->pAllocator, &pAsync->commandPool));
+
+	VkCommandBufferAllocateInfo allocateInfo = {
+		.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		.level				= VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		.commandPool		= pAsync->commandPool,
+		.commandBufferCount	= VK_ASYNC_COMPUTE_SLOTS,
+	};
+	VK_CHECK(vkAllocateCommandBuffers(pDevice->handle, &allocateInfo, pAsync->pCommandBuffers));
+
+	VK_CHECK(TimelineCreate(pCtx, &pAsync->computeTimeline));
+	VK_CHECK(TimelineCreate(pCtx, &pAsync->graphicsTimeline));
+	pAsync->submittedValue		= 0;
+	pAsync->graphicsWaitValue	= 0;
+	pAsync->waitedValue			= 0;
+
+	/* NOTE: Same layout as the draw image's, vkAsyncComputeTargetsEnsure only rewrites them */
+	for (uint32_t s = 0; s < VK_ASYNC_COMPUTE_SLOTS; s++)
+	{
+		void* pNext = VK_NULL_HANDLE;
+		VK_CHECK(vkDescriptorAllocatorAllocate(
+					pCtx,
+					&pCtx->descriptorAllocator,
+					pCtx->drawImageDescriptorSetLayout,
+					pNext,
+					&pAsync->pDescriptorSets[s]));
+	}
+
+	VK_CHECK(vkAsyncComputeTargetsEnsure(pCtx));
+	YINFO("Backgrounds on compute queue family %d", pDevice->computeQueueIndex);
+	return VK_SUCCESS;
+}
+
+void
+vkAsyncComputeShutdown(VkContext* pCtx)
+{
+	VulkanAsyncCompute* pAsync = &pCtx->asyncCompute;
+	if (pAsync->commandPool == VK_NULL_HANDLE)
+		return ;
+
+	for (uint32_t s = 0; s < VK_ASYNC_COMPUTE_SLOTS; s++)
+		vkDestroyVulkanImage(pCtx, &pAsync->pBackgrounds[s].image);
+	vkDestroySemaphore(pCtx->device.handle, pAsync->graphicsTimeline, pCtx->pAllocator);
+	vkDestroySemaphore(pCtx->device.handle, pAsync->computeTimeline, pCtx->pAllocator);
+	/* NOTE: Frees the command buffers with it */
+	vkDestroyCommandPool(pCtx->device.handle, pAsync->commandPool, pCtx->pAllocator);
+	pAsync->commandPool	= VK_NULL_HANDLE;
+	pAsync->bEnabled	= FALSE;
+}
+
+YND static VkResult
+BackgroundDescriptorWrite(VkContext* pCtx, uint32_t slot)
+{
+	VulkanAsyncCompute* pAsync = &pCtx->asyncCompute;
+	VkDescriptorImageInfo descriptorImageInfo = {
+		.imageLayout	= VK_IMAGE_LAYOUT_GENERAL,
+		.imageView		= pAsync->pBackgrounds[slot].image.view,
+	};
+	VkWriteDescriptorSet writeDescriptorSet = {
+		.sType				= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstBinding			= 0,
+		.dstSet				= pAsync->pDescriptorSets[slot],
+		.descriptorCount	= 1,
+		.descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+		.pImageInfo			= &descriptorImageInfo,
+	};
+	vkUpdateDescriptorSets(pCtx->device.handle, 1, &writeDescriptorSet, 0, VK_NULL_HANDLE);
+	return VK_SUCCESS;
+}
+
+YND VkResult
+vkAsyncComputeTargetsEnsure(VkContext* pCtx)
+{
+	VulkanAsyncCompute*	pAsync		= &pCtx->asyncCompute;
+	VkExtent3D			capacity	= pCtx->drawImage.extent;
+	if (!pAsync->bEnabled)
+		return VK_SUCCESS;
+	if (pAsync->pBackgrounds[0].image.handle != VK_NULL_HANDLE
+			&& pAsync->pBackgrounds[0].extent.width == capacity.width
+			&& pAsync->pBackgrounds[0].extent.height == capacity.height)
+		return VK_SUCCESS;
+
+	/*
+	 * NOTE: The frame fences the retired images wait for do not cover the compute queue,
+	 * past this wait no submit uses the descriptor sets either, they can be rewritten
+	 */
+	VK_CHECK(TimelineWait(pCtx, pAsync->computeTimeline, pAsync->submittedValue));
+
+	VkImageUsageFlags usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	for (uint32_t s = 0; s < VK_ASYNC_COMPUTE_SLOTS; s++)
+	{
+		DrawImage* pBackground = &pAsync->pBackgrounds[s];
+		if (pBackground->image.handle != VK_NULL_HANDLE)
+		{
+			vkFrameRetirePush(pCtx, VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)pBackground->image.view, NULL);
+			vkFrameRetirePush(pCtx, VK_OBJECT_TYPE_IMAGE, (uint64_t)pBackground->image.handle,
+					pBackground->image.memory ? &pBackground->image.allocation : NULL);
+		}
+		*pBackground = (DrawImage){
+			.format	= pCtx->drawImage.format,
+			.extent	= capacity,
+		};
+		b8			bCreateView	= TRUE;
+		uint32_t	mipLevels	= 1;
+		VK_CHECK(vkImageCreate(
+					pCtx,
+					VK_IMAGE_TYPE_2D,
+					capacity.width,
+					capacity.height,
+					pBackground->format,
+					VK_IMAGE_TILING_OPTIMAL,
+					usage,
+					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+					bCreateView,
+					VK_IMAGE_ASPECT_COLOR_BIT,
+					&pBackground->image,
+					capacity,
+					mipLevels));
+		VK_CHECK(BackgroundDescriptorWrite(pCtx, s));
+		/* NOTE: Whatever is pending was written to the old image, never copy it */
+		pAsync->pExtents[s] = (VkExtent2D){0};
+	}
+	return VK_SUCCESS;
+}
+
+/*
+ * NOTE: Acquire half of the ownership transfer, then the copy. The semaphore
+ * wait of the submit is at the transfer stages, the barrier chains to it.
+ */
+static void
+BackgroundCopyPass(VkContext* pCtx, VkCommandBuffer commandBuffer, YMB void* pData)
+{
+	VulkanAsyncCompute*	pAsync	= &pCtx->asyncCompute;
+	uint32_t			slot	= pAsync->graphicsWaitValue % VK_ASYNC_COMPUTE_SLOTS;
+	VkImage				image	= pAsync->pBackgrounds[slot].image.handle;
+	VkExtent2D			extent	= pAsync->pExtents[slot];
+
+	VkImageMemoryBarrier2 acquireBarrier = OwnershipBarrier(pCtx, image);
+	acquireBarrier.srcStageMask		= VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+	acquireBarrier.dstStageMask		= VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+	acquireBarrier.dstAccessMask	= VK_ACCESS_2_TRANSFER_READ_BIT;
+	ImageBarrier(commandBuffer, &acquireBarrier);
+
+	VkImageCopy region = {
+		.srcSubresource	= {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+		.dstSubresource	= {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+		.extent			= {extent.width, extent.height, 1},
+	};
+	vkCmdCopyImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			pCtx->drawImage.image.handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+}
+
+/*
+ * NOTE: Waited even when not copied, this frame's fence then covers every
+ * compute submit before it, pipelines and images retire on those fences. A
+ * background already waited for was acquired or skipped, never copy it again.
+ */
+void
+vkAsyncComputeBackgroundWait(VkContext* pCtx)
+{
+	VulkanAsyncCompute* pAsync = &pCtx->asyncCompute;
+	if (!pAsync->bEnabled || pAsync->submittedValue == pAsync->waitedValue)
+		return ;
+	pAsync->graphicsWaitValue	= pAsync->submittedValue;
+	pAsync->waitedValue			= pAsync->submittedValue;
+}
+
+b8
+vkAsyncComputeBackgroundPassAdd(
+		VkContext*							pCtx,
+		VulkanRenderGraph*					pGraph,
+		uint32_t							drawTarget,
+		VkExtent2D							extent,
+		uint64_t							hash)
+{
+	VulkanAsyncCompute* pAsync = &pCtx->asyncCompute;
+	if (!pAsync->bEnabled || pAsync->graphicsWaitValue == 0)
+		return FALSE;
+
+	uint32_t slot = pAsync->graphicsWaitValue % VK_ASYNC_COMPUTE_SLOTS;
+	if (pAsync->pExtents[slot].width != extent.width
+			|| pAsync->pExtents[slot].height != extent.height
+			|| pAsync->pHashes[slot] != hash)
+		return FALSE;
+
+	/* NOTE: Left in its layout by the release, the pass acquires it */
+	uint32_t background = vkRenderGraphImageImport(pGraph, "async background",
+			pAsync->pBackgrounds[slot].image.handle, VK_IMAGE_ASPECT_COLOR_BIT,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_NONE);
+
+	uint32_t pass = vkRenderGraphPassAdd(pGraph, "background copy", BackgroundCopyPass, VK_NULL_HANDLE);
+	vkRenderGraphPassUse(pGraph, pass, background, RENDER_GRAPH_USAGE_TRANSFER_SRC);
+	vkRenderGraphPassUse(pGraph, pass, drawTarget, RENDER_GRAPH_USAGE_TRANSFER_DST);
+	return TRUE;
+}
+
+YND static VkResult
+BackgroundRecord(VkContext* pCtx, uint32_t slot, VkExtent2D extent)
+{
+	VulkanAsyncCompute*	pAsync			= &pCtx->asyncCompute;
+	VkCommandBuffer		commandBuffer	= pAsync->pCommandBuffers[slot];
+	VkImage				image			= pAsync->pBackgrounds[slot].image.handle;
+
+	VkCommandBufferBeginInfo beginInfo = {
+		.sType	= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags	= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+	};
+	VK_CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+	/* NOTE: Overwritten whole, after the graphics copy the submit waits for */
+	VkImageMemoryBarrier2 writeBarrier = OwnershipBarrier(pCtx, image);
+	writeBarrier.oldLayout				= VK_IMAGE_LAYOUT_UNDEFINED;
+	writeBarrier.newLayout				= VK_IMAGE_LAYOUT_GENERAL;
+	writeBarrier.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	writeBarrier.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	writeBarrier.srcStageMask			= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	writeBarrier.dstStageMask			= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	writeBarrier.dstAccessMask			= VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+	ImageBarrier(commandBuffer, &writeBarrier);
+
+	VK_CHECK(vkComputeShaderInvocation(pCtx, commandBuffer, pCtx->pComputeShaders[gShaderFileIndex],
+				pAsync->pDescriptorSets[slot], extent));
+
+	/* NOTE: Release half, the dst stage and access are ignored here */
+	VkImageMemoryBarrier2 releaseBarrier = OwnershipBarrier(pCtx, image);
+	releaseBarrier.srcStageMask		= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	releaseBarrier.srcAccessMask	= VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+	ImageBarrier(commandBuffer, &releaseBarrier);
+
+	VK_CHECK(vkEndCommandBuffer(commandBuffer));
+	return VK_SUCCESS;
+}
+
+YND VkResult
+vkAsyncComputeBackgroundSubmit(VkContext* pCtx, VkExtent2D extent, uint64_t hash)
+{
+	VulkanAsyncCompute* pAsync = &pCtx->asyncCompute;
+	if (!pAsync->bEnabled)
+		return VK_SUCCESS;
+	TracyCZoneN(submitCtx, "vkAsyncComputeBackgroundSubmit", 1);
+
+	uint64_t	value	= pAsync->submittedValue + 1;
+	uint32_t	slot	= value % VK_ASYNC_COMPUTE_SLOTS;
+
+	/* NOTE: The slot's command buffer was last submitted that many values ago */
+	if (value > VK_ASYNC_COMPUTE_SLOTS)
+		VK_CHECK(TimelineWait(pCtx, pAsync->computeTimeline, value - VK_ASYNC_COMPUTE_SLOTS));
+	VK_CHECK(BackgroundRecord(pCtx, slot, extent));
+	pAsync->pExtents[slot]	= extent;
+	pAsync->pHashes[slot]	= hash;
+
+	/* NOTE: The frame that copied the slot's previous background signaled its value */
+	VkSemaphoreSubmitInfo waitInfo = {
+		.sType		= VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+		.semaphore	= pAsync->graphicsTimeline,
+		.stageMask	= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+		.value		= value > VK_ASYNC_COMPUTE_SLOTS ? value - VK_ASYNC_COMPUTE_SLOTS : 0,
+	};
+	VkSemaphoreSubmitInfo signalInfo = {
+		.sType		= VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+		.semaphore	= pAsync->computeTimeline,
+		.stageMask	= VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+		.value		= value,
+	};
+	VkCommandBufferSubmitInfo cmdBufferSubmitInfo = {
+		.sType			= VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+		.commandBuffer	= pAsync->pCommandBuffers[slot],
+	};
+	VkSubmitInfo2 submitInfo2 = {
+		.sType						= VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+		.commandBufferInfoCount		= 1,
+		.pCommandBufferInfos		= &cmdBufferSubmitInfo,
+		.waitSemaphoreInfoCount		= waitInfo.value ? 1 : 0,
+		.pWaitSemaphoreInfos		= &waitInfo,
+		.signalSemaphoreInfoCount	= 1,
+		.pSignalSemaphoreInfos		= &signalInfo,
+	};
+	uint32_t submitCount = 1;
+	VK_CHECK(vkQueueSubmit2(pCtx->device.computeQueue, submitCount, &submitInfo2, VK_NULL_HANDLE));
+	pAsync->submittedValue = value;
+
+	TracyCZoneEnd(submitCtx);
+	return VK_SUCCESS;
+}
@@ -0,0 +1,57 @@
+#ifndef VULKAN_ASYNC_COMPUTE_H
+#define VULKAN_ASYNC_COMPUTE_H
+
+#include "yvulkan.h"
+#include "vulkan_render_graph.h"
+
+/**
+ * @brief	Left disabled without a compute family apart from the graphics and
+ *			transfer ones, or when `bEnabled` is FALSE. The background effects
+ *			then stay on the graphics queue, the API stays the same.
+ */
+YND VkResult vkAsyncComputeInit(
+		VkContext*							pCtx,
+		b8									bEnabled);
+
+/**
+ * @brief	Expects the device to be idle.
+ */
+void vkAsyncComputeShutdown(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Recreates the background slots at the draw image size. Waits for
+ *			the compute queue, the frames still copying retire the old ones.
+ */
+YND VkResult vkAsyncComputeTargetsEnsure(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Makes the frame's graphics submit wait for the last background
+ *			submitted, copied or not. Once per frame, before the passes.
+ */
+void vkAsyncComputeBackgroundWait(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Adds the pass copying the background the compute queue wrote last
+ *			frame into `drawTarget`. FALSE when there is none or it was written
+ *			with another vkBackgroundHash, the caller runs the effect itself.
+ */
+b8 vkAsyncComputeBackgroundPassAdd(
+		VkContext*							pCtx,
+		VulkanRenderGraph*					pGraph,
+		uint32_t							drawTarget,
+		VkExtent2D							extent,
+		uint64_t							hash);
+
+/**
+ * @brief	Submits the next frame's background at `extent` on the compute
+ *			queue, before the current frame's graphics submit.
+ */
+YND VkResult vkAsyncComputeBackgroundSubmit(
+		VkContext*							pCtx,
+		VkExtent2D							extent,
+		uint64_t							hash);
+
+#endif // VULKAN_ASYNC_COMPUTE_H
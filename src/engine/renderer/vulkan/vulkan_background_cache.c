@@ -0,0 +1,162 @@
+#include "vulkan_background_cache.h"
+
+#include "vulkan_frame.h"
+#include "vulkan_swapchain.h"
+
+/* NOTE: FNV-1a */
+static uint64_t
+BackgroundHashBytes(uint64_t hash, const void* pData, uint64_t size)
+{
+	const uint8_t* pBytes = pData;
+	for (uint64_t i = 0; i < size; i++)
+	{
+		hash ^= pBytes[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+uint64_t
+vkBackgroundHash(const ComputeShaderFx* pShader, VkExtent2D extent)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	hash = BackgroundHashBytes(hash, &pShader->pushConstant, sizeof(ComputePushConstant));
+	hash = BackgroundHashBytes(hash, &pShader->pipeline, sizeof(VkPipeline));
+	hash = BackgroundHashBytes(hash, &extent, sizeof(VkExtent2D));
+	return hash ? hash : 1;
+}
+
+YND VkResult
+vkBackgroundCacheEnsure(VkContext* pCtx)
+{
+	VulkanBackgroundCache*	pCache		= &pCtx->backgroundCache;
+	VkExtent3D				capacity	= pCtx->drawImage.extent;
+	if (pCache->image.image.handle != VK_NULL_HANDLE
+			&& pCache->image.extent.width == capacity.width
+			&& pCache->image.extent.height == capacity.height)
+		return VK_SUCCESS;
+
+	/* NOTE: Frames in flight may still copy from it */
+	if (pCache->image.image.handle != VK_NULL_HANDLE)
+	{
+		vkFrameRetirePush(pCtx, VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)pCache->image.image.view, NULL);
+		vkFrameRetirePush(pCtx, VK_OBJECT_TYPE_IMAGE, (uint64_t)pCache->image.image.handle,
+				pCache->image.image.memory ? &pCache->image.image.allocation : NULL);
+	}
+	*pCache = (VulkanBackgroundCache){
+		.image = {
+			.format	= pCtx->drawImage.format,
+			.extent	= capacity,
+		},
+	};
+
+	b8			bCreateView	= TRUE;
+	uint32_t	mipLevels	= 1;
+	VK_CHECK(vkImageCreate(
+				pCtx,
+				VK_IMAGE_TYPE_2D,
+				capacity.width,
+				capacity.height,
+				pCache->image.format,
+				VK_IMAGE_TILING_OPTIMAL,
+				VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				bCreateView,
+				VK_IMAGE_ASPECT_COLOR_BIT,
+				&pCache->image.image,
+				capacity,
+				mipLevels));
+	return VK_SUCCESS;
+}
+
+void
+vkBackgroundCacheDestroy(VkContext* pCtx)
+{
+	if (pCtx->backgroundCache.image.image.handle != VK_NULL_HANDLE)
+		vkDestroyVulkanImage(pCtx, &pCtx->backgroundCache.image.image);
+	pCtx->backgroundCache = (VulkanBackgroundCache){0};
+}
+
+static void
+ImageCopy(VkCommandBuffer commandBuffer, VkImage srcImage, VkImage dstImage, VkExtent2D extent)
+{
+	VkImageCopy region = {
+		.srcSubresource	= {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+		.dstSubresource	= {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+		.extent			= {extent.width, extent.height, 1},
+	};
+	vkCmdCopyImage(commandBuffer, srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+}
+
+static void
+BackgroundCacheReadPass(VkContext* pCtx, VkCommandBuffer commandBuffer, YMB void* pData)
+{
+	VulkanBackgroundCache* pCache = &pCtx->backgroundCache;
+	ImageCopy(commandBuffer, pCache->image.image.handle, pCtx->drawImage.image.handle, pCache->extent);
+}
+
+static void
+BackgroundCacheStorePass(VkContext* pCtx, VkCommandBuffer commandBuffer, YMB void* pData)
+{
+	VulkanBackgroundCache* pCache = &pCtx->backgroundCache;
+	ImageCopy(commandBuffer, pCtx->drawImage.image.handle, pCache->image.image.handle, pCache->extent);
+}
+
+b8
+vkBackgroundCachePassAdd(
+		VkContext*							pCtx,
+		VulkanRenderGraph*					pGraph,
+		uint32_t							drawTarget,
+		VkExtent2D							extent,
+		uint64_t							hash)
+{
+	VulkanBackgroundCache* pCache = &pCtx->backgroundCache;
+	if (pCache->hash != hash)
+		return FALSE;
+
+	/* NOTE: The store exported it in this layout, visible to the transfer reads */
+	uint32_t cached = vkRenderGraphImageImport(pGraph, "background cache", pCache->image.image.handle,
+			VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_NONE);
+
+	uint32_t pass = vkRenderGraphPassAdd(pGraph, "background cache", BackgroundCacheReadPass, VK_NULL_HANDLE);
+	vkRenderGraphPassUse(pGraph, pass, cached, RENDER_GRAPH_USAGE_TRANSFER_SRC);
+	vkRenderGraphPassUse(pGraph, pass, drawTarget, RENDER_GRAPH_USAGE_TRANSFER_DST);
+	pCache->extent = extent;
+	return TRUE;
+}
+
+b8
+vkBackgroundCacheStorePassAdd(
+		VkContext*							pCtx,
+		VulkanRenderGraph*					pGraph,
+		uint32_t							drawTarget,
+		VkExtent2D							extent,
+		uint64_t							hash)
+{
+	VulkanBackgroundCache*	pCache	= &pCtx->backgroundCache;
+	b8						bStable	= pCache->lastHash == hash;
+	pCache->bSettling	= !bStable && !pCache->bChanged;
+	pCache->bChanged	= !bStable;
+	pCache->lastHash	= hash;
+	if (!bStable)
+		return FALSE;
+
+	/* NOTE: Overwritten whole, after the copies earlier frames made from it */
+	uint32_t cached = vkRenderGraphImageImport(pGraph, "background cache", pCache->image.image.handle,
+			VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT);
+	vkRenderGraphExport(pGraph, cached, RENDER_GRAPH_USAGE_TRANSFER_SRC);
+
+	uint32_t pass = vkRenderGraphPassAdd(pGraph, "background store", BackgroundCacheStorePass, VK_NULL_HANDLE);
+	vkRenderGraphPassUse(pGraph, pass, drawTarget, RENDER_GRAPH_USAGE_TRANSFER_SRC);
+	vkRenderGraphPassUse(pGraph, pass, cached, RENDER_GRAPH_USAGE_TRANSFER_DST);
+	pCache->hash	= hash;
+	pCache->extent	= extent;
+	return TRUE;
+}
+
+b8
+vkBackgroundCacheSettling(const VkContext* pCtx)
+{
+	return pCtx->backgroundCache.bSettling;
+}
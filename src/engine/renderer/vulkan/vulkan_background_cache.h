@@ -0,0 +1,60 @@
+#ifndef VULKAN_BACKGROUND_CACHE_H
+#define VULKAN_BACKGROUND_CACHE_H
+
+#include "yvulkan.h"
+#include "vulkan_render_graph.h"
+
+/**
+ * @brief	Hash of everything `pShader` reads to draw the background at
+ *			`extent`: its push constants and pipeline, the extent itself. A
+ *			reloaded pipeline is a new handle, so a new hash. Never 0.
+ */
+uint64_t vkBackgroundHash(
+		const ComputeShaderFx*				pShader,
+		VkExtent2D							extent);
+
+/**
+ * @brief	Grows the cached image with the draw image, emptied when it does.
+ */
+YND VkResult vkBackgroundCacheEnsure(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Expects the device to be idle.
+ */
+void vkBackgroundCacheDestroy(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Adds the pass copying the cached background into `drawTarget`
+ *			when it was drawn with `hash`, FALSE when the effect has to run.
+ */
+b8 vkBackgroundCachePassAdd(
+		VkContext*							pCtx,
+		VulkanRenderGraph*					pGraph,
+		uint32_t							drawTarget,
+		VkExtent2D							extent,
+		uint64_t							hash);
+
+/**
+ * @brief	Adds the pass keeping what `drawTarget` holds as the cached
+ *			background, call it right after the effect. Only done once `hash`
+ *			held still for two frames, returns FALSE otherwise so animated
+ *			inputs never pay for the copy.
+ */
+b8 vkBackgroundCacheStorePassAdd(
+		VkContext*							pCtx,
+		VulkanRenderGraph*					pGraph,
+		uint32_t							drawTarget,
+		VkExtent2D							extent,
+		uint64_t							hash);
+
+/**
+ * @brief	TRUE when the last vkBackgroundCacheStorePassAdd saw the hash change
+ *			after it held still, the next frame likely draws with the same one.
+ *			Changing two frames in a row is an animation, nothing to predict.
+ */
+b8 vkBackgroundCacheSettling(
+		const VkContext*					pCtx);
+
+#endif // VULKAN_BACKGROUND_CACHE_H
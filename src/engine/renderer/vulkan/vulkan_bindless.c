@@ -0,0 +1,288 @@
+#include "vulkan_bindless.h"
+
+#include "vulkan_descriptor.h"
+
+#include "core/darray.h"
+#include "core/logger.h"
+#include "core/ymemory.h"
+
+static void
+SlotsInit(VulkanBindlessSlots* pSlots, uint32_t capacity, uint32_t reserved)
+{
+	pSlots->capacity	= capacity;
+	pSlots->highWater	= reserved;
+	pSlots->pUsed		= yAlloc(sizeof(b8) * capacity, MEMORY_TAG_RENDERER);
+	pSlots->pFree		= DarrayCreate(uint32_t);
+	pSlots->pRetired	= DarrayCreate(VulkanBindlessRetired);
+}
+
+static void
+SlotsDestroy(VulkanBindlessSlots* pSlots)
+{
+	yFree(pSlots->pUsed, pSlots->capacity, MEMORY_TAG_RENDERER);
+	DarrayDestroy(pSlots->pFree);
+	DarrayDestroy(pSlots->pRetired);
+}
+
+/* NOTE: Recycled slots first, the heap only grows when the free list is empty */
+static uint32_t
+SlotAcquire(VulkanBindlessSlots* pSlots)
+{
+	uint64_t freeCount = DarrayLength(pSlots->pFree);
+	if (freeCount)
+	{
+		uint32_t index = pSlots->pFree[freeCount - 1];
+		DarrayLengthSet(pSlots->pFree, freeCount - 1);
+		pSlots->pUsed[index] = TRUE;
+		return index;
+	}
+	if (pSlots->highWater >= pSlots->capacity)
+		return VK_BINDLESS_INVALID;
+	pSlots->pUsed[pSlots->highWater] = TRUE;
+	return pSlots->highWater++;
+}
+
+/* NOTE: Under the mutex, a slot already retired or never handed out stays put */
+static void
+SlotRetire(VulkanBindlessSlots* pSlots, uint32_t index, uint64_t frame)
+{
+	if (index >= pSlots->highWater || !pSlots->pUsed[index])
+	{
+		YWARN("Bindless slot %u removed while not in use", index);
+		return ;
+	}
+	pSlots->pUsed[index] = FALSE;
+
+	VulkanBindlessRetired retired = {
+		.index	= index,
+		.frame	= frame,
+	};
+	DarrayPush(pSlots->pRetired, retired);
+}
+
+static void
+SlotsCollect(VulkanBindlessSlots* pSlots, uint64_t currentFrame, uint32_t framesInFlight)
+{
+	uint64_t kept = 0;
+	for (uint64_t i = 0; i < DarrayLength(pSlots->pRetired); i++)
+	{
+		VulkanBindlessRetired retired = pSlots->pRetired[i];
+		if (retired.frame + framesInFlight <= currentFrame)
+		{
+			DarrayPush(pSlots->pFree, retired.index);
+		}
+		else
+			pSlots->pRetired[kept++] = retired;
+	}
+	DarrayLengthSet(pSlots->pRetired, kept);
+}
+
+YND VkResult
+vkBindlessCreate(VkContext* pCtx)
+{
+	VkDevice			device		= pCtx->device.handle;
+	VulkanBindless*		pBindless	= yAlloc(sizeof(VulkanBindless), MEMORY_TAG_RENDERER);
+	pCtx->pBindless					= pBindless;
+	if (!OsMutexCreate(&pBindless->mutex))
+		return VK_ERROR_INITIALIZATION_FAILED;
+
+	SlotsInit(&pBindless->textures, VK_BINDLESS_MAX_TEXTURES, VK_BINDLESS_TEXTURE_NONE + 1);
+	SlotsInit(&pBindless->samplers, VK_BINDLESS_MAX_SAMPLERS, 0);
+
+	VkDescriptorPoolSize pPoolSizes[2] = {
+		{ .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,	.descriptorCount = VK_BINDLESS_MAX_TEXTURES },
+		{ .type = VK_DESCRIPTOR_TYPE_SAMPLER,		.descriptorCount = VK_BINDLESS_MAX_SAMPLERS },
+	};
+	VkDescriptorPoolCreateInfo poolCreateInfo = {
+		.sType			= VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.flags			= VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+		.maxSets		= 1,
+		.poolSizeCount	= 2,
+		.pPoolSizes		= pPoolSizes,
+	};
+	VK_CHECK(vkCreateDescriptorPool(device, &poolCreateInfo, pCtx->pAllocator, &pBindless->pool));
+
+	VkDescriptorSetLayoutBinding* pBindings = DarrayReserve(VkDescriptorSetLayoutBinding, 2);
+	pBindings[0] = (VkDescriptorSetLayoutBinding){
+		.binding			= VK_BINDLESS_BINDING_TEXTURES,
+		.descriptorType		= VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+		.descriptorCount	= VK_BINDLESS_MAX_TEXTURES,
+	};
+	pBindings[1] = (VkDescriptorSetLayoutBinding){
+		.binding			= VK_BINDLESS_BINDING_SAMPLERS,
+		.descriptorType		= VK_DESCRIPTOR_TYPE_SAMPLER,
+		.descriptorCount	= VK_BINDLESS_MAX_SAMPLERS,
+	};
+
+	/* NOTE: Unwritten slots are fine as long as nothing reads them */
+	VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+										  | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+										  | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+	VkDescriptorBindingFlags pBindingFlags[2] = { bindingFlags, bindingFlags };
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {
+		.sType			= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+		.bindingCount	= 2,
+		.pBindingFlags	= pBindingFlags,
+	};
+	VkResult result = vkDescriptorSetLayoutCreate(
+			pBindings,
+			device,
+			pCtx,
+			VK_SHADER_STAGE_FRAGMENT_BIT,
+			&bindingFlagsInfo,
+			VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+			&pBindless->layout);
+	DarrayDestroy(pBindings);
+	VK_CHECK(result);
+
+	VK_CHECK(vkDescriptorSetAllocate(device, pBindless->layout, &pBindless->set, pBindless->pool));
+
+	VkSamplerCreateInfo samplerCreateInfo = {
+		.sType			= VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+		.magFilter		= VK_FILTER_LINEAR,
+		.minFilter		= VK_FILTER_LINEAR,
+		.mipmapMode		= VK_SAMPLER_MIPMAP_MODE_LINEAR,
+		.addressModeU	= VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+		.addressModeV	= VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+		.addressModeW	= VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+		.maxLod			= VK_LOD_CLAMP_NONE,
+	};
+	VK_CHECK(vkCreateSampler(device, &samplerCreateInfo, pCtx->pAllocator, &pBindless->defaultSampler));
+	if (vkBindlessSamplerAdd(pCtx, pBindless->defaultSampler) != VK_BINDLESS_SAMPLER_DEFAULT)
+		return VK_ERROR_INITIALIZATION_FAILED;
+
+	return VK_SUCCESS;
+}
+
+void
+vkBindlessDestroy(VkContext* pCtx)
+{
+	VulkanBindless* pBindless = pCtx->pBindless;
+	if (!pBindless)
+		return ;
+
+	VkDevice device = pCtx->device.handle;
+	vkDestroySampler(device, pBindless->defaultSampler, pCtx->pAllocator);
+	/* NOTE: Frees the set with it */
+	vkDestroyDescriptorPool(device, pBindless->pool, pCtx->pAllocator);
+	vkDestroyDescriptorSetLayout(device, pBindless->layout, pCtx->pAllocator);
+	SlotsDestroy(&pBindless->textures);
+	SlotsDestroy(&pBindless->samplers);
+	OsMutexDestroy(&pBindless->mutex);
+	yFree(pBindless, 1, MEMORY_TAG_RENDERER);
+	pCtx->pBindless = NULL;
+}
+
+static uint32_t
+vkBindlessWrite(
+		VkContext*				pCtx,
+		VulkanBindlessSlots*	pSlots,
+		uint32_t				binding,
+		VkDescriptorType		type,
+		VkDescriptorImageInfo	imageInfo)
+{
+	VulkanBindless* pBindless = pCtx->pBindless;
+
+	/* NOTE: Held through the write, the set's updates have to be externally synced */
+	OsMutexLock(&pBindless->mutex);
+	uint32_t index = SlotAcquire(pSlots);
+	if (index != VK_BINDLESS_INVALID)
+	{
+		VkWriteDescriptorSet writeDescriptorSet = {
+			.sType				= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet				= pBindless->set,
+			.dstBinding			= binding,
+			.dstArrayElement	= index,
+			.descriptorCount	= 1,
+			.descriptorType		= type,
+			.pImageInfo			= &imageInfo,
+		};
+		vkUpdateDescriptorSets(pCtx->device.handle, 1, &writeDescriptorSet, 0, VK_NULL_HANDLE);
+	}
+	OsMutexUnlock(&pBindless->mutex);
+
+	if (index == VK_BINDLESS_INVALID)
+		YERROR("Bindless heap full: %u descriptors of type %s", pSlots->capacity, string_VkDescriptorType(type));
+	return index;
+}
+
+uint32_t
+vkBindlessTextureAdd(VkContext* pCtx, VkImageView view, VkImageLayout layout)
+{
+	VkDescriptorImageInfo imageInfo = {
+		.imageView		= view,
+		.imageLayout	= layout,
+	};
+	return vkBindlessWrite(pCtx, &pCtx->pBindless->textures, VK_BINDLESS_BINDING_TEXTURES,
+			VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, imageInfo);
+}
+
+uint32_t
+vkBindlessSamplerAdd(VkContext* pCtx, VkSampler sampler)
+{
+	VkDescriptorImageInfo imageInfo = {
+		.sampler = sampler,
+	};
+	return vkBindlessWrite(pCtx, &pCtx->pBindless->samplers, VK_BINDLESS_BINDING_SAMPLERS,
+			VK_DESCRIPTOR_TYPE_SAMPLER, imageInfo);
+}
+
+void
+vkBindlessTextureRemove(VkContext* pCtx, uint32_t index)
+{
+	VulkanBindless* pBindless = pCtx->pBindless;
+	if (index == VK_BINDLESS_TEXTURE_NONE)
+		return ;
+
+	OsMutexLock(&pBindless->mutex);
+	SlotRetire(&pBindless->textures, index, pCtx->nbFrames);
+	OsMutexUnlock(&pBindless->mutex);
+}
+
+void
+vkBindlessSamplerRemove(VkContext* pCtx, uint32_t index)
+{
+	VulkanBindless* pBindless = pCtx->pBindless;
+	if (index == VK_BINDLESS_SAMPLER_DEFAULT)
+		return ;
+
+	OsMutexLock(&pBindless->mutex);
+	SlotRetire(&pBindless->samplers, index, pCtx->nbFrames);
+	OsMutexUnlock(&pBindless->mutex);
+}
+
+void
+vkBindlessCollect(VkContext* pCtx)
+{
+	VulkanBindless* pBindless = pCtx->pBindless;
+
+	/*
+	 * NOTE: A slot removed during frame N may be read until frame N's fence,
+	 * vkFrameBegin waits it when nbFrames reaches N + maxFrameInFlight.
+	 */
+	OsMutexLock(&pBindless->mutex);
+	SlotsCollect(&pBindless->textures, pCtx->nbFrames, pCtx->swapchain.maxFrameInFlight);
+	SlotsCollect(&pBindless->samplers, pCtx->nbFrames, pCtx->swapchain.maxFrameInFlight);
+	OsMutexUnlock(&pBindless->mutex);
+}
+
+void
+vkBindlessBind(
+		VkContext*				pCtx,
+		VkCommandBuffer			commandBuffer,
+		VkPipelineBindPoint		bindPoint,
+		VkPipelineLayout		layout,
+		uint32_t				firstSet)
+{
+	uint32_t descriptorSetCount	= 1;
+	uint32_t dynamicOffsetCount	= 0;
+	vkCmdBindDescriptorSets(
+			commandBuffer,
+			bindPoint,
+			layout,
+			firstSet,
+			descriptorSetCount,
+			&pCtx->pBindless->set,
+			dynamicOffsetCount,
+			VK_NULL_HANDLE);
+}
@@ -0,0 +1,107 @@
+#ifndef VULKAN_BINDLESS_H
+#define VULKAN_BINDLESS_H
+
+#include "yvulkan.h"
+
+/*
+ * NOTE: One descriptor set holding every sampled image and sampler, bound
+ * once per frame and indexed from the per instance data. Bindings are
+ * partially bound and update after bind, slots are written while the set is
+ * bound and a removed slot is recycled once no frame in flight can read it.
+ */
+#define VK_BINDLESS_MAX_TEXTURES		4096
+#define VK_BINDLESS_MAX_SAMPLERS		64
+
+#define VK_BINDLESS_BINDING_TEXTURES	0
+#define VK_BINDLESS_BINDING_SAMPLERS	1
+
+/* NOTE: Texture slot 0 is never written, it reads as "untextured" in the shaders */
+#define VK_BINDLESS_TEXTURE_NONE		0
+/* NOTE: Sampler slot 0 is the default linear, clamp to edge sampler */
+#define VK_BINDLESS_SAMPLER_DEFAULT		0
+#define VK_BINDLESS_INVALID				UINT32_MAX
+
+typedef struct VulkanBindlessRetired
+{
+	uint32_t				index;
+	// NOTE: pCtx->nbFrames when it was removed
+	uint64_t				frame;
+} VulkanBindlessRetired;
+
+typedef struct VulkanBindlessSlots
+{
+	uint32_t				capacity;
+	// NOTE: Slots below it were handed out at least once
+	uint32_t				highWater;
+	// NOTE: capacity entries, TRUE from acquire to retire, a second remove is ignored
+	b8*						pUsed;
+	// NOTE: Darrays
+	uint32_t*				pFree;
+	VulkanBindlessRetired*	pRetired;
+} VulkanBindlessSlots;
+
+struct VulkanBindless
+{
+	VkDescriptorPool		pool;
+	VkDescriptorSetLayout	layout;
+	VkDescriptorSet			set;
+	VkSampler				defaultSampler;
+
+	YMutex					mutex;
+	VulkanBindlessSlots		textures;
+	VulkanBindlessSlots		samplers;
+};
+
+YND VkResult vkBindlessCreate(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Expects the device to be idle.
+ */
+void vkBindlessDestroy(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Writes `view` to a free slot and returns its index, VK_BINDLESS_INVALID
+ *			when the heap is full. Safe from any thread.
+ */
+uint32_t vkBindlessTextureAdd(
+		VkContext*							pCtx,
+		VkImageView							view,
+		VkImageLayout						layout);
+
+/**
+ * @brief	The slot is handed out again once the frames in flight are done with it.
+ *			`view` has to outlive them as well.
+ */
+void vkBindlessTextureRemove(
+		VkContext*							pCtx,
+		uint32_t							index);
+
+uint32_t vkBindlessSamplerAdd(
+		VkContext*							pCtx,
+		VkSampler							sampler);
+
+void vkBindlessSamplerRemove(
+		VkContext*							pCtx,
+		uint32_t							index);
+
+/**
+ * @brief	Moves the slots no frame in flight can read anymore to the free
+ *			lists, call after vkFrameBegin.
+ */
+void vkBindlessCollect(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Binds the set at `firstSet` of `layout`, which must have been made
+ *			with pCtx->pBindless->layout there.
+ */
+void vkBindlessBind(
+		VkContext*							pCtx,
+		VkCommandBuffer						commandBuffer,
+		VkPipelineBindPoint					bindPoint,
+		VkPipelineLayout					layout,
+		uint32_t							firstSet);
+
+#endif // VULKAN_BINDLESS_H
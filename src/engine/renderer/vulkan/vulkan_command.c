@@ -86,35 +86,6 @@ vkCommandPoolCreate(VulkanDevice device, VkAllocationCallbacks* pAllocator, VkCo
 	return VK_SUCCESS;
 }
 
-YND VkResult 
-vkCommandBufferCreate(VkContext *pCtx)
-{
-    if (!pCtx->pGfxCommands) 
-	{
-        pCtx->pGfxCommands = DarrayReserve(VulkanCommandBuffer, pCtx->swapchain.imageCount);
-        for (uint32_t i = 0; i < pCtx->swapchain.imageCount; ++i) {
-            memset(&pCtx->pGfxCommands[i], 0, sizeof(VulkanCommandBuffer));
-        }
-    }
-    for (uint32_t i = 0; i < pCtx->swapchain.imageCount; ++i) 
-	{
-        if (pCtx->pGfxCommands[i].handle) 
-		{
-            /*
-             * vulkan_command_buffer_free(
-             *     &context,
-             *     context.device.graphics_command_pool,
-             *     &context.graphics_command_buffers[i]);
-             */
-        }
-        memset(&pCtx->pGfxCommands[i], 0, sizeof(VulkanCommandBuffer));
-        VK_CHECK(vkCommandBufferAllocate(pCtx->device.handle, VK_COMMAND_BUFFER_LEVEL_PRIMARY, 
-					pCtx->device.graphicsCommandPool, &pCtx->pGfxCommands[i]));
-    }
-    YINFO("Vulkan command buffers created.");
-	return VK_SUCCESS;
-}
-
 YND VkResult
 vkCommandBufferAllocate(VkDevice device, VkCommandBufferLevel cmdBufferLvl, VkCommandPool pool,
 		VulkanCommandBuffer *pOutCommandBuffers)
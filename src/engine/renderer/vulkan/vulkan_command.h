@@ -39,9 +39,6 @@ YND VkResult vkCommandBufferFree(
 		VkCommandPool*						pPool,
 		uint32_t							poolCount);
 
-YND VkResult vkCommandBufferCreate(
-		VkContext*							pCtx);
-
 void vkCommandBufferBegin(
 		VulkanCommandBuffer*				pCmd,
 		b8									bSingleUse,
@@ -95,6 +95,115 @@ vkDescriptorAllocatorPoolInit(
 	return VK_SUCCESS;
 }
 
+/* NOTE: A ready pool, a new one when there is none left */
+YND static VkResult
+vkDescriptorAllocatorPoolGet(VkContext* pCtx, DescriptorAllocator* pAllocator, VkDescriptorPool* pOutPool)
+{
+	uint64_t readyCount = DarrayLength(pAllocator->pReadyPools);
+	if (readyCount)
+	{
+		*pOutPool = pAllocator->pReadyPools[readyCount - 1];
+		DarrayLengthSet(pAllocator->pReadyPools, readyCount - 1);
+		return VK_SUCCESS;
+	}
+
+	VK_CHECK(vkDescriptorAllocatorPoolInit(pCtx, pOutPool, pCtx->device.handle, pAllocator->setsPerPool,
+				pAllocator->pRatios));
+
+	/* NOTE: Next one is bigger, fewer pools when the demand keeps growing */
+	uint32_t setsPerPool = pAllocator->setsPerPool + pAllocator->setsPerPool / 2;
+	pAllocator->setsPerPool = setsPerPool > DESCRIPTOR_ALLOCATOR_MAX_SETS ? DESCRIPTOR_ALLOCATOR_MAX_SETS : setsPerPool;
+	return VK_SUCCESS;
+}
+
+YND VkResult
+vkDescriptorAllocatorInit(
+		VkContext*							pCtx,
+		DescriptorAllocator*				pAllocator,
+		uint32_t							initialSets,
+		const PoolSizeRatio*				pRatios,
+		uint32_t							ratioCount)
+{
+	/* NOTE: vkDescriptorAllocatorPoolInit walks the capacity */
+	pAllocator->pRatios		= DarrayReserve(PoolSizeRatio, ratioCount);
+	DarrayLengthSet(pAllocator->pRatios, ratioCount);
+	for (uint32_t i = 0; i < ratioCount; i++)
+		pAllocator->pRatios[i] = pRatios[i];
+	pAllocator->pReadyPools	= DarrayCreate(VkDescriptorPool);
+	pAllocator->pFullPools	= DarrayCreate(VkDescriptorPool);
+	pAllocator->setsPerPool	= initialSets;
+
+	VkDescriptorPool pool;
+	VK_CHECK(vkDescriptorAllocatorPoolGet(pCtx, pAllocator, &pool));
+	DarrayPush(pAllocator->pReadyPools, pool);
+	return VK_SUCCESS;
+}
+
+void
+vkDescriptorAllocatorDestroy(VkContext* pCtx, DescriptorAllocator* pAllocator)
+{
+	if (!pAllocator->pRatios)
+		return ;
+
+	VkDevice device = pCtx->device.handle;
+	for (uint64_t i = 0; i < DarrayLength(pAllocator->pReadyPools); i++)
+		vkDestroyDescriptorPool(device, pAllocator->pReadyPools[i], pCtx->pAllocator);
+	for (uint64_t i = 0; i < DarrayLength(pAllocator->pFullPools); i++)
+		vkDestroyDescriptorPool(device, pAllocator->pFullPools[i], pCtx->pAllocator);
+	DarrayDestroy(pAllocator->pReadyPools);
+	DarrayDestroy(pAllocator->pFullPools);
+	DarrayDestroy(pAllocator->pRatios);
+	*pAllocator = (DescriptorAllocator){0};
+}
+
+YND VkResult
+vkDescriptorAllocatorAllocate(
+		VkContext*							pCtx,
+		DescriptorAllocator*				pAllocator,
+		VkDescriptorSetLayout				layout,
+		void*								pNext,
+		VkDescriptorSet*					pOutDescriptorSet)
+{
+	VkDescriptorPool pool;
+	VK_CHECK(vkDescriptorAllocatorPoolGet(pCtx, pAllocator, &pool));
+
+	VkDescriptorSetAllocateInfo allocateInfo = {
+		.sType				= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.pNext				= pNext,
+		.descriptorPool		= pool,
+		.descriptorSetCount	= 1,
+		.pSetLayouts		= &layout,
+	};
+	VkResult result = vkAllocateDescriptorSets(pCtx->device.handle, &allocateInfo, pOutDescriptorSet);
+
+	/* NOTE: Out of sets or of one descriptor type, only a new pool helps */
+	if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+	{
+		DarrayPush(pAllocator->pFullPools, pool);
+		VK_CHECK(vkDescriptorAllocatorPoolGet(pCtx, pAllocator, &pool));
+		allocateInfo.descriptorPool = pool;
+		result = vkAllocateDescriptorSets(pCtx->device.handle, &allocateInfo, pOutDescriptorSet);
+	}
+	DarrayPush(pAllocator->pReadyPools, pool);
+	VK_CHECK(result);
+	return VK_SUCCESS;
+}
+
+YND VkResult
+vkDescriptorAllocatorReset(VkContext* pCtx, DescriptorAllocator* pAllocator)
+{
+	VkDevice device = pCtx->device.handle;
+	for (uint64_t i = 0; i < DarrayLength(pAllocator->pReadyPools); i++)
+		VK_CHECK(vkResetDescriptorPool(device, pAllocator->pReadyPools[i], 0));
+	for (uint64_t i = 0; i < DarrayLength(pAllocator->pFullPools); i++)
+	{
+		VK_CHECK(vkResetDescriptorPool(device, pAllocator->pFullPools[i], 0));
+		DarrayPush(pAllocator->pReadyPools, pAllocator->pFullPools[i]);
+	}
+	DarrayClear(pAllocator->pFullPools);
+	return VK_SUCCESS;
+}
+
 /* NOTE: Why is this even a function ?! */
 VkResult
 vkDescriptorSetAllocate(
@@ -114,21 +223,63 @@ vkDescriptorSetAllocate(
 	return VK_SUCCESS;
 }
 
+YND VkResult
+vkDrawImageDescriptorSetUpdate(VkContext* pCtx)
+{
+	/*
+	 * NOTE: A new set every time, frames in flight may still have the previous
+	 * one bound. It stays in the long lived pools, the draw image only grows so
+	 * this happens a handful of times.
+	 */
+	void* pNext = VK_NULL_HANDLE;
+	VK_CHECK(vkDescriptorAllocatorAllocate(
+				pCtx,
+				&pCtx->descriptorAllocator,
+				pCtx->drawImageDescriptorSetLayout,
+				pNext,
+				&pCtx->drawImageDescriptorSet));
+
+	VkDescriptorImageInfo descriptorImageInfo = {
+		.imageLayout	= VK_IMAGE_LAYOUT_GENERAL,
+		.imageView		= pCtx->drawImage.image.view,
+	};
+	VkWriteDescriptorSet writeDescriptorSet = {
+		.sType				= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.pNext				= VK_NULL_HANDLE,
+		.dstBinding			= 0,
+		.dstSet				= pCtx->drawImageDescriptorSet,
+		.descriptorCount	= 1,
+		.descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+		.pImageInfo			= &descriptorImageInfo,
+	};
+
+	const VkCopyDescriptorSet*	pDescriptorCopies		= VK_NULL_HANDLE;
+	uint32_t					descriptorCopyCount		= 0;
+	uint32_t					descriptorWriteCount	= 1;
+	vkUpdateDescriptorSets(
+			pCtx->device.handle,
+			descriptorWriteCount,
+			&writeDescriptorSet,
+			descriptorCopyCount,
+			pDescriptorCopies);
+	return VK_SUCCESS;
+}
+
 YND VkResult
 vkDescriptorsInit(VkContext* pCtx, VkDevice device)
 {
 	uint32_t			binding				= 0;
 	uint32_t			maxSets				= 10;
 	void*				pNext				= VK_NULL_HANDLE;
-	PoolSizeRatio*		pSizeRatios			= DarrayCreate(PoolSizeRatio);
 	VkDescriptorType	descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
 	VkShaderStageFlags	shaderStageFlags	= VK_SHADER_STAGE_COMPUTE_BIT;
-
-	pSizeRatios[0].type		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-	pSizeRatios[0].ratio	= 1.0f;
+	PoolSizeRatio		pSizeRatios[1]		= {
+		{ .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, .ratio = 1.0f },
+	};
 	pCtx->pBindings			= DarrayCreate(VkDescriptorSetLayoutBinding);
 
-	VK_RESULT(vkDescriptorAllocatorPoolInit(pCtx, &pCtx->descriptorPool.handle, device, maxSets, pSizeRatios));
+	/* NOTE: Starts at maxSets, grows when more long lived sets are needed */
+	VK_RESULT(vkDescriptorAllocatorInit(pCtx, &pCtx->descriptorAllocator, maxSets, pSizeRatios, 1));
 
 	vkDescriptorSetLayoutAddBinding(pCtx->pBindings, binding, descriptorType);
 
@@ -142,32 +293,8 @@ vkDescriptorsInit(VkContext* pCtx, VkDevice device)
 				flags,
 				&pCtx->drawImageDescriptorSetLayout));
 
-	VK_CHECK(vkDescriptorSetAllocate(
-				device,
-				pCtx->drawImageDescriptorSetLayout,
-				&pCtx->drawImageDescriptorSet,
-				pCtx->descriptorPool.handle));
-
-	VkDescriptorImageInfo descriptorImageInfo = {
-		.imageLayout	= VK_IMAGE_LAYOUT_GENERAL,
-		.imageView		= pCtx->drawImage.image.view,
-	};
-	VkWriteDescriptorSet writeDescriptorSet = {
-		.sType				= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-		.pNext				= VK_NULL_HANDLE,
-		.dstBinding			= 0,
-		.dstSet				= pCtx->drawImageDescriptorSet,
-		.descriptorCount	= 1,
-		.descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-		.pImageInfo			= &descriptorImageInfo,
-	};
-
-	const VkCopyDescriptorSet*	pDescriptorCopies		= VK_NULL_HANDLE;
-	uint32_t					descriptorCopyCount		= 0;
-	uint32_t					descriptorWriteCount	= 1;
-	vkUpdateDescriptorSets(device, descriptorWriteCount, &writeDescriptorSet, descriptorCopyCount, pDescriptorCopies);
+	VK_CHECK(vkDrawImageDescriptorSetUpdate(pCtx));
 
-	DarrayDestroy(pSizeRatios);
 	DarrayDestroy(pCtx->pBindings);
 	return VK_SUCCESS;
 }
@@ -29,10 +29,54 @@ YND VkResult vkDescriptorAllocatorPoolInit(
 		uint32_t							maxSets,
 		PoolSizeRatio*						pPoolRatios);
 
+#define DESCRIPTOR_ALLOCATOR_MAX_SETS 4092
+
+/**
+ * @brief	Copies `pRatios`, the first pool holds `initialSets` sets.
+ */
+YND VkResult vkDescriptorAllocatorInit(
+		VkContext*							pCtx,
+		DescriptorAllocator*				pAllocator,
+		uint32_t							initialSets,
+		const PoolSizeRatio*				pRatios,
+		uint32_t							ratioCount);
+
+/**
+ * @brief	Expects no set of it to be in use anymore.
+ */
+void vkDescriptorAllocatorDestroy(
+		VkContext*							pCtx,
+		DescriptorAllocator*				pAllocator);
+
+/**
+ * @brief	Allocates from the last ready pool, a full one is set aside and
+ *			the allocation retried once on a new, bigger pool.
+ */
+YND VkResult vkDescriptorAllocatorAllocate(
+		VkContext*							pCtx,
+		DescriptorAllocator*				pAllocator,
+		VkDescriptorSetLayout				layout,
+		void*								pNext,
+		VkDescriptorSet*					pOutDescriptorSet);
+
+/**
+ * @brief	Resets every pool, all their sets at once, and makes them ready again.
+ */
+YND VkResult vkDescriptorAllocatorReset(
+		VkContext*							pCtx,
+		DescriptorAllocator*				pAllocator);
+
 YND VkResult vkDescriptorsInit(
 		VkContext*							pCtx,
 		VkDevice							device);
 
+/**
+ * @brief	Points pCtx->drawImageDescriptorSet at the current draw image view,
+ *			in a newly allocated set.
+ */
+YND VkResult vkDrawImageDescriptorSetUpdate(
+		VkContext*							pCtx);
+
 YND VkResult vkDescriptorSetAllocate(
 		VkDevice							device,
 		VkDescriptorSetLayout				layout,
@@ -10,60 +10,50 @@
 
 static VkResult VulkanDeviceSelect(VkContext *pCtx);
 
+YMB static b8
+DeviceExtensionSupported(VkPhysicalDevice physicalDevice, const char* pName)
+{
+	uint32_t extensionCount = 0;
+	if (vkEnumerateDeviceExtensionProperties(physicalDevice, 0, &extensionCount, NULL) != VK_SUCCESS)
+		return FALSE;
+	VkExtensionProperties pExtensions[extensionCount];
+	if (vkEnumerateDeviceExtensionProperties(physicalDevice, 0, &extensionCount, pExtensions) != VK_SUCCESS)
+		return FALSE;
+	for (uint32_t i = 0; i < extensionCount; i++)
+	{
+		if (!strcmp(pExtensions[i].extensionName, pName))
+			return TRUE;
+	}
+	return FALSE;
+}
+
 YND VkResult
 VulkanCreateDevice(VkContext *pCtx, VkDevice *pOutDevice, YMB char *pGPUName)
 {
-	uint32_t queueCreateInfoCount = 1;
-	uint8_t index = 0;
-
 	VK_CHECK(VulkanDeviceSelect(pCtx));
 
 	YINFO("Creating logical device...");
 
-	b8 bPresentSharesGraphicsQueue = pCtx->device.graphicsQueueIndex == pCtx->device.presentQueueIndex;
-	b8 bTransferSharesGraphicsQueue = pCtx->device.graphicsQueueIndex == pCtx->device.transferQueueIndex;
-
-	if (!bPresentSharesGraphicsQueue) 
-		queueCreateInfoCount++;
-	if (!bTransferSharesGraphicsQueue) 
-		queueCreateInfoCount++;
-
-	uint32_t pIndices[queueCreateInfoCount];
-	pIndices[index++] = pCtx->device.graphicsQueueIndex;
-
-	if (!bPresentSharesGraphicsQueue) 
-		pIndices[index++] = pCtx->device.presentQueueIndex;
-	if (!bTransferSharesGraphicsQueue) 
-		pIndices[index++] = pCtx->device.transferQueueIndex;
-
-	struct temp {int32_t count; uint32_t index;};
-	struct temp tempIndices[queueCreateInfoCount];
-	for (uint32_t i = 0; i < queueCreateInfoCount; i++)
-	{
-		tempIndices[i].index = -1;
-		tempIndices[i].count = 0;
-	}
+	/*
+	 * NOTE: One queue per family, the roles sharing a family share its queue.
+	 * The compute family may also be the present one, both are only used by
+	 * the render thread.
+	 */
+	int32_t pRoleIndices[4] = {
+		pCtx->device.graphicsQueueIndex,
+		pCtx->device.presentQueueIndex,
+		pCtx->device.transferQueueIndex,
+		pCtx->device.computeQueueIndex,
+	};
+	uint32_t pFamilyIndices[4];
 	uint32_t realQueueCreateInfoCount = 0;
-
-	YMB uint32_t i = 0;
-	YMB uint32_t j = 0;
-	/* Remove duplicates */
-	while (i < queueCreateInfoCount)
+	for (uint32_t i = 0; i < 4; i++)
 	{
-		if (tempIndices[realQueueCreateInfoCount].index != pIndices[i])
-		{
-			tempIndices[realQueueCreateInfoCount].index = pIndices[i];
-			while ( j < queueCreateInfoCount && tempIndices[realQueueCreateInfoCount].index == pIndices[j])
-			{
-					tempIndices[realQueueCreateInfoCount].count++;
-					j++;
-			}
-			i++;
-			if (tempIndices[realQueueCreateInfoCount].count > 0)
-				realQueueCreateInfoCount++;
-			continue;
-		}
-		i++;
+		b8 bDuplicate = pRoleIndices[i] < 0;
+		for (uint32_t j = 0; j < realQueueCreateInfoCount && !bDuplicate; j++)
+			bDuplicate = pFamilyIndices[j] == (uint32_t)pRoleIndices[i];
+		if (!bDuplicate)
+			pFamilyIndices[realQueueCreateInfoCount++] = (uint32_t)pRoleIndices[i];
 	}
 
 	VkDeviceQueueCreateInfo pQueueCreateInfos[realQueueCreateInfoCount];
@@ -71,7 +61,7 @@ VulkanCreateDevice(VkContext *pCtx, VkDevice *pOutDevice, YMB char *pGPUName)
 	for (uint32_t i = 0; i < realQueueCreateInfoCount; ++i)
 	{
 		pQueueCreateInfos[i].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-		pQueueCreateInfos[i].queueFamilyIndex = tempIndices[i].index;
+		pQueueCreateInfos[i].queueFamilyIndex = pFamilyIndices[i];
 		pQueueCreateInfos[i].queueCount = 1;
 		/*
 		 * TODO enable this for future enhancements.
@@ -84,15 +74,9 @@ VulkanCreateDevice(VkContext *pCtx, VkDevice *pOutDevice, YMB char *pGPUName)
 		pQueueCreateInfos[i].pNext = 0;
 		pQueueCreateInfos[i].pQueuePriorities = &queue_priority;
 	}
-	VkPhysicalDeviceBufferDeviceAddressFeatures deviceAddressFeature = {
-		.sType					= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES,
-		.bufferDeviceAddress	= VK_TRUE,
-	};
-
 	VkPhysicalDeviceDynamicRenderingFeatures dynamicRendering = {
 		.sType				= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES,
 		.dynamicRendering	= VK_TRUE,
-		.pNext				= &deviceAddressFeature,
 	};
 
 	VkPhysicalDeviceSynchronization2Features physicalDeviceSynch2Features =  {
@@ -101,6 +85,44 @@ VulkanCreateDevice(VkContext *pCtx, VkDevice *pOutDevice, YMB char *pGPUName)
 		.pNext = &dynamicRendering,
 	};
 
+	/*
+	 * NOTE: Transfer queue uploads signal a timeline the graphics submits wait on,
+	 * the tile cull pass writes the draw count read by vkCmdDrawIndexedIndirectCount
+	 * and the bindless set is descriptor indexing (VK_EXT_descriptor_indexing in 1.2).
+	 * The 1.2 features go through this struct only, it can't be chained with
+	 * their standalone structs.
+	 */
+	VkPhysicalDeviceVulkan12Features vulkan12Features = {
+		.sType											= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+		.bufferDeviceAddress							= VK_TRUE,
+		.timelineSemaphore								= VK_TRUE,
+		.drawIndirectCount								= VK_TRUE,
+		.runtimeDescriptorArray							= VK_TRUE,
+		.shaderSampledImageArrayNonUniformIndexing		= VK_TRUE,
+		.descriptorBindingPartiallyBound				= VK_TRUE,
+		.descriptorBindingSampledImageUpdateAfterBind	= VK_TRUE,
+		.descriptorBindingUpdateUnusedWhilePending		= VK_TRUE,
+		.pNext											= &physicalDeviceSynch2Features,
+	};
+
+	/*
+	 * NOTE: Present wait lets the frame latency limiter wait for the image to
+	 * be on screen, not only rendered. Only chained when both are there.
+	 */
+	b8 bPresentWait = DeviceExtensionSupported(pCtx->device.physicalDevice, VK_KHR_PRESENT_ID_EXTENSION_NAME)
+		&& DeviceExtensionSupported(pCtx->device.physicalDevice, VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+	VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {
+		.sType			= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,
+		.presentWait	= VK_TRUE,
+	};
+	VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {
+		.sType			= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,
+		.presentId		= VK_TRUE,
+		.pNext			= &presentWaitFeatures,
+	};
+	if (bPresentWait)
+		dynamicRendering.pNext = &presentIdFeatures;
+
 	/* TODO: shoud be config driven */
 	VkPhysicalDeviceFeatures enabledFeatures = {
 		.samplerAnisotropy = VK_TRUE,
@@ -109,15 +131,37 @@ VulkanCreateDevice(VkContext *pCtx, VkDevice *pOutDevice, YMB char *pGPUName)
 	VkPhysicalDeviceFeatures2 enabledFeatures2 = {
 		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
 		.features = enabledFeatures,
-		.pNext = &physicalDeviceSynch2Features,
+		.pNext = &vulkan12Features,
 	};
 	vkGetPhysicalDeviceFeatures2(pCtx->device.physicalDevice, &enabledFeatures2);
-	YDEBUG("deviceAddressFeature.bufferDeviceAddress %d", deviceAddressFeature.bufferDeviceAddress);
-	YASSERT(deviceAddressFeature.bufferDeviceAddress);
+	YDEBUG("vulkan12Features.bufferDeviceAddress %d", vulkan12Features.bufferDeviceAddress);
+	YASSERT(vulkan12Features.bufferDeviceAddress);
+	YASSERT(vulkan12Features.timelineSemaphore);
+	YASSERT(vulkan12Features.runtimeDescriptorArray);
+	YASSERT(vulkan12Features.shaderSampledImageArrayNonUniformIndexing);
+	YASSERT(vulkan12Features.descriptorBindingPartiallyBound);
+	YASSERT(vulkan12Features.descriptorBindingSampledImageUpdateAfterBind);
+	YASSERT(vulkan12Features.descriptorBindingUpdateUnusedWhilePending);
+	/* NOTE: Left as queried, the tiles fall back to a single indirect draw without it */
+	pCtx->device.bDrawIndirectCount = vulkan12Features.drawIndirectCount;
+	/* NOTE: Same, the limiter waits on the frame fences without it */
+	pCtx->device.bPresentWait = bPresentWait && presentIdFeatures.presentId && presentWaitFeatures.presentWait;
 	const char **ppExtensionNames = DarrayCreate(const char *);
 	DarrayPush(ppExtensionNames, &VK_KHR_SWAPCHAIN_EXTENSION_NAME);
-	DarrayPush(ppExtensionNames, &VK_EXT_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME );
+	if (bPresentWait)
+	{
+		DarrayPush(ppExtensionNames, &VK_KHR_PRESENT_ID_EXTENSION_NAME);
+		DarrayPush(ppExtensionNames, &VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+	}
+	/* NOTE: Buffer device address is core, the EXT must not be enabled with vulkan12Features */
 	/* DarrayPush(ppExtensionNames, &VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME); */
+#ifdef TRACY_ENABLE
+	/* NOTE: Lets Tracy line the GPU zones up with the CPU ones */
+	pCtx->device.bCalibratedTimestamps = DeviceExtensionSupported(pCtx->device.physicalDevice,
+			VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+	if (pCtx->device.bCalibratedTimestamps)
+		DarrayPush(ppExtensionNames, &VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+#endif // TRACY_ENABLE
 	YMB uint32_t extensionCount = DarrayLength(ppExtensionNames);
 
 	VkDeviceCreateInfo deviceCreateInfo = {
@@ -134,6 +178,16 @@ VulkanCreateDevice(VkContext *pCtx, VkDevice *pOutDevice, YMB char *pGPUName)
 	vkGetDeviceQueue(pCtx->device.handle, pCtx->device.presentQueueIndex, 0, &pCtx->device.presentQueue);
 	vkGetDeviceQueue(pCtx->device.handle, pCtx->device.graphicsQueueIndex, 0, &pCtx->device.graphicsQueue);
 	vkGetDeviceQueue(pCtx->device.handle, pCtx->device.transferQueueIndex, 0, &pCtx->device.transferQueue);
+	if (pCtx->device.computeQueueIndex >= 0)
+		vkGetDeviceQueue(pCtx->device.handle, pCtx->device.computeQueueIndex, 0, &pCtx->device.computeQueue);
+
+	if (pCtx->device.bPresentWait)
+	{
+		pCtx->device.pfnWaitForPresent = (PFN_vkWaitForPresentKHR)
+			vkGetDeviceProcAddr(pCtx->device.handle, "vkWaitForPresentKHR");
+		pCtx->device.bPresentWait = pCtx->device.pfnWaitForPresent != NULL;
+	}
+	YINFO("Present wait: %s", pCtx->device.bPresentWait ? "yes" : "no");
 
 	DarrayDestroy(ppExtensionNames);
 
@@ -201,6 +255,18 @@ PhysicalDeviceMeetsRequirements( VkPhysicalDevice device, VkSurfaceKHR surface,
         if (supportsPresent)
             pOutQueueInfo->presentFamilyIndex = i;
     }
+    // Async compute: a compute family without graphics, other than the one uploads use.
+    // The loop above took any compute family, graphics ones included, none is better.
+    pOutQueueInfo->computeFamilyIndex = -1;
+    for (uint32_t i = 0; i < queueFamilyCount; ++i)
+	{
+        VkQueueFlags flags = queueFamilies[i].queueFlags;
+        if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT) && i != pOutQueueInfo->transferFamilyIndex)
+		{
+            pOutQueueInfo->computeFamilyIndex = i;
+            break;
+        }
+    }
     if (
         (!pRequirements->bGraphics || (pRequirements->bGraphics && (i32)pOutQueueInfo->graphicsFamilyIndex != -1)) &&
         (!pRequirements->bPresent || (pRequirements->bPresent && (i32)pOutQueueInfo->presentFamilyIndex != -1)) &&
@@ -301,7 +367,8 @@ VulkanDeviceSelect(VkContext *pCtx)
 			.bPresent = TRUE,
 			.bTransfer = TRUE,
 			.bSamplerAnisotropy = TRUE,
-			.bDiscreteGpu = TRUE,
+			/* NOTE: Headless runs target CI machines, lavapipe included */
+			.bDiscreteGpu = !pCtx->bHeadless,
 		};
 		requirements.ppDeviceExtensionNames = DarrayCreate(const char *);
 		DarrayPush(requirements.ppDeviceExtensionNames, &VK_KHR_SWAPCHAIN_EXTENSION_NAME);
@@ -345,11 +412,22 @@ VulkanDeviceSelect(VkContext *pCtx)
 			pCtx->device.graphicsQueueIndex = queueInfo.graphicsFamilyIndex;
 			pCtx->device.presentQueueIndex = queueInfo.presentFamilyIndex;
 			pCtx->device.transferQueueIndex = queueInfo.transferFamilyIndex;
-			// NOTE: set compute index here if needed.
+			pCtx->device.computeQueueIndex = queueInfo.computeFamilyIndex;
 
 			// Keep a copy of properties, features and memory info for later use.
 			pCtx->device.properties = properties;
 			pCtx->device.features = features;
+
+			VkPhysicalDeviceSubgroupProperties subgroupProperties = {
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES,
+			};
+			VkPhysicalDeviceProperties2 properties2 = {
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+				.pNext = &subgroupProperties,
+			};
+			vkGetPhysicalDeviceProperties2(pVkDevices[i], &properties2);
+			pCtx->device.subgroupSize = subgroupProperties.subgroupSize;
+			YINFO("Subgroup size: %u", subgroupProperties.subgroupSize);
 			pCtx->device.memory = memory;
 			DarrayDestroy(requirements.ppDeviceExtensionNames);
 			break;
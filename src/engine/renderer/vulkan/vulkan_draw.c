@@ -6,51 +6,71 @@
 #include "vulkan_command.h"
 #include "vulkan_image.h"
 #include "vulkan_pipeline.h"
+#include "vulkan_shader_reload.h"
+#include "vulkan_staging.h"
+#include "vulkan_transfer.h"
+#include "vulkan_frame.h"
 #include "vulkan_timer.h"
+#include "vulkan_tiles.h"
+#include "vulkan_bindless.h"
+#include "vulkan_render_graph.h"
+#include "vulkan_resolution.h"
+#include "vulkan_frame_dump.h"
+#include "vulkan_async_compute.h"
+#include "vulkan_background_cache.h"
 
 #include "core/yvec4.h"
 #include "core/logger.h"
-#include "cglm/mat4.h"
 
 #include "profiler.h"
 
 #include <math.h>
 
 YND VkResult
-vkComputeShaderInvocation(VkContext* pCtx, VulkanCommandBuffer* pCmd, ComputeShaderFx computeShader)
+vkComputeShaderInvocation(
+		VkContext*							pCtx,
+		VkCommandBuffer						commandBuffer,
+		ComputeShaderFx						computeShader,
+		VkDescriptorSet						descriptorSet,
+		VkExtent2D							renderExtent)
 {
 	VkPipelineBindPoint pipelineBindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
-	vkCmdBindPipeline(pCmd->handle, pipelineBindPoint, computeShader.pipeline);
+	vkCmdBindPipeline(commandBuffer, pipelineBindPoint, computeShader.pipeline);
 
 	const uint32_t*	pDynamicOffsets		= VK_NULL_HANDLE;
 	uint32_t		firstSet			= 0;
 	uint32_t		descriptorSetCount	= 1;
 	uint32_t		dynamicOffsetCount	= 0;
 	vkCmdBindDescriptorSets(
-			pCmd->handle,
+			commandBuffer,
 			pipelineBindPoint,
 			computeShader.pipelineLayout,
 			firstSet,
 			descriptorSetCount,
-			&pCtx->drawImageDescriptorSet,
+			&descriptorSet,
 			dynamicOffsetCount,
 			pDynamicOffsets);
 
+	/* NOTE: data4.xy is the render extent, the shaders cover that much of the image */
+	computeShader.pushConstant.data4[0] = (f32)renderExtent.width;
+	computeShader.pushConstant.data4[1] = (f32)renderExtent.height;
+
 	VkShaderStageFlags	flags	= VK_SHADER_STAGE_COMPUTE_BIT;
 	uint32_t			offset	= 0;
 	uint32_t			size	= sizeof(ComputePushConstant);
 	vkCmdPushConstants(
-			pCmd->handle,
+			commandBuffer,
 			pCtx->gradientComputePipelineLayout,
 			flags,
 			offset,
 			size,
 			&computeShader.pushConstant);
 
-	uint32_t groupCountX = ceil(pCtx->drawImage.extent.width / 16.0f);
-	uint32_t groupCountY = ceil(pCtx->drawImage.extent.height / 16.0f);
+	/* NOTE: Same sizes the pipeline was specialized with */
+	uint32_t groupCountX = (renderExtent.width + computeShader.pGroupSize[0] - 1) / computeShader.pGroupSize[0];
+	uint32_t groupCountY = (renderExtent.height + computeShader.pGroupSize[1] - 1) / computeShader.pGroupSize[1];
 	uint32_t groupCountZ = 1;
-	vkCmdDispatch(pCmd->handle, groupCountX, groupCountY, groupCountZ);
+	vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
 
 	return VK_SUCCESS;
 }
@@ -76,21 +96,47 @@ PrintColor(RgbaFloat c)
 	YINFO("r: %f, g: %f, b: %f, a:%f", c.r, c.g, c.b, c.a);
 }
 
-/* FIXME: Resizing -> 
- * 	- Recreation of swapchain
- * 	- Recreation of bindings
- * 	- Get the new and correct framebuffer size
- * 	- Check Images actual state (Transition etc in yDrawImpl)
- */
-
 void vkGeometryDraw(
 		VkContext*							pCtx,
 		VkCommandBuffer						commandBuffer,
 		VkExtent2D							drawExtent,
 		DrawImage							drawImage,
-		DrawImage							depthImage,
-		GenericPipeline*					pMeshPipeline,
-		VkPipeline							trianglePipeline);
+		DrawImage							depthImage);
+
+static void
+ComputeBackgroundPass(VkContext* pCtx, VkCommandBuffer commandBuffer, void* pData)
+{
+	YMB VkResult result = vkComputeShaderInvocation(pCtx, commandBuffer, *(ComputeShaderFx*)pData,
+			pCtx->drawImageDescriptorSet, pCtx->resolution.renderExtent);
+	VK_ASSERT(result);
+}
+
+static void
+TileCullPass(VkContext* pCtx, VkCommandBuffer commandBuffer, void* pData)
+{
+	vkTilesCull(pCtx, commandBuffer, *(VkExtent2D*)pData);
+}
+
+static void
+GeometryPass(VkContext* pCtx, VkCommandBuffer commandBuffer, void* pData)
+{
+	vkGeometryDraw(
+			pCtx,
+			commandBuffer,
+			*(VkExtent2D*)pData,
+			pCtx->drawImage,
+			pCtx->depthImage);
+}
+
+static void
+CopyToSwapchainPass(VkContext* pCtx, VkCommandBuffer commandBuffer, YMB void* pData)
+{
+	DrawImage	drawImage		= pCtx->drawImage;
+	VkImage		swapchainImage	= pCtx->swapchain.pImages[pCtx->imageIndex];
+	VkExtent2D	swapchainExtent	= {.width = pCtx->swapchain.extent.width, .height = pCtx->swapchain.extent.height};
+	/* NOTE: Linear filtered, upscales what this frame rendered to the whole swapchain image */
+	vkImageCopy(commandBuffer, drawImage.image.handle, swapchainImage, pCtx->resolution.renderExtent, swapchainExtent);
+}
 
 /* WARN: Leaking currently, needs to free at the beginning or at the end */
 /* TODO: Profile ImageCopy&Co's */
@@ -101,31 +147,54 @@ vkDrawImpl(VkContext* pCtx)
 
 	YMB VkDevice	device				= pCtx->device.handle;
 	uint64_t		fenceWaitTimeoutNs	= 1000 * 1000 * 1000; // 1 sec || 1 billion nanoseconds
-	VK_CHECK(vkFenceWait(pCtx, &pCtx->pFencesInFlight[pCtx->currentFrame], fenceWaitTimeoutNs));
+	/* NOTE: Waits this frame's previous submission, then resets its pools and runs its deletions */
+	VK_CHECK(vkFrameBegin(pCtx, fenceWaitTimeoutNs));
+	VulkanFrame*	pFrame				= vkFrameCurrent(pCtx);
+	TracyCPlot("Frames in flight", vkFramesPendingCount(pCtx));
+
+	/* NOTE: Resized, or reported out of date or suboptimal, the old one is retired not waited on */
+	if (pCtx->framebufferSizeGeneration != pCtx->framebufferSizeLastGeneration)
+	{
+		VK_CHECK(vkSwapchainRecreate(
+					pCtx,
+					pCtx->framebufferWidth,
+					pCtx->framebufferHeight,
+					&pCtx->swapchain));
+	}
+
 	/*
-	 * NOTE: Fences have to be reset between uses, you can’t use the same
-	 * fence on multiple GPU commands without resetting it in the middle.
+	 * NOTE: Get next swapchain image. Before anything queues deletions on this
+	 * frame, a skipped frame does not submit and the next one flushes them.
 	 */
-	VK_CHECK(vkFenceReset(pCtx, &pCtx->pFencesInFlight[pCtx->currentFrame]));
+	VkResult acquireResult = vkSwapchainAcquireNextImageIndex(
+			pCtx,
+			&pCtx->swapchain,
+			fenceWaitTimeoutNs,
+			pFrame->semaphoreAvailableImage,
+			VK_NULL_HANDLE, 
+			&pCtx->imageIndex);
+	if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR)
+	{
+		TracyCZoneEnd(drawCtx);
+		return VK_SUCCESS;
+	}
+	VK_CHECK(acquireResult);
 
-	/* NOTE: Get next swapchain image */
-	VK_CHECK(vkSwapchainAcquireNextImageIndex(
-				pCtx,
-				&pCtx->swapchain,
-				fenceWaitTimeoutNs,
-				pCtx->pSemaphoresAvailableImage[pCtx->currentFrame],
-				VK_NULL_HANDLE, 
-				&pCtx->imageIndex));
+	/* NOTE: Replaced pipelines go to this frame's deletion queue */
+	vkShaderReloadApply(pCtx);
+
+	/* NOTE: Same for the staging range its copies read from */
+	vkStagingRingReclaim(pCtx, pCtx->currentFrame);
+	vkTransferCollect(pCtx);
+	/* NOTE: And the bindless slots removed a full round of frames ago */
+	vkBindlessCollect(pCtx);
 
-	/* NOTE: Getting the current frame's cmd buffer and reset it */
-	VulkanCommandBuffer*		pCmd	= &pCtx->pGfxCommands[pCtx->imageIndex];
-	VkCommandBufferResetFlags	flags	= 0;
-	VK_CHECK(vkCommandBufferReset(pCmd, flags));
+	/* NOTE: The current frame's cmd buffer, its pool was reset by vkFrameBegin */
+	VulkanCommandBuffer*	pCmd		= &pFrame->commandBuffer;
 
 	DrawImage		drawImage			= pCtx->drawImage;
 	/* YDEBUG("Format is: %s", string_VkFormat(depthImage.format)); */
 	/* exit(1); */
-	DrawImage		depthImage			= pCtx->depthImage;
 	VkImage			swapchainImage		= pCtx->swapchain.pImages[pCtx->imageIndex];
 
 	/* NOTE: Start command recording */
@@ -134,56 +203,108 @@ vkDrawImpl(VkContext* pCtx)
 	b8				bRenderPassContinue	= FALSE;
 	vkCommandBufferBegin(pCmd, bSingleUse, bRenderPassContinue, bSimultaneousUse);
 
-	/* NOTE: Start counter */
-	vkTimerStart(pCmd->handle);
+	/* NOTE: Reads back this frame's previous timestamps, opens the "frame" scope */
+	vkGpuProfilerFrameBegin(pCtx, pCmd->handle);
+
+	/* NOTE: Uploads queued since the last frame go first */
+	vkGpuScopeBegin(pCtx, pCmd->handle, "uploads");
+	vkStagingRingFlush(pCtx, pCmd->handle, pCtx->currentFrame);
+	vkTransferAcquire(pCtx, pCmd->handle);
+	vkGpuScopeEnd(pCtx, pCmd->handle);
+
+	/* NOTE: Picked from the GPU times the profiler just read back */
+	VkExtent2D extent = vkResolutionUpdate(pCtx);
+	/* NOTE: Debug only, no gameplay pushes notes yet */
+	if (pCtx->bTilesDemo)
+		vkTilesDemoPush(pCtx, extent);
+
+	/* NOTE: Only the order and the usages are written here, the graph derives the barriers */
+	VulkanRenderGraph	graph;
+	VulkanRenderGraph*	pGraph = &graph;
+	vkRenderGraphReset(pGraph);
+
+	/* NOTE: Shared by every frame, the previous one may still read it in its copy */
+	uint32_t drawTarget = vkRenderGraphImageImport(pGraph, "draw image", drawImage.image.handle,
+			VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT);
+	/* NOTE: Transient, bound with the stages of its aliases once the passes using it are known */
+	uint32_t depthTarget = vkRenderGraphImageImport(pGraph, "depth image", VK_NULL_HANDLE,
+			VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_NONE);
+	/* NOTE: Chains to the acquire semaphore, waited at the transfer stages */
+	uint32_t swapchainTarget = vkRenderGraphImageImport(pGraph, "swapchain image", swapchainImage,
+			VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT);
+	/* NOTE: One per frame in flight, vkFrameBegin's fence covers the previous uses */
+	uint32_t visibleTiles = vkRenderGraphBufferImport(pGraph, "visible tiles",
+			pCtx->pTileRenderer->pVisibleBuffers[pCtx->currentFrame].handle);
+	uint32_t tileDraw = vkRenderGraphBufferImport(pGraph, "tile draw",
+			pCtx->pTileRenderer->pDrawBuffers[pCtx->currentFrame].handle);
+	vkRenderGraphExport(pGraph, swapchainTarget, RENDER_GRAPH_USAGE_PRESENT);
 
-	/* NOTE: Make the swapchain image into general mode */
-	VkImageLayout	currentLayout		= VK_IMAGE_LAYOUT_UNDEFINED;
-	VkImageLayout	newLayout			= VK_IMAGE_LAYOUT_GENERAL;
-	vkImageTransition(pCmd, drawImage.image.handle, currentLayout, newLayout);
+	/*
+	 * NOTE: Copied from the cache while its inputs hold still, else from the
+	 * compute queue when it has this frame's background, else drawn here.
+	 */
+	uint32_t	pass			= VK_RENDER_GRAPH_INVALID;
+	uint64_t	backgroundHash	= vkBackgroundHash(&pCtx->pComputeShaders[gShaderFileIndex], extent);
+	b8			bGenerateAhead	= FALSE;
+	vkAsyncComputeBackgroundWait(pCtx);
+	if (!vkBackgroundCachePassAdd(pCtx, pGraph, drawTarget, extent, backgroundHash))
+	{
+		if (!vkAsyncComputeBackgroundPassAdd(pCtx, pGraph, drawTarget, extent, backgroundHash))
+		{
+			pass = vkRenderGraphPassAdd(pGraph, "compute background", ComputeBackgroundPass,
+					&pCtx->pComputeShaders[gShaderFileIndex]);
+			vkRenderGraphPassUse(pGraph, pass, drawTarget, RENDER_GRAPH_USAGE_STORAGE_IMAGE_WRITE_COMPUTE);
+		}
+		/*
+		 * NOTE: Once stored the next frame copies the cache, nothing to generate
+		 * ahead. Animated inputs never match what was generated, skipped too.
+		 */
+		bGenerateAhead = !vkBackgroundCacheStorePassAdd(pCtx, pGraph, drawTarget, extent, backgroundHash)
+			&& vkBackgroundCacheSettling(pCtx);
+	}
 
-	/* NOTE: Compute shader invocation */
-	VK_CHECK(vkComputeShaderInvocation(pCtx, pCmd, pCtx->pComputeShaders[gShaderFileIndex]));
+	/* NOTE: Visibility is decided on the GPU, the draw reads its count indirectly */
+	pass = vkRenderGraphPassAdd(pGraph, "tile cull", TileCullPass, &extent);
+	vkRenderGraphPassUse(pGraph, pass, tileDraw, RENDER_GRAPH_USAGE_TRANSFER_DST);
+	vkRenderGraphPassUse(pGraph, pass, tileDraw, RENDER_GRAPH_USAGE_STORAGE_BUFFER_WRITE_COMPUTE);
+	vkRenderGraphPassUse(pGraph, pass, visibleTiles, RENDER_GRAPH_USAGE_STORAGE_BUFFER_WRITE_COMPUTE);
 
-	/* NOTE: make the drawable image and the depth image into proper layout */
-	vkImageTransition(pCmd, drawImage.image.handle, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-	vkImageTransition(pCmd, depthImage.image.handle, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+	pass = vkRenderGraphPassAdd(pGraph, "geometry", GeometryPass, &extent);
+	vkRenderGraphPassUse(pGraph, pass, drawTarget, RENDER_GRAPH_USAGE_COLOR_ATTACHMENT);
+	vkRenderGraphPassUse(pGraph, pass, depthTarget, RENDER_GRAPH_USAGE_DEPTH_ATTACHMENT);
+	vkRenderGraphPassUse(pGraph, pass, tileDraw, RENDER_GRAPH_USAGE_INDIRECT_READ);
+	vkRenderGraphPassUse(pGraph, pass, visibleTiles, RENDER_GRAPH_USAGE_STORAGE_BUFFER_READ_VERTEX);
 
-	/* NOTE: Draw the geometry pipeline */
-	YMB VkExtent2D extent = { .width = pCtx->swapchain.extent.width, .height = pCtx->swapchain.extent.height, };
-	vkGeometryDraw(
-			pCtx,
-			pCmd->handle,
-			extent,
-			pCtx->drawImage,
-			depthImage,
-			&pCtx->meshPipeline,
-			pCtx->triPipeline.pipeline);
+	pass = vkRenderGraphPassAdd(pGraph, "copy to swapchain", CopyToSwapchainPass, VK_NULL_HANDLE);
+	vkRenderGraphPassUse(pGraph, pass, drawTarget, RENDER_GRAPH_USAGE_TRANSFER_SRC);
+	vkRenderGraphPassUse(pGraph, pass, swapchainTarget, RENDER_GRAPH_USAGE_TRANSFER_DST);
 
-	/* NOTE: make the drawable image and the swapchain image into layout for copies */
-	currentLayout	= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-	newLayout		= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-	vkImageTransition(pCmd, drawImage.image.handle, currentLayout, newLayout);
-	vkImageTransition(pCmd, swapchainImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	/* NOTE: After the copy, the draw image is already in its layout */
+	b8 bFrameDump = vkFrameDumpDue(pCtx);
+	if (bFrameDump)
+		VK_CHECK(vkFrameDumpPassAdd(pCtx, pGraph, drawTarget, extent));
 
-	/* NOTE: Copy the image to the swapchain*/
-	VkExtent2D drawExtent		= {.width = drawImage.extent.width, .height = drawImage.extent.height};
-	VkExtent2D swapchainExtent	= {.width = pCtx->swapchain.extent.width, .height = drawImage.extent.height};
-	vkImageCopy(pCmd->handle, drawImage.image.handle, swapchainImage, drawExtent, swapchainExtent);
+	VK_CHECK(vkRenderTargetsTransientsBind(pCtx, pGraph, depthTarget));
+	vkRenderGraphExecute(pCtx, pGraph, pCmd->handle);
 
-	/* NOTE: Make the swapchain image into presentable mode */
-	vkImageTransition(pCmd, swapchainImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
-
-	/* NOTE: Stop the timer and log */
-	vkTimerEnd(pCmd->handle);
-	/* vkTimerLog(pCtx->device.properties, pCtx->device.graphicsQueue, device, MICROSECONDS); */
+	/* NOTE: Closes the "frame" scope, the times are read when this frame comes back */
+	vkGpuProfilerFrameEnd(pCtx, pCmd->handle);
 
 	/* NOTE: End command recording */
 	VK_CHECK(vkCommandBufferEnd(pCmd));
 
+	/* NOTE: The next frame's background, overlaps this frame's graphics work */
+	if (bGenerateAhead)
+		VK_CHECK(vkAsyncComputeBackgroundSubmit(pCtx, extent, backgroundHash));
+
 	/* NOTE: submit command buffer to the queue and execute it. */
+	uint64_t frameNumber = pCtx->nbFrames;
 	VK_CHECK(vkQueueSubmitAndSwapchainPresent(pCtx, pCmd));
 
+	/* NOTE: Present moved currentFrame on, pFrame is still the one submitted */
+	if (bFrameDump)
+		VK_CHECK(vkFrameDumpWrite(pCtx, pFrame, frameNumber));
+
 	TracyCZoneEnd(drawCtx);
 	return VK_SUCCESS;
 }
@@ -211,18 +332,56 @@ vkClearBackground(VkContext* pCtx, VulkanCommandBuffer* pCmd, VkImage pImage)
 YND VkResult
 vkQueueSubmitAndSwapchainPresent(VkContext* pCtx, VulkanCommandBuffer* pCmd)
 {
-	VkSemaphoreSubmitInfo semaphoreWaitSubmitInfo = {
-		.sType						= VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-		.semaphore					= pCtx->pSemaphoresAvailableImage[pCtx->currentFrame],
-		.stageMask					= VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
-		.value						= 1,
+	VulkanFrame* pFrame = vkFrameCurrent(pCtx);
+	VkSemaphoreSubmitInfo pSemaphoreWaitSubmitInfos[3] = {
+		{
+			.sType					= VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore				= pFrame->semaphoreAvailableImage,
+			/* NOTE: Only the copy touches the swapchain image, the passes before it can start early */
+			.stageMask				= VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+			.value					= 1,
+		},
 	};
-	VkSemaphoreSubmitInfo semaphoreSignalSubmitInfo = {
-		.sType 						= VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-		.semaphore 					= pCtx->pSemaphoresQueueComplete[pCtx->currentFrame],
-		.stageMask 					= VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
-		.value 						= 1,
+	uint32_t waitSemaphoreCount = 1;
+
+	/* NOTE: Buffers acquired in this command buffer, wait for the transfer queue's release */
+	if (pCtx->transfer.graphicsWaitValue)
+	{
+		pSemaphoreWaitSubmitInfos[waitSemaphoreCount++] = (VkSemaphoreSubmitInfo){
+			.sType					= VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore				= pCtx->transfer.timeline,
+			.stageMask				= VK_UPLOAD_DST_STAGES,
+			.value					= pCtx->transfer.graphicsWaitValue,
+		};
+		pCtx->transfer.graphicsWaitValue = 0;
+	}
+	VkSemaphoreSubmitInfo pSemaphoreSignalSubmitInfos[2] = {
+		{
+			.sType 					= VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore 				= pFrame->semaphoreQueueComplete,
+			.stageMask 				= VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+			.value 					= 1,
+		},
 	};
+	uint32_t signalSemaphoreCount = 1;
+
+	/* NOTE: Background written on the compute queue, the copy waits for it and lets its slot go */
+	if (pCtx->asyncCompute.graphicsWaitValue)
+	{
+		pSemaphoreWaitSubmitInfos[waitSemaphoreCount++] = (VkSemaphoreSubmitInfo){
+			.sType					= VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore				= pCtx->asyncCompute.computeTimeline,
+			.stageMask				= VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+			.value					= pCtx->asyncCompute.graphicsWaitValue,
+		};
+		pSemaphoreSignalSubmitInfos[signalSemaphoreCount++] = (VkSemaphoreSubmitInfo){
+			.sType					= VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore				= pCtx->asyncCompute.graphicsTimeline,
+			.stageMask				= VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+			.value					= pCtx->asyncCompute.graphicsWaitValue,
+		};
+		pCtx->asyncCompute.graphicsWaitValue = 0;
+	}
 	VkCommandBufferSubmitInfo cmdBufferSubmitInfo = {
 		.sType						= VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
 		.commandBuffer				= pCmd->handle,
@@ -231,18 +390,24 @@ vkQueueSubmitAndSwapchainPresent(VkContext* pCtx, VulkanCommandBuffer* pCmd)
 		.sType						= VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
 		.commandBufferInfoCount		= 1,
 		.pCommandBufferInfos		= &cmdBufferSubmitInfo,
-		.pWaitSemaphoreInfos		= &semaphoreWaitSubmitInfo,
-		.waitSemaphoreInfoCount		= 1,
-		.pSignalSemaphoreInfos		= &semaphoreSignalSubmitInfo,
-		.signalSemaphoreInfoCount	= 1,
+		.pWaitSemaphoreInfos		= pSemaphoreWaitSubmitInfos,
+		.waitSemaphoreInfoCount		= waitSemaphoreCount,
+		.pSignalSemaphoreInfos		= pSemaphoreSignalSubmitInfos,
+		.signalSemaphoreInfoCount	= signalSemaphoreCount,
 	};
 
+	/*
+	 * NOTE: Fences have to be reset between uses, you can’t use the same
+	 * fence on multiple GPU commands without resetting it in the middle.
+	 */
+	VK_CHECK(vkFenceReset(pCtx, &pFrame->fenceInFlight));
+
 	uint32_t submitCount = 1;
 	VK_CHECK(vkQueueSubmit2(
 				pCtx->device.graphicsQueue,
 				submitCount,
 				&submitInfo2,
-				pCtx->pFencesInFlight[pCtx->currentFrame].handle));
+				pFrame->fenceInFlight.handle));
 
 	pCmd->state = COMMAND_BUFFER_STATE_SUBMITTED;
 
@@ -251,7 +416,7 @@ vkQueueSubmitAndSwapchainPresent(VkContext* pCtx, VulkanCommandBuffer* pCmd)
 				&pCtx->swapchain,
 				pCtx->device.graphicsQueue,
 				pCtx->device.presentQueue,
-				pCtx->pSemaphoresQueueComplete[pCtx->currentFrame],
+				pFrame->semaphoreQueueComplete,
 				pCtx->imageIndex));
 
 	return VK_SUCCESS;
@@ -265,9 +430,7 @@ vkGeometryDraw(
 		VkCommandBuffer						commandBuffer,
 		VkExtent2D							drawExtent,
 		DrawImage							drawImage,
-		DrawImage							depthImage,
-		GenericPipeline*					pMeshPipeline,
-		VkPipeline							trianglePipeline)
+		DrawImage							depthImage)
 {
 	/* NOTE: begin a render pass  connected to our draw image */
 	VkRenderingAttachmentInfo	colorAttachment	= {
@@ -283,7 +446,8 @@ vkGeometryDraw(
 		.imageView						= depthImage.image.view,
 		.imageLayout					= VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
 		.loadOp							= VK_ATTACHMENT_LOAD_OP_CLEAR,
-		.storeOp						= VK_ATTACHMENT_STORE_OP_STORE,
+		/* NOTE: Transient, nothing reads it after this pass */
+		.storeOp						= VK_ATTACHMENT_STORE_OP_DONT_CARE,
 		.clearValue.depthStencil.depth	= 0.f,
 
 	};
@@ -303,8 +467,6 @@ vkGeometryDraw(
 
 	vkCmdBeginRendering(commandBuffer, &renderingInfo);
 
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, trianglePipeline);
-
 	/* NOTE: set dynamic viewport and scissor */
 	VkViewport	viewport	=	{
 		.x			=	0,
@@ -330,42 +492,8 @@ vkGeometryDraw(
 	uint32_t	scissorCount	=	1;
 	vkCmdSetScissor(commandBuffer, firstScissor, scissorCount, &scissor);
 
-	/* NOTE: launch a draw command to draw 3 vertices */
-	YMB uint32_t	vertexCount		=	3;
-	uint32_t	instanceCount	=	1;
-	YMB uint32_t	firstVertex		=	0;
-	uint32_t	firstInstance	=	0;
-	vkCmdDraw(commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
-
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pMeshPipeline->pipeline);
-
-	GpuDrawPushConstants	pushConstants	= {0};
-	mat4					matrice			= GLM_MAT4_IDENTITY_INIT;
-
-	glm_mat4_copy(matrice, pushConstants.worldMatrix);
-	pushConstants.vertexBufferAddress = pCtx->gpuMeshBuffers.vertexBufferAddress;
-
-	uint32_t			offset		= 0;
-	uint32_t			size		= sizeof(GpuDrawPushConstants);
-	VkShaderStageFlags	stageFlags	= VK_SHADER_STAGE_VERTEX_BIT;
-	vkCmdPushConstants(
-			commandBuffer,
-			pMeshPipeline->pipelineLayout,
-			stageFlags,
-			offset,
-			size,
-			&pushConstants);
-
-	VkIndexType	indexType	= VK_INDEX_TYPE_UINT32;
-	vkCmdBindIndexBuffer(commandBuffer, pCtx->gpuMeshBuffers.indexBuffer.handle, offset, indexType);
-
-	uint32_t	indexCount		= 6;
-	uint32_t	vertexOffset	= 0;
-	uint32_t	firstIndex		= 0;
-
-	instanceCount	= 1;
-	firstInstance	= 0;
-	vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+	/* NOTE: Every tile and note the cull pass kept, in one indirect draw */
+	vkTilesDraw(pCtx, commandBuffer, drawExtent);
 
 	vkCmdEndRendering(commandBuffer);
 }
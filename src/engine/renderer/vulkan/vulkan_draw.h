@@ -7,6 +7,17 @@ YND	VkResult vkQueueSubmitAndSwapchainPresent(
 		VkContext*							pCtx,
 		VulkanCommandBuffer*				pCmd);
 
+/**
+ * @brief	Dispatches `computeShader` over `renderExtent` of the storage image
+ *			bound by `descriptorSet`, on whichever queue `commandBuffer` goes to.
+ */
+YND VkResult vkComputeShaderInvocation(
+		VkContext*							pCtx,
+		VkCommandBuffer						commandBuffer,
+		ComputeShaderFx						computeShader,
+		VkDescriptorSet						descriptorSet,
+		VkExtent2D							renderExtent);
+
 YND VkResult vkDrawImpl(
 		VkContext*							pCtx);
 
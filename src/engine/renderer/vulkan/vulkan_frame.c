@@ -0,0 +1,270 @@
+#include "vulkan_frame.h"
+
+#include "vulkan_allocator.h"
+#include "vulkan_command.h"
+#include "vulkan_descriptor.h"
+#include "vulkan_fence.h"
+
+#include "os.h"
+
+#include "core/darray.h"
+#include "core/logger.h"
+
+#include "profiler.h"
+
+/* NOTE: Transient sets only, the long lived ones come from pCtx->descriptorAllocator */
+#define FRAME_DESCRIPTOR_INITIAL_SETS 16
+
+YND static VkResult
+vkFrameCreate(VkContext* pCtx, VulkanFrame* pFrame)
+{
+	VkDevice device = pCtx->device.handle;
+
+	/* NOTE: No per buffer reset flag, the whole pool is reset at vkFrameBegin */
+	VkCommandPoolCreateInfo poolCreateInfo = {
+		.sType				= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags				= VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		.queueFamilyIndex	= pCtx->device.graphicsQueueIndex,
+	};
+	VK_CHECK(vkCreateCommandPool(device, &poolCreateInfo, pCtx->pAllocator, &pFrame->commandPool));
+	VK_CHECK(vkCommandBufferAllocate(device, VK_COMMAND_BUFFER_LEVEL_PRIMARY, pFrame->commandPool,
+				&pFrame->commandBuffer));
+
+	PoolSizeRatio pSizeRatios[4] = {
+		{ .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,			.ratio = 1.0f },
+		{ .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,		.ratio = 2.0f },
+		{ .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,		.ratio = 2.0f },
+		{ .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,	.ratio = 2.0f },
+	};
+	VK_CHECK(vkDescriptorAllocatorInit(pCtx, &pFrame->descriptors, FRAME_DESCRIPTOR_INITIAL_SETS, pSizeRatios, 4));
+
+	/*
+	 * NOTE: The fence starts signaled so the first wait on it returns, there is
+	 * no previous submission of this frame to wait for.
+	 */
+	b8 bSignaled = TRUE;
+	VK_CHECK(vkFenceCreate(device, bSignaled, pCtx->pAllocator, &pFrame->fenceInFlight));
+
+	VkSemaphoreCreateInfo semaphoreCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
+	};
+	VK_CHECK(vkCreateSemaphore(device, &semaphoreCreateInfo, pCtx->pAllocator, &pFrame->semaphoreAvailableImage));
+	VK_CHECK(vkCreateSemaphore(device, &semaphoreCreateInfo, pCtx->pAllocator, &pFrame->semaphoreQueueComplete));
+
+	pFrame->stagingEnd		= 0;
+	pFrame->pDeletionQueue	= DarrayCreate(VulkanDeletion);
+	return VK_SUCCESS;
+}
+
+static void
+DeletionRun(VkContext* pCtx, VulkanDeletion* pDeletion)
+{
+	VkDevice				device		= pCtx->device.handle;
+	VkAllocationCallbacks*	pAllocator	= pCtx->pAllocator;
+	switch (pDeletion->type)
+	{
+		case VK_OBJECT_TYPE_PIPELINE:
+			vkDestroyPipeline(device, (VkPipeline)pDeletion->handle, pAllocator); break;
+		case VK_OBJECT_TYPE_PIPELINE_LAYOUT:
+			vkDestroyPipelineLayout(device, (VkPipelineLayout)pDeletion->handle, pAllocator); break;
+		case VK_OBJECT_TYPE_BUFFER:
+			vkDestroyBuffer(device, (VkBuffer)pDeletion->handle, pAllocator); break;
+		case VK_OBJECT_TYPE_IMAGE:
+			vkDestroyImage(device, (VkImage)pDeletion->handle, pAllocator); break;
+		case VK_OBJECT_TYPE_IMAGE_VIEW:
+			vkDestroyImageView(device, (VkImageView)pDeletion->handle, pAllocator); break;
+		case VK_OBJECT_TYPE_SAMPLER:
+			vkDestroySampler(device, (VkSampler)pDeletion->handle, pAllocator); break;
+		case VK_OBJECT_TYPE_DESCRIPTOR_POOL:
+			vkDestroyDescriptorPool(device, (VkDescriptorPool)pDeletion->handle, pAllocator); break;
+		case VK_OBJECT_TYPE_QUERY_POOL:
+			vkDestroyQueryPool(device, (VkQueryPool)pDeletion->handle, pAllocator); break;
+		case VK_OBJECT_TYPE_FRAMEBUFFER:
+			vkDestroyFramebuffer(device, (VkFramebuffer)pDeletion->handle, pAllocator); break;
+		case VK_OBJECT_TYPE_SWAPCHAIN_KHR:
+			vkDestroySwapchainKHR(device, (VkSwapchainKHR)pDeletion->handle, pAllocator); break;
+		case VK_OBJECT_TYPE_UNKNOWN:
+			break;
+		default:
+			YERROR("Deletion queue: unhandled object type %d", pDeletion->type);
+			break;
+	}
+	/* NOTE: Memory goes after the resource bound to it */
+	if (pDeletion->allocation.memory != VK_NULL_HANDLE)
+		vkMemoryFree(pCtx->device.pMemoryAllocator, &pDeletion->allocation);
+}
+
+static void
+vkDeletionQueueFlush(VkContext* pCtx, VulkanFrame* pFrame)
+{
+	for (uint64_t i = 0; i < DarrayLength(pFrame->pDeletionQueue); i++)
+		DeletionRun(pCtx, &pFrame->pDeletionQueue[i]);
+	DarrayClear(pFrame->pDeletionQueue);
+}
+
+/*
+ * NOTE: Retired during frame N, vkFrameBegin waits frame N's fence when
+ * nbFrames reaches N + maxFrameInFlight. Skipped frames bump neither.
+ */
+static void
+RetiredCollect(VkContext* pCtx, b8 bAll)
+{
+	uint64_t kept = 0;
+	for (uint64_t i = 0; i < DarrayLength(pCtx->pRetired); i++)
+	{
+		VulkanDeletion* pDeletion = &pCtx->pRetired[i];
+		if (bAll || pDeletion->frame + pCtx->swapchain.maxFrameInFlight <= pCtx->nbFrames)
+			DeletionRun(pCtx, pDeletion);
+		else
+			pCtx->pRetired[kept++] = *pDeletion;
+	}
+	DarrayLengthSet(pCtx->pRetired, kept);
+}
+
+YND VkResult
+vkFramesCreate(VkContext* pCtx)
+{
+	uint32_t frameCount = pCtx->swapchain.maxFrameInFlight;
+	pCtx->pFrames = DarrayReserve(VulkanFrame, frameCount);
+	DarrayLengthSet(pCtx->pFrames, frameCount);
+	for (uint32_t i = 0; i < frameCount; i++)
+	{
+		pCtx->pFrames[i] = (VulkanFrame){0};
+		VK_CHECK(vkFrameCreate(pCtx, &pCtx->pFrames[i]));
+	}
+	pCtx->currentFrame = 0;
+	pCtx->pRetired = DarrayCreate(VulkanDeletion);
+	YINFO("%u frames in flight", frameCount);
+	return VK_SUCCESS;
+}
+
+void
+vkFramesDestroy(VkContext* pCtx)
+{
+	if (!pCtx->pFrames)
+		return ;
+
+	VkDevice device = pCtx->device.handle;
+	for (uint64_t i = 0; i < DarrayLength(pCtx->pFrames); i++)
+	{
+		VulkanFrame* pFrame = &pCtx->pFrames[i];
+		vkDeletionQueueFlush(pCtx, pFrame);
+		DarrayDestroy(pFrame->pDeletionQueue);
+		vkDestroySemaphore(device, pFrame->semaphoreAvailableImage, pCtx->pAllocator);
+		vkDestroySemaphore(device, pFrame->semaphoreQueueComplete, pCtx->pAllocator);
+		vkFenceDestroy(pCtx, &pFrame->fenceInFlight);
+		vkDescriptorAllocatorDestroy(pCtx, &pFrame->descriptors);
+		/* NOTE: Frees the command buffer with it */
+		vkDestroyCommandPool(device, pFrame->commandPool, pCtx->pAllocator);
+	}
+	DarrayDestroy(pCtx->pFrames);
+	pCtx->pFrames = NULL;
+
+	RetiredCollect(pCtx, TRUE);
+	DarrayDestroy(pCtx->pRetired);
+	pCtx->pRetired = NULL;
+}
+
+YND VkResult
+vkFrameBegin(VkContext* pCtx, uint64_t timeoutNs)
+{
+	VulkanFrame* pFrame = vkFrameCurrent(pCtx);
+	/*
+	 * NOTE: Reset right before the submit, a frame skipped on an out of date
+	 * swapchain leaves it signaled and the next wait returns.
+	 */
+	VK_CHECK(vkFenceWait(pCtx, &pFrame->fenceInFlight, timeoutNs));
+
+	/* NOTE: Nothing recorded by this frame is still executing */
+	vkDeletionQueueFlush(pCtx, pFrame);
+	RetiredCollect(pCtx, FALSE);
+	VK_CHECK(vkResetCommandPool(pCtx->device.handle, pFrame->commandPool, 0));
+	pFrame->commandBuffer.state = COMMAND_BUFFER_STATE_READY;
+	/* NOTE: Every pool the frame grew to, no set is freed on its own */
+	VK_CHECK(vkDescriptorAllocatorReset(pCtx, &pFrame->descriptors));
+	return VK_SUCCESS;
+}
+
+uint32_t
+vkFramesPendingCount(VkContext* pCtx)
+{
+	uint32_t pendingCount = 0;
+	for (uint64_t i = 0; i < DarrayLength(pCtx->pFrames); i++)
+	{
+		if (vkGetFenceStatus(pCtx->device.handle, pCtx->pFrames[i].fenceInFlight.handle) == VK_NOT_READY)
+			pendingCount++;
+	}
+	return pendingCount;
+}
+
+void
+vkFrameDeletionPush(VkContext* pCtx, VkObjectType type, uint64_t handle, VulkanAllocation* pAllocation)
+{
+	VulkanDeletion deletion = {
+		.type	= type,
+		.handle	= handle,
+	};
+	if (pAllocation)
+	{
+		deletion.allocation = *pAllocation;
+		*pAllocation = (VulkanAllocation){0};
+	}
+	DarrayPush(vkFrameCurrent(pCtx)->pDeletionQueue, deletion);
+}
+
+void
+vkFrameRetirePush(VkContext* pCtx, VkObjectType type, uint64_t handle, VulkanAllocation* pAllocation)
+{
+	VulkanDeletion deletion = {
+		.type	= type,
+		.handle	= handle,
+		.frame	= pCtx->nbFrames,
+	};
+	if (pAllocation)
+	{
+		deletion.allocation = *pAllocation;
+		*pAllocation = (VulkanAllocation){0};
+	}
+	DarrayPush(pCtx->pRetired, deletion);
+}
+
+void
+vkFrameLatencyWait(VkContext* pCtx)
+{
+	uint32_t		maxQueued		= pCtx->latency.maxQueued;
+	uint32_t		frameCount		= pCtx->swapchain.maxFrameInFlight;
+	VkSwapchain*	pSwapchain		= &pCtx->swapchain;
+	uint64_t		timeoutNs		= 1000 * 1000 * 1000;
+	if (maxQueued == 0 || pCtx->nbFrames == 0)
+		return ;
+
+	TracyCZoneN(latencyCtx, "Frame latency wait", 1);
+	if (pCtx->device.bPresentWait)
+	{
+		/* NOTE: Until the image is on screen, maxQueued - 1 presents may still be pending */
+		if (pSwapchain->presentId >= maxQueued)
+		{
+			uint64_t presentId = pSwapchain->presentId - (maxQueued - 1);
+			if (presentId > pSwapchain->presentIdWaited)
+			{
+				VkResult result = pCtx->device.pfnWaitForPresent(pCtx->device.handle, pSwapchain->handle,
+						presentId, timeoutNs);
+				pSwapchain->presentIdWaited = presentId;
+				/* NOTE: Out of date or timed out, vkDrawImpl deals with the swapchain */
+				if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)
+				{
+					f64 presentTimeMs = pCtx->latency.pPresentTimesMs[presentId % VK_PRESENT_TIMES_MAX];
+					pCtx->latency.presentLatencyMs = OsGetAbsoluteTime(MILLISECONDS) - presentTimeMs;
+					TracyCPlot("Present latency (ms)", pCtx->latency.presentLatencyMs);
+				}
+			}
+		}
+	}
+	/* NOTE: The frame submitted maxQueued frames ago, vkFrameBegin already waits further back */
+	else if (maxQueued < frameCount)
+	{
+		uint32_t frame = (pCtx->currentFrame + frameCount - maxQueued) % frameCount;
+		YMB VkResult result = vkFenceWait(pCtx, &pCtx->pFrames[frame].fenceInFlight, timeoutNs);
+	}
+	TracyCZoneEnd(latencyCtx);
+}
@@ -0,0 +1,74 @@
+#ifndef VULKAN_FRAME_H
+#define VULKAN_FRAME_H
+
+#include "yvulkan.h"
+
+#define VK_FRAMES_IN_FLIGHT_MIN			2
+#define VK_FRAMES_IN_FLIGHT_MAX			3
+#define VK_FRAMES_IN_FLIGHT_DEFAULT		2
+
+/**
+ * @brief	Creates swapchain.maxFrameInFlight frames, the first wait on each
+ *			fence returns right away.
+ */
+YND VkResult vkFramesCreate(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Expects the device to be idle, runs what is left in the deletion queues.
+ */
+void vkFramesDestroy(
+		VkContext*							pCtx);
+
+static inline VulkanFrame*
+vkFrameCurrent(VkContext* pCtx)
+{
+	return &pCtx->pFrames[pCtx->currentFrame];
+}
+
+/**
+ * @brief	Waits the current frame's fence then resets its command pool and
+ *			descriptor pools and runs its deletion queue. The fence itself is
+ *			reset by vkQueueSubmitAndSwapchainPresent.
+ */
+YND VkResult vkFrameBegin(
+		VkContext*							pCtx,
+		uint64_t							timeoutNs);
+
+/**
+ * @brief	Frames whose last submission the GPU has not finished yet.
+ */
+uint32_t vkFramesPendingCount(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Destroys `handle` (and frees `pAllocation` when not NULL) once no
+ *			frame in flight can still use it.
+ */
+void vkFrameDeletionPush(
+		VkContext*							pCtx,
+		VkObjectType						type,
+		uint64_t							handle,
+		VulkanAllocation*					pAllocation);
+
+/**
+ * @brief	Same as vkFrameDeletionPush for what any frame in flight may use,
+ *			not only the current one, and for pushes made by a frame that ends
+ *			up skipped before its submit, like a swapchain retired on resize.
+ */
+void vkFrameRetirePush(
+		VkContext*							pCtx,
+		VkObjectType						type,
+		uint64_t							handle,
+		VulkanAllocation*					pAllocation);
+
+/**
+ * @brief	Blocks until at most latency.maxQueued frames are queued ahead of
+ *			the screen, with present wait, or of the GPU otherwise. Call it
+ *			before input is sampled, the next frame then reacts to the newest
+ *			input. Does nothing when maxQueued is 0.
+ */
+void vkFrameLatencyWait(
+		VkContext*							pCtx);
+
+#endif // VULKAN_FRAME_H
@@ -0,0 +1,144 @@
+#include "vulkan_frame_dump.h"
+
+#include "vulkan_memory.h"
+#include "vulkan_fence.h"
+
+#include "core/filesystem.h"
+#include "core/logger.h"
+#include "core/ymemory.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define FRAME_DUMP_MAX_PATH		512
+
+/* NOTE: frame_<number>.ppm lands here */
+static const char* gpFrameDumpDirectory = "./build";
+
+static f32
+HalfToFloat(uint16_t half)
+{
+	uint32_t	exponent	= (half >> 10) & 0x1f;
+	uint32_t	mantissa	= half & 0x3ff;
+	f32			value		= 0.0f;
+	if (exponent == 0)
+		value = ldexpf((f32)mantissa, -24);
+	else if (exponent != 31)
+		value = ldexpf((f32)(mantissa | 0x400), (int32_t)exponent - 25);
+	/* NOTE: Infinities and NaNs come out black, so do negative values */
+	return (half & 0x8000) ? -value : value;
+}
+
+static uint8_t
+ChannelToByte(uint16_t half)
+{
+	f32 value = HalfToFloat(half);
+	value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+	return (uint8_t)(value * 255.0f + 0.5f);
+}
+
+static void
+FrameDumpPass(VkContext* pCtx, VkCommandBuffer commandBuffer, YMB void* pData)
+{
+	VulkanFrameDump* pDump = &pCtx->frameDump;
+	VkBufferImageCopy region = {
+		.bufferOffset		= 0,
+		.bufferRowLength	= 0,
+		.bufferImageHeight	= 0,
+		.imageSubresource	= {
+			.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT,
+			.mipLevel		= 0,
+			.baseArrayLayer	= 0,
+			.layerCount		= 1,
+		},
+		.imageOffset		= {0, 0, 0},
+		.imageExtent		= {pDump->extent.width, pDump->extent.height, 1},
+	};
+	vkCmdCopyImageToBuffer(commandBuffer, pCtx->drawImage.image.handle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			pDump->buffer.handle, 1, &region);
+}
+
+b8
+vkFrameDumpDue(VkContext* pCtx)
+{
+	uint32_t interval = pCtx->frameDump.interval;
+	return interval && (pCtx->nbFrames + 1) % interval == 0;
+}
+
+YND VkResult
+vkFrameDumpPassAdd(VkContext* pCtx, VulkanRenderGraph* pGraph, uint32_t drawTarget, VkExtent2D extent)
+{
+	VulkanFrameDump*	pDump	= &pCtx->frameDump;
+	VkDeviceSize		size	= (VkDeviceSize)extent.width * extent.height * VK_FRAME_DUMP_TEXEL_SIZE;
+	if (pDump->buffer.handle == VK_NULL_HANDLE || pDump->buffer.size < size)
+	{
+		if (pDump->buffer.handle != VK_NULL_HANDLE)
+			vkBufferDestroy(pCtx->device, pCtx->pAllocator, &pDump->buffer);
+		VK_CHECK(vkBufferCreate(
+					pCtx->device,
+					pCtx->pAllocator,
+					size,
+					VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+					&pDump->buffer));
+	}
+	pDump->extent = extent;
+
+	uint32_t dumpBuffer = vkRenderGraphBufferImport(pGraph, "frame dump", pDump->buffer.handle);
+	vkRenderGraphExport(pGraph, dumpBuffer, RENDER_GRAPH_USAGE_HOST_READ);
+
+	uint32_t pass = vkRenderGraphPassAdd(pGraph, "frame dump", FrameDumpPass, VK_NULL_HANDLE);
+	vkRenderGraphPassUse(pGraph, pass, drawTarget, RENDER_GRAPH_USAGE_TRANSFER_SRC);
+	vkRenderGraphPassUse(pGraph, pass, dumpBuffer, RENDER_GRAPH_USAGE_TRANSFER_DST);
+	return VK_SUCCESS;
+}
+
+YND VkResult
+vkFrameDumpWrite(VkContext* pCtx, VulkanFrame* pFrame, uint64_t frameNumber)
+{
+	VulkanFrameDump* pDump = &pCtx->frameDump;
+	/* NOTE: No timeout, lavapipe can take a while on a large frame */
+	VK_CHECK(vkFenceWait(pCtx, &pFrame->fenceInFlight, UINT64_MAX));
+
+	char pPath[FRAME_DUMP_MAX_PATH];
+	snprintf(pPath, sizeof(pPath), "%s/frame_%06llu.ppm", gpFrameDumpDirectory, (unsigned long long)frameNumber);
+
+	FILE* pStream = NULL;
+	if (OsFopen(&pStream, pPath, "wb") != 0 || !pStream)
+	{
+		YWARN("Could not open %s, frame not dumped", pPath);
+		return VK_SUCCESS;
+	}
+
+	uint32_t		width		= pDump->extent.width;
+	uint32_t		height		= pDump->extent.height;
+	uint64_t		rowSize		= (uint64_t)width * 3;
+	uint8_t*		pRow		= yAlloc(rowSize, MEMORY_TAG_RENDERER);
+	const uint16_t*	pTexels		= pDump->buffer.allocation.pMapped;
+	b8				bWritten	= fprintf(pStream, "P6\n%u %u\n255\n", width, height) > 0;
+	for (uint32_t y = 0; y < height && bWritten; y++)
+	{
+		const uint16_t* pSource = pTexels + (uint64_t)y * width * 4;
+		for (uint32_t x = 0; x < width; x++)
+		{
+			pRow[x * 3 + 0] = ChannelToByte(pSource[x * 4 + 0]);
+			pRow[x * 3 + 1] = ChannelToByte(pSource[x * 4 + 1]);
+			pRow[x * 3 + 2] = ChannelToByte(pSource[x * 4 + 2]);
+		}
+		bWritten = fwrite(pRow, 1, rowSize, pStream) == rowSize;
+	}
+	yFree2(pRow, rowSize, MEMORY_TAG_RENDERER);
+
+	if (OsFclose(pStream) != 0 || !bWritten)
+		YWARN("Could not write %s", pPath);
+	else
+		YINFO("Frame %llu dumped to %s", (unsigned long long)frameNumber, pPath);
+	return VK_SUCCESS;
+}
+
+void
+vkFrameDumpDestroy(VkContext* pCtx)
+{
+	if (pCtx->frameDump.buffer.handle != VK_NULL_HANDLE)
+		vkBufferDestroy(pCtx->device, pCtx->pAllocator, &pCtx->frameDump.buffer);
+}
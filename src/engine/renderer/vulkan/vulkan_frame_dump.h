@@ -0,0 +1,43 @@
+#ifndef VULKAN_FRAME_DUMP_H
+#define VULKAN_FRAME_DUMP_H
+
+#include "yvulkan.h"
+#include "vulkan_render_graph.h"
+
+/* NOTE: R16G16B16A16_SFLOAT, the format of the draw image */
+#define VK_FRAME_DUMP_TEXEL_SIZE		8
+
+/**
+ * @brief	TRUE when the frame about to be recorded is one of every
+ *			frameDump.interval.
+ */
+b8 vkFrameDumpDue(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Adds the pass copying `extent` of `drawTarget` to the readback
+ *			buffer, exported to the host so it is never culled. Grows the
+ *			buffer first, the previous dump was already waited on.
+ */
+YND VkResult vkFrameDumpPassAdd(
+		VkContext*							pCtx,
+		VulkanRenderGraph*					pGraph,
+		uint32_t							drawTarget,
+		VkExtent2D							extent);
+
+/**
+ * @brief	Waits for `pFrame`, the one that recorded the pass, and writes the
+ *			copy as a binary PPM named after `frameNumber`.
+ */
+YND VkResult vkFrameDumpWrite(
+		VkContext*							pCtx,
+		VulkanFrame*						pFrame,
+		uint64_t							frameNumber);
+
+/**
+ * @brief	Expects the device to be idle.
+ */
+void vkFrameDumpDestroy(
+		VkContext*							pCtx);
+
+#endif // VULKAN_FRAME_DUMP_H
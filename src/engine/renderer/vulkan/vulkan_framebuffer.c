@@ -57,8 +57,8 @@ vkFramebuffersRegenerate(VkContext* pCtx, VkSwapchain* pSwapchain, VulkanRenderP
 		vkFramebufferCreate(
 				pCtx,
 				pRenderpass,
-				pCtx->framebufferWidth,
-				pCtx->framebufferHeight,
+				pSwapchain->extent.width,
+				pSwapchain->extent.height,
 				attachmentCount,
 				pAttachments,
 				&pSwapchain->pFramebuffers[i]);
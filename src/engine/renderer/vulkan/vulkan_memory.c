@@ -1,5 +1,7 @@
 #include "vulkan_memory.h"
 #include "vulkan_command.h"
+#include "vulkan_allocator.h"
+#include "vulkan_transfer.h"
 
 #include <string.h>
 
@@ -22,41 +24,18 @@ vkBufferCreate(
 	};
 	VK_CHECK(vkCreateBuffer(device.handle, &createInfo, pAllocator, &pOutBuffer->handle));
 
-	/* NOTE: Get memory requirements before allocating */
-	VkMemoryRequirements memoryRequirements;
-	vkGetBufferMemoryRequirements(device.handle, pOutBuffer->handle, &memoryRequirements);
-
-	int32_t		memoryTypeIndex;
-
-	VK_RESULT(MemoryTypeFindIndex(
-				device.physicalDevice,
-				memoryRequirements.memoryTypeBits,
-				propertyFlags,
-				&memoryTypeIndex));
-
-	VkMemoryAllocateFlagsInfo	allocateFlagsInfo = {
-		.sType	= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
-		.flags	= VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
-	};
-
-	VkMemoryAllocateInfo memoryAllocateInfo = {
-		.sType				= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-		.allocationSize		= memoryRequirements.size,
-		.memoryTypeIndex	= (uint32_t) memoryTypeIndex,
-		.pNext				= &allocateFlagsInfo,
-	};
-
-	/* NOTE: Allocate the memory */
-	VkDeviceMemory	bufferMemory;
-	VK_CHECK(vkAllocateMemory(device.handle, &memoryAllocateInfo, pAllocator, &bufferMemory));
-
-	/* TODO: Check this !! */
-	VkDeviceSize memoryOffset = 0;
-	VK_CHECK(vkBindBufferMemory(device.handle, pOutBuffer->handle, bufferMemory, memoryOffset));
-
-	pOutBuffer->memory	= bufferMemory;
-	pOutBuffer->offset	= memoryOffset;
-	pOutBuffer->size	= memoryRequirements.size;
+	/* NOTE: Sub-allocated from the device allocator, offset is no longer always 0 */
+	VkResult result = vkBufferMemoryBind(&device, pOutBuffer->handle, propertyFlags, &pOutBuffer->allocation);
+	if (result != VK_SUCCESS)
+	{
+		vkDestroyBuffer(device.handle, pOutBuffer->handle, pAllocator);
+		pOutBuffer->handle = VK_NULL_HANDLE;
+		VK_CHECK(result);
+	}
+
+	pOutBuffer->memory	= pOutBuffer->allocation.memory;
+	pOutBuffer->offset	= pOutBuffer->allocation.offset;
+	pOutBuffer->size	= pOutBuffer->allocation.size;
 	pOutBuffer->flags	= 0;
 
     /*
@@ -67,6 +46,15 @@ vkBufferCreate(
 	return VK_SUCCESS;
 }
 
+void
+vkBufferDestroy(VulkanDevice device, VkAllocationCallbacks* pAllocator, VulkanBuffer* pBuffer)
+{
+	vkDestroyBuffer(device.handle, pBuffer->handle, pAllocator);
+	vkMemoryFree(device.pMemoryAllocator, &pBuffer->allocation);
+	pBuffer->handle	= VK_NULL_HANDLE;
+	pBuffer->memory	= VK_NULL_HANDLE;
+}
+
 struct ContextTemp
 {
 	const uint64_t	vertexBufferSize;
@@ -75,48 +63,18 @@ struct ContextTemp
 	GpuMeshBuffers*	pNewSurface;
 };
 
-YND VkResult
-vkMeshUpload(
+/* NOTE: One off staging buffer, waits for the copy to complete */
+YND static VkResult
+vkMeshUploadImmediate(
 		VulkanDevice						device,
 		VkAllocationCallbacks*				pAllocator,
 		uint32_t*							pIndices,
 		Vertex*								pVertices,
-		GpuMeshBuffers*						pOutGpuMeshBuffers)
+		GpuMeshBuffers*						pSurface)
 {
 	const uint64_t vertexBufferSize	= DarrayCapacity(pVertices) * sizeof(Vertex);
 	const uint64_t indexBufferSize	= DarrayCapacity(pIndices) * sizeof(uint32_t);
 
-	GpuMeshBuffers	newSurface;
-	/* NOTE: create vertex buffer */
-	VK_RESULT(vkBufferCreate(
-				device,
-				pAllocator,
-				vertexBufferSize, 
-				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT 
-				| VK_BUFFER_USAGE_TRANSFER_DST_BIT 
-				| VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				&newSurface.vertexBuffer
-				));
-
-	/* NOTE: Find the adress of the vertex buffer */
-	VkBufferDeviceAddressInfo deviceAdressInfo = { 
-		.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-		.buffer = newSurface.vertexBuffer.handle,
-	};
-	newSurface.vertexBufferAddress = vkGetBufferDeviceAddress(device.handle, &deviceAdressInfo);
-
-	/* NOTE: Create index buffer */
-	VK_RESULT(vkBufferCreate(
-				device,
-				pAllocator,
-				indexBufferSize, 
-				VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, 
-
-				/* NOTE: GPU only ! */
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				&newSurface.indexBuffer));
-
 	VulkanBuffer	staging;
 
 	VK_RESULT(vkBufferCreate(
@@ -130,9 +88,8 @@ vkMeshUpload(
 
 				&staging));
 
-	/* NOTE: Map memory to copy form CPU to GPU */
-	void*	pData;
-	VK_CHECK(vkMapMemory(device.handle, staging.memory, staging.offset, staging.size, staging.flags, &pData));
+	/* NOTE: Host visible blocks stay mapped for their whole life */
+	uint8_t*	pData = staging.allocation.pMapped;
 
 	/* NOTE: Copy vertex buffer */
 	memcpy(pData, pVertices, vertexBufferSize);
@@ -146,17 +103,75 @@ vkMeshUpload(
 		.vertexBufferSize = vertexBufferSize,
 		.indexBufferSize = indexBufferSize,
 		.pStaging = &staging,
-		.pNewSurface = &newSurface,
+		.pNewSurface = pSurface,
 	};
 
 	/* NOTE: Submit immediate command with pfn */
 	VK_RESULT(vkCommandSubmitImmediate(Submit, device, device.immediateSubmit, &ctx));
 
-	/* NOTE: should this be done ? */
-	/* vkUnmapMemory(device.handle, staging.memory); */
+	vkBufferDestroy(device, pAllocator, &staging);
+
+	return VK_SUCCESS;
+}
 
-	vkDestroyBuffer(device.handle, staging.handle, pAllocator);
-	vkFreeMemory(device.handle, staging.memory, pAllocator);
+YND VkResult
+vkMeshUpload(
+		VkContext*							pCtx,
+		uint32_t*							pIndices,
+		Vertex*								pVertices,
+		GpuMeshBuffers*						pOutGpuMeshBuffers)
+{
+	VulkanDevice			device				= pCtx->device;
+	VkAllocationCallbacks*	pAllocator			= pCtx->pAllocator;
+	const uint64_t			vertexBufferSize	= DarrayCapacity(pVertices) * sizeof(Vertex);
+	const uint64_t			indexBufferSize		= DarrayCapacity(pIndices) * sizeof(uint32_t);
+
+	GpuMeshBuffers	newSurface;
+	/* NOTE: create vertex buffer */
+	VK_RESULT(vkBufferCreate(
+				device,
+				pAllocator,
+				vertexBufferSize, 
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT 
+				| VK_BUFFER_USAGE_TRANSFER_DST_BIT 
+				| VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				&newSurface.vertexBuffer
+				));
+
+	/* NOTE: Find the adress of the vertex buffer */
+	VkBufferDeviceAddressInfo deviceAdressInfo = { 
+		.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+		.buffer = newSurface.vertexBuffer.handle,
+	};
+	newSurface.vertexBufferAddress = vkGetBufferDeviceAddress(device.handle, &deviceAdressInfo);
+
+	/* NOTE: Create index buffer */
+	VK_RESULT(vkBufferCreate(
+				device,
+				pAllocator,
+				indexBufferSize, 
+				VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, 
+
+				/* NOTE: GPU only ! */
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				&newSurface.indexBuffer));
+
+	/* NOTE: Transfer queue or staging ring, the next frame acquires the buffers, nothing waits here */
+	uint64_t	vertexValue;
+	uint64_t	indexValue;
+	VkResult	vertexResult	= vkTransferBufferUpload(pCtx, &newSurface.vertexBuffer, 0, pVertices,
+			vertexBufferSize, &vertexValue);
+	VkResult	indexResult		= vertexResult != VK_SUCCESS ? vertexResult
+		: vkTransferBufferUpload(pCtx, &newSurface.indexBuffer, 0, pIndices, indexBufferSize, &indexValue);
+	if (indexResult == VK_NOT_READY)
+	{
+		/* NOTE: Ring is full, a copy already queued gets overwritten with the same data */
+		YDEBUG("Staging ring full, uploading %llu bytes immediately", vertexBufferSize + indexBufferSize);
+		VK_RESULT(vkMeshUploadImmediate(device, pAllocator, pIndices, pVertices, &newSurface));
+	}
+	else
+		VK_CHECK(indexResult);
 
 	(*pOutGpuMeshBuffers).vertexBufferAddress = newSurface.vertexBufferAddress;
 	(*pOutGpuMeshBuffers).indexBuffer = newSurface.indexBuffer;
@@ -195,6 +210,11 @@ Submit(void* pCtx, VulkanCommandBuffer command)
 YND VkResult
 vkMappedBufferGetData(VkDevice device, VulkanBuffer* pBuffer, void** ppOutData)
 {
+	if (pBuffer->allocation.pMapped)
+	{
+		*ppOutData = pBuffer->allocation.pMapped;
+		return VK_SUCCESS;
+	}
 	VK_CHECK(vkMapMemory(device, pBuffer->memory, pBuffer->offset, pBuffer->size, pBuffer->flags, ppOutData));
 	return VK_SUCCESS;
 }
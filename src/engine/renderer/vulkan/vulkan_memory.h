@@ -22,9 +22,13 @@ typedef struct Vertex
 
 } Vertex;
 
+/**
+ * @brief	Queues the copies on the transfer queue or the staging ring, the mesh
+ *			is usable from the next recorded frame. Falls back to a blocking
+ *			upload when the ring is full.
+ */
 YND VkResult vkMeshUpload(
-		VulkanDevice						device,
-		VkAllocationCallbacks*				pAllocator,
+		VkContext*							pCtx,
 		uint32_t*							pIndices,
 		Vertex*								pVertices,
 		GpuMeshBuffers*						pOutGpuMeshBuffers);
@@ -48,4 +52,12 @@ YND VkResult vkBufferCreate(
 		uint32_t							propertyFlags,
 		VulkanBuffer*						pOutBuffer);
 
+/**
+ * @brief	Destroys the buffer and gives its range back to the device allocator.
+ */
+void vkBufferDestroy(
+		VulkanDevice						device,
+		VkAllocationCallbacks*				pAllocator,
+		VulkanBuffer*						pBuffer);
+
 #endif //VULKAN_MEMORY_H
@@ -3,6 +3,7 @@
 #include "renderer/rendererimpl.h"
 
 #include "core/filesystem.h"
+#include "core/pack.h"
 #include "core/darray.h"
 #include "core/darray_debug.h"
 #include "core/logger.h"
@@ -11,10 +12,14 @@
 
 #include "core/yvec4.h"
 
+#include "os.h"
+
 #include <errno.h>
 #include <stdio.h>
 #include <string.h>
 
+#define SPIRV_MAGIC 0x07230203u
+
 #define IO_CHECK(expr) \
 	do { \
 		int errcode = expr; \
@@ -34,6 +39,27 @@
  */
 YND VkResult
 vkLoadShaderModule(VkContext *pCtx, const char* pFilePath, VkDevice device, VkShaderModule* pOutShaderModule)
+{
+	/* NOTE: Pack blobs are page aligned, SPIR-V is used straight from the mapping */
+	PackBlob blob;
+	if (PackLoad(pFilePath, &blob))
+	{
+		VkShaderModuleCreateInfo shaderModuleCreateInfo = {
+			.sType		= VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+			.pNext		= VK_NULL_HANDLE,
+			.codeSize	= blob.size,
+			.pCode		= blob.pData,
+		};
+		VkResult result = vkCreateShaderModule(device, &shaderModuleCreateInfo, pCtx->pAllocator, pOutShaderModule);
+		PackBlobRelease(&blob);
+		return result;
+	}
+
+	return vkLoadShaderModuleFile(pCtx, pFilePath, device, pOutShaderModule);
+}
+
+YND VkResult
+vkLoadShaderModuleFile(VkContext *pCtx, const char* pFilePath, VkDevice device, VkShaderModule* pOutShaderModule)
 {
 	uint32_t*	pBuffer;
 	FILE*		pStream;
@@ -45,6 +71,14 @@ vkLoadShaderModule(VkContext *pCtx, const char* pFilePath, VkDevice device, VkSh
 	IO_CHECK(fseek(pStream, 0, SEEK_END));
 	fileSize = ftell(pStream);
 
+	/* NOTE: Catches files caught mid-write by the hot reload */
+	if (fileSize < sizeof(uint32_t) || fileSize % sizeof(uint32_t) != 0)
+	{
+		YERROR("%s: not a SPIR-V module (%zu bytes)", pFilePath, fileSize);
+		OsFclose(pStream);
+		return VK_ERROR_INITIALIZATION_FAILED;
+	}
+
 	pBuffer = DarrayReserve(uint32_t, fileSize / sizeof(uint32_t));
 	fseek(pStream, 0, SEEK_SET);
 
@@ -58,18 +92,29 @@ vkLoadShaderModule(VkContext *pCtx, const char* pFilePath, VkDevice device, VkSh
 	}
 	IO_CHECK(OsFclose(pStream));
 
+	if (pBuffer[0] != SPIRV_MAGIC)
+	{
+		YERROR("%s: bad SPIR-V magic 0x%08x", pFilePath, pBuffer[0]);
+		DarrayDestroy(pBuffer);
+		return VK_ERROR_INITIALIZATION_FAILED;
+	}
+
 	VkShaderModuleCreateInfo shaderModuleCreateInfo = {
 		.sType		= VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
 		.pNext		= VK_NULL_HANDLE,
 		.codeSize	= fileSize,
 		.pCode		= pBuffer,
 	};
-	VK_CHECK(vkCreateShaderModule(device, &shaderModuleCreateInfo, pCtx->pAllocator, pOutShaderModule));
+	VkResult result = vkCreateShaderModule(device, &shaderModuleCreateInfo, pCtx->pAllocator, pOutShaderModule);
 
 	DarrayDestroy(pBuffer);
-	return VK_SUCCESS;
+	return result;
 }
 
+/*
+ * NOTE: Only the shared layout and the per effect state, the pipelines
+ * themselves are built by vkComputePipelineBuild so they can run as jobs.
+ */
 YND VkResult
 vkComputePipelineInit(VkContext *pCtx, VkDevice device, const char** ppShaderPaths)
 {
@@ -95,80 +140,152 @@ vkComputePipelineInit(VkContext *pCtx, VkDevice device, const char** ppShaderPat
 				pCtx->pAllocator,
 				&pCtx->gradientComputePipelineLayout));
 
-	/* NOTE: Setup PipelineInfo */
-	uint32_t createInfoCount = 1;
-	VkPipelineCache pipelineCache = VK_NULL_HANDLE;
-
-	VkPipelineShaderStageCreateInfo pipelineShaderStageInfo = {
-		.sType	= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-		.pNext	= VK_NULL_HANDLE,
-		.stage	= VK_SHADER_STAGE_COMPUTE_BIT,
-		.pName	= "main",
-	};
-	VkComputePipelineCreateInfo computePipelineCreateInfo = {
-		.sType	= VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
-		.pNext	= VK_NULL_HANDLE,
-		.layout	= pCtx->gradientComputePipelineLayout,
-		.stage	= pipelineShaderStageInfo,
-	};
-
-	/* NOTE: Load and init pipeline of gradientColorDrawShader */
-	VkShaderModule gradientDrawShader;
-	VkShaderModule skyDrawShader;
-	VkShaderModule gradientColorDrawShader;
-	VK_CHECK(vkLoadShaderModule(pCtx, ppShaderPaths[0], device, &gradientColorDrawShader));
-	VK_CHECK(vkLoadShaderModule(pCtx, ppShaderPaths[1], device, &gradientDrawShader));
-	VK_CHECK(vkLoadShaderModule(pCtx, ppShaderPaths[2], device, &skyDrawShader));
+	uint32_t pGroupSize[2];
+	vkComputeGroupSizeSelect(&pCtx->device, 2, pGroupSize);
+	YINFO("Background group size: %ux%u", pGroupSize[0], pGroupSize[1]);
+	for (uint32_t i = 0; i < DarrayCapacity(pCtx->pComputeShaders); i++)
+	{
+		pCtx->pComputeShaders[i].pGroupSize[0] = pGroupSize[0];
+		pCtx->pComputeShaders[i].pGroupSize[1] = pGroupSize[1];
+	}
 
-	/* NOTE: Load and init pipeline of gradientDrawShader */
+	/* NOTE: gradientColorDrawShader */
 	pCtx->pComputeShaders[0].pFilePath = ppShaderPaths[0];
 	pCtx->pComputeShaders[0].pipelineLayout = pCtx->gradientComputePipelineLayout;
 	Vec4Fill(1.0f, 0.0f, 0.0f, 1.0f, pCtx->pComputeShaders[0].pushConstant.data1);
 	Vec4Fill(0.0f, 0.0f, 1.0f, 1.0f, pCtx->pComputeShaders[0].pushConstant.data2);
-	computePipelineCreateInfo.stage.module = gradientColorDrawShader;
-	VK_CHECK(vkCreateComputePipelines(
-				device,
-				pipelineCache,
-				createInfoCount,
-				&computePipelineCreateInfo,
-				pCtx->pAllocator,
-				&pCtx->pComputeShaders[0].pipeline));
 
-	/* NOTE: Load and init pipeline of gradientDrawShader */
+	/* NOTE: gradientDrawShader */
 	pCtx->pComputeShaders[1].pFilePath = ppShaderPaths[1];
 	pCtx->pComputeShaders[1].pipelineLayout = pCtx->gradientComputePipelineLayout;
 	Vec4Fill(1.0f, 0.0f, 0.0f, 1.0f, pCtx->pComputeShaders[1].pushConstant.data1);
 	Vec4Fill(0.0f, 0.0f, 1.0f, 1.0f, pCtx->pComputeShaders[1].pushConstant.data2);
-	computePipelineCreateInfo.stage.module = gradientDrawShader;
-	VK_CHECK(vkCreateComputePipelines(
-				device,
-				pipelineCache,
-				createInfoCount,
-				&computePipelineCreateInfo,
-				pCtx->pAllocator,
-				&pCtx->pComputeShaders[1].pipeline));
 
-	/* NOTE: Load and init pipeline of skyDrawShader */
+	/* NOTE: skyDrawShader */
 	pCtx->pComputeShaders[2].pFilePath = ppShaderPaths[2];
 	pCtx->pComputeShaders[2].pipelineLayout = pCtx->gradientComputePipelineLayout;
 	Vec4Fill(0.1f, 0.2f, 0.4f, 0.97f, pCtx->pComputeShaders[2].pushConstant.data1);
-	computePipelineCreateInfo.stage.module = skyDrawShader;
+
+	return VK_SUCCESS;
+}
+
+void
+vkComputeGroupSizeSelect(const VulkanDevice* pDevice, uint32_t dimensions, uint32_t pOutGroupSize[2])
+{
+	const VkPhysicalDeviceLimits*	pLimits			= &pDevice->properties.limits;
+	uint32_t						invocations		= 256;
+	uint32_t						subgroupSize	= pDevice->subgroupSize ? pDevice->subgroupSize : 32;
+
+	if (invocations > pLimits->maxComputeWorkGroupInvocations)
+		invocations = pLimits->maxComputeWorkGroupInvocations;
+
+	/* NOTE: Flat groups only need to stay out of partly filled subgroups */
+	if (dimensions == 1)
+	{
+		uint32_t width = subgroupSize > 64 ? subgroupSize : 64;
+		if (width > invocations)
+			width = invocations;
+		if (width > pLimits->maxComputeWorkGroupSize[0])
+			width = pLimits->maxComputeWorkGroupSize[0];
+		pOutGroupSize[0] = width;
+		pOutGroupSize[1] = 1;
+		return ;
+	}
+
+	/* NOTE: A subgroup writes a row of texels, narrow ones still get 8 */
+	uint32_t width = subgroupSize < 8 ? 8 : subgroupSize;
+	if (width > invocations)
+		width = invocations;
+	if (width > pLimits->maxComputeWorkGroupSize[0])
+		width = pLimits->maxComputeWorkGroupSize[0];
+	uint32_t height = invocations / width;
+	if (height > pLimits->maxComputeWorkGroupSize[1])
+		height = pLimits->maxComputeWorkGroupSize[1];
+	pOutGroupSize[0] = width;
+	pOutGroupSize[1] = height ? height : 1;
+}
+
+YND VkResult
+vkComputePipelineCreate(VkContext *pCtx, VkDevice device, VkShaderModule shaderModule,
+		const ComputeShaderFx* pShader, VkPipeline* pOutPipeline)
+{
+	/* NOTE: local_size_x_id = 0, local_size_y_id = 1, ids unused by a shader are ignored */
+	VkSpecializationMapEntry pSpecializationEntries[2] = {
+		{ .constantID = 0, .offset = 0,					.size = sizeof(uint32_t) },
+		{ .constantID = 1, .offset = sizeof(uint32_t),	.size = sizeof(uint32_t) },
+	};
+	VkSpecializationInfo specializationInfo = {
+		.mapEntryCount	= 2,
+		.pMapEntries	= pSpecializationEntries,
+		.dataSize		= sizeof(pShader->pGroupSize),
+		.pData			= pShader->pGroupSize,
+	};
+	VkPipelineShaderStageCreateInfo pipelineShaderStageInfo = {
+		.sType					= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+		.pNext					= VK_NULL_HANDLE,
+		.stage					= VK_SHADER_STAGE_COMPUTE_BIT,
+		.module					= shaderModule,
+		.pName					= "main",
+		.pSpecializationInfo	= &specializationInfo,
+	};
+	VkComputePipelineCreateInfo computePipelineCreateInfo = {
+		.sType	= VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		.pNext	= VK_NULL_HANDLE,
+		.layout	= pShader->pipelineLayout,
+		.stage	= pipelineShaderStageInfo,
+	};
+
+	uint32_t createInfoCount = 1;
+	VkPipelineCache pipelineCache = pCtx->pipelineCache;
 	VK_CHECK(vkCreateComputePipelines(
 				device,
 				pipelineCache,
 				createInfoCount,
 				&computePipelineCreateInfo,
 				pCtx->pAllocator,
-				&pCtx->pComputeShaders[2].pipeline));
-
-	/* NOTE: Cleanup */
-	vkDestroyShaderModule(device, skyDrawShader, pCtx->pAllocator);
-	vkDestroyShaderModule(device, gradientColorDrawShader, pCtx->pAllocator);
-	vkDestroyShaderModule(device, gradientDrawShader, pCtx->pAllocator);
+				pOutPipeline));
 
 	return VK_SUCCESS;
 }
 
+YND VkResult
+vkComputePipelineBuild(VkContext *pCtx, VkDevice device, ComputeShaderFx* pShader)
+{
+	VkShaderModule shaderModule;
+	VK_CHECK(vkLoadShaderModule(pCtx, pShader->pFilePath, device, &shaderModule));
+	VkResult result = vkComputePipelineCreate(pCtx, device, shaderModule, pShader, &pShader->pipeline);
+	vkDestroyShaderModule(device, shaderModule, pCtx->pAllocator);
+
+	return result;
+}
+
+/*
+ * NOTE: Job entry point, everything a job writes is its own PipelineBuildJob
+ * and its own pipeline slot. The cache is internally synced.
+ */
+void
+vkPipelineBuildJob(void* pData)
+{
+	PipelineBuildJob*	pJob	= pData;
+	f64					start	= OsGetAbsoluteTime(MILLISECONDS);
+
+	if (pJob->pPipeline)
+	{
+		pJob->result = vkGenericPipelineInit(
+				pJob->pCtx,
+				pJob->device,
+				pJob->pPipeline,
+				pJob->pushConstantCount ? &pJob->pushConstantRange : VK_NULL_HANDLE,
+				pJob->pushConstantCount,
+				pJob->pCtx->depthImage.format,
+				pJob->bDepthTest);
+	}
+	else
+		pJob->result = vkComputePipelineBuild(pJob->pCtx, pJob->device, pJob->pCompute);
+
+	pJob->elapsedMs = OsGetAbsoluteTime(MILLISECONDS) - start;
+}
+
 
 static inline void
 vkRasterizerSetModes(
@@ -271,6 +388,7 @@ vkInputAssemblySetTopology(VkPipelineInputAssemblyStateCreateInfo* pInputAssembl
 YND VkResult
 vkGraphicsPipelineCreate(
 		VkDevice							device,
+		VkPipelineCache						pipelineCache,
 		GraphicsPipeline*					pPipeline,
 		VkAllocationCallbacks*				pAllocator,
 		VkPipeline*							pOutPipeline)
@@ -333,7 +451,6 @@ vkGraphicsPipelineCreate(
 	};
 
 	pipelineInfo.pDynamicState		=	&dynamicInfo;
-	VkPipelineCache	pipelineCache	=	VK_NULL_HANDLE;
 	uint32_t		createInfoCount	=	1;
 
 	VK_CHECK(vkCreateGraphicsPipelines(
@@ -369,6 +486,8 @@ vkGenericPipelineInit(
 		.sType					= VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
 		.pPushConstantRanges	= pConstantRange,
 		.pushConstantRangeCount	= pushConstantCount,
+		.pSetLayouts			= &pPipeline->setLayout,
+		.setLayoutCount			= pPipeline->setLayout != VK_NULL_HANDLE,
 	};
 
 	VK_CHECK(vkCreatePipelineLayout(device, &pipelineLayoutInfo, pCtx->pAllocator, &pPipeline->pipelineLayout));
@@ -429,6 +548,7 @@ vkGenericPipelineInit(
 	VkPipeline newPipeline = {0};
 	VK_CHECK(vkGraphicsPipelineCreate(
 				device,
+				pCtx->pipelineCache,
 				&pPipeline->graphicsPipeline,
 				pCtx->pAllocator,
 				&newPipeline));
@@ -510,7 +630,7 @@ vkPipelineInit(VkContext *pCtx, VkDevice device, const char* pFilePath)
 	};
 
 	uint32_t createInfoCount = 1;
-	VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+	VkPipelineCache pipelineCache = pCtx->pipelineCache;
 
 	VK_CHECK(vkCreateComputePipelines(
 				device,
@@ -6,6 +6,23 @@
 
 #include "core/yvec4.h"
 
+/*
+ * NOTE: One pipeline to build on the job system, `pCompute` when `pPipeline`
+ * is NULL. `result` and `elapsedMs` are only valid after the JobWait.
+ */
+typedef struct PipelineBuildJob
+{
+	VkContext*				pCtx;
+	VkDevice				device;
+	GenericPipeline*		pPipeline;
+	ComputeShaderFx*		pCompute;
+	VkPushConstantRange		pushConstantRange;
+	uint32_t				pushConstantCount;
+	bool					bDepthTest;
+	VkResult				result;
+	f64						elapsedMs;
+} PipelineBuildJob;
+
 YND VkResult vkGenericPipelineInit(
 		VkContext*							pCtx,
 		VkDevice							device,
@@ -21,11 +38,58 @@ YND VkResult vkLoadShaderModule(
 		VkDevice							device,
 		VkShaderModule*						pOutShaderModule);
 
+/**
+ * @brief	Same as vkLoadShaderModule but never looks into the mounted pack,
+ *			used by the hot reload which wants the freshly built file.
+ */
+YND VkResult vkLoadShaderModuleFile(
+		VkContext*							pCtx,
+		const char*							pFilePath,
+		VkDevice							device,
+		VkShaderModule*						pOutShaderModule);
+
 YND VkResult vkComputePipelineInit(
 		VkContext*							pCtx,
 		VkDevice							device,
 		const char**						ppFilePath);
 
+/**
+ * @brief	Group size of a `dimensions` (1 or 2) compute shader on `pDevice`:
+ *			256 invocations, a row one subgroup wide (at least 8), within the
+ *			device limits. The unused dimension is 1.
+ */
+void vkComputeGroupSizeSelect(
+		const VulkanDevice*					pDevice,
+		uint32_t							dimensions,
+		uint32_t							pOutGroupSize[2]);
+
+/**
+ * @brief	Builds `shaderModule` with the layout of `pShader`, its group size
+ *			given as specialization constants 0 and 1.
+ */
+YND VkResult vkComputePipelineCreate(
+		VkContext*							pCtx,
+		VkDevice							device,
+		VkShaderModule						shaderModule,
+		const ComputeShaderFx*				pShader,
+		VkPipeline*							pOutPipeline);
+
+/**
+ * @brief	Loads the SPIR-V of `pShader` and builds its pipeline with its
+ *			layout, for pCtx->pComputeShaders vkComputePipelineInit has to be
+ *			called first.
+ */
+YND VkResult vkComputePipelineBuild(
+		VkContext*							pCtx,
+		VkDevice							device,
+		ComputeShaderFx*					pShader);
+
+/**
+ * @brief	pfnJob building the pipeline described by a PipelineBuildJob.
+ */
+void vkPipelineBuildJob(
+		void*								pData);
+
 YND VkResult vkPipelineInit(
 		VkContext*							pCtx,
 		VkDevice							device,
@@ -0,0 +1,206 @@
+#include "vulkan_pipeline_cache.h"
+
+#include "core/filesystem.h"
+#include "core/logger.h"
+#include "core/ymemory.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define PIPELINE_CACHE_MAGIC		0x43505659u /* "YVPC" */
+#define PIPELINE_CACHE_VERSION		1
+#define PIPELINE_CACHE_MAX_PATH		512
+
+typedef struct PipelineCacheFileHeader
+{
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	vendorID;
+	uint32_t	deviceID;
+	uint32_t	driverVersion;
+	uint32_t	reserved;
+	uint64_t	dataSize;
+	uint64_t	dataHash;
+	uint8_t		pipelineCacheUUID[VK_UUID_SIZE];
+} PipelineCacheFileHeader;
+
+/* NOTE: FNV-1a, only here to catch truncated or torn files */
+static uint64_t
+PipelineCacheHash(const uint8_t* pData, uint64_t size)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (uint64_t i = 0; i < size; i++)
+	{
+		hash ^= pData[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static void
+PipelineCachePath(VkContext* pCtx, const char* pDirectory, char* pOutPath, size_t pathSize)
+{
+	VkPhysicalDeviceProperties* pProperties = &pCtx->device.properties;
+	snprintf(pOutPath, pathSize, "%s/pipeline_%04x_%04x.cache", pDirectory,
+			pProperties->vendorID, pProperties->deviceID);
+}
+
+/*
+ * NOTE: Checks both our header and the driver's own VkPipelineCacheHeaderVersionOne,
+ * some drivers crash on blobs from another device instead of ignoring them.
+ */
+static const char*
+PipelineCacheValidate(VkContext* pCtx, const uint8_t* pFile, uint64_t fileSize)
+{
+	VkPhysicalDeviceProperties*		pProperties	= &pCtx->device.properties;
+	const PipelineCacheFileHeader*	pHeader		= (const PipelineCacheFileHeader*)pFile;
+	const uint8_t*					pData		= pFile + sizeof(PipelineCacheFileHeader);
+
+	if (fileSize < sizeof(PipelineCacheFileHeader)
+			|| pHeader->magic != PIPELINE_CACHE_MAGIC
+			|| pHeader->version != PIPELINE_CACHE_VERSION)
+		return "unknown format";
+	if (pHeader->vendorID != pProperties->vendorID
+			|| pHeader->deviceID != pProperties->deviceID
+			|| pHeader->driverVersion != pProperties->driverVersion
+			|| memcmp(pHeader->pipelineCacheUUID, pProperties->pipelineCacheUUID, VK_UUID_SIZE) != 0)
+		return "device or driver changed";
+	if (pHeader->dataSize != fileSize - sizeof(PipelineCacheFileHeader)
+			|| pHeader->dataHash != PipelineCacheHash(pData, pHeader->dataSize))
+		return "truncated or corrupted";
+
+	VkPipelineCacheHeaderVersionOne driverHeader;
+	if (pHeader->dataSize < sizeof(driverHeader))
+		return "driver header missing";
+	memcpy(&driverHeader, pData, sizeof(driverHeader));
+	if (driverHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+			|| driverHeader.headerSize < sizeof(driverHeader)
+			|| driverHeader.vendorID != pProperties->vendorID
+			|| driverHeader.deviceID != pProperties->deviceID
+			|| memcmp(driverHeader.pipelineCacheUUID, pProperties->pipelineCacheUUID, VK_UUID_SIZE) != 0)
+		return "driver header mismatch";
+	return NULL;
+}
+
+YND VkResult
+vkPipelineCacheCreate(VkContext* pCtx, const char* pDirectory)
+{
+	char pPath[PIPELINE_CACHE_MAX_PATH];
+	PipelineCachePath(pCtx, pDirectory, pPath, sizeof(pPath));
+
+	uint8_t*	pFile		= NULL;
+	int64_t		fileSize	= -1;
+	FILE*		pStream		= NULL;
+	if (OsFopen(&pStream, pPath, "rb") == 0 && pStream)
+	{
+		fileSize = OsFileSize(pStream);
+		if (fileSize > 0)
+		{
+			pFile = yAlloc(fileSize, MEMORY_TAG_RENDERER);
+			if (OsFreadAt(pStream, pFile, fileSize, 0) != fileSize)
+			{
+				yFree2(pFile, fileSize, MEMORY_TAG_RENDERER);
+				pFile = NULL;
+			}
+		}
+		OsFclose(pStream);
+	}
+
+	VkPipelineCacheCreateInfo createInfo = {
+		.sType				= VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+		.pNext				= VK_NULL_HANDLE,
+		.initialDataSize	= 0,
+		.pInitialData		= VK_NULL_HANDLE,
+	};
+	if (pFile)
+	{
+		const char* pReason = PipelineCacheValidate(pCtx, pFile, fileSize);
+		if (pReason)
+			YINFO("Pipeline cache %s ignored: %s", pPath, pReason);
+		else
+		{
+			createInfo.initialDataSize	= fileSize - sizeof(PipelineCacheFileHeader);
+			createInfo.pInitialData		= pFile + sizeof(PipelineCacheFileHeader);
+		}
+	}
+
+	VkResult result = vkCreatePipelineCache(pCtx->device.handle, &createInfo, pCtx->pAllocator, &pCtx->pipelineCache);
+	if (result != VK_SUCCESS && createInfo.initialDataSize)
+	{
+		/* NOTE: Driver refused the blob anyway, an empty cache still beats none */
+		YWARN("Pipeline cache %s rejected by the driver", pPath);
+		createInfo.initialDataSize	= 0;
+		createInfo.pInitialData		= VK_NULL_HANDLE;
+		result = vkCreatePipelineCache(pCtx->device.handle, &createInfo, pCtx->pAllocator, &pCtx->pipelineCache);
+	}
+	if (createInfo.initialDataSize)
+		YINFO("Pipeline cache loaded from %s (%zu bytes)", pPath, createInfo.initialDataSize);
+	if (pFile)
+		yFree2(pFile, fileSize, MEMORY_TAG_RENDERER);
+	VK_CHECK(result);
+	return VK_SUCCESS;
+}
+
+YND b8
+vkPipelineCacheSave(VkContext* pCtx, const char* pDirectory)
+{
+	if (pCtx->pipelineCache == VK_NULL_HANDLE)
+		return FALSE;
+
+	VkDevice	device		= pCtx->device.handle;
+	size_t		dataSize	= 0;
+	if (vkGetPipelineCacheData(device, pCtx->pipelineCache, &dataSize, VK_NULL_HANDLE) != VK_SUCCESS || dataSize == 0)
+		return FALSE;
+
+	uint64_t	fileSize	= sizeof(PipelineCacheFileHeader) + dataSize;
+	uint8_t*	pFile		= yAlloc(fileSize, MEMORY_TAG_RENDERER);
+	uint8_t*	pData		= pFile + sizeof(PipelineCacheFileHeader);
+	/* NOTE: VK_INCOMPLETE would mean the cache grew in between, nothing else builds pipelines now */
+	if (vkGetPipelineCacheData(device, pCtx->pipelineCache, &dataSize, pData) != VK_SUCCESS)
+	{
+		yFree2(pFile, fileSize, MEMORY_TAG_RENDERER);
+		return FALSE;
+	}
+
+	VkPhysicalDeviceProperties* pProperties = &pCtx->device.properties;
+	PipelineCacheFileHeader* pHeader = (PipelineCacheFileHeader*)pFile;
+	*pHeader = (PipelineCacheFileHeader){
+		.magic			= PIPELINE_CACHE_MAGIC,
+		.version		= PIPELINE_CACHE_VERSION,
+		.vendorID		= pProperties->vendorID,
+		.deviceID		= pProperties->deviceID,
+		.driverVersion	= pProperties->driverVersion,
+		.dataSize		= dataSize,
+		.dataHash		= PipelineCacheHash(pData, dataSize),
+	};
+	memcpy(pHeader->pipelineCacheUUID, pProperties->pipelineCacheUUID, VK_UUID_SIZE);
+
+	char pPath[PIPELINE_CACHE_MAX_PATH];
+	char pTempPath[PIPELINE_CACHE_MAX_PATH + 8];
+	PipelineCachePath(pCtx, pDirectory, pPath, sizeof(pPath));
+	snprintf(pTempPath, sizeof(pTempPath), "%s.tmp", pPath);
+
+	b8		bSaved	= FALSE;
+	FILE*	pStream	= NULL;
+	if (OsFopen(&pStream, pTempPath, "wb") == 0 && pStream)
+	{
+		size_t written = fwrite(pFile, 1, sizeof(PipelineCacheFileHeader) + dataSize, pStream);
+		if (OsFclose(pStream) == 0 && written == sizeof(PipelineCacheFileHeader) + dataSize)
+			bSaved = OsFileRename(pTempPath, pPath);
+		if (!bSaved)
+			remove(pTempPath);
+	}
+	if (bSaved)
+		YINFO("Pipeline cache saved to %s (%zu bytes)", pPath, dataSize);
+	else
+		YWARN("Could not save the pipeline cache to %s", pPath);
+	yFree2(pFile, fileSize, MEMORY_TAG_RENDERER);
+	return bSaved;
+}
+
+void
+vkPipelineCacheDestroy(VkContext* pCtx)
+{
+	vkDestroyPipelineCache(pCtx->device.handle, pCtx->pipelineCache, pCtx->pAllocator);
+	pCtx->pipelineCache = VK_NULL_HANDLE;
+}
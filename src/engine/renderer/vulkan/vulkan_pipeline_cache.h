@@ -0,0 +1,30 @@
+#ifndef VULKAN_PIPELINE_CACHE_H
+#define VULKAN_PIPELINE_CACHE_H
+
+#include "yvulkan.h"
+
+/*
+ * NOTE: One cache file per vendor/device pair in `pDirectory`. The file starts
+ * with our own header (driver version, pipelineCacheUUID, checksum) so a
+ * driver update or a torn write ends up as an empty cache, not a bad blob.
+ */
+
+/**
+ * @brief	Creates pCtx->pipelineCache, seeded from disk when the file matches
+ *			the current device and driver.
+ */
+YND VkResult vkPipelineCacheCreate(
+		VkContext*							pCtx,
+		const char*							pDirectory);
+
+/**
+ * @brief	Writes the cache next to its final path then renames it over.
+ */
+YND b8 vkPipelineCacheSave(
+		VkContext*							pCtx,
+		const char*							pDirectory);
+
+void vkPipelineCacheDestroy(
+		VkContext*							pCtx);
+
+#endif // VULKAN_PIPELINE_CACHE_H
@@ -0,0 +1,454 @@
+#include "vulkan_render_graph.h"
+
+#include "vulkan_timer.h"
+
+#include "core/logger.h"
+#include "core/myassert.h"
+
+#include "profiler.h"
+
+#include <string.h>
+
+#define RENDER_GRAPH_WRITE_ACCESS	( VK_ACCESS_2_SHADER_WRITE_BIT					\
+									| VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT			\
+									| VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT		\
+									| VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT	\
+									| VK_ACCESS_2_TRANSFER_WRITE_BIT				\
+									| VK_ACCESS_2_HOST_WRITE_BIT					\
+									| VK_ACCESS_2_MEMORY_WRITE_BIT )
+
+/* NOTE: A pass needs at most one per access, the final batch one per export */
+#define RENDER_GRAPH_MAX_BARRIERS	(VK_RENDER_GRAPH_MAX_RESOURCES)
+
+typedef struct RenderGraphUsageInfo
+{
+	VkPipelineStageFlags2	stages;
+	VkAccessFlags2			access;
+	// NOTE: Ignored for buffers
+	VkImageLayout			layout;
+} RenderGraphUsageInfo;
+
+static const RenderGraphUsageInfo gpUsageInfos[MAX_RENDER_GRAPH_USAGE] = {
+	[RENDER_GRAPH_USAGE_NONE] = {0},
+	/* NOTE: Load and store, the attachment is read as well */
+	[RENDER_GRAPH_USAGE_COLOR_ATTACHMENT] = {
+		.stages	= VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+		.access	= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+		.layout	= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+	},
+	[RENDER_GRAPH_USAGE_DEPTH_ATTACHMENT] = {
+		.stages	= VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+		.access	= VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+		.layout	= VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+	},
+	[RENDER_GRAPH_USAGE_STORAGE_IMAGE_WRITE_COMPUTE] = {
+		.stages	= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+		.access	= VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+		.layout	= VK_IMAGE_LAYOUT_GENERAL,
+	},
+	[RENDER_GRAPH_USAGE_STORAGE_IMAGE_READ_COMPUTE] = {
+		.stages	= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+		.access	= VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+		.layout	= VK_IMAGE_LAYOUT_GENERAL,
+	},
+	[RENDER_GRAPH_USAGE_SAMPLED_FRAGMENT] = {
+		.stages	= VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+		.access	= VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+		.layout	= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+	},
+	/* NOTE: Copies, blits, resolves and clears */
+	[RENDER_GRAPH_USAGE_TRANSFER_SRC] = {
+		.stages	= VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+		.access	= VK_ACCESS_2_TRANSFER_READ_BIT,
+		.layout	= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+	},
+	[RENDER_GRAPH_USAGE_TRANSFER_DST] = {
+		.stages	= VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+		.access	= VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		.layout	= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+	},
+	/* NOTE: The present semaphore does the rest, nothing to wait in the queue */
+	[RENDER_GRAPH_USAGE_PRESENT] = {
+		.stages	= VK_PIPELINE_STAGE_2_NONE,
+		.access	= VK_ACCESS_2_NONE,
+		.layout	= VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+	},
+	/* NOTE: Atomics read what they write */
+	[RENDER_GRAPH_USAGE_STORAGE_BUFFER_WRITE_COMPUTE] = {
+		.stages	= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+		.access	= VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+	},
+	[RENDER_GRAPH_USAGE_STORAGE_BUFFER_READ_COMPUTE] = {
+		.stages	= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+		.access	= VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+	},
+	[RENDER_GRAPH_USAGE_STORAGE_BUFFER_READ_VERTEX] = {
+		.stages	= VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+		.access	= VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+	},
+	[RENDER_GRAPH_USAGE_INDIRECT_READ] = {
+		.stages	= VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+		.access	= VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+	},
+	/* NOTE: Readbacks, the fence wait does the rest */
+	[RENDER_GRAPH_USAGE_HOST_READ] = {
+		.stages	= VK_PIPELINE_STAGE_2_HOST_BIT,
+		.access	= VK_ACCESS_2_HOST_READ_BIT,
+		.layout	= VK_IMAGE_LAYOUT_GENERAL,
+	},
+};
+
+typedef struct RenderGraphBarriers
+{
+	uint32_t				imageCount;
+	uint32_t				bufferCount;
+	VkImageMemoryBarrier2	pImages[RENDER_GRAPH_MAX_BARRIERS];
+	VkBufferMemoryBarrier2	pBuffers[RENDER_GRAPH_MAX_BARRIERS];
+} RenderGraphBarriers;
+
+void
+vkRenderGraphReset(VulkanRenderGraph* pGraph)
+{
+	pGraph->passCount		= 0;
+	pGraph->resourceCount	= 0;
+	pGraph->culledCount		= 0;
+}
+
+static uint32_t
+ResourceAdd(VulkanRenderGraph* pGraph, const char* pName)
+{
+	if (pGraph->resourceCount >= VK_RENDER_GRAPH_MAX_RESOURCES)
+	{
+		YERROR("Render graph: too many resources, %s dropped", pName);
+		return VK_RENDER_GRAPH_INVALID;
+	}
+	uint32_t					index		= pGraph->resourceCount++;
+	VulkanRenderGraphResource*	pResource	= &pGraph->pResources[index];
+	memset(pResource, 0, sizeof(VulkanRenderGraphResource));
+	pResource->pName = pName;
+	return index;
+}
+
+uint32_t
+vkRenderGraphImageImport(
+		VulkanRenderGraph*		pGraph,
+		const char*				pName,
+		VkImage					image,
+		VkImageAspectFlags		aspectMask,
+		VkImageLayout			initialLayout,
+		VkPipelineStageFlags2	initialStages)
+{
+	uint32_t index = ResourceAdd(pGraph, pName);
+	if (index == VK_RENDER_GRAPH_INVALID)
+		return index;
+
+	VulkanRenderGraphResource* pResource = &pGraph->pResources[index];
+	pResource->image		= image;
+	pResource->bImage		= TRUE;
+	pResource->aspectMask	= aspectMask;
+	pResource->layout		= initialLayout;
+	/* NOTE: Whatever happened before is a write to wait on, the first transition chains to it */
+	pResource->writeStages	= initialStages;
+	return index;
+}
+
+void
+vkRenderGraphImageBind(VulkanRenderGraph* pGraph, uint32_t resource, VkImage image, VkPipelineStageFlags2 initialStages)
+{
+	if (resource >= pGraph->resourceCount)
+		return ;
+	pGraph->pResources[resource].image			= image;
+	pGraph->pResources[resource].writeStages	= initialStages;
+}
+
+uint32_t
+vkRenderGraphBufferImport(VulkanRenderGraph* pGraph, const char* pName, VkBuffer buffer)
+{
+	uint32_t index = ResourceAdd(pGraph, pName);
+	if (index != VK_RENDER_GRAPH_INVALID)
+		pGraph->pResources[index].buffer = buffer;
+	return index;
+}
+
+void
+vkRenderGraphExport(VulkanRenderGraph* pGraph, uint32_t resource, VulkanRenderGraphUsage finalUsage)
+{
+	if (resource >= pGraph->resourceCount)
+		return ;
+	pGraph->pResources[resource].bExported	= TRUE;
+	pGraph->pResources[resource].finalUsage	= finalUsage;
+}
+
+/* NOTE: Before culling, a culled pass only makes the range wider than needed */
+b8
+vkRenderGraphResourcePasses(const VulkanRenderGraph* pGraph, uint32_t resource, uint32_t* pOutFirst, uint32_t* pOutLast)
+{
+	b8 bUsed = FALSE;
+	for (uint32_t p = 0; p < pGraph->passCount; p++)
+	{
+		const VulkanRenderGraphPass* pPass = &pGraph->pPasses[p];
+		for (uint32_t a = 0; a < pPass->accessCount; a++)
+		{
+			if (pPass->pAccesses[a].resource != resource)
+				continue;
+			if (!bUsed)
+				*pOutFirst = p;
+			*pOutLast	= p;
+			bUsed		= TRUE;
+			break;
+		}
+	}
+	return bUsed;
+}
+
+uint32_t
+vkRenderGraphPassAdd(
+		VulkanRenderGraph*		pGraph,
+		const char*				pName,
+		PFN_vkRenderGraphPass	pfnExecute,
+		void*					pData)
+{
+	if (pGraph->passCount >= VK_RENDER_GRAPH_MAX_PASSES)
+	{
+		YERROR("Render graph: too many passes, %s dropped", pName);
+		return VK_RENDER_GRAPH_INVALID;
+	}
+	uint32_t				index	= pGraph->passCount++;
+	VulkanRenderGraphPass*	pPass	= &pGraph->pPasses[index];
+	pPass->pName		= pName;
+	pPass->pfnExecute	= pfnExecute;
+	pPass->pData		= pData;
+	pPass->accessCount	= 0;
+	pPass->bCulled		= FALSE;
+	return index;
+}
+
+void
+vkRenderGraphPassUse(
+		VulkanRenderGraph*		pGraph,
+		uint32_t				pass,
+		uint32_t				resource,
+		VulkanRenderGraphUsage	usage)
+{
+	if (pass >= pGraph->passCount || resource >= pGraph->resourceCount || usage == RENDER_GRAPH_USAGE_NONE)
+		return ;
+
+	VulkanRenderGraphPass*		pPass	= &pGraph->pPasses[pass];
+	const RenderGraphUsageInfo*	pInfo	= &gpUsageInfos[usage];
+	b8							bImage	= pGraph->pResources[resource].bImage;
+	VkImageLayout				layout	= bImage ? pInfo->layout : VK_IMAGE_LAYOUT_UNDEFINED;
+
+	for (uint32_t i = 0; i < pPass->accessCount; i++)
+	{
+		VulkanRenderGraphAccess* pAccess = &pPass->pAccesses[i];
+		if (pAccess->resource != resource)
+			continue;
+		YASSERT_MSG(pAccess->layout == layout, "Render graph: one layout per image per pass");
+		pAccess->stages	|= pInfo->stages;
+		pAccess->access	|= pInfo->access;
+		pAccess->bWrite	|= (pInfo->access & RENDER_GRAPH_WRITE_ACCESS) != 0;
+		return ;
+	}
+
+	if (pPass->accessCount >= VK_RENDER_GRAPH_MAX_ACCESSES)
+	{
+		YERROR("Render graph: too many resources used by %s", pPass->pName);
+		return ;
+	}
+	pPass->pAccesses[pPass->accessCount++] = (VulkanRenderGraphAccess){
+		.resource	= resource,
+		.stages		= pInfo->stages,
+		.access		= pInfo->access,
+		.layout		= layout,
+		.bWrite		= (pInfo->access & RENDER_GRAPH_WRITE_ACCESS) != 0,
+	};
+}
+
+/*
+ * NOTE: Walks the passes backward from the exported resources. A pass lives
+ * when it writes something still needed, then everything it reads is needed
+ * before it. Writes do not end the need, a pass may only write part of it.
+ */
+static void
+RenderGraphCull(VulkanRenderGraph* pGraph)
+{
+	b8 pNeeded[VK_RENDER_GRAPH_MAX_RESOURCES] = {0};
+	for (uint32_t i = 0; i < pGraph->resourceCount; i++)
+		pNeeded[i] = pGraph->pResources[i].bExported;
+
+	pGraph->culledCount = 0;
+	for (uint32_t p = pGraph->passCount; p-- > 0;)
+	{
+		VulkanRenderGraphPass* pPass = &pGraph->pPasses[p];
+
+		b8 bAlive = FALSE;
+		for (uint32_t i = 0; i < pPass->accessCount && !bAlive; i++)
+			bAlive = pPass->pAccesses[i].bWrite && pNeeded[pPass->pAccesses[i].resource];
+
+		pPass->bCulled = !bAlive;
+		if (!bAlive)
+		{
+			pGraph->culledCount++;
+			continue;
+		}
+		for (uint32_t i = 0; i < pPass->accessCount; i++)
+		{
+			if (pPass->pAccesses[i].access & ~RENDER_GRAPH_WRITE_ACCESS)
+				pNeeded[pPass->pAccesses[i].resource] = TRUE;
+		}
+	}
+}
+
+/*
+ * NOTE: Reads in the same layout after reads need nothing, nor a read in
+ * stages and accesses the last write was already made visible to. Anything
+ * else waits on the last write, and a write or a layout change waits on the
+ * reads since as well, with only the writes made available.
+ */
+static void
+BarrierAdd(RenderGraphBarriers* pBarriers, VulkanRenderGraphResource* pResource, const VulkanRenderGraphAccess* pAccess)
+{
+	b8 bImage			= pResource->bImage;
+	b8 bLayoutChange	= bImage && pResource->layout != pAccess->layout;
+	b8 bVisible			= (pAccess->stages & ~pResource->readStages) == 0
+						&& (pAccess->access & ~pResource->readAccess) == 0;
+
+	VkPipelineStageFlags2	srcStages	= pResource->writeStages;
+	VkAccessFlags2			srcAccess	= pResource->writeAccess;
+	b8						bBarrier	= bLayoutChange;
+	if (pAccess->bWrite || bLayoutChange)
+	{
+		srcStages	|= pResource->readStages;
+		bBarrier	|= srcStages != 0;
+	}
+	else
+		bBarrier	|= pResource->writeStages != 0 && !bVisible;
+
+	if (bBarrier && bImage)
+	{
+		pBarriers->pImages[pBarriers->imageCount++] = (VkImageMemoryBarrier2){
+			.sType					= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+			.srcStageMask			= srcStages,
+			.srcAccessMask			= srcAccess,
+			.dstStageMask			= pAccess->stages,
+			.dstAccessMask			= pAccess->access,
+			.oldLayout				= pResource->layout,
+			.newLayout				= pAccess->layout,
+			.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
+			.image					= pResource->image,
+			.subresourceRange		= {
+				.aspectMask			= pResource->aspectMask,
+				.baseMipLevel		= 0,
+				.levelCount			= VK_REMAINING_MIP_LEVELS,
+				.baseArrayLayer		= 0,
+				.layerCount			= VK_REMAINING_ARRAY_LAYERS,
+			},
+		};
+	}
+	else if (bBarrier)
+	{
+		pBarriers->pBuffers[pBarriers->bufferCount++] = (VkBufferMemoryBarrier2){
+			.sType					= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+			.srcStageMask			= srcStages,
+			.srcAccessMask			= srcAccess,
+			.dstStageMask			= pAccess->stages,
+			.dstAccessMask			= pAccess->access,
+			.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
+			.buffer					= pResource->buffer,
+			.offset					= 0,
+			.size					= VK_WHOLE_SIZE,
+		};
+	}
+
+	if (pAccess->bWrite)
+	{
+		pResource->writeStages	= pAccess->stages;
+		pResource->writeAccess	= pAccess->access & RENDER_GRAPH_WRITE_ACCESS;
+		pResource->readStages	= 0;
+		pResource->readAccess	= 0;
+	}
+	else if (bLayoutChange)
+	{
+		/* NOTE: The transition is the write now, made visible to this access only */
+		pResource->writeStages	= pAccess->stages;
+		pResource->writeAccess	= VK_ACCESS_2_NONE;
+		pResource->readStages	= pAccess->stages;
+		pResource->readAccess	= pAccess->access;
+	}
+	else if (bBarrier)
+	{
+		pResource->readStages	|= pAccess->stages;
+		pResource->readAccess	|= pAccess->access;
+	}
+	else
+		pResource->readStages	|= pAccess->stages;
+	pResource->layout = bImage ? pAccess->layout : pResource->layout;
+}
+
+static void
+BarriersFlush(VkCommandBuffer commandBuffer, RenderGraphBarriers* pBarriers)
+{
+	if (pBarriers->imageCount == 0 && pBarriers->bufferCount == 0)
+		return ;
+
+	VkDependencyInfo dependencyInfo = {
+		.sType						= VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+		.imageMemoryBarrierCount	= pBarriers->imageCount,
+		.pImageMemoryBarriers		= pBarriers->pImages,
+		.bufferMemoryBarrierCount	= pBarriers->bufferCount,
+		.pBufferMemoryBarriers		= pBarriers->pBuffers,
+	};
+	vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	pBarriers->imageCount	= 0;
+	pBarriers->bufferCount	= 0;
+}
+
+void
+vkRenderGraphExecute(VkContext* pCtx, VulkanRenderGraph* pGraph, VkCommandBuffer commandBuffer)
+{
+	TracyCZoneN(graphCtx, "Render graph", 1);
+
+	RenderGraphCull(pGraph);
+	TracyCPlot("Render graph culled passes", pGraph->culledCount);
+
+	RenderGraphBarriers barriers = {0};
+	for (uint32_t p = 0; p < pGraph->passCount; p++)
+	{
+		VulkanRenderGraphPass* pPass = &pGraph->pPasses[p];
+		if (pPass->bCulled)
+			continue;
+
+		for (uint32_t i = 0; i < pPass->accessCount; i++)
+		{
+			VulkanRenderGraphAccess* pAccess = &pPass->pAccesses[i];
+			BarrierAdd(&barriers, &pGraph->pResources[pAccess->resource], pAccess);
+		}
+
+		vkGpuScopeBegin(pCtx, commandBuffer, pPass->pName);
+		BarriersFlush(commandBuffer, &barriers);
+		pPass->pfnExecute(pCtx, commandBuffer, pPass->pData);
+		vkGpuScopeEnd(pCtx, commandBuffer);
+	}
+
+	/* NOTE: Leaves the exports the way the next user expects them, in one last batch */
+	for (uint32_t i = 0; i < pGraph->resourceCount; i++)
+	{
+		VulkanRenderGraphResource* pResource = &pGraph->pResources[i];
+		if (!pResource->bExported || pResource->finalUsage == RENDER_GRAPH_USAGE_NONE)
+			continue;
+
+		const RenderGraphUsageInfo*	pInfo	= &gpUsageInfos[pResource->finalUsage];
+		VulkanRenderGraphAccess		access	= {
+			.resource	= i,
+			.stages		= pInfo->stages,
+			.access		= pInfo->access,
+			.layout		= pResource->bImage ? pInfo->layout : VK_IMAGE_LAYOUT_UNDEFINED,
+		};
+		BarrierAdd(&barriers, pResource, &access);
+	}
+	BarriersFlush(commandBuffer, &barriers);
+
+	TracyCZoneEnd(graphCtx);
+}
@@ -0,0 +1,159 @@
+#ifndef VULKAN_RENDER_GRAPH_H
+#define VULKAN_RENDER_GRAPH_H
+
+#include "yvulkan.h"
+
+/*
+ * NOTE: Rebuilt every frame. Passes declare how they use each image and
+ * buffer, vkRenderGraphExecute culls the passes nothing exported depends on
+ * and records the others in order, with the layout transitions and the
+ * stage and access masks derived from the declared usages. The barriers a
+ * pass needs are batched into a single vkCmdPipelineBarrier2 before it.
+ */
+#define VK_RENDER_GRAPH_MAX_PASSES		32
+#define VK_RENDER_GRAPH_MAX_RESOURCES	32
+#define VK_RENDER_GRAPH_MAX_ACCESSES	8	/* NOTE: Per pass */
+#define VK_RENDER_GRAPH_INVALID			UINT32_MAX
+
+typedef enum VulkanRenderGraphUsage
+{
+	RENDER_GRAPH_USAGE_NONE,
+	RENDER_GRAPH_USAGE_COLOR_ATTACHMENT,
+	RENDER_GRAPH_USAGE_DEPTH_ATTACHMENT,
+	RENDER_GRAPH_USAGE_STORAGE_IMAGE_WRITE_COMPUTE,
+	RENDER_GRAPH_USAGE_STORAGE_IMAGE_READ_COMPUTE,
+	RENDER_GRAPH_USAGE_SAMPLED_FRAGMENT,
+	RENDER_GRAPH_USAGE_TRANSFER_SRC,
+	RENDER_GRAPH_USAGE_TRANSFER_DST,
+	RENDER_GRAPH_USAGE_PRESENT,
+	RENDER_GRAPH_USAGE_STORAGE_BUFFER_WRITE_COMPUTE,
+	RENDER_GRAPH_USAGE_STORAGE_BUFFER_READ_COMPUTE,
+	RENDER_GRAPH_USAGE_STORAGE_BUFFER_READ_VERTEX,
+	RENDER_GRAPH_USAGE_INDIRECT_READ,
+	RENDER_GRAPH_USAGE_HOST_READ,
+	MAX_RENDER_GRAPH_USAGE
+} VulkanRenderGraphUsage;
+
+typedef void (*PFN_vkRenderGraphPass)(VkContext* pCtx, VkCommandBuffer commandBuffer, void* pData);
+
+typedef struct VulkanRenderGraphAccess
+{
+	uint32_t				resource;
+	VkPipelineStageFlags2	stages;
+	VkAccessFlags2			access;
+	VkImageLayout			layout;
+	b8						bWrite;
+} VulkanRenderGraphAccess;
+
+typedef struct VulkanRenderGraphPass
+{
+	// NOTE: Not owned, also the GPU profiler scope name
+	const char*				pName;
+	PFN_vkRenderGraphPass	pfnExecute;
+	void*					pData;
+	uint32_t				accessCount;
+	VulkanRenderGraphAccess	pAccesses[VK_RENDER_GRAPH_MAX_ACCESSES];
+	b8						bCulled;
+} VulkanRenderGraphPass;
+
+typedef struct VulkanRenderGraphResource
+{
+	const char*				pName;
+	VkImage					image;
+	VkBuffer				buffer;
+	// NOTE: Set on import, the image itself may only be bound once the passes are known
+	b8						bImage;
+	VkImageAspectFlags		aspectMask;
+	VkImageLayout			layout;
+
+	// NOTE: Last write, then the stages and accesses it was made visible to since
+	VkPipelineStageFlags2	writeStages;
+	VkAccessFlags2			writeAccess;
+	VkPipelineStageFlags2	readStages;
+	VkAccessFlags2			readAccess;
+
+	b8						bExported;
+	VulkanRenderGraphUsage	finalUsage;
+} VulkanRenderGraphResource;
+
+typedef struct VulkanRenderGraph
+{
+	uint32_t					passCount;
+	uint32_t					resourceCount;
+	uint32_t					culledCount;
+	VulkanRenderGraphPass		pPasses[VK_RENDER_GRAPH_MAX_PASSES];
+	VulkanRenderGraphResource	pResources[VK_RENDER_GRAPH_MAX_RESOURCES];
+} VulkanRenderGraph;
+
+void vkRenderGraphReset(
+		VulkanRenderGraph*					pGraph);
+
+/**
+ * @brief	`initialStages` are the ones the image was last used in before the
+ *			graph, the first barrier waits on them. The content is discarded
+ *			when `initialLayout` is VK_IMAGE_LAYOUT_UNDEFINED.
+ */
+uint32_t vkRenderGraphImageImport(
+		VulkanRenderGraph*					pGraph,
+		const char*							pName,
+		VkImage								image,
+		VkImageAspectFlags					aspectMask,
+		VkImageLayout						initialLayout,
+		VkPipelineStageFlags2				initialStages);
+
+/**
+ * @brief	Sets the image of a resource imported with VK_NULL_HANDLE, for the
+ *			ones only created once the passes using them are known.
+ */
+void vkRenderGraphImageBind(
+		VulkanRenderGraph*					pGraph,
+		uint32_t							resource,
+		VkImage								image,
+		VkPipelineStageFlags2				initialStages);
+
+uint32_t vkRenderGraphBufferImport(
+		VulkanRenderGraph*					pGraph,
+		const char*							pName,
+		VkBuffer							buffer);
+
+/**
+ * @brief	The passes it depends on are never culled. It ends the graph in
+ *			`finalUsage`, left as is with RENDER_GRAPH_USAGE_NONE.
+ */
+void vkRenderGraphExport(
+		VulkanRenderGraph*					pGraph,
+		uint32_t							resource,
+		VulkanRenderGraphUsage				finalUsage);
+
+uint32_t vkRenderGraphPassAdd(
+		VulkanRenderGraph*					pGraph,
+		const char*							pName,
+		PFN_vkRenderGraphPass				pfnExecute,
+		void*								pData);
+
+/**
+ * @brief	Declaring the same resource twice in a pass merges both usages,
+ *			their image layouts have to match.
+ */
+void vkRenderGraphPassUse(
+		VulkanRenderGraph*					pGraph,
+		uint32_t							pass,
+		uint32_t							resource,
+		VulkanRenderGraphUsage				usage);
+
+/**
+ * @brief	Order of the first and last pass using `resource`, in the order
+ *			they were added. FALSE when none does.
+ */
+b8 vkRenderGraphResourcePasses(
+		const VulkanRenderGraph*			pGraph,
+		uint32_t							resource,
+		uint32_t*							pOutFirst,
+		uint32_t*							pOutLast);
+
+void vkRenderGraphExecute(
+		VkContext*							pCtx,
+		VulkanRenderGraph*					pGraph,
+		VkCommandBuffer						commandBuffer);
+
+#endif // VULKAN_RENDER_GRAPH_H
@@ -0,0 +1,70 @@
+#include "vulkan_resolution.h"
+
+#include "vulkan_timer.h"
+
+#include "profiler.h"
+
+#include <math.h>
+
+/* NOTE: The passes of vkDrawImpl whose cost follows the pixel count, the skipped ones count 0 */
+static const char* gppResolutionScopes[] = {
+	"compute background",
+	"geometry",
+};
+
+void
+vkResolutionInit(VkContext* pCtx, f64 targetMs)
+{
+	pCtx->resolution = (VulkanDynamicResolution){
+		.scale		= VK_RESOLUTION_SCALE_MAX,
+		.minScale	= VK_RESOLUTION_SCALE_MIN,
+		.maxScale	= VK_RESOLUTION_SCALE_MAX,
+		.targetMs	= targetMs > 0.0 ? targetMs : VK_RESOLUTION_TARGET_MS_DEFAULT,
+	};
+}
+
+VkExtent2D
+vkResolutionUpdate(VkContext* pCtx)
+{
+	VulkanDynamicResolution* pResolution = &pCtx->resolution;
+
+	f64 gpuMs = 0.0;
+	for (uint32_t i = 0; i < sizeof(gppResolutionScopes) / sizeof(gppResolutionScopes[0]); i++)
+		gpuMs += vkGpuScopeLastMs(pCtx, gppResolutionScopes[i]);
+
+	if (gpuMs > 0.0)
+	{
+		pResolution->averageMs = pResolution->averageMs == 0.0
+			? gpuMs
+			: pResolution->averageMs + (gpuMs - pResolution->averageMs) * VK_RESOLUTION_SMOOTHING;
+
+		f64 error = pResolution->averageMs / pResolution->targetMs - 1.0;
+		if (fabs(error) > VK_RESOLUTION_DEADBAND)
+		{
+			/* NOTE: The cost follows the pixel count, the square of the scale */
+			f32 wanted	= pResolution->scale * (f32)sqrt(pResolution->targetMs / pResolution->averageMs);
+			f32 step	= wanted - pResolution->scale;
+			step		= step > VK_RESOLUTION_SCALE_STEP ? VK_RESOLUTION_SCALE_STEP : step;
+			step		= step < -VK_RESOLUTION_SCALE_STEP ? -VK_RESOLUTION_SCALE_STEP : step;
+			f32 scale	= pResolution->scale + step;
+			scale		= scale > pResolution->maxScale ? pResolution->maxScale : scale;
+			pResolution->scale = scale < pResolution->minScale ? pResolution->minScale : scale;
+		}
+	}
+
+	/* NOTE: Never past the draw image, it may lag behind a resize */
+	VkExtent3D	swapchainExtent	= pCtx->swapchain.extent;
+	VkExtent3D	drawExtent		= pCtx->drawImage.extent;
+	uint32_t	width			= swapchainExtent.width < drawExtent.width ? swapchainExtent.width : drawExtent.width;
+	uint32_t	height			= swapchainExtent.height < drawExtent.height ? swapchainExtent.height : drawExtent.height;
+	pResolution->renderExtent = (VkExtent2D){
+		.width	= (uint32_t)(width * pResolution->scale + 0.5f),
+		.height	= (uint32_t)(height * pResolution->scale + 0.5f),
+	};
+	if (pResolution->renderExtent.width == 0)
+		pResolution->renderExtent.width = 1;
+	if (pResolution->renderExtent.height == 0)
+		pResolution->renderExtent.height = 1;
+	TracyCPlot("Resolution scale", pResolution->scale);
+	return pResolution->renderExtent;
+}
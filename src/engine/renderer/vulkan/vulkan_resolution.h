@@ -0,0 +1,30 @@
+#ifndef VULKAN_RESOLUTION_H
+#define VULKAN_RESOLUTION_H
+
+#include "yvulkan.h"
+
+#define VK_RESOLUTION_TARGET_MS_DEFAULT		14.0	/* NOTE: 60 Hz with some room for the CPU side */
+#define VK_RESOLUTION_SCALE_MIN				0.5f
+#define VK_RESOLUTION_SCALE_MAX				1.0f
+/* NOTE: Largest change in a frame, the times lag by the frames in flight */
+#define VK_RESOLUTION_SCALE_STEP			0.05f
+/* NOTE: Relative error left alone, keeps the scale from flickering around the target */
+#define VK_RESOLUTION_DEADBAND				0.05
+#define VK_RESOLUTION_SMOOTHING				0.1
+
+/**
+ * @brief	`targetMs` of 0 uses VK_RESOLUTION_TARGET_MS_DEFAULT.
+ */
+void vkResolutionInit(
+		VkContext*							pCtx,
+		f64									targetMs);
+
+/**
+ * @brief	Feeds the GPU times the profiler read back to the controller and
+ *			returns the extent to render this frame at. Call after
+ *			vkGpuProfilerFrameBegin. Stays at full scale without the profiler.
+ */
+VkExtent2D vkResolutionUpdate(
+		VkContext*							pCtx);
+
+#endif // VULKAN_RESOLUTION_H
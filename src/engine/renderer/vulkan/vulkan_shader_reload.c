@@ -0,0 +1,154 @@
+#include "vulkan_shader_reload.h"
+
+#include "vulkan_pipeline.h"
+#include "vulkan_frame.h"
+
+#include "os.h"
+#include "core/darray.h"
+#include "core/logger.h"
+#include "core/ymemory.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+/* NOTE: Bounds how long vkShaderReloadShutdown waits on the watcher thread */
+#define SHADER_RELOAD_POLL_MS 100
+
+static const char*
+FileBaseName(const char* pFilePath)
+{
+	const char* pSlash = strrchr(pFilePath, '/');
+	return pSlash ? pSlash + 1 : pFilePath;
+}
+
+/*
+ * NOTE: Runs on the watcher thread. The pipeline cache is internally synced,
+ * the layout is shared and never changes so nothing here touches what the
+ * render thread writes.
+ */
+YND static VkResult
+vkShaderReloadCompute(VkContext* pCtx, uint32_t index)
+{
+	VulkanShaderReload*	pReload		= &pCtx->shaderReload;
+	VkDevice			device		= pCtx->device.handle;
+	const char*			pFilePath	= pCtx->pComputeShaders[index].pFilePath;
+	f64					start		= OsGetAbsoluteTime(MILLISECONDS);
+
+	VkShaderModule shaderModule;
+	VK_CHECK(vkLoadShaderModuleFile(pCtx, pFilePath, device, &shaderModule));
+
+	VkPipeline	pipeline	= VK_NULL_HANDLE;
+	VkResult	result		= vkComputePipelineCreate(pCtx, device, shaderModule,
+			&pCtx->pComputeShaders[index], &pipeline);
+	vkDestroyShaderModule(device, shaderModule, pCtx->pAllocator);
+	VK_CHECK(result);
+
+	OsMutexLock(&pReload->mutex);
+	VkPipeline stalePipeline = pReload->pPendingPipelines[index];
+	pReload->pPendingPipelines[index] = pipeline;
+	OsMutexUnlock(&pReload->mutex);
+
+	/* NOTE: Saved twice before a frame picked it up, it was never bound */
+	if (stalePipeline != VK_NULL_HANDLE)
+		vkDestroyPipeline(device, stalePipeline, pCtx->pAllocator);
+
+	YINFO("Reloaded %s in %.2f ms", FileBaseName(pFilePath), OsGetAbsoluteTime(MILLISECONDS) - start);
+	return VK_SUCCESS;
+}
+
+static int32_t
+vkShaderReloadThread(void* pData)
+{
+	VkContext*			pCtx	= pData;
+	VulkanShaderReload*	pReload	= &pCtx->shaderReload;
+	char				pName[FILE_WATCH_MAX_NAME];
+
+	while (atomic_load(&pReload->bRunning))
+	{
+		if (!OsFileWatchNext(&pReload->watch, SHADER_RELOAD_POLL_MS, pName, sizeof(pName)))
+			continue;
+		for (uint32_t i = 0; i < pReload->pipelineCount; i++)
+		{
+			if (strcmp(FileBaseName(pCtx->pComputeShaders[i].pFilePath), pName) != 0)
+				continue;
+			/* NOTE: On failure the current pipeline stays, fix the shader and save again */
+			if (vkShaderReloadCompute(pCtx, i) != VK_SUCCESS)
+				YWARN("%s: reload failed, keeping the previous pipeline", pName);
+		}
+	}
+	return 0;
+}
+
+YND VkResult
+vkShaderReloadInit(VkContext* pCtx, const char* pDirectory)
+{
+	VulkanShaderReload* pReload = &pCtx->shaderReload;
+	*pReload = (VulkanShaderReload){0};
+
+	if (!OsFileWatchCreate(pDirectory, &pReload->watch))
+	{
+		YWARN("Shader hot reload disabled, cannot watch %s", pDirectory);
+		return VK_SUCCESS;
+	}
+	if (!OsMutexCreate(&pReload->mutex))
+	{
+		OsFileWatchDestroy(&pReload->watch);
+		return VK_ERROR_INITIALIZATION_FAILED;
+	}
+	pReload->pipelineCount		= (uint32_t)DarrayCapacity(pCtx->pComputeShaders);
+	pReload->pPendingPipelines	= yAlloc(sizeof(VkPipeline) * pReload->pipelineCount, MEMORY_TAG_RENDERER);
+
+	atomic_store(&pReload->bRunning, TRUE);
+	if (!OsThreadCreate(vkShaderReloadThread, pCtx, &pReload->thread))
+	{
+		atomic_store(&pReload->bRunning, FALSE);
+		vkShaderReloadShutdown(pCtx);
+		return VK_ERROR_INITIALIZATION_FAILED;
+	}
+	YINFO("Shader hot reload watching %s", pDirectory);
+	return VK_SUCCESS;
+}
+
+void
+vkShaderReloadApply(VkContext* pCtx)
+{
+	VulkanShaderReload* pReload = &pCtx->shaderReload;
+	if (!pReload->pPendingPipelines)
+		return ;
+
+	/*
+	 * NOTE: The old pipeline can still be recorded in the other frames in
+	 * flight, the current frame's deletion queue runs after all of them.
+	 */
+	OsMutexLock(&pReload->mutex);
+	for (uint32_t i = 0; i < pReload->pipelineCount; i++)
+	{
+		if (pReload->pPendingPipelines[i] == VK_NULL_HANDLE)
+			continue;
+		vkFrameDeletionPush(pCtx, VK_OBJECT_TYPE_PIPELINE, (uint64_t)pCtx->pComputeShaders[i].pipeline, NULL);
+		pCtx->pComputeShaders[i].pipeline = pReload->pPendingPipelines[i];
+		pReload->pPendingPipelines[i] = VK_NULL_HANDLE;
+	}
+	OsMutexUnlock(&pReload->mutex);
+}
+
+void
+vkShaderReloadShutdown(VkContext* pCtx)
+{
+	VulkanShaderReload* pReload = &pCtx->shaderReload;
+	if (!pReload->pPendingPipelines)
+		return ;
+
+	if (atomic_load(&pReload->bRunning))
+	{
+		atomic_store(&pReload->bRunning, FALSE);
+		OsThreadJoin(&pReload->thread);
+	}
+	for (uint32_t i = 0; i < pReload->pipelineCount; i++)
+		vkDestroyPipeline(pCtx->device.handle, pReload->pPendingPipelines[i], pCtx->pAllocator);
+
+	yFree(pReload->pPendingPipelines, pReload->pipelineCount, MEMORY_TAG_RENDERER);
+	OsMutexDestroy(&pReload->mutex);
+	OsFileWatchDestroy(&pReload->watch);
+	*pReload = (VulkanShaderReload){0};
+}
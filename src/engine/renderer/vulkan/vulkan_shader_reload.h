@@ -0,0 +1,27 @@
+#ifndef VULKAN_SHADER_RELOAD_H
+#define VULKAN_SHADER_RELOAD_H
+
+#include "yvulkan.h"
+
+/**
+ * @brief	Watches `pDirectory` for rebuilt compute SPIR-V. A failure to watch
+ *			only disables the reload, it never fails the renderer init.
+ */
+YND VkResult vkShaderReloadInit(
+		VkContext*							pCtx,
+		const char*							pDirectory);
+
+/**
+ * @brief	Swaps in pipelines rebuilt since the last call and queues the
+ *			replaced ones for deletion. Call once per frame after vkFrameBegin.
+ */
+void vkShaderReloadApply(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Stops the watcher thread, expects the device to be idle.
+ */
+void vkShaderReloadShutdown(
+		VkContext*							pCtx);
+
+#endif // VULKAN_SHADER_RELOAD_H
@@ -0,0 +1,147 @@
+#include "vulkan_staging.h"
+
+#include "vulkan_memory.h"
+
+#include "core/darray.h"
+#include "core/logger.h"
+
+#include <string.h>
+
+static inline VkDeviceSize
+AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+YND VkResult
+vkStagingRingCreate(VkContext* pCtx, VkDeviceSize size)
+{
+	VulkanStagingRing* pRing = &pCtx->stagingRing;
+	VK_CHECK(vkBufferCreate(
+				pCtx->device,
+				pCtx->pAllocator,
+				size,
+				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				&pRing->buffer));
+	if (!OsMutexCreate(&pRing->mutex))
+	{
+		vkBufferDestroy(pCtx->device, pCtx->pAllocator, &pRing->buffer);
+		return VK_ERROR_INITIALIZATION_FAILED;
+	}
+
+	/* NOTE: Buffer size is the requirement size, keep the one asked for */
+	pRing->buffer.size	= size;
+	pRing->pMapped		= pRing->buffer.allocation.pMapped;
+	pRing->head			= 0;
+	pRing->tail			= 0;
+	pRing->pDstBuffers	= DarrayCreate(VkBuffer);
+	pRing->pRegions		= DarrayCreate(VkBufferCopy);
+	return VK_SUCCESS;
+}
+
+void
+vkStagingRingDestroy(VkContext* pCtx)
+{
+	VulkanStagingRing* pRing = &pCtx->stagingRing;
+	if (pRing->buffer.handle == VK_NULL_HANDLE)
+		return ;
+
+	if (DarrayLength(pRing->pRegions))
+		YWARN("%llu staged copies were never flushed", DarrayLength(pRing->pRegions));
+	vkBufferDestroy(pCtx->device, pCtx->pAllocator, &pRing->buffer);
+	DarrayDestroy(pRing->pDstBuffers);
+	DarrayDestroy(pRing->pRegions);
+	OsMutexDestroy(&pRing->mutex);
+	pRing->pMapped = NULL;
+}
+
+YND b8
+vkStagingUpload(VkContext* pCtx, VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* pData, VkDeviceSize size)
+{
+	VulkanStagingRing*	pRing		= &pCtx->stagingRing;
+	VkDeviceSize		ringSize	= pRing->buffer.size;
+	if (size == 0 || size > ringSize)
+		return FALSE;
+
+	OsMutexLock(&pRing->mutex);
+	VkDeviceSize offset = AlignUp(pRing->head, VK_STAGING_ALIGNMENT);
+	/* NOTE: A copy never wraps, skip to the start of the ring instead */
+	if (offset % ringSize + size > ringSize)
+		offset = AlignUp(offset, ringSize);
+	if (offset + size - pRing->tail > ringSize)
+	{
+		OsMutexUnlock(&pRing->mutex);
+		return FALSE;
+	}
+	pRing->head = offset + size;
+
+	VkBufferCopy region = {
+		.srcOffset	= offset % ringSize,
+		.dstOffset	= dstOffset,
+		.size		= size,
+	};
+	memcpy(pRing->pMapped + region.srcOffset, pData, size);
+	DarrayPush(pRing->pDstBuffers, dstBuffer);
+	DarrayPush(pRing->pRegions, region);
+	OsMutexUnlock(&pRing->mutex);
+	return TRUE;
+}
+
+void
+vkStagingRingReclaim(VkContext* pCtx, uint32_t frame)
+{
+	VulkanStagingRing* pRing = &pCtx->stagingRing;
+	OsMutexLock(&pRing->mutex);
+	if (pCtx->pFrames[frame].stagingEnd > pRing->tail)
+		pRing->tail = pCtx->pFrames[frame].stagingEnd;
+	OsMutexUnlock(&pRing->mutex);
+}
+
+void
+vkStagingRingFlush(VkContext* pCtx, VkCommandBuffer commandBuffer, uint32_t frame)
+{
+	VulkanStagingRing* pRing = &pCtx->stagingRing;
+	OsMutexLock(&pRing->mutex);
+	pCtx->pFrames[frame].stagingEnd = pRing->head;
+
+	uint64_t copyCount = DarrayLength(pRing->pRegions);
+	if (copyCount == 0)
+	{
+		OsMutexUnlock(&pRing->mutex);
+		return ;
+	}
+
+	/* NOTE: One vkCmdCopyBuffer per run of copies going to the same buffer */
+	uint64_t first = 0;
+	for (uint64_t i = 1; i <= copyCount; i++)
+	{
+		if (i < copyCount && pRing->pDstBuffers[i] == pRing->pDstBuffers[first])
+			continue;
+		uint32_t regionCount = i - first;
+		vkCmdCopyBuffer(
+				commandBuffer,
+				pRing->buffer.handle,
+				pRing->pDstBuffers[first],
+				regionCount,
+				&pRing->pRegions[first]);
+		first = i;
+	}
+	DarrayClear(pRing->pDstBuffers);
+	DarrayClear(pRing->pRegions);
+	OsMutexUnlock(&pRing->mutex);
+
+	VkMemoryBarrier2 memoryBarrier = {
+		.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+		.srcStageMask	= VK_PIPELINE_STAGE_2_COPY_BIT,
+		.srcAccessMask	= VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		.dstStageMask	= VK_UPLOAD_DST_STAGES,
+		.dstAccessMask	= VK_UPLOAD_DST_ACCESS,
+	};
+	VkDependencyInfo dependencyInfo = {
+		.sType				= VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+		.memoryBarrierCount	= 1,
+		.pMemoryBarriers	= &memoryBarrier,
+	};
+	vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
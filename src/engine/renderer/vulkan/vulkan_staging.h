@@ -0,0 +1,55 @@
+#ifndef VULKAN_STAGING_H
+#define VULKAN_STAGING_H
+
+#include "yvulkan.h"
+
+#define VK_STAGING_RING_SIZE		(8ull * 1024 * 1024)
+#define VK_STAGING_ALIGNMENT		16
+
+/* NOTE: Where uploaded buffers get read, used by the barriers after the copies */
+#define VK_UPLOAD_DST_STAGES		(VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT	\
+									| VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT	\
+									| VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT)
+#define VK_UPLOAD_DST_ACCESS		(VK_ACCESS_2_INDEX_READ_BIT				\
+									| VK_ACCESS_2_SHADER_STORAGE_READ_BIT	\
+									| VK_ACCESS_2_UNIFORM_READ_BIT)
+
+YND VkResult vkStagingRingCreate(
+		VkContext*							pCtx,
+		VkDeviceSize						size);
+
+/**
+ * @brief	Expects the device to be idle.
+ */
+void vkStagingRingDestroy(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Copies `size` bytes of `pData` into the ring and queues a copy to
+ *			`dstBuffer`, recorded by the next vkStagingRingFlush. Returns FALSE
+ *			when the ring is full, it never waits on the GPU.
+ */
+YND b8 vkStagingUpload(
+		VkContext*							pCtx,
+		VkBuffer							dstBuffer,
+		VkDeviceSize						dstOffset,
+		const void*							pData,
+		VkDeviceSize						size);
+
+/**
+ * @brief	Gives back what `frame` consumed, call after waiting its in flight fence.
+ */
+void vkStagingRingReclaim(
+		VkContext*							pCtx,
+		uint32_t							frame);
+
+/**
+ * @brief	Records the queued copies of this frame into `commandBuffer`,
+ *			followed by a barrier making them visible to the draws after it.
+ */
+void vkStagingRingFlush(
+		VkContext*							pCtx,
+		VkCommandBuffer						commandBuffer,
+		uint32_t							frame);
+
+#endif // VULKAN_STAGING_H
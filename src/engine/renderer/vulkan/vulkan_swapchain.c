@@ -1,4 +1,14 @@
+#include "os.h"
+
 #include "vulkan_swapchain.h"
+#include "vulkan_allocator.h"
+#include "vulkan_descriptor.h"
+#include "vulkan_frame.h"
+#include "vulkan_framebuffer.h"
+#include "vulkan_transient.h"
+#include "vulkan_async_compute.h"
+#include "vulkan_background_cache.h"
+#include "core/darray.h"
 #include "core/ymemory.h"
 #include "core/logger.h"
 
@@ -6,7 +16,6 @@
 
 #include "profiler.h"
 
-/* TODO: Resize !!!!!!!!!!! */
 YND VkResult 
 vkImageViewCreate(VkContext* pContext, VkFormat format, VulkanImage* pImage, VkImageAspectFlags aspectFlags)
 {
@@ -72,27 +81,9 @@ vkImageCreate(
 
     VK_CHECK(vkCreateImage(pContext->device.handle, &imageCreateInfo, pContext->pAllocator, &pOutImage->handle));
 
-    /* NOTE: Query memory requirements. */
-    VkMemoryRequirements memoryRequirements;
-    vkGetImageMemoryRequirements(pContext->device.handle, pOutImage->handle, &memoryRequirements);
-
-    int32_t memoryType;
-
-	VK_RESULT(pContext->MemoryFindIndex(
-				pContext->device.physicalDevice,
-				memoryRequirements.memoryTypeBits,
-				memoryFlags,
-				&memoryType));
-
-    VkMemoryAllocateInfo memAllocInfo = {
-		.sType				= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-		.allocationSize		= memoryRequirements.size,
-		.memoryTypeIndex	= memoryType,
-	};
-	VK_ASSERT(vkAllocateMemory(pContext->device.handle, &memAllocInfo, pContext->pAllocator, &pOutImage->memory));
-
-	// TODO: configurable memory offset.
-    VK_ASSERT(vkBindImageMemory(pContext->device.handle, pOutImage->handle, pOutImage->memory, 0));
+	/* NOTE: Sub-allocated, big images get a dedicated allocation */
+	VK_ASSERT(vkImageMemoryBind(&pContext->device, pOutImage->handle, tiling, memoryFlags, &pOutImage->allocation));
+	pOutImage->memory = pOutImage->allocation.memory;
     if (bCreateView)
 	{
         pOutImage->view = VK_NULL_HANDLE;
@@ -131,14 +122,47 @@ vkDeviceDetectDepthFormat(VulkanDevice *pDevice)
 	return FALSE;
 }
 
-YND VkResult 
-vkSwapchainCreate(VkContext* pContext, uint32_t width, uint32_t height, VkSwapchain* pSwapchain)
+static b8
+PresentModeSupported(VkSwapchainSupportInfo* pSupport, VkPresentModeKHR mode)
+{
+    for (uint32_t i = 0; i < pSupport->presentModeCount; ++i)
+	{
+        if (pSupport->pPresentModes[i] == mode)
+            return TRUE;
+    }
+	return FALSE;
+}
+
+/* NOTE: The closest supported mode, FIFO is the only one always there */
+static VkPresentModeKHR
+PresentModeChoose(VkSwapchainSupportInfo* pSupport, VkPresentModeKHR desiredMode)
+{
+	VkPresentModeKHR pFallbacks[3] = { desiredMode, VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR };
+	if (desiredMode == VK_PRESENT_MODE_MAILBOX_KHR)
+		pFallbacks[1] = VK_PRESENT_MODE_IMMEDIATE_KHR;
+	else if (desiredMode == VK_PRESENT_MODE_IMMEDIATE_KHR)
+		pFallbacks[1] = VK_PRESENT_MODE_MAILBOX_KHR;
+
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		if (PresentModeSupported(pSupport, pFallbacks[i]))
+			return pFallbacks[i];
+	}
+	return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+/* NOTE: The handle, its images and their views, `oldSwapchain` is handed over to the new one */
+YND static VkResult
+SwapchainHandleCreate(VkContext* pContext, uint32_t width, uint32_t height, VkSwapchainKHR oldSwapchain,
+		VkSwapchain* pSwapchain)
 {
     VkExtent2D swapchainExtent = {
 		.width	= width, 
 		.height	= height,
 	};
-    pSwapchain->maxFrameInFlight = 2;
+    /* NOTE: Set by vkInit from the renderer config, recreate keeps it */
+    if (pSwapchain->maxFrameInFlight == 0)
+        pSwapchain->maxFrameInFlight = VK_FRAMES_IN_FLIGHT_DEFAULT;
 
     /* NOTE: Choose a swap surface format. */
     b8 bFound = FALSE;
@@ -158,19 +182,11 @@ vkSwapchainCreate(VkContext* pContext, uint32_t width, uint32_t height, VkSwapch
     if (!bFound)
 		pSwapchain->imageFormat = pContext->device.swapchainSupport.pFormats[0];
 
-    /* VkPresentModeKHR present_mode = VK_PRESENT_MODE_FIFO_KHR; */
-	/* VkPresentModeKHR desiredMode = VK_PRESENT_MODE_MAILBOX_KHR; */
-	VkPresentModeKHR desiredMode = VK_PRESENT_MODE_FIFO_KHR;
-	VkPresentModeKHR presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
-    for (uint32_t i = 0; i < pContext->device.swapchainSupport.presentModeCount; ++i)
-	{
-        VkPresentModeKHR mode = pContext->device.swapchainSupport.pPresentModes[i];
-        if (mode == desiredMode)
-		{
-            presentMode = mode;
-            break;
-        }
-    }
+	VkPresentModeKHR presentMode = PresentModeChoose(&pContext->device.swapchainSupport,
+			pSwapchain->desiredPresentMode);
+	if (presentMode != pSwapchain->presentMode)
+		YINFO("Present mode: %s", string_VkPresentModeKHR(presentMode));
+	pSwapchain->presentMode = presentMode;
     /* NOTE: Requery swapchain support. */
     VK_CHECK(vkDeviceQuerySwapchainSupport(
 				pContext->device.physicalDevice,
@@ -190,6 +206,10 @@ vkSwapchainCreate(VkContext* pContext, uint32_t width, uint32_t height, VkSwapch
     swapchainExtent.width = YCLAMP(swapchainExtent.width, min.width, max.width);
     swapchainExtent.height = YCLAMP(swapchainExtent.height, min.height, max.height);
 
+	/* NOTE: Minimized, there is nothing to present to until the window comes back */
+	if (swapchainExtent.width == 0 || swapchainExtent.height == 0)
+		return VK_NOT_READY;
+
     uint32_t imageCount = pContext->device.swapchainSupport.capabilities.minImageCount + 1;
 
     if (pContext->device.swapchainSupport.capabilities.maxImageCount > 0 
@@ -233,7 +253,7 @@ vkSwapchainCreate(VkContext* pContext, uint32_t width, uint32_t height, VkSwapch
     swapchainCreateInfo.compositeAlpha	= VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     swapchainCreateInfo.presentMode		= presentMode;
     swapchainCreateInfo.clipped			= VK_TRUE;
-    swapchainCreateInfo.oldSwapchain	= 0;
+    swapchainCreateInfo.oldSwapchain	= oldSwapchain;
 
     VK_CHECK(vkCreateSwapchainKHR(
 				pContext->device.handle,
@@ -241,8 +261,9 @@ vkSwapchainCreate(VkContext* pContext, uint32_t width, uint32_t height, VkSwapch
 				pContext->pAllocator,
 				&pSwapchain->handle));
 
-    /* NOTE: Start with a zero frame index. */
-    pContext->currentFrame = 0;
+	/* NOTE: Present ids only have to grow within one swapchain */
+	pSwapchain->presentId		= 0;
+	pSwapchain->presentIdWaited	= 0;
 
     /* NOTE: Images */
     pSwapchain->imageCount = 0;
@@ -279,6 +300,18 @@ vkSwapchainCreate(VkContext* pContext, uint32_t width, uint32_t height, VkSwapch
 					&pSwapchain->pViews[i]));
     }
 
+	pSwapchain->extent = (VkExtent3D){
+		.width	= swapchainExtent.width,
+		.height	= swapchainExtent.height,
+		.depth	= 1,
+	};
+	return VK_SUCCESS;
+}
+
+/* NOTE: Sized like the swapchain, only the framebuffers of mainRenderpass use it */
+YND static VkResult
+DepthAttachmentCreate(VkContext* pContext, VkSwapchain* pSwapchain)
+{
     /* NOTE: Depth resources */
     if (!vkDeviceDetectDepthFormat(&pContext->device))
 	{
@@ -287,20 +320,15 @@ vkSwapchainCreate(VkContext* pContext, uint32_t width, uint32_t height, VkSwapch
 		return VK_ERROR_UNKNOWN;
     }
     /* NOTE: Create depth image and its view. */
-	VkExtent3D extent = {
-		.width	= swapchainExtent.width,
-		.height	= swapchainExtent.height,
-		.depth	= 1,
-	};
-	pSwapchain->extent = extent;
+	VkExtent3D extent = pSwapchain->extent;
 	VkImageUsageFlags swapchainImageUsageFlag = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
 	b8 bCreateView = TRUE;
 	uint32_t mipLevels = 4;
     VK_CHECK(vkImageCreate(
 		/*(VkContext*)*/				pContext, 
 		/*(VkImageType)*/				VK_IMAGE_TYPE_2D, 
-		/*(uint32_t)*/					swapchainExtent.width, 
-		/*(uint32_t)*/					swapchainExtent.height,
+		/*(uint32_t)*/					extent.width, 
+		/*(uint32_t)*/					extent.height,
         /*(VkFormat)*/					pContext->device.depthFormat,
         /*(VkImageTiling)*/				VK_IMAGE_TILING_OPTIMAL,
 		/*(VkImageUsageFlags)*/			swapchainImageUsageFlag,
@@ -311,24 +339,138 @@ vkSwapchainCreate(VkContext* pContext, uint32_t width, uint32_t height, VkSwapch
 		/*(VkExtent3D)*/				extent,
 		/*(uint32_t)*/					mipLevels));
 
-	/* NOTE: Create the drawable image */
-	DrawImage drawImage = {
-		.format	= VK_FORMAT_R16G16B16A16_SFLOAT,
+	return VK_SUCCESS;
+}
+
+/* NOTE: Views first, memory last, once the frames that drew with them are done */
+static void
+VulkanImageRetire(VkContext* pCtx, VulkanImage* pImage)
+{
+	vkFrameRetirePush(pCtx, VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)pImage->view, NULL);
+	vkFrameRetirePush(pCtx, VK_OBJECT_TYPE_IMAGE, (uint64_t)pImage->handle,
+			pImage->memory ? &pImage->allocation : NULL);
+	*pImage = (VulkanImage){0};
+}
 
-		.extent	= {
-			.width	= width,
-			.height	= height,
-			.depth	= 1,
+/* NOTE: The frames still drawing with them keep them until their fence */
+static void
+TransientsRetire(VkContext* pCtx)
+{
+	VulkanTransientMemory* pMemory = &pCtx->transientMemory;
+	if (pCtx->depthImage.image.handle != VK_NULL_HANDLE)
+		VulkanImageRetire(pCtx, &pCtx->depthImage.image);
+	for (uint32_t s = 0; s < pMemory->slotCount; s++)
+		vkFrameRetirePush(pCtx, VK_OBJECT_TYPE_UNKNOWN, 0, &pMemory->pSlots[s]);
+	pMemory->slotCount = 0;
+}
+
+/*
+ * NOTE: Only the geometry pass reads and writes the depth image, the next
+ * frame clears it again. Transient, lazily allocated where the device allows it.
+ */
+YND static VkResult
+TransientsCreate(VkContext* pCtx)
+{
+	VulkanTransientMemory*	pMemory		= &pCtx->transientMemory;
+	DrawImage*				pDepthImage	= &pCtx->depthImage;
+	VulkanTransientImage pTransients[VK_TRANSIENT_COUNT] = {
+		[VK_TRANSIENT_DEPTH] = {
+			.format		= pDepthImage->format,
+			.extent		= pDepthImage->extent,
+			.usage		= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
+			.aspectMask	= VK_IMAGE_ASPECT_DEPTH_BIT,
+			.firstPass	= pMemory->pFirstPasses[VK_TRANSIENT_DEPTH],
+			.lastPass	= pMemory->pLastPasses[VK_TRANSIENT_DEPTH],
+			.stages		= VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+			.pImage		= &pDepthImage->image,
 		},
+	};
+	VK_CHECK(vkTransientImagesCreate(pCtx, pTransients, VK_TRANSIENT_COUNT, pMemory));
+	return VK_SUCCESS;
+}
+
+YND VkResult
+vkRenderTargetsTransientsBind(VkContext* pCtx, VulkanRenderGraph* pGraph, uint32_t depthTarget)
+{
+	VulkanTransientMemory*	pMemory		= &pCtx->transientMemory;
+	uint32_t				pTargets[VK_TRANSIENT_COUNT]	= {[VK_TRANSIENT_DEPTH] = depthTarget};
+	VulkanImage*			pImages[VK_TRANSIENT_COUNT]		= {[VK_TRANSIENT_DEPTH] = &pCtx->depthImage.image};
+
+	/*
+	 * NOTE: Ranges only widen, the frames that add or skip optional passes
+	 * stop replanning once every variant was seen.
+	 */
+	b8 bReplan = pCtx->depthImage.image.handle == VK_NULL_HANDLE;
+	for (uint32_t i = 0; i < VK_TRANSIENT_COUNT; i++)
+	{
+		uint32_t firstPass;
+		uint32_t lastPass;
+		if (!vkRenderGraphResourcePasses(pGraph, pTargets[i], &firstPass, &lastPass))
+			continue;
+		if (firstPass < pMemory->pFirstPasses[i])
+		{
+			pMemory->pFirstPasses[i] = firstPass;
+			bReplan = TRUE;
+		}
+		if (lastPass > pMemory->pLastPasses[i])
+		{
+			pMemory->pLastPasses[i] = lastPass;
+			bReplan = TRUE;
+		}
+	}
+
+	if (bReplan)
+	{
+		TransientsRetire(pCtx);
+		VK_CHECK(TransientsCreate(pCtx));
+		YDEBUG("Transients planned, depth in passes %u to %u",
+				pMemory->pFirstPasses[VK_TRANSIENT_DEPTH], pMemory->pLastPasses[VK_TRANSIENT_DEPTH]);
+	}
+
+	for (uint32_t i = 0; i < VK_TRANSIENT_COUNT; i++)
+		vkRenderGraphImageBind(pGraph, pTargets[i], pImages[i]->handle, pMemory->pAliasStages[i]);
+	return VK_SUCCESS;
+}
+
+YND VkResult
+vkRenderTargetsEnsure(VkContext* pContext, uint32_t width, uint32_t height)
+{
+	VkExtent3D capacity = pContext->drawImage.extent;
+	if (width <= capacity.width && height <= capacity.height)
+		return VK_SUCCESS;
+
+	/* NOTE: Never shrinks, the render extent covers the part the swapchain needs */
+	capacity.width	= width > capacity.width ? width : capacity.width;
+	capacity.height	= height > capacity.height ? height : capacity.height;
+	capacity.depth	= 1;
+
+	if (pContext->drawImage.image.handle != VK_NULL_HANDLE)
+	{
+		VulkanImageRetire(pContext, &pContext->drawImage.image);
+		TransientsRetire(pContext);
+	}
+	else
+	{
+		/* NOTE: Empty ranges, the first graph sets them */
+		for (uint32_t i = 0; i < VK_TRANSIENT_COUNT; i++)
+		{
+			pContext->transientMemory.pFirstPasses[i]	= VK_RENDER_GRAPH_INVALID;
+			pContext->transientMemory.pLastPasses[i]	= 0;
+		}
+	}
 
+	/* NOTE: Create the drawable image */
+	DrawImage drawImage = {
+		.format	= VK_FORMAT_R16G16B16A16_SFLOAT,
+		.extent	= capacity,
 	};
 	VkImageUsageFlags drawImageUsageFlag =
 		VK_IMAGE_USAGE_TRANSFER_SRC_BIT | 
 		VK_IMAGE_USAGE_TRANSFER_DST_BIT |
 		VK_IMAGE_USAGE_STORAGE_BIT		|
 		VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-	bCreateView = TRUE;
-	mipLevels = 1;
+	b8			bCreateView	= TRUE;
+	uint32_t	mipLevels	= 1;
 
 	VK_CHECK(vkImageCreate(
 				pContext,
@@ -353,42 +495,29 @@ vkSwapchainCreate(VkContext* pContext, uint32_t width, uint32_t height, VkSwapch
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
 
-	DrawImage depthImage = {
+	/* NOTE: The format is enough for the pipelines, the images wait for the passes using them */
+	pContext->depthImage = (DrawImage){
 		.format	= VK_FORMAT_D32_SFLOAT,
-    
-		.extent	= {
-			.width	= width,
-			.height	= height,
-			.depth	= 1,
-		},
-    
+		.extent	= capacity,
 	};
-	VkImageUsageFlags depthImageUsageFlag = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-	bCreateView = TRUE;
-	mipLevels = 1;
-    
-	VK_CHECK(vkImageCreate(
-				pContext,
-				VK_IMAGE_TYPE_2D,
-				depthImage.extent.width,
-				depthImage.extent.height,
-				depthImage.format,
-				VK_IMAGE_TILING_OPTIMAL,
-				depthImageUsageFlag,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				bCreateView,
-				VK_IMAGE_ASPECT_DEPTH_BIT,
-				&depthImage.image,
-				depthImage.extent,
-				mipLevels));
-    
-	pContext->depthImage = depthImage;
 
-    /*
-	 * pContext->depthImage.format = pContext->device.depthFormat;
-	 * pContext->depthImage.image = pContext->swapchain.depthAttachment;
-	 * pContext->depthImage.handle = pContext->swapchain.depthAttachment.handle;
-     */
+	/* NOTE: Not there yet on the first call, vkDescriptorsInit writes it */
+	if (pContext->drawImageDescriptorSetLayout != VK_NULL_HANDLE)
+		VK_CHECK(vkDrawImageDescriptorSetUpdate(pContext));
+	/* NOTE: Same, vkAsyncComputeInit creates them the first time */
+	VK_CHECK(vkAsyncComputeTargetsEnsure(pContext));
+	VK_CHECK(vkBackgroundCacheEnsure(pContext));
+
+	YDEBUG("Render targets: %ux%u", capacity.width, capacity.height);
+	return VK_SUCCESS;
+}
+
+YND VkResult
+vkSwapchainCreate(VkContext* pContext, uint32_t width, uint32_t height, VkSwapchain* pSwapchain)
+{
+	VK_CHECK(SwapchainHandleCreate(pContext, width, height, VK_NULL_HANDLE, pSwapchain));
+	VK_CHECK(DepthAttachmentCreate(pContext, pSwapchain));
+	VK_CHECK(vkRenderTargetsEnsure(pContext, width, height));
 
     YINFO("Swapchain created successfully.");
 	return VK_SUCCESS;
@@ -397,10 +526,45 @@ vkSwapchainCreate(VkContext* pContext, uint32_t width, uint32_t height, VkSwapch
 YND VkResult
 vkSwapchainRecreate(VkContext *pCtx, uint32_t width, uint32_t height, VkSwapchain *pSwapchain)
 {
-	YMB VkDevice device = pCtx->device.handle;
+	VkSwapchain old = *pSwapchain;
+	VkResult result = SwapchainHandleCreate(pCtx, width, height, old.handle, pSwapchain);
+	if (result == VK_NOT_READY)
+		return VK_SUCCESS;
+	VK_RESULT(result);
+
+	/*
+	 * NOTE: No wait on the device, the old swapchain and what was built on it
+	 * go once the frames in flight that may still use them are done.
+	 */
+	for (uint32_t i = 0; i < old.imageCount; i++)
+	{
+		vkFrameRetirePush(pCtx, VK_OBJECT_TYPE_FRAMEBUFFER, (uint64_t)old.pFramebuffers[i].handle, NULL);
+		yFree(old.pFramebuffers[i].pAttachments, old.pFramebuffers[i].attachmentCount, MEMORY_TAG_RENDERER);
+		old.pFramebuffers[i] = (VulkanFramebuffer){0};
+		vkFrameRetirePush(pCtx, VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)old.pViews[i], NULL);
+	}
+	vkFrameRetirePush(pCtx, VK_OBJECT_TYPE_SWAPCHAIN_KHR, (uint64_t)old.handle, NULL);
+	VulkanImageRetire(pCtx, &pSwapchain->depthAttachment);
+	yFree(old.pImages, old.imageCount, MEMORY_TAG_RENDERER);
+	yFree(old.pViews, old.imageCount, MEMORY_TAG_RENDERER);
+
+	if (pSwapchain->imageCount != old.imageCount)
+	{
+		DarrayDestroy(pSwapchain->pFramebuffers);
+		pSwapchain->pFramebuffers = DarrayReserve(VulkanFramebuffer, pSwapchain->imageCount);
+		DarrayDestroy(pCtx->ppImagesInFlight);
+		pCtx->ppImagesInFlight = DarrayReserve(VulkanFence, pSwapchain->imageCount);
+		for (uint32_t i = 0; i < pSwapchain->imageCount; ++i)
+			pCtx->ppImagesInFlight[i] = 0;
+	}
+	VK_CHECK(DepthAttachmentCreate(pCtx, pSwapchain));
+	vkFramebuffersRegenerate(pCtx, pSwapchain, &pCtx->mainRenderpass);
 
-	VK_RESULT(vkSwapchainDestroy(pCtx, pSwapchain));
-	VK_RESULT(vkSwapchainCreate(pCtx, width, height, pSwapchain));
+	/* NOTE: Only reallocated past their current size, shrinking keeps them */
+	VK_CHECK(vkRenderTargetsEnsure(pCtx, pSwapchain->extent.width, pSwapchain->extent.height));
+
+	pCtx->framebufferSizeLastGeneration = pCtx->framebufferSizeGeneration;
+	YDEBUG("Swapchain recreated: %ux%u", pSwapchain->extent.width, pSwapchain->extent.height);
 	return VK_SUCCESS;
 }
 
@@ -429,11 +593,16 @@ vkSwapchainAcquireNextImageIndex(
 	 */
 	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
 	{
-		/* NOTE: Trigger pSwapchain recreation, then boot out of the render loop. */
-		VK_RESULT(vkSwapchainRecreate(pCtx, pCtx->framebufferWidth, pCtx->framebufferHeight, pSwapchain));
+		/*
+		 * NOTE: Recreated by the next vkDrawImpl. Suboptimal still acquired an
+		 * image, this frame goes on with it. Out of date did not, the caller
+		 * skips the frame.
+		 */
+		pCtx->framebufferSizeGeneration++;
+		return result == VK_SUBOPTIMAL_KHR ? VK_SUCCESS : result;
 	}
 	/* WARN: Is this fatal ?! */
-	else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+	else if (result != VK_SUCCESS)
 	{
 		YFATAL("Failed to acquire pSwapchain image!");
 		return result;
@@ -445,9 +614,17 @@ YND VkResult
 vkSwapchainPresent(VkContext* pCtx, VkSwapchain* pSwapchain, YMB VkQueue gfxQueue, VkQueue presentQueue,
 		VkSemaphore semaphoreRenderComplete, uint32_t presentImageIndex)
 {
+	/* NOTE: Tags the present for vkFrameLatencyWait */
+	uint64_t presentId = pSwapchain->presentId + 1;
+	VkPresentIdKHR presentIdInfo = {
+		.sType				= VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+		.swapchainCount		= 1,
+		.pPresentIds		= &presentId,
+	};
 	// Return the image to the swapchain for presentation.
 	VkPresentInfoKHR presentInfo = {
 		.sType				= VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+		.pNext				= pCtx->device.bPresentWait ? &presentIdInfo : VK_NULL_HANDLE,
 		.waitSemaphoreCount	= 1,
 		.pWaitSemaphores	= &semaphoreRenderComplete,
 		.swapchainCount		= 1,
@@ -456,16 +633,21 @@ vkSwapchainPresent(VkContext* pCtx, VkSwapchain* pSwapchain, YMB VkQueue gfxQueu
 		.pResults			= VK_NULL_HANDLE,
 	};
 
-	/* TracyCFrameMark; */
 	VkResult result = vkQueuePresentKHR(presentQueue, &presentInfo);
+	TracyCFrameMark;
+	if (pCtx->device.bPresentWait && (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR))
+	{
+		pSwapchain->presentId = presentId;
+		pCtx->latency.pPresentTimesMs[presentId % VK_PRESENT_TIMES_MAX] = OsGetAbsoluteTime(MILLISECONDS);
+	}
 	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
 	{
 		YDEBUG("%s", string_VkResult(result));
 		/* 
 		 * NOTE: Swapchain is out of date, suboptimal or a framebuffer resize has occurred.
-		 * Trigger swapchain recreation.
+		 * The next vkDrawImpl recreates it, the image was still handed over.
 		 */
-		VK_ASSERT(vkSwapchainRecreate(pCtx, pCtx->framebufferWidth, pCtx->framebufferHeight, pSwapchain));
+		pCtx->framebufferSizeGeneration++;
 	}
 	else if (result != VK_SUCCESS)
 	{
@@ -486,16 +668,16 @@ vkDestroyVulkanImage(VkContext *pContext, VulkanImage *pImage)
 		vkDestroyImageView(pContext->device.handle, pImage->view, pContext->pAllocator);
 		pImage->view = 0;
 	}
-	if (pImage->memory)
-	{
-		vkFreeMemory(pContext->device.handle, pImage->memory, pContext->pAllocator);
-		pImage->memory = 0;
-	}
 	if (pImage->handle)
 	{
 		vkDestroyImage(pContext->device.handle, pImage->handle, pContext->pAllocator);
 		pImage->handle = 0;
 	}
+	if (pImage->memory)
+	{
+		vkMemoryFree(pContext->device.pMemoryAllocator, &pImage->allocation);
+		pImage->memory = 0;
+	}
 }
 
 YND VkResult
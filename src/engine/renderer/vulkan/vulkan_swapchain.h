@@ -2,6 +2,7 @@
 #define VULKAN_SWAPCHAIN_H
 
 #include "yvulkan.h"
+#include "vulkan_render_graph.h"
 
 YND VkResult vkSwapchainDestroy(
 		VkContext*							pCtx, 
@@ -13,11 +14,47 @@ YND VkResult vkSwapchainCreate(
 		uint32_t							height,
 		VkSwapchain*						pSwapchain);
 
+/**
+ * @brief	Hands the old swapchain over to the new one without waiting on the
+ *			device, what was built on it is retired with vkFrameRetirePush.
+ *			Does nothing while the window is minimized.
+ */
+YND VkResult vkSwapchainRecreate(
+		VkContext*							pCtx,
+		uint32_t							width,
+		uint32_t							height,
+		VkSwapchain*						pSwapchain);
+
+/**
+ * @brief	Reallocates the draw image when `width` or `height` is past its
+ *			current extent, it keeps the bigger of both sizes. The old one is
+ *			retired, the draw image descriptor set rewritten. The transient
+ *			ones are left to vkRenderTargetsTransientsBind.
+ */
+YND VkResult vkRenderTargetsEnsure(
+		VkContext*							pContext,
+		uint32_t							width,
+		uint32_t							height);
+
+/**
+ * @brief	Binds the transient images to their imports in `pGraph`, call it
+ *			once every pass was added. They are planned against the passes
+ *			using them and created again when a pass falls outside.
+ */
+YND VkResult vkRenderTargetsTransientsBind(
+		VkContext*							pCtx,
+		VulkanRenderGraph*					pGraph,
+		uint32_t							depthTarget);
+
 YND VkResult vkDeviceQuerySwapchainSupport(
 		VkPhysicalDevice					physDevice,
 		VkSurfaceKHR						surface,
 		VkSwapchainSupportInfo*				pOutSupportInfo);
 
+/**
+ * @brief	VK_ERROR_OUT_OF_DATE_KHR when no image was acquired, the frame has
+ *			to be skipped. Either that or suboptimal schedule a recreation.
+ */
 YND VkResult vkSwapchainAcquireNextImageIndex(
 		VkContext*							pCtx,
 		VkSwapchain* 						pSwapchain,
@@ -34,6 +71,12 @@ YND VkResult vkSwapchainPresent(
 		VkSemaphore							semaphoreRenderComplete,
 		uint32_t							presentImageIndex);
 
+YND VkResult vkImageViewCreate(
+		VkContext*							pContext,
+		VkFormat							format,
+		VulkanImage*						pImage,
+		VkImageAspectFlags					aspectFlags);
+
 YND VkResult vkImageCreate(
 		VkContext*							pContext,
 		VkImageType							imageType,
@@ -49,4 +92,8 @@ YND VkResult vkImageCreate(
 		YMB VkExtent3D						extent,
 		uint32_t mipLevels					);
 
+void vkDestroyVulkanImage(
+		VkContext*							pContext,
+		VulkanImage*						pImage);
+
 #endif // VULKAN_SWAPCHAIN_H
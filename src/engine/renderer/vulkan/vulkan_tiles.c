@@ -0,0 +1,273 @@
+#include "vulkan_tiles.h"
+
+#include "vulkan_memory.h"
+#include "vulkan_pipeline.h"
+
+#include "core/darray.h"
+#include "core/logger.h"
+#include "core/ymemory.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+YND static VkResult
+vkTileBufferCreate(
+		VkContext*			pCtx,
+		VkDeviceSize		size,
+		VkBufferUsageFlags	usage,
+		uint32_t			memoryProperties,
+		VulkanBuffer*		pOutBuffer,
+		VkDeviceAddress*	pOutAddress)
+{
+	VK_CHECK(vkBufferCreate(
+				pCtx->device,
+				pCtx->pAllocator,
+				size,
+				usage | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+				memoryProperties,
+				pOutBuffer));
+
+	VkBufferDeviceAddressInfo deviceAddressInfo = {
+		.sType	= VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+		.buffer	= pOutBuffer->handle,
+	};
+	*pOutAddress = vkGetBufferDeviceAddress(pCtx->device.handle, &deviceAddressInfo);
+	return VK_SUCCESS;
+}
+
+YND VkResult
+vkTilesCreate(VkContext* pCtx)
+{
+	VulkanTileRenderer* pTiles	= yAlloc(sizeof(VulkanTileRenderer), MEMORY_TAG_RENDERER);
+	pTiles->pTiles				= DarrayReserve(TileInstance, VK_TILE_MAX_INSTANCES);
+	pTiles->timeWindow[0]		= -INFINITY;
+	pTiles->timeWindow[1]		= INFINITY;
+	pCtx->pTileRenderer			= pTiles;
+
+	VkDeviceSize instancesSize = sizeof(TileInstance) * VK_TILE_MAX_INSTANCES;
+	for (uint32_t i = 0; i < pCtx->swapchain.maxFrameInFlight; i++)
+	{
+		/* NOTE: Rewritten every frame, the cull pass reads it straight from host memory */
+		VK_CHECK(vkTileBufferCreate(pCtx, instancesSize, 0,
+					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+					&pTiles->pInstanceBuffers[i], &pTiles->pInstanceAddresses[i]));
+		VK_CHECK(vkTileBufferCreate(pCtx, instancesSize, 0,
+					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+					&pTiles->pVisibleBuffers[i], &pTiles->pVisibleAddresses[i]));
+		/* NOTE: Reset with vkCmdUpdateBuffer before each cull */
+		VK_CHECK(vkTileBufferCreate(pCtx, sizeof(TileDrawBuffer),
+					VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+					&pTiles->pDrawBuffers[i], &pTiles->pDrawAddresses[i]));
+	}
+
+	pTiles->pipeline.pVertexShaderFilePath		= "./build/obj/engine/shaders/tile_instanced.vert.spv";
+	pTiles->pipeline.pFragmentShaderFilePath	= "./build/obj/engine/shaders/tile.frag.spv";
+	pTiles->pipeline.setLayout					= pCtx->pBindless->layout;
+
+	/* NOTE: Buffers go through the push constants only, no descriptor set */
+	VkPushConstantRange cullRange = {
+		.offset		= 0,
+		.size		= sizeof(TileCullPushConstants),
+		.stageFlags	= VK_SHADER_STAGE_COMPUTE_BIT,
+	};
+	VkPipelineLayoutCreateInfo cullLayoutInfo = {
+		.sType					= VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.pPushConstantRanges	= &cullRange,
+		.pushConstantRangeCount	= 1,
+	};
+	VK_CHECK(vkCreatePipelineLayout(pCtx->device.handle, &cullLayoutInfo, pCtx->pAllocator,
+				&pTiles->cull.pipelineLayout));
+	pTiles->cull.pFilePath = "./build/obj/engine/shaders/tile_cull.comp.spv";
+	vkComputeGroupSizeSelect(&pCtx->device, 1, pTiles->cull.pGroupSize);
+	return VK_SUCCESS;
+}
+
+void
+vkTilesDestroy(VkContext* pCtx)
+{
+	VulkanTileRenderer* pTiles = pCtx->pTileRenderer;
+	if (!pTiles)
+		return ;
+
+	VkDevice device = pCtx->device.handle;
+	vkDestroyPipeline(device, pTiles->pipeline.pipeline, pCtx->pAllocator);
+	vkDestroyPipelineLayout(device, pTiles->pipeline.pipelineLayout, pCtx->pAllocator);
+	vkDestroyPipeline(device, pTiles->cull.pipeline, pCtx->pAllocator);
+	vkDestroyPipelineLayout(device, pTiles->cull.pipelineLayout, pCtx->pAllocator);
+	for (uint32_t i = 0; i < VK_FRAMES_IN_FLIGHT_MAX; i++)
+	{
+		if (pTiles->pInstanceBuffers[i].handle != VK_NULL_HANDLE)
+			vkBufferDestroy(pCtx->device, pCtx->pAllocator, &pTiles->pInstanceBuffers[i]);
+		if (pTiles->pVisibleBuffers[i].handle != VK_NULL_HANDLE)
+			vkBufferDestroy(pCtx->device, pCtx->pAllocator, &pTiles->pVisibleBuffers[i]);
+		if (pTiles->pDrawBuffers[i].handle != VK_NULL_HANDLE)
+			vkBufferDestroy(pCtx->device, pCtx->pAllocator, &pTiles->pDrawBuffers[i]);
+	}
+	DarrayDestroy(pTiles->pTiles);
+	yFree(pTiles, 1, MEMORY_TAG_RENDERER);
+	pCtx->pTileRenderer = NULL;
+}
+
+void
+vkTilePush(VkContext* pCtx, const TileInstance* pTile)
+{
+	VulkanTileRenderer* pTiles = pCtx->pTileRenderer;
+	if (DarrayLength(pTiles->pTiles) >= VK_TILE_MAX_INSTANCES)
+		return ;
+
+	TileInstance tile = *pTile;
+	DarrayPush(pTiles->pTiles, tile);
+}
+
+void
+vkTilesTimeWindowSet(VkContext* pCtx, f32 start, f32 end)
+{
+	pCtx->pTileRenderer->timeWindow[0] = start;
+	pCtx->pTileRenderer->timeWindow[1] = end;
+}
+
+void
+vkTilesDemoPush(VkContext* pCtx, VkExtent2D drawExtent)
+{
+	f32			now				= pCtx->nbFrames / 60.0f;
+	f32			laneWidth		= drawExtent.width / (f32)(VK_TILE_DEMO_LANES + 2);
+	f32			noteHeight		= laneWidth * 0.25f;
+	f32			pixelsPerSecond	= drawExtent.height * 0.5f;
+	f32			hitLine			= drawExtent.height * 0.85f;
+	f32			interval		= 0.25f;
+	/* NOTE: 16 seconds of chart per lane, most of it is left to the cull pass */
+	uint32_t	noteCount		= 64;
+	f32			chartStart		= floorf(now / interval) * interval - 1.0f;
+
+	/* NOTE: From the bottom of the screen to a note entering at the top */
+	vkTilesTimeWindowSet(pCtx,
+			now - (drawExtent.height - hitLine) / pixelsPerSecond,
+			now + (hitLine + noteHeight) / pixelsPerSecond);
+
+	for (uint32_t lane = 0; lane < VK_TILE_DEMO_LANES; lane++)
+	{
+		/* NOTE: Lanes scroll at the same speed but out of phase */
+		f32 laneOffset = interval * lane / VK_TILE_DEMO_LANES;
+		for (uint32_t i = 0; i < noteCount; i++)
+		{
+			f32 time	= chartStart + i * interval + laneOffset;
+			f32 y		= hitLine - (time - now) * pixelsPerSecond - noteHeight;
+			TileInstance note = {
+				.position		= { laneWidth * (lane + 1) + 2.0f, y },
+				.size			= { laneWidth - 4.0f, noteHeight },
+				.color			= { 0.2f + 0.2f * lane, 0.6f, 1.0f - 0.2f * lane, 1.0f },
+				.uvRect			= { 0.0f, 0.0f, 1.0f, 1.0f },
+				.lane			= lane,
+				.hitState		= fabsf(time - now) < 0.05f,
+				.time			= time,
+				.duration		= 0.0f,
+				.textureIndex	= VK_BINDLESS_TEXTURE_NONE,
+				.samplerIndex	= VK_BINDLESS_SAMPLER_DEFAULT,
+			};
+			vkTilePush(pCtx, &note);
+		}
+	}
+}
+
+void
+vkTilesCull(VkContext* pCtx, VkCommandBuffer commandBuffer, VkExtent2D drawExtent)
+{
+	VulkanTileRenderer*	pTiles			= pCtx->pTileRenderer;
+	uint32_t			frame			= pCtx->currentFrame;
+	uint32_t			instanceCount	= (uint32_t)DarrayLength(pTiles->pTiles);
+
+	/* NOTE: vkFrameBegin waited this frame's fence, nothing reads its buffers anymore */
+	memcpy(pTiles->pInstanceBuffers[frame].allocation.pMapped, pTiles->pTiles, sizeof(TileInstance) * instanceCount);
+	DarrayClear(pTiles->pTiles);
+	pTiles->submittedCount = instanceCount;
+	if (instanceCount == 0)
+		return ;
+
+	/* NOTE: No draw and no instance until the cull pass counts them */
+	TileDrawBuffer drawReset = {
+		.command.indexCount	= 6,
+	};
+	vkCmdUpdateBuffer(commandBuffer, pTiles->pDrawBuffers[frame].handle, 0, sizeof(TileDrawBuffer), &drawReset);
+
+	VkMemoryBarrier2 resetBarrier = {
+		.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+		.srcStageMask	= VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+		.srcAccessMask	= VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		.dstStageMask	= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+		.dstAccessMask	= VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+	};
+	VkDependencyInfo dependencyInfo = {
+		.sType				= VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+		.memoryBarrierCount	= 1,
+		.pMemoryBarriers	= &resetBarrier,
+	};
+	vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pTiles->cull.pipeline);
+
+	TileCullPushConstants pushConstants = {
+		.instanceBufferAddress	= pTiles->pInstanceAddresses[frame],
+		.visibleBufferAddress	= pTiles->pVisibleAddresses[frame],
+		.drawBufferAddress		= pTiles->pDrawAddresses[frame],
+		.screenRect				= { 0.0f, 0.0f, (f32)drawExtent.width, (f32)drawExtent.height },
+		.timeWindow				= { pTiles->timeWindow[0], pTiles->timeWindow[1] },
+		.instanceCount			= instanceCount,
+	};
+	uint32_t	offset	= 0;
+	uint32_t	size	= sizeof(TileCullPushConstants);
+	vkCmdPushConstants(
+			commandBuffer,
+			pTiles->cull.pipelineLayout,
+			VK_SHADER_STAGE_COMPUTE_BIT,
+			offset,
+			size,
+			&pushConstants);
+
+	/* NOTE: Same size the pipeline was specialized with */
+	uint32_t groupSize		= pTiles->cull.pGroupSize[0];
+	uint32_t groupCountX	= (instanceCount + groupSize - 1) / groupSize;
+	vkCmdDispatch(commandBuffer, groupCountX, 1, 1);
+}
+
+void
+vkTilesDraw(VkContext* pCtx, VkCommandBuffer commandBuffer, VkExtent2D drawExtent)
+{
+	VulkanTileRenderer*	pTiles	= pCtx->pTileRenderer;
+	uint32_t			frame	= pCtx->currentFrame;
+	/* NOTE: Nothing was culled, the draw buffer was not reset either */
+	if (pTiles->submittedCount == 0)
+		return ;
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pTiles->pipeline.pipeline);
+	/* NOTE: Every texture of the playfield is in it, one bind for all the tiles */
+	vkBindlessBind(pCtx, commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pTiles->pipeline.pipelineLayout, 0);
+
+	TilePushConstants pushConstants = {
+		.instanceBufferAddress	= pTiles->pVisibleAddresses[frame],
+		.pixelToNdc				= { 2.0f / drawExtent.width, 2.0f / drawExtent.height },
+	};
+	uint32_t	offset	= 0;
+	uint32_t	size	= sizeof(TilePushConstants);
+	vkCmdPushConstants(
+			commandBuffer,
+			pTiles->pipeline.pipelineLayout,
+			VK_SHADER_STAGE_VERTEX_BIT,
+			offset,
+			size,
+			&pushConstants);
+
+	/* NOTE: The rect's 4 vertices are rebuilt from gl_VertexIndex, only its indices are used */
+	vkCmdBindIndexBuffer(commandBuffer, pCtx->gpuMeshBuffers.indexBuffer.handle, offset, VK_INDEX_TYPE_UINT32);
+
+	/* NOTE: The instance count comes from the cull pass, the CPU never reads it back */
+	VkBuffer		drawBuffer		= pTiles->pDrawBuffers[frame].handle;
+	VkDeviceSize	commandOffset	= offsetof(TileDrawBuffer, command);
+	uint32_t		maxDrawCount	= 1;
+	uint32_t		stride			= sizeof(VkDrawIndexedIndirectCommand);
+	if (pCtx->device.bDrawIndirectCount)
+		vkCmdDrawIndexedIndirectCount(commandBuffer, drawBuffer, commandOffset, drawBuffer, 0, maxDrawCount, stride);
+	else
+		vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, commandOffset, maxDrawCount, stride);
+}
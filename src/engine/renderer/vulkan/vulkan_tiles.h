@@ -0,0 +1,152 @@
+#ifndef VULKAN_TILES_H
+#define VULKAN_TILES_H
+
+#include "yvulkan.h"
+#include "vulkan_frame.h"
+#include "vulkan_bindless.h"
+
+/*
+ * NOTE: Instanced tiles and notes. Tiles pushed during a frame are copied as
+ * is to the frame's instance buffer, tile_cull.comp drops the ones outside
+ * the time window or the draw extent and compacts the others into the
+ * visible buffer, counting them in the frame's draw buffer. The vertex
+ * shader reads the visible ones by device address and expands the rect mesh
+ * of DefaultDataInit, one indirect draw covers all of them. Textures come
+ * from the bindless set, bound once for the whole playfield.
+ */
+#define VK_TILE_MAX_INSTANCES			16384
+#define VK_TILE_DEMO_LANES				4
+
+/* NOTE: std430 layout of TileInstance in tile_instanced.vert, keep them in sync */
+typedef struct TileInstance
+{
+	// NOTE: Top left corner and size, in draw image pixels
+	f32						position[2];
+	f32						size[2];
+	f32						color[4];
+	// NOTE: u0 v0 u1 v1
+	f32						uvRect[4];
+	uint32_t				lane;
+	// NOTE: 0 when not hit, the fragment shader brightens anything else
+	uint32_t				hitState;
+	// NOTE: Seconds, culled when [time, time + duration] is outside the window
+	f32						time;
+	f32						duration;
+	// NOTE: Bindless slots, VK_BINDLESS_TEXTURE_NONE draws the plain color
+	uint32_t				textureIndex;
+	uint32_t				samplerIndex;
+	uint32_t				pad[2];
+} TileInstance;
+
+_Static_assert(sizeof(TileInstance) == 80, "TileInstance must match its std430 layout");
+
+typedef struct TilePushConstants
+{
+	VkDeviceAddress			instanceBufferAddress;
+	// NOTE: 2 / draw extent, pixels to NDC
+	f32						pixelToNdc[2];
+} TilePushConstants;
+
+/* NOTE: std430 layout of the push constants of tile_cull.comp */
+typedef struct TileCullPushConstants
+{
+	VkDeviceAddress			instanceBufferAddress;
+	VkDeviceAddress			visibleBufferAddress;
+	VkDeviceAddress			drawBufferAddress;
+	uint64_t				pad;
+	// NOTE: x0 y0 x1 y1 in pixels
+	f32						screenRect[4];
+	f32						timeWindow[2];
+	uint32_t				instanceCount;
+	uint32_t				pad2;
+} TileCullPushConstants;
+
+_Static_assert(sizeof(TileCullPushConstants) == 64, "TileCullPushConstants must match its std430 layout");
+
+/* NOTE: Count first, vkCmdDrawIndexedIndirectCount reads it at offset 0 */
+typedef struct TileDrawBuffer
+{
+	uint32_t						drawCount;
+	uint32_t						pad[3];
+	VkDrawIndexedIndirectCommand	command;
+} TileDrawBuffer;
+
+struct VulkanTileRenderer
+{
+	GenericPipeline			pipeline;
+	ComputeShaderFx			cull;
+
+	// NOTE: Host visible and persistently mapped, one per frame in flight
+	VulkanBuffer			pInstanceBuffers[VK_FRAMES_IN_FLIGHT_MAX];
+	VkDeviceAddress			pInstanceAddresses[VK_FRAMES_IN_FLIGHT_MAX];
+
+	// NOTE: Device local, written by the cull pass
+	VulkanBuffer			pVisibleBuffers[VK_FRAMES_IN_FLIGHT_MAX];
+	VkDeviceAddress			pVisibleAddresses[VK_FRAMES_IN_FLIGHT_MAX];
+	VulkanBuffer			pDrawBuffers[VK_FRAMES_IN_FLIGHT_MAX];
+	VkDeviceAddress			pDrawAddresses[VK_FRAMES_IN_FLIGHT_MAX];
+
+	// NOTE: Darray, cleared by each vkTilesCull
+	TileInstance*			pTiles;
+	uint32_t				submittedCount;
+
+	// NOTE: Seconds, start and end of what can be on screen
+	f32						timeWindow[2];
+};
+
+/**
+ * @brief	Allocates pCtx->pTileRenderer, its buffers and the cull layout,
+ *			the pipelines are built by the pipeline jobs of vkInit.
+ */
+YND VkResult vkTilesCreate(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Expects the device to be idle.
+ */
+void vkTilesDestroy(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Queues `pTile` for the next vkTilesCull, dropped when the frame is full.
+ */
+void vkTilePush(
+		VkContext*							pCtx,
+		const TileInstance*					pTile);
+
+/**
+ * @brief	Tiles whose [time, time + duration] misses [start, end] are culled.
+ */
+void vkTilesTimeWindowSet(
+		VkContext*							pCtx,
+		f32									start,
+		f32									end);
+
+/**
+ * @brief	Pushes VK_TILE_DEMO_LANES lanes of notes scrolling with nbFrames.
+ */
+void vkTilesDemoPush(
+		VkContext*							pCtx,
+		VkExtent2D							drawExtent);
+
+/**
+ * @brief	Copies the pushed tiles to the current frame's instance buffer and
+ *			dispatches the cull pass, outside of any rendering pass. Call after
+ *			vkFrameBegin. The barrier to vkTilesDraw's indirect and vertex
+ *			reads is left to the caller, the render graph of vkDrawImpl.
+ */
+void vkTilesCull(
+		VkContext*							pCtx,
+		VkCommandBuffer						commandBuffer,
+		VkExtent2D							drawExtent);
+
+/**
+ * @brief	Draws what vkTilesCull kept, inside a dynamic rendering pass with
+ *			viewport and scissor set.
+ */
+void vkTilesDraw(
+		VkContext*							pCtx,
+		VkCommandBuffer						commandBuffer,
+		VkExtent2D							drawExtent);
+
+#endif // VULKAN_TILES_H
@@ -1,106 +1,315 @@
 #include "vulkan_timer.h"
+#include "vulkan_tracy.h"
 
-static VkQueryPool gTimer;
+#include "core/filesystem.h"
+#include "core/logger.h"
+#include "core/ymemory.h"
+
+#include <string.h>
+#include <vulkan/vk_enum_string_helper.h>
 
 YND VkResult
-vkQueryPoolTimerCreate(VkDevice device, VkAllocationCallbacks* pAllocator, VkQueryPool* pOutQueryPool)
+vkGpuProfilerCreate(VkContext* pCtx)
 {
+	VulkanDevice* pDevice = &pCtx->device;
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(pDevice->physicalDevice, &queueFamilyCount, NULL);
+	VkQueueFamilyProperties pQueueFamilies[queueFamilyCount];
+	vkGetPhysicalDeviceQueueFamilyProperties(pDevice->physicalDevice, &queueFamilyCount, pQueueFamilies);
+	uint32_t validBits = pQueueFamilies[pDevice->graphicsQueueIndex].timestampValidBits;
+	if (validBits == 0)
+	{
+		YWARN("GPU profiler disabled, the graphics queue has no timestamps");
+		return VK_SUCCESS;
+	}
+
+	VulkanGpuProfiler* pProfiler = yAlloc(sizeof(VulkanGpuProfiler), MEMORY_TAG_RENDERER);
+	/* NOTE: timestampPeriod is in nanoseconds per tick */
+	pProfiler->timestampPeriod	= pDevice->properties.limits.timestampPeriod;
+	pProfiler->timestampMask	= validBits >= 64 ? UINT64_MAX : (1ull << validBits) - 1;
+	pProfiler->frameCount		= pCtx->swapchain.maxFrameInFlight;
+	pCtx->pGpuProfiler			= pProfiler;
+
 	VkQueryPoolCreateInfo queryPoolCreateInfo = {
 		.sType		= VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
 		.queryType	= VK_QUERY_TYPE_TIMESTAMP,
-		.queryCount	= 2,
+		.queryCount	= VK_GPU_PROFILER_MAX_QUERIES,
 	};
-
-	pOutQueryPool = &gTimer;
-	VK_CHECK(vkCreateQueryPool(device, &queryPoolCreateInfo, pAllocator, pOutQueryPool));
-	/* NOTE: This is just temporary */
+	for (uint32_t i = 0; i < pProfiler->frameCount; i++)
+	{
+		VK_CHECK(vkCreateQueryPool(pDevice->handle, &queryPoolCreateInfo, pCtx->pAllocator,
+					&pProfiler->pFrames[i].queryPool));
+	}
 	return VK_SUCCESS;
 }
 
 void
-vkQueryPoolTimerDestroy(VkDevice device, VkAllocationCallbacks* pAllocator, VkQueryPool queryPool)
+vkGpuProfilerDestroy(VkContext* pCtx)
+{
+	VulkanGpuProfiler* pProfiler = pCtx->pGpuProfiler;
+	if (!pProfiler)
+		return ;
+
+	for (uint32_t i = 0; i < pProfiler->frameCount; i++)
+		vkDestroyQueryPool(pCtx->device.handle, pProfiler->pFrames[i].queryPool, pCtx->pAllocator);
+	if (pProfiler->pCsv)
+		OsFclose(pProfiler->pCsv);
+	yFree(pProfiler, 1, MEMORY_TAG_RENDERER);
+	pCtx->pGpuProfiler = NULL;
+}
+
+static uint32_t
+GpuScopeFind(VulkanGpuProfiler* pProfiler, const char* pName, uint32_t depth)
+{
+	for (uint32_t i = 0; i < pProfiler->scopeCount; i++)
+	{
+		VulkanGpuScopeStats* pScope = &pProfiler->pScopes[i];
+		if (pScope->depth == depth && (pScope->pName == pName || strcmp(pScope->pName, pName) == 0))
+			return i;
+	}
+	if (pProfiler->scopeCount == VK_GPU_PROFILER_MAX_SCOPES)
+		return UINT32_MAX;
+
+	pProfiler->pScopes[pProfiler->scopeCount] = (VulkanGpuScopeStats){
+		.pName	= pName,
+		.depth	= depth,
+	};
+	return pProfiler->scopeCount++;
+}
+
+static void
+GpuScopeSamplePush(VulkanGpuScopeStats* pScope, f64 ms)
+{
+	pScope->pSamples[pScope->sampleHead] = (f32)ms;
+	pScope->sampleHead = (pScope->sampleHead + 1) % VK_GPU_PROFILER_WINDOW;
+	if (pScope->sampleCount < VK_GPU_PROFILER_WINDOW)
+		pScope->sampleCount++;
+
+	f64 total	= 0.0;
+	f64 max		= 0.0;
+	for (uint32_t i = 0; i < pScope->sampleCount; i++)
+	{
+		total += pScope->pSamples[i];
+		if (pScope->pSamples[i] > max)
+			max = pScope->pSamples[i];
+	}
+	pScope->lastMs		= ms;
+	pScope->averageMs	= total / pScope->sampleCount;
+	pScope->maxMs		= max;
+}
+
+static void
+GpuProfilerFrameCollect(VkContext* pCtx, VulkanGpuProfilerFrame* pFrame)
+{
+	VulkanGpuProfiler* pProfiler = pCtx->pGpuProfiler;
+	if (pFrame->queryCount == 0)
+		return ;
+
+	/* NOTE: No WAIT_BIT, the frame's fence was waited on already */
+	uint64_t			pResults[VK_GPU_PROFILER_MAX_QUERIES * 2];
+	VkDeviceSize		stride	= sizeof(uint64_t) * 2;
+	VkQueryResultFlags	flags	= VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT;
+	VkResult result = vkGetQueryPoolResults(
+			pCtx->device.handle,
+			pFrame->queryPool,
+			0,
+			pFrame->queryCount,
+			sizeof(pResults),
+			pResults,
+			stride,
+			flags);
+	if (result != VK_SUCCESS && result != VK_NOT_READY)
+	{
+		YWARN("GPU profiler: %s reading the timestamps", string_VkResult(result));
+		return ;
+	}
+
+	pProfiler->lastFrameNumber = pFrame->frameNumber;
+
+	/* NOTE: A scope opened more than once in a frame reports the sum */
+	f64	pFrameMs[VK_GPU_PROFILER_MAX_SCOPES] = {0};
+	b8	pSeen[VK_GPU_PROFILER_MAX_SCOPES] = {0};
+	for (uint32_t i = 0; i < pFrame->scopeQueryCount; i++)
+	{
+		VulkanGpuScopeQuery* pQuery = &pFrame->pScopeQueries[i];
+		uint64_t* pBegin	= &pResults[pQuery->beginQuery * 2];
+		uint64_t* pEnd		= &pResults[pQuery->endQuery * 2];
+		if (!pBegin[1] || !pEnd[1])
+			continue;
+		uint64_t ticks = (pEnd[0] - pBegin[0]) & pProfiler->timestampMask;
+		pFrameMs[pQuery->scope] += ticks * pProfiler->timestampPeriod / (1000.0 * 1000.0);
+		pSeen[pQuery->scope] = TRUE;
+	}
+
+	for (uint32_t i = 0; i < pProfiler->scopeCount; i++)
+	{
+		if (!pSeen[i])
+			continue;
+		VulkanGpuScopeStats* pScope = &pProfiler->pScopes[i];
+		GpuScopeSamplePush(pScope, pFrameMs[i]);
+		pScope->lastFrameNumber = pFrame->frameNumber;
+		if (pProfiler->pCsv)
+			fprintf(pProfiler->pCsv, "%llu,%s,%u,%.4f\n", (unsigned long long)pFrame->frameNumber, pScope->pName, pScope->depth, pFrameMs[i]);
+	}
+}
+
+void
+vkGpuProfilerFrameBegin(VkContext* pCtx, VkCommandBuffer commandBuffer)
 {
-	/* NOTE: This is just temporary */
-	queryPool = gTimer;
-	vkDeviceWaitIdle(device);
-	vkDestroyQueryPool(device, queryPool, pAllocator);
+	/* NOTE: Tracy reads its own queries back */
+	vkTracyCollect(pCtx->pTracyContext, commandBuffer);
+
+	VulkanGpuProfiler* pProfiler = pCtx->pGpuProfiler;
+	if (!pProfiler)
+		return ;
+
+	VulkanGpuProfilerFrame* pFrame = &pProfiler->pFrames[pCtx->currentFrame];
+	GpuProfilerFrameCollect(pCtx, pFrame);
+
+	vkCmdResetQueryPool(commandBuffer, pFrame->queryPool, 0, VK_GPU_PROFILER_MAX_QUERIES);
+	pFrame->frameNumber		= pCtx->nbFrames;
+	pFrame->queryCount		= 0;
+	pFrame->scopeQueryCount	= 0;
+	pProfiler->openCount	= 0;
+	vkGpuScopeBegin(pCtx, commandBuffer, "frame");
 }
 
 void
-vkTimerStart(VkCommandBuffer command)
+vkGpuProfilerFrameEnd(VkContext* pCtx, VkCommandBuffer commandBuffer)
 {
-	uint32_t firstQuery = 0;
-	uint32_t queryCount = 1;
+	VulkanGpuProfiler* pProfiler = pCtx->pGpuProfiler;
+	if (!pProfiler)
+		return ;
+
+	if (pProfiler->openCount > 1)
+		YWARN("GPU profiler: %u scopes left open", pProfiler->openCount - 1);
+	while (pProfiler->openCount)
+		vkGpuScopeEnd(pCtx, commandBuffer);
 
-	vkCmdResetQueryPool(command, gTimer, firstQuery, queryCount);
-	vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, gTimer, firstQuery);
+	if (VK_GPU_PROFILER_LOG_INTERVAL && pCtx->nbFrames && pCtx->nbFrames % VK_GPU_PROFILER_LOG_INTERVAL == 0)
+		vkGpuProfilerLog(pCtx);
 }
 
 void
-vkTimerEnd(VkCommandBuffer command)
+vkGpuScopeBeginAt(VkContext* pCtx, VkCommandBuffer commandBuffer, const char* pName, YMB const char* pFile,
+		YMB const char* pFunction, YMB uint32_t line)
 {
-	uint32_t secondQuery = 1;
+	vkTracyZoneBegin(pCtx->pTracyContext, commandBuffer, pName, pFile, pFunction, line);
+
+	VulkanGpuProfiler* pProfiler = pCtx->pGpuProfiler;
+	if (!pProfiler)
+		return ;
 
-	/* NOTE: This is just temporary */
-	vkCmdResetQueryPool(command, gTimer, secondQuery, 1);
-	vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, gTimer, secondQuery);
+	uint32_t depth = pProfiler->openCount++;
+	if (depth >= VK_GPU_PROFILER_MAX_DEPTH)
+		return ;
+
+	VulkanGpuProfilerFrame*	pFrame	= &pProfiler->pFrames[pCtx->currentFrame];
+	uint32_t				scope	= GpuScopeFind(pProfiler, pName, depth);
+	if (scope == UINT32_MAX || pFrame->queryCount + 2 > VK_GPU_PROFILER_MAX_QUERIES)
+	{
+		pProfiler->pOpenScopes[depth] = UINT32_MAX;
+		return ;
+	}
+
+	/* NOTE: Both queries are reserved now so a scope never ends up half written */
+	VulkanGpuScopeQuery query = {
+		.scope		= scope,
+		.beginQuery	= pFrame->queryCount,
+		.endQuery	= pFrame->queryCount + 1,
+	};
+	pFrame->queryCount += 2;
+	pProfiler->pOpenScopes[depth] = pFrame->scopeQueryCount;
+	pFrame->pScopeQueries[pFrame->scopeQueryCount++] = query;
+
+	/*
+	 * NOTE: Bottom of pipe on both ends, the begin timestamp lands once the
+	 * previous commands are done so a scope does not count what ran before it.
+	 */
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, pFrame->queryPool, query.beginQuery);
 }
 
-YND VkResult
-vkTimerGetResults(VkQueue queue, VkDevice device, uint64_t* pOutTimeStamp)
+void
+vkGpuScopeEnd(VkContext* pCtx, VkCommandBuffer commandBuffer)
 {
-	vkQueueWaitIdle(queue);
-	uint32_t			firstQuery	=	0;
-	uint32_t			queryCount	=	2;
-	size_t				dataSize	=	sizeof(uint64_t) * 2;
-	VkDeviceSize		stride		=	sizeof(uint64_t);
-	VkQueryResultFlags	flags		=	VK_QUERY_RESULT_64_BIT; // | VK_QUERY_RESULT_WAIT_BIT;
-
-	VK_CHECK(vkGetQueryPoolResults(
-				device,
-				gTimer,
-				firstQuery,
-				queryCount,
-				dataSize,
-				pOutTimeStamp,
-				stride,
-				flags));
+	vkTracyZoneEnd(pCtx->pTracyContext);
 
-	return VK_SUCCESS;
+	VulkanGpuProfiler* pProfiler = pCtx->pGpuProfiler;
+	if (!pProfiler || pProfiler->openCount == 0)
+		return ;
+
+	uint32_t depth = --pProfiler->openCount;
+	if (depth >= VK_GPU_PROFILER_MAX_DEPTH || pProfiler->pOpenScopes[depth] == UINT32_MAX)
+		return ;
+
+	VulkanGpuProfilerFrame*	pFrame	= &pProfiler->pFrames[pCtx->currentFrame];
+	VulkanGpuScopeQuery*	pQuery	= &pFrame->pScopeQueries[pProfiler->pOpenScopes[depth]];
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, pFrame->queryPool, pQuery->endQuery);
 }
 
-VkResult
-vkTimerLog(VkPhysicalDeviceProperties properties, VkQueue queue, VkDevice device, SECOND_UNIT unit)
+uint32_t
+vkGpuProfilerScopesGet(VkContext* pCtx, const VulkanGpuScopeStats** ppOutScopes)
 {
-	f64 unitScale = 1.0f;
-	char *pStrUnit = "ms";
-	switch (unit)
+	VulkanGpuProfiler* pProfiler = pCtx->pGpuProfiler;
+	if (!pProfiler)
 	{
-		case SECONDS:
-			unitScale *= 1000.0f * 1000.0f * 1000.0f;
-			pStrUnit = "s";
-			break;
-		case MILLISECONDS:
-			unitScale *= 1000.0f * 1000.0f;
-			pStrUnit = "ns";
-			break;
-		case MICROSECONDS:
-			unitScale *= 1000.0f;
-			pStrUnit = "us";
-			break;
-		case NANOSECONDS:
-			unitScale *= 1.0f;
-			pStrUnit = "ms";
-			break;
-		default:
-			YERROR("Unknown unit %d defaults to milliseconds", unit);
-			break;
+		*ppOutScopes = NULL;
+		return 0;
 	}
+	*ppOutScopes = pProfiler->pScopes;
+	return pProfiler->scopeCount;
+}
 
-	uint64_t pTimeStamp[2];
-	VK_CHECK(vkTimerGetResults(queue, device, pTimeStamp));
-	f64 timestampPeriod = properties.limits.timestampPeriod;
-	f64 deltaTime = (pTimeStamp[1] - pTimeStamp[0]) * timestampPeriod;
-	YINFO("Took: %.2f%s", deltaTime / unitScale, pStrUnit);
-	return VK_SUCCESS;
+f64
+vkGpuScopeLastMs(VkContext* pCtx, const char* pName)
+{
+	VulkanGpuProfiler* pProfiler = pCtx->pGpuProfiler;
+	if (!pProfiler)
+		return 0.0;
+
+	for (uint32_t i = 0; i < pProfiler->scopeCount; i++)
+	{
+		VulkanGpuScopeStats* pScope = &pProfiler->pScopes[i];
+		if (pScope->pName != pName && strcmp(pScope->pName, pName) != 0)
+			continue;
+		/* NOTE: Skipped by the last frame, its old time is no cost anymore */
+		return pScope->lastFrameNumber == pProfiler->lastFrameNumber ? pScope->lastMs : 0.0;
+	}
+	return 0.0;
+}
+
+void
+vkGpuProfilerLog(VkContext* pCtx)
+{
+	const VulkanGpuScopeStats*	pScopes		= NULL;
+	uint32_t					scopeCount	= vkGpuProfilerScopesGet(pCtx, &pScopes);
+	for (uint32_t i = 0; i < scopeCount; i++)
+	{
+		const VulkanGpuScopeStats* pScope = &pScopes[i];
+		YINFO("GPU %*s%-24s %.3f ms (avg %.3f, max %.3f over %u frames)",
+				pScope->depth * 2, "", pScope->pName, pScope->lastMs, pScope->averageMs,
+				pScope->maxMs, pScope->sampleCount);
+	}
+}
+
+b8
+vkGpuProfilerCsvOpen(VkContext* pCtx, const char* pPath)
+{
+	VulkanGpuProfiler* pProfiler = pCtx->pGpuProfiler;
+	if (!pProfiler)
+		return FALSE;
+
+	if (pProfiler->pCsv)
+		OsFclose(pProfiler->pCsv);
+	pProfiler->pCsv = NULL;
+	if (OsFopen(&pProfiler->pCsv, pPath, "w") != 0 || !pProfiler->pCsv)
+	{
+		YWARN("GPU profiler: could not open %s", pPath);
+		pProfiler->pCsv = NULL;
+		return FALSE;
+	}
+	fprintf(pProfiler->pCsv, "frame,scope,depth,ms\n");
+	YINFO("GPU profiler writing to %s", pPath);
+	return TRUE;
 }
@@ -2,32 +2,145 @@
 #define VULKAN_TIMER_H
 
 #include "yvulkan.h"
+#include "vulkan_frame.h"
 
-YND VkResult vkQueryPoolTimerCreate(
-		VkDevice							device,
-		VkAllocationCallbacks*				pAllocator,
-		VkQueryPool*						pOutQueryPool);
+#include <stdio.h>
 
-YND VkResult vkTimerGetResults(
-		VkQueue								queue,
-		VkDevice							device,
-		uint64_t*							pOutTimeStamp);
+/*
+ * NOTE: GPU profiler. Each frame in flight writes its timestamps to its own
+ * query pool, the results are read when that frame comes around again, its
+ * fence is signaled by then so reading them never waits on the GPU.
+ * Scopes nest, each one is identified by its name and keeps the times of its
+ * last VK_GPU_PROFILER_WINDOW frames.
+ */
+#define VK_GPU_PROFILER_MAX_SCOPES			32
+#define VK_GPU_PROFILER_MAX_DEPTH			8
+#define VK_GPU_PROFILER_MAX_QUERIES			128
+#define VK_GPU_PROFILER_WINDOW				64
+#define VK_GPU_PROFILER_LOG_INTERVAL		1000	/* NOTE: In frames, 0 disables it */
 
-void vkQueryPoolTimerDestroy(
-		VkDevice							device,
-		VkAllocationCallbacks*				pAllocator,
-		VkQueryPool							queryPool);
+typedef struct VulkanGpuScopeStats
+{
+	// NOTE: Not owned, expected to be a string literal
+	const char*				pName;
+	uint32_t				depth;
 
-void vkTimerStart(
-		VkCommandBuffer						command);
+	f64						lastMs;
+	f64						averageMs;
+	f64						maxMs;
+	// NOTE: Frame lastMs was read back from, older than the profiler's last one when skipped since
+	uint64_t				lastFrameNumber;
 
-void vkTimerEnd(
-		VkCommandBuffer						command);
+	// NOTE: Ring of the last frames' times
+	uint32_t				sampleCount;
+	uint32_t				sampleHead;
+	f32						pSamples[VK_GPU_PROFILER_WINDOW];
+} VulkanGpuScopeStats;
 
-VkResult vkTimerLog(
-		VkPhysicalDeviceProperties			properties,
-		VkQueue								queue, 
-		VkDevice							device,
-		SECOND_UNIT							unit);
+typedef struct VulkanGpuScopeQuery
+{
+	uint32_t				scope;
+	uint32_t				beginQuery;
+	uint32_t				endQuery;
+} VulkanGpuScopeQuery;
+
+typedef struct VulkanGpuProfilerFrame
+{
+	VkQueryPool				queryPool;
+	uint64_t				frameNumber;
+	uint32_t				queryCount;
+	uint32_t				scopeQueryCount;
+	VulkanGpuScopeQuery		pScopeQueries[VK_GPU_PROFILER_MAX_QUERIES / 2];
+} VulkanGpuProfilerFrame;
+
+struct VulkanGpuProfiler
+{
+	f64						timestampPeriod;
+	uint64_t				timestampMask;
+	uint32_t				frameCount;
+	uint32_t				scopeCount;
+	VulkanGpuScopeStats		pScopes[VK_GPU_PROFILER_MAX_SCOPES];
+	VulkanGpuProfilerFrame	pFrames[VK_FRAMES_IN_FLIGHT_MAX];
+	// NOTE: Last frame whose timestamps were read back
+	uint64_t				lastFrameNumber;
+
+	// NOTE: Indices in the current frame's pScopeQueries, UINT32_MAX when dropped
+	uint32_t				openCount;
+	uint32_t				pOpenScopes[VK_GPU_PROFILER_MAX_DEPTH];
+
+	FILE*					pCsv;
+};
+
+/**
+ * @brief	Leaves pCtx->pGpuProfiler NULL when the graphics queue has no
+ *			timestamps, every other call is a no-op then.
+ */
+YND VkResult vkGpuProfilerCreate(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Expects the device to be idle.
+ */
+void vkGpuProfilerDestroy(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Reads the results this frame recorded last time, resets its queries
+ *			and opens the "frame" scope. Call right after vkCommandBufferBegin.
+ */
+void vkGpuProfilerFrameBegin(
+		VkContext*							pCtx,
+		VkCommandBuffer						commandBuffer);
+
+/**
+ * @brief	Closes the scopes still open, logs every VK_GPU_PROFILER_LOG_INTERVAL frames.
+ */
+void vkGpuProfilerFrameEnd(
+		VkContext*							pCtx,
+		VkCommandBuffer						commandBuffer);
+
+/**
+ * @brief	Use vkGpuScopeBegin, Tracy then shows the zone at its call site.
+ */
+void vkGpuScopeBeginAt(
+		VkContext*							pCtx,
+		VkCommandBuffer						commandBuffer,
+		const char*							pName,
+		const char*							pFile,
+		const char*							pFunction,
+		uint32_t							line);
+
+#define vkGpuScopeBegin(pCtx, commandBuffer, pName) \
+	vkGpuScopeBeginAt(pCtx, commandBuffer, pName, __FILE__, __func__, __LINE__)
+
+void vkGpuScopeEnd(
+		VkContext*							pCtx,
+		VkCommandBuffer						commandBuffer);
+
+/**
+ * @brief	Returns the number of scopes seen so far, `ppOutScopes` points to
+ *			them in first seen order, children follow their parent.
+ */
+uint32_t vkGpuProfilerScopesGet(
+		VkContext*							pCtx,
+		const VulkanGpuScopeStats**			ppOutScopes);
+
+/**
+ * @brief	Last frame's time of the first scope named `pName`, 0 when there is
+ *			none yet, no profiler, or the last frame read back did not open it.
+ */
+f64 vkGpuScopeLastMs(
+		VkContext*							pCtx,
+		const char*							pName);
+
+void vkGpuProfilerLog(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Appends a `frame,scope,depth,ms` row per scope and frame read back.
+ */
+b8 vkGpuProfilerCsvOpen(
+		VkContext*							pCtx,
+		const char*							pPath);
 
 #endif // VULKAN_TIMER_H
@@ -0,0 +1,72 @@
+#ifndef VULKAN_TRACY_H
+#define VULKAN_TRACY_H
+
+/*
+ * NOTE: Tracy's Vulkan profiler is C++ only, this is the C side of
+ * src/TracyVulkan.cpp. Plain Vulkan types only, the C++ side cannot include
+ * yvulkan.h. Everything compiles out without TRACY_ENABLE.
+ */
+#include <vulkan/vulkan.h>
+#include <stdint.h>
+
+#define VK_TRACY_MAX_DEPTH 8
+
+#ifdef TRACY_ENABLE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief	Submits on `queue` with `commandBuffer` and waits, init time only.
+ *			`commandBuffer` must come from a pool with the reset flag.
+ *			Device and host timestamps are calibrated when `bCalibrated` is set,
+ *			which needs VK_EXT_calibrated_timestamps enabled on `device`.
+ */
+void* vkTracyContextCreate(
+		VkInstance							instance,
+		VkPhysicalDevice					physicalDevice,
+		VkDevice							device,
+		VkQueue								queue,
+		VkCommandBuffer						commandBuffer,
+		VkBool32							bCalibrated);
+
+void vkTracyContextDestroy(
+		void*								pTracyCtx);
+
+/**
+ * @brief	Reads back the zones of finished frames, outside of any render pass.
+ */
+void vkTracyCollect(
+		void*								pTracyCtx,
+		VkCommandBuffer						commandBuffer);
+
+/**
+ * @brief	`pName` is copied, zones nest up to VK_TRACY_MAX_DEPTH.
+ */
+void vkTracyZoneBegin(
+		void*								pTracyCtx,
+		VkCommandBuffer						commandBuffer,
+		const char*							pName,
+		const char*							pFile,
+		const char*							pFunction,
+		uint32_t							line);
+
+void vkTracyZoneEnd(
+		void*								pTracyCtx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#else
+
+#	define vkTracyContextCreate(instance, physicalDevice, device, queue, commandBuffer, bCalibrated) NULL
+#	define vkTracyContextDestroy(pTracyCtx)
+#	define vkTracyCollect(pTracyCtx, commandBuffer)
+#	define vkTracyZoneBegin(pTracyCtx, commandBuffer, pName, pFile, pFunction, line)
+#	define vkTracyZoneEnd(pTracyCtx)
+
+#endif // TRACY_ENABLE
+
+#endif // VULKAN_TRACY_H
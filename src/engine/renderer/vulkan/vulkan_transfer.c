@@ -0,0 +1,271 @@
+#include "vulkan_transfer.h"
+
+#include "vulkan_command.h"
+#include "vulkan_memory.h"
+#include "vulkan_staging.h"
+
+#include "core/darray.h"
+#include "core/logger.h"
+
+#include <string.h>
+
+YND VkResult
+vkTransferInit(VkContext* pCtx)
+{
+	VulkanTransferQueue*	pTransfer	= &pCtx->transfer;
+	VulkanDevice*			pDevice		= &pCtx->device;
+
+	pTransfer->bDedicated = pDevice->transferQueueIndex != pDevice->graphicsQueueIndex;
+	if (!pTransfer->bDedicated)
+	{
+		YINFO("No dedicated transfer queue family, uploads go through the staging ring");
+		return VK_SUCCESS;
+	}
+	if (!OsMutexCreate(&pTransfer->mutex))
+		return VK_ERROR_INITIALIZATION_FAILED;
+
+	/* NOTE: Transient, every command buffer is recorded once then freed */
+	VkCommandPoolCreateInfo poolCreateInfo = {
+		.sType				= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags				= VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		.queueFamilyIndex	= pDevice->transferQueueIndex,
+	};
+	VK_CHECK(vkCreateCommandPool(pDevice->handle, &poolCreateInfo, pCtx->pAllocator, &pTransfer->commandPool));
+
+	VkSemaphoreTypeCreateInfo semaphoreTypeInfo = {
+		.sType			= VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+		.semaphoreType	= VK_SEMAPHORE_TYPE_TIMELINE,
+		.initialValue	= 0,
+	};
+	VkSemaphoreCreateInfo semaphoreCreateInfo = {
+		.sType	= VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		.pNext	= &semaphoreTypeInfo,
+	};
+	VK_CHECK(vkCreateSemaphore(pDevice->handle, &semaphoreCreateInfo, pCtx->pAllocator, &pTransfer->timeline));
+
+	pTransfer->submittedValue		= 0;
+	pTransfer->graphicsWaitValue	= 0;
+	pTransfer->pTransfers			= DarrayCreate(VulkanTransfer);
+	YINFO("Uploads on transfer queue family %d", pDevice->transferQueueIndex);
+	return VK_SUCCESS;
+}
+
+static void
+vkTransferRelease(VkContext* pCtx, VulkanTransfer* pTransfer)
+{
+	vkFreeCommandBuffers(pCtx->device.handle, pCtx->transfer.commandPool, 1, &pTransfer->commandBuffer);
+	vkBufferDestroy(pCtx->device, pCtx->pAllocator, &pTransfer->staging);
+}
+
+void
+vkTransferShutdown(VkContext* pCtx)
+{
+	VulkanTransferQueue* pTransfer = &pCtx->transfer;
+	if (!pTransfer->bDedicated || pTransfer->commandPool == VK_NULL_HANDLE)
+		return ;
+
+	for (uint64_t i = 0; i < DarrayLength(pTransfer->pTransfers); i++)
+		vkTransferRelease(pCtx, &pTransfer->pTransfers[i]);
+	DarrayDestroy(pTransfer->pTransfers);
+	vkDestroySemaphore(pCtx->device.handle, pTransfer->timeline, pCtx->pAllocator);
+	vkDestroyCommandPool(pCtx->device.handle, pTransfer->commandPool, pCtx->pAllocator);
+	OsMutexDestroy(&pTransfer->mutex);
+	pTransfer->commandPool = VK_NULL_HANDLE;
+}
+
+/* NOTE: Both halves of the ownership transfer must use the same barrier values */
+static VkBufferMemoryBarrier2
+OwnershipBarrier(VkContext* pCtx, VulkanTransfer* pTransfer)
+{
+	return (VkBufferMemoryBarrier2){
+		.sType					= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+		.srcQueueFamilyIndex	= pCtx->device.transferQueueIndex,
+		.dstQueueFamilyIndex	= pCtx->device.graphicsQueueIndex,
+		.buffer					= pTransfer->dstBuffer,
+		.offset					= pTransfer->dstOffset,
+		.size					= pTransfer->size,
+	};
+}
+
+YND static VkResult
+vkTransferRecord(VkContext* pCtx, VulkanTransfer* pTransfer)
+{
+	VkDevice device = pCtx->device.handle;
+
+	VkCommandBufferAllocateInfo allocateInfo = {
+		.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		.level				= VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		.commandPool		= pCtx->transfer.commandPool,
+		.commandBufferCount	= 1,
+	};
+	VK_CHECK(vkAllocateCommandBuffers(device, &allocateInfo, &pTransfer->commandBuffer));
+
+	VkCommandBufferBeginInfo beginInfo = {
+		.sType	= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags	= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+	};
+	VK_CHECK(vkBeginCommandBuffer(pTransfer->commandBuffer, &beginInfo));
+
+	VkBufferCopy region = {
+		.srcOffset	= 0,
+		.dstOffset	= pTransfer->dstOffset,
+		.size		= pTransfer->size,
+	};
+	uint32_t regionCount = 1;
+	vkCmdCopyBuffer(pTransfer->commandBuffer, pTransfer->staging.handle, pTransfer->dstBuffer, regionCount, &region);
+
+	/* NOTE: Release half, the dst stage and access are ignored here */
+	VkBufferMemoryBarrier2 releaseBarrier = OwnershipBarrier(pCtx, pTransfer);
+	releaseBarrier.srcStageMask		= VK_PIPELINE_STAGE_2_COPY_BIT;
+	releaseBarrier.srcAccessMask	= VK_ACCESS_2_TRANSFER_WRITE_BIT;
+	VkDependencyInfo dependencyInfo = {
+		.sType						= VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+		.bufferMemoryBarrierCount	= 1,
+		.pBufferMemoryBarriers		= &releaseBarrier,
+	};
+	vkCmdPipelineBarrier2(pTransfer->commandBuffer, &dependencyInfo);
+
+	VK_CHECK(vkEndCommandBuffer(pTransfer->commandBuffer));
+	return VK_SUCCESS;
+}
+
+YND VkResult
+vkTransferBufferUpload(
+		VkContext*							pCtx,
+		VulkanBuffer*						pDst,
+		VkDeviceSize						dstOffset,
+		const void*							pData,
+		VkDeviceSize						size,
+		uint64_t*							pOutValue)
+{
+	VulkanTransferQueue* pQueue = &pCtx->transfer;
+	*pOutValue = 0;
+	if (!pQueue->bDedicated)
+		return vkStagingUpload(pCtx, pDst->handle, dstOffset, pData, size) ? VK_SUCCESS : VK_NOT_READY;
+
+	/* NOTE: Own staging per upload, streaming sizes vary too much for a ring */
+	VulkanTransfer transfer = {
+		.dstBuffer	= pDst->handle,
+		.dstOffset	= dstOffset,
+		.size		= size,
+	};
+	VK_CHECK(vkBufferCreate(
+				pCtx->device,
+				pCtx->pAllocator,
+				size,
+				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				&transfer.staging));
+	memcpy(transfer.staging.allocation.pMapped, pData, size);
+
+	/* NOTE: The pool and the queue are externally synchronized */
+	OsMutexLock(&pQueue->mutex);
+	VkResult result = vkTransferRecord(pCtx, &transfer);
+	if (result == VK_SUCCESS)
+	{
+		transfer.value = pQueue->submittedValue + 1;
+		VkSemaphoreSubmitInfo signalInfo = {
+			.sType		= VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore	= pQueue->timeline,
+			.value		= transfer.value,
+			.stageMask	= VK_PIPELINE_STAGE_2_COPY_BIT,
+		};
+		VkCommandBufferSubmitInfo cmdBufferSubmitInfo = {
+			.sType			= VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+			.commandBuffer	= transfer.commandBuffer,
+		};
+		VkSubmitInfo2 submitInfo2 = {
+			.sType						= VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+			.commandBufferInfoCount		= 1,
+			.pCommandBufferInfos		= &cmdBufferSubmitInfo,
+			.signalSemaphoreInfoCount	= 1,
+			.pSignalSemaphoreInfos		= &signalInfo,
+		};
+		uint32_t submitCount = 1;
+		result = vkQueueSubmit2(pCtx->device.transferQueue, submitCount, &submitInfo2, VK_NULL_HANDLE);
+	}
+	if (result == VK_SUCCESS)
+	{
+		pQueue->submittedValue = transfer.value;
+		DarrayPush(pQueue->pTransfers, transfer);
+		*pOutValue = transfer.value;
+	}
+	else if (transfer.commandBuffer != VK_NULL_HANDLE)
+		vkTransferRelease(pCtx, &transfer);
+	else
+		vkBufferDestroy(pCtx->device, pCtx->pAllocator, &transfer.staging);
+	OsMutexUnlock(&pQueue->mutex);
+	VK_CHECK(result);
+	return VK_SUCCESS;
+}
+
+void
+vkTransferAcquire(VkContext* pCtx, VkCommandBuffer commandBuffer)
+{
+	VulkanTransferQueue* pQueue = &pCtx->transfer;
+	if (!pQueue->bDedicated)
+		return ;
+
+	OsMutexLock(&pQueue->mutex);
+	uint64_t transferCount = DarrayLength(pQueue->pTransfers);
+	if (transferCount == 0)
+	{
+		OsMutexUnlock(&pQueue->mutex);
+		return ;
+	}
+	VkBufferMemoryBarrier2*	pBarriers		= DarrayReserve(VkBufferMemoryBarrier2, transferCount);
+	uint32_t				barrierCount	= 0;
+	for (uint64_t i = 0; i < transferCount; i++)
+	{
+		VulkanTransfer* pTransfer = &pQueue->pTransfers[i];
+		if (pTransfer->bAcquired)
+			continue;
+		/* NOTE: Acquire half, the src stage and access are ignored here */
+		pBarriers[barrierCount] = OwnershipBarrier(pCtx, pTransfer);
+		pBarriers[barrierCount].dstStageMask	= VK_UPLOAD_DST_STAGES;
+		pBarriers[barrierCount].dstAccessMask	= VK_UPLOAD_DST_ACCESS;
+		barrierCount++;
+		pTransfer->bAcquired = TRUE;
+		if (pTransfer->value > pQueue->graphicsWaitValue)
+			pQueue->graphicsWaitValue = pTransfer->value;
+	}
+	OsMutexUnlock(&pQueue->mutex);
+
+	if (barrierCount)
+	{
+		VkDependencyInfo dependencyInfo = {
+			.sType						= VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.bufferMemoryBarrierCount	= barrierCount,
+			.pBufferMemoryBarriers		= pBarriers,
+		};
+		vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	}
+	DarrayDestroy(pBarriers);
+}
+
+void
+vkTransferCollect(VkContext* pCtx)
+{
+	VulkanTransferQueue* pQueue = &pCtx->transfer;
+	if (!pQueue->bDedicated)
+		return ;
+
+	uint64_t completedValue = 0;
+	if (vkGetSemaphoreCounterValue(pCtx->device.handle, pQueue->timeline, &completedValue) != VK_SUCCESS)
+		return ;
+
+	OsMutexLock(&pQueue->mutex);
+	uint64_t i = 0;
+	while (i < DarrayLength(pQueue->pTransfers))
+	{
+		VulkanTransfer* pTransfer = &pQueue->pTransfers[i];
+		if (!pTransfer->bAcquired || pTransfer->value > completedValue)
+		{
+			i++;
+			continue;
+		}
+		vkTransferRelease(pCtx, pTransfer);
+		DarrayPop(pQueue->pTransfers, pTransfer);
+	}
+	OsMutexUnlock(&pQueue->mutex);
+}
@@ -0,0 +1,47 @@
+#ifndef VULKAN_TRANSFER_H
+#define VULKAN_TRANSFER_H
+
+#include "yvulkan.h"
+
+/**
+ * @brief	Without a transfer family of its own the uploads go through the
+ *			staging ring instead, the API stays the same.
+ */
+YND VkResult vkTransferInit(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Expects the device to be idle.
+ */
+void vkTransferShutdown(
+		VkContext*							pCtx);
+
+/**
+ * @brief	Copies `pData` into `pDst` on the transfer queue, safe from any
+ *			thread. `pOutValue` is the timeline value signaled once the copy is
+ *			done, 0 when it went through the staging ring.
+ *			Returns VK_NOT_READY when the staging ring is full, retry later.
+ */
+YND VkResult vkTransferBufferUpload(
+		VkContext*							pCtx,
+		VulkanBuffer*						pDst,
+		VkDeviceSize						dstOffset,
+		const void*							pData,
+		VkDeviceSize						size,
+		uint64_t*							pOutValue);
+
+/**
+ * @brief	Records the queue family acquire of every buffer released since the
+ *			last call, the graphics submit then waits on pCtx->transfer.graphicsWaitValue.
+ */
+void vkTransferAcquire(
+		VkContext*							pCtx,
+		VkCommandBuffer						commandBuffer);
+
+/**
+ * @brief	Frees the staging buffers and command buffers of completed uploads.
+ */
+void vkTransferCollect(
+		VkContext*							pCtx);
+
+#endif // VULKAN_TRANSFER_H
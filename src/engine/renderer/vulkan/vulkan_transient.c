@@ -0,0 +1,208 @@
+#include "vulkan_transient.h"
+
+#include "vulkan_allocator.h"
+#include "vulkan_swapchain.h"
+
+#include "core/logger.h"
+
+typedef struct TransientSlot
+{
+	VkMemoryRequirements	requirements;
+	uint32_t				lastPass;
+	VkPipelineStageFlags2	stages;
+	b8						bLazy;
+	// NOTE: The driver wants this image alone, nothing aliases it
+	VkImage					dedicatedImage;
+} TransientSlot;
+
+static b8
+LazyMemoryAvailable(VulkanAllocator* pAllocator, uint32_t typeBits)
+{
+	VkPhysicalDeviceMemoryProperties* pProperties = &pAllocator->memoryProperties;
+	for (uint32_t i = 0; i < pProperties->memoryTypeCount; i++)
+	{
+		if ((typeBits & (1u << i))
+				&& (pProperties->memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/* NOTE: First fit, walked by first pass, a slot is free again once its last user is done */
+static uint32_t
+SlotFind(TransientSlot* pSlots, uint32_t slotCount, const VulkanTransientImage* pImage,
+		const VkMemoryRequirements* pRequirements, b8 bLazy)
+{
+	for (uint32_t s = 0; s < slotCount; s++)
+	{
+		TransientSlot* pSlot = &pSlots[s];
+		if (pSlot->dedicatedImage || pSlot->bLazy != bLazy || pSlot->lastPass >= pImage->firstPass)
+			continue;
+		if (pSlot->requirements.memoryTypeBits & pRequirements->memoryTypeBits)
+			return s;
+	}
+	return slotCount;
+}
+
+YND static VkResult
+TransientImagesBuild(
+		VkContext*				pCtx,
+		VulkanTransientImage*	pImages,
+		uint32_t				count,
+		VulkanTransientMemory*	pOutMemory)
+{
+	VkDevice			device		= pCtx->device.handle;
+	VulkanAllocator*	pAllocator	= pCtx->device.pMemoryAllocator;
+
+	uint32_t	pOrder[VK_TRANSIENT_MAX_SLOTS];
+	uint32_t	pSlotOf[VK_TRANSIENT_MAX_SLOTS];
+	for (uint32_t i = 0; i < count; i++)
+	{
+		VulkanTransientImage*	pTransient	= &pImages[i];
+		VulkanImage*			pImage		= pTransient->pImage;
+		VkImageCreateInfo imageCreateInfo = {
+			.sType			= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			.imageType		= VK_IMAGE_TYPE_2D,
+			.extent			= pTransient->extent,
+			.mipLevels		= 1,
+			.arrayLayers	= 1,
+			.format			= pTransient->format,
+			.tiling			= VK_IMAGE_TILING_OPTIMAL,
+			.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED,
+			.usage			= pTransient->usage,
+			.samples		= VK_SAMPLE_COUNT_1_BIT,
+			.sharingMode	= VK_SHARING_MODE_EXCLUSIVE,
+		};
+		pImage->width	= pTransient->extent.width;
+		pImage->height	= pTransient->extent.height;
+		VK_CHECK(vkCreateImage(device, &imageCreateInfo, pCtx->pAllocator, &pImage->handle));
+
+		/* NOTE: Insertion sort by first pass, there are a handful of them */
+		uint32_t k = i;
+		for (; k > 0 && pImages[pOrder[k - 1]].firstPass > pTransient->firstPass; k--)
+			pOrder[k] = pOrder[k - 1];
+		pOrder[k] = i;
+	}
+
+	TransientSlot	pSlots[VK_TRANSIENT_MAX_SLOTS] = {0};
+	uint32_t		slotCount = 0;
+	for (uint32_t k = 0; k < count; k++)
+	{
+		VulkanTransientImage* pTransient = &pImages[pOrder[k]];
+
+		VkMemoryDedicatedRequirements dedicatedRequirements = {
+			.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+		};
+		VkMemoryRequirements2 memoryRequirements = {
+			.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+			.pNext = &dedicatedRequirements,
+		};
+		VkImageMemoryRequirementsInfo2 requirementsInfo = {
+			.sType	= VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2,
+			.image	= pTransient->pImage->handle,
+		};
+		vkGetImageMemoryRequirements2(device, &requirementsInfo, &memoryRequirements);
+		VkMemoryRequirements* pRequirements = &memoryRequirements.memoryRequirements;
+
+		b8 bLazy = (pTransient->usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT)
+			&& LazyMemoryAvailable(pAllocator, pRequirements->memoryTypeBits);
+		uint32_t slot = dedicatedRequirements.requiresDedicatedAllocation
+			? slotCount
+			: SlotFind(pSlots, slotCount, pTransient, pRequirements, bLazy);
+
+		TransientSlot* pSlot = &pSlots[slot];
+		if (slot == slotCount)
+		{
+			slotCount++;
+			pSlot->requirements		= *pRequirements;
+			pSlot->bLazy			= bLazy;
+			pSlot->dedicatedImage	= dedicatedRequirements.requiresDedicatedAllocation
+									? pTransient->pImage->handle
+									: VK_NULL_HANDLE;
+		}
+		else
+		{
+			VkMemoryRequirements* pShared = &pSlot->requirements;
+			pShared->size			= pShared->size > pRequirements->size ? pShared->size : pRequirements->size;
+			pShared->alignment		= pShared->alignment > pRequirements->alignment
+									? pShared->alignment
+									: pRequirements->alignment;
+			pShared->memoryTypeBits	&= pRequirements->memoryTypeBits;
+		}
+		pSlot->lastPass	= pTransient->lastPass;
+		pSlot->stages	|= pTransient->stages;
+		pSlotOf[pOrder[k]] = slot;
+	}
+
+	for (uint32_t s = 0; s < slotCount; s++)
+	{
+		TransientSlot*			pSlot	= &pSlots[s];
+		VkMemoryPropertyFlags	flags	= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		if (pSlot->bLazy)
+			flags |= VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+
+		VkMemoryDedicatedAllocateInfo dedicated = {
+			.sType	= VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+			.image	= pSlot->dedicatedImage,
+		};
+		/* NOTE: Lazy memory gets its own allocation too, a shared block would be committed whole */
+		b8 bDedicated = pSlot->bLazy || pSlot->dedicatedImage != VK_NULL_HANDLE;
+		VK_CHECK(vkMemoryAllocate(
+					pAllocator,
+					&pSlot->requirements,
+					flags,
+					VULKAN_ALLOCATION_OPTIMAL,
+					bDedicated,
+					dedicated,
+					&pOutMemory->pSlots[s]));
+		pOutMemory->slotCount++;
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		VulkanTransientImage*	pTransient	= &pImages[i];
+		VulkanAllocation*		pSlot		= &pOutMemory->pSlots[pSlotOf[i]];
+		VK_CHECK(vkBindImageMemory(device, pTransient->pImage->handle, pSlot->memory, pSlot->offset));
+		VK_CHECK(vkImageViewCreate(pCtx, pTransient->format, pTransient->pImage, pTransient->aspectMask));
+		pOutMemory->pAliasStages[i] = pSlots[pSlotOf[i]].stages;
+	}
+
+	YDEBUG("Transient images: %u in %u memory slots", count, slotCount);
+	return VK_SUCCESS;
+}
+
+YND VkResult
+vkTransientImagesCreate(
+		VkContext*				pCtx,
+		VulkanTransientImage*	pImages,
+		uint32_t				count,
+		VulkanTransientMemory*	pOutMemory)
+{
+	pOutMemory->slotCount = 0;
+	if (count > VK_TRANSIENT_MAX_SLOTS)
+	{
+		YERROR("Too many transient images: %u, %u at most", count, VK_TRANSIENT_MAX_SLOTS);
+		return VK_ERROR_INITIALIZATION_FAILED;
+	}
+
+	/* NOTE: Zeroed first so a failure halfway knows what to destroy */
+	for (uint32_t i = 0; i < count; i++)
+		*pImages[i].pImage = (VulkanImage){0};
+
+	VkResult result = TransientImagesBuild(pCtx, pImages, count, pOutMemory);
+	if (result != VK_SUCCESS)
+	{
+		for (uint32_t i = 0; i < count; i++)
+			vkDestroyVulkanImage(pCtx, pImages[i].pImage);
+		vkTransientMemoryFree(pCtx, pOutMemory);
+	}
+	return result;
+}
+
+void
+vkTransientMemoryFree(VkContext* pCtx, VulkanTransientMemory* pMemory)
+{
+	for (uint32_t s = 0; s < pMemory->slotCount; s++)
+		vkMemoryFree(pCtx->device.pMemoryAllocator, &pMemory->pSlots[s]);
+	pMemory->slotCount = 0;
+}
@@ -0,0 +1,45 @@
+#ifndef VULKAN_TRANSIENT_H
+#define VULKAN_TRANSIENT_H
+
+#include "yvulkan.h"
+
+/*
+ * NOTE: Attachments only needed inside a frame. Their content is never stored
+ * (storeOp DONT_CARE), the ones with VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT
+ * go to lazily allocated memory when the device has some, which tilers never
+ * back with real memory. Images whose passes don't overlap share the same
+ * memory, the render graph discards their content on first use anyway.
+ */
+typedef struct VulkanTransientImage
+{
+	VkFormat				format;
+	VkExtent3D				extent;
+	VkImageUsageFlags		usage;
+	VkImageAspectFlags		aspectMask;
+	// NOTE: Order of the first and last pass of the frame using it, inclusive
+	uint32_t				firstPass;
+	uint32_t				lastPass;
+	VkPipelineStageFlags2	stages;
+	// NOTE: Created and bound by vkTransientImagesCreate, memory stays 0
+	VulkanImage*			pImage;
+} VulkanTransientImage;
+
+/**
+ * @brief	Creates the images and binds them to the fewest memory slots their
+ *			lifetimes allow. At most VK_TRANSIENT_MAX_SLOTS images. Nothing is
+ *			left behind on failure.
+ */
+YND VkResult vkTransientImagesCreate(
+		VkContext*							pCtx,
+		VulkanTransientImage*				pImages,
+		uint32_t							count,
+		VulkanTransientMemory*				pOutMemory);
+
+/**
+ * @brief	Destroy the images first, vkDestroyVulkanImage leaves the memory alone.
+ */
+void vkTransientMemoryFree(
+		VkContext*							pCtx,
+		VulkanTransientMemory*				pMemory);
+
+#endif // VULKAN_TRANSIENT_H
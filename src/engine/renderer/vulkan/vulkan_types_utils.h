@@ -64,13 +64,32 @@ typedef struct VulkanFramebuffer
 	VulkanRenderPass*	pRenderpass;
 } VulkanFramebuffer;
 
+typedef struct VulkanMemoryBlock VulkanMemoryBlock;
+
+/*
+ * NOTE: Range handed out by the device memory allocator (vulkan_allocator.c).
+ * `pBlock` is NULL for dedicated allocations, they own `memory` alone.
+ * `pMapped` is set when the memory type is host visible, it stays mapped.
+ */
+typedef struct VulkanAllocation
+{
+	VkDeviceMemory		memory;
+	VkDeviceSize		offset;
+	VkDeviceSize		size;
+	void*				pMapped;
+	VulkanMemoryBlock*	pBlock;
+	uint32_t			memoryTypeIndex;
+	uint32_t			order;
+} VulkanAllocation;
+
 typedef struct VulkanImage
 {
-	VkImage			handle;
-	VkImageView		view;
-	VkDeviceMemory	memory;
-	uint32_t		width;
-	uint32_t		height;
+	VkImage				handle;
+	VkImageView			view;
+	VkDeviceMemory		memory;
+	VulkanAllocation	allocation;
+	uint32_t			width;
+	uint32_t			height;
 } VulkanImage;
 
 typedef struct VkSwapchain
@@ -79,6 +98,12 @@ typedef struct VkSwapchain
 	uint32_t			imageCount;
 	VkSurfaceFormatKHR	imageFormat;
 	u8					maxFrameInFlight;
+	// NOTE: Set by vkInit from the renderer config, recreate keeps it
+	VkPresentModeKHR	desiredPresentMode;
+	VkPresentModeKHR	presentMode;
+	// NOTE: Last id handed to a present and last one waited, both restart with a new handle
+	uint64_t			presentId;
+	uint64_t			presentIdWaited;
 	VkImage*			pImages;
 	VkImageView*		pViews;
 	VkExtent3D			extent;
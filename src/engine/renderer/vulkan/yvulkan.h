@@ -8,12 +8,21 @@
 #include "renderer/vulkan/vulkan_types_utils.h"
 #include "renderer/vulkan/macro_utils.h"
 
+#include "core/filewatch.h"
+#include "core/ythread.h"
+
 #ifdef PLATFORM_LINUX
 #	ifdef YGLFW3
 #	endif
 #endif
 
 typedef struct OsState OsState;
+typedef struct RendererConfig RendererConfig;
+
+typedef struct VulkanAllocator VulkanAllocator;
+typedef struct VulkanGpuProfiler VulkanGpuProfiler;
+typedef struct VulkanTileRenderer VulkanTileRenderer;
+typedef struct VulkanBindless VulkanBindless;
 
 typedef struct VulkanBuffer
 {
@@ -22,6 +31,7 @@ typedef struct VulkanBuffer
 	VkDeviceSize		size;
 	VkDeviceSize		offset;
 	VkMemoryMapFlags	flags;
+	VulkanAllocation	allocation;
 } VulkanBuffer;
 
 
@@ -63,19 +73,31 @@ typedef struct VulkanDevice
 	VkQueue								graphicsQueue;
 	VkQueue 							presentQueue;
 	VkQueue 							transferQueue;
+	VkQueue 							computeQueue;
 
 	int32_t								graphicsQueueIndex;
 	int32_t								presentQueueIndex;
 	int32_t								transferQueueIndex;
+	// NOTE: A compute family without graphics apart from the transfer one, -1 without one
+	int32_t								computeQueueIndex;
 
 	VkPhysicalDeviceProperties			properties;
+	// NOTE: The compute group sizes are picked from it, see vkComputeGroupSizeSelect
+	uint32_t							subgroupSize;
 	VkPhysicalDeviceFeatures			features;
 	VkPhysicalDeviceMemoryProperties	memory;
 
-	VkCommandPool						graphicsCommandPool;
 	VkFormat							depthFormat;
+	b8									bCalibratedTimestamps;
+	b8									bDrawIndirectCount;
+	// NOTE: VK_KHR_present_id and VK_KHR_present_wait, both or neither
+	b8									bPresentWait;
+	PFN_vkWaitForPresentKHR				pfnWaitForPresent;
 
 	VulkanImmediateSubmit				immediateSubmit;
+
+	// NOTE: Pointer so the by value VulkanDevice copies share it
+	VulkanAllocator*					pMemoryAllocator;
 } VulkanDevice;
 
 typedef struct DrawImage
@@ -86,6 +108,69 @@ typedef struct DrawImage
 	VkFormat	format;
 } DrawImage;
 
+#define VK_TRANSIENT_MAX_SLOTS		8
+/* NOTE: Index of the depth attachment in the transients of vkRenderTargetsTransientsBind */
+#define VK_TRANSIENT_DEPTH			0
+#define VK_TRANSIENT_COUNT			1
+
+/* NOTE: Memory the transient attachments are aliased onto, see vulkan_transient.h */
+typedef struct VulkanTransientMemory
+{
+	uint32_t				slotCount;
+	VulkanAllocation		pSlots[VK_TRANSIENT_MAX_SLOTS];
+	// NOTE: Per image, the stages of every image sharing its memory, the initialStages of its graph import
+	VkPipelineStageFlags2	pAliasStages[VK_TRANSIENT_MAX_SLOTS];
+	// NOTE: Per image, the passes of the frame graphs it was planned for, widened by new ones
+	uint32_t				pFirstPasses[VK_TRANSIENT_MAX_SLOTS];
+	uint32_t				pLastPasses[VK_TRANSIENT_MAX_SLOTS];
+} VulkanTransientMemory;
+
+/*
+ * NOTE: The passes render to the top left renderExtent of the draw image,
+ * scaled from the swapchain extent so the GPU time of the resolution bound
+ * passes stays around targetMs. The copy to the swapchain upscales it.
+ */
+typedef struct VulkanDynamicResolution
+{
+	f32					scale;
+	f32					minScale;
+	f32					maxScale;
+	f64					targetMs;
+	// NOTE: Moving average of the times read back, frames in flight late
+	f64					averageMs;
+	VkExtent2D			renderExtent;
+} VulkanDynamicResolution;
+
+#define VK_PRESENT_TIMES_MAX		8
+
+/*
+ * NOTE: vkFrameLatencyWait runs before input is sampled, so what the player
+ * sees was decided at most maxQueued frames earlier.
+ */
+typedef struct VulkanFrameLatency
+{
+	// NOTE: 0 never waits, vkFrameBegin still caps it at maxFrameInFlight. At most VK_PRESENT_TIMES_MAX
+	uint32_t			maxQueued;
+	// NOTE: Milliseconds at each vkQueuePresentKHR, indexed by present id
+	f64					pPresentTimesMs[VK_PRESENT_TIMES_MAX];
+	// NOTE: From the present call to the image on screen, present wait only
+	f64					presentLatencyMs;
+} VulkanFrameLatency;
+
+/*
+ * NOTE: Every interval frames the render extent of the draw image is copied
+ * to buffer and written to disk once the frame's fence signals, that frame
+ * waits for the GPU. Lets headless runs show what they drew.
+ */
+typedef struct VulkanFrameDump
+{
+	// NOTE: 0 never dumps
+	uint32_t			interval;
+	// NOTE: Host visible, grown to the largest extent dumped so far
+	VulkanBuffer		buffer;
+	VkExtent2D			extent;
+} VulkanFrameDump;
+
 typedef struct PoolSizeRatio
 {
 	VkDescriptorType	type;
@@ -98,10 +183,18 @@ typedef struct VulkanDescriptorPool
 	PoolSizeRatio		poolSizeRatio;
 } VulkanDescriptorPool;
 
+/*
+ * NOTE: Pools built from pRatios, chained when the ready ones run out, each
+ * new one with more sets than the last. Reset gives every pool back at once,
+ * sets are never freed one by one.
+ */
 typedef struct DescriptorAllocator
 {
-	VkDescriptorPool	pool;
-	PoolSizeRatio		poolSizeRatio;
+	// NOTE: Darrays
+	PoolSizeRatio*		pRatios;
+	VkDescriptorPool*	pReadyPools;
+	VkDescriptorPool*	pFullPools;
+	uint32_t			setsPerPool;
 } DescriptorAllocator;
 
 typedef struct GraphicsPipeline
@@ -133,12 +226,14 @@ typedef struct GpuDrawPushConstants
 /* TODO: Uniform struct for vertex, frag, compute and mesh */
 typedef struct GenericPipeline
 {
-	char*				pFragmentShaderFilePath;
-	char*				pVertexShaderFilePath;
-	VkPipelineLayout	pipelineLayout;
-	VkPipeline			pipeline;
-	GpuMeshBuffers		rectangle;
-	GraphicsPipeline	graphicsPipeline;
+	char*					pFragmentShaderFilePath;
+	char*					pVertexShaderFilePath;
+	VkPipelineLayout		pipelineLayout;
+	VkPipeline				pipeline;
+	// NOTE: Set 0 of the layout when not VK_NULL_HANDLE
+	VkDescriptorSetLayout	setLayout;
+	GpuMeshBuffers			rectangle;
+	GraphicsPipeline		graphicsPipeline;
 } GenericPipeline;
 
 typedef struct ComputeShaderFx
@@ -148,17 +243,165 @@ typedef struct ComputeShaderFx
 	VkPipeline			pipeline;
 	VkPipelineLayout	pipelineLayout;
 	GraphicsPipeline	graphicsPipeline;
+	// NOTE: Specialization constants 0 and 1 of the shader, the dispatch divides by them
+	uint32_t			pGroupSize[2];
 } ComputeShaderFx;
 
+/*
+ * NOTE: Compute pipelines rebuilt by the watcher thread land in
+ * pPendingPipelines, the render thread swaps them in after the in flight fence.
+ */
+typedef struct VulkanShaderReload
+{
+	YThread							thread;
+	YMutex							mutex;
+	OsFileWatch						watch;
+	_Atomic b8						bRunning;
+	uint32_t						pipelineCount;
+	VkPipeline*						pPendingPipelines;
+} VulkanShaderReload;
+
+/* NOTE: Handle destroyed once the frame that queued it comes around again */
+typedef struct VulkanDeletion
+{
+	VkObjectType					type;
+	uint64_t						handle;
+	VulkanAllocation				allocation;
+	// NOTE: pCtx->nbFrames when retired, only read by pCtx->pRetired
+	uint64_t						frame;
+} VulkanDeletion;
+
+/*
+ * NOTE: Everything one frame in flight records with. The whole command pool
+ * and descriptor pools are reset once the frame's fence is signaled.
+ */
+typedef struct VulkanFrame
+{
+	VkCommandPool					commandPool;
+	VulkanCommandBuffer				commandBuffer;
+	// NOTE: Transient sets, reset whole once the fence is signaled
+	DescriptorAllocator				descriptors;
+
+	VulkanFence						fenceInFlight;
+	VkSemaphore						semaphoreAvailableImage;
+	VkSemaphore						semaphoreQueueComplete;
+
+	// NOTE: Staging ring head at this frame's flush
+	VkDeviceSize					stagingEnd;
+
+	// NOTE: Darray
+	VulkanDeletion*					pDeletionQueue;
+} VulkanFrame;
+
+/*
+ * NOTE: Persistently mapped staging memory used as a ring. Each frame's
+ * flush marks how far the ring was consumed, reaching its in flight fence
+ * gives that range back.
+ */
+typedef struct VulkanStagingRing
+{
+	VulkanBuffer					buffer;
+	uint8_t*						pMapped;
+	YMutex							mutex;
+
+	// NOTE: Monotonic offsets, the ring position is offset % buffer.size
+	VkDeviceSize					head;
+	VkDeviceSize					tail;
+
+	// NOTE: Darrays, copies waiting for the next flush
+	VkBuffer*						pDstBuffers;
+	VkBufferCopy*					pRegions;
+} VulkanStagingRing;
+
+typedef struct VulkanTransfer
+{
+	VkBuffer						dstBuffer;
+	VkDeviceSize					dstOffset;
+	VkDeviceSize					size;
+	uint64_t						value;
+	VulkanBuffer					staging;
+	VkCommandBuffer					commandBuffer;
+	b8								bAcquired;
+} VulkanTransfer;
+
+/*
+ * NOTE: Uploads on the dedicated transfer queue. Each submit signals the
+ * next timeline value, the graphics queue acquires the buffers and waits on
+ * the highest value it acquired.
+ */
+typedef struct VulkanTransferQueue
+{
+	YMutex							mutex;
+	b8								bDedicated;
+	VkCommandPool					commandPool;
+	VkSemaphore						timeline;
+	uint64_t						submittedValue;
+
+	// NOTE: Render thread only, consumed by the next graphics submit
+	uint64_t						graphicsWaitValue;
+
+	// NOTE: Darray, freed once acquired and completed
+	VulkanTransfer*					pTransfers;
+} VulkanTransferQueue;
+
+#define VK_ASYNC_COMPUTE_SLOTS		2
+
+/*
+ * NOTE: Background effects on a compute only queue family. Each frame
+ * submits the next frame's background into one slot while the graphics
+ * queue copies the other one into the draw image. The compute timeline
+ * counts the backgrounds written, the graphics timeline the ones copied.
+ */
+typedef struct VulkanAsyncCompute
+{
+	b8								bEnabled;
+	VkCommandPool					commandPool;
+	VkCommandBuffer					pCommandBuffers[VK_ASYNC_COMPUTE_SLOTS];
+	VkSemaphore						computeTimeline;
+	VkSemaphore						graphicsTimeline;
+	uint64_t						submittedValue;
+
+	// NOTE: Render thread only, waited then signaled by the next graphics submit
+	uint64_t						graphicsWaitValue;
+	// NOTE: Last value the graphics timeline was given, it never signals one twice
+	uint64_t						waitedValue;
+
+	DrawImage						pBackgrounds[VK_ASYNC_COMPUTE_SLOTS];
+	VkDescriptorSet					pDescriptorSets[VK_ASYNC_COMPUTE_SLOTS];
+	// NOTE: What each slot was written with, a mismatch runs the effect on the graphics queue
+	VkExtent2D						pExtents[VK_ASYNC_COMPUTE_SLOTS];
+	uint64_t						pHashes[VK_ASYNC_COMPUTE_SLOTS];
+} VulkanAsyncCompute;
+
+/*
+ * NOTE: Last background kept once its inputs held still for two frames, the
+ * frames drawn with the same ones copy it instead of running the effect.
+ */
+typedef struct VulkanBackgroundCache
+{
+	DrawImage						image;
+	// NOTE: vkBackgroundHash of what image holds, 0 while it holds nothing
+	uint64_t						hash;
+	// NOTE: Of the frame before, a store waits for the same one twice in a row
+	uint64_t						lastHash;
+	// NOTE: lastHash differed from the one before it, the inputs may be animated
+	b8								bChanged;
+	// NOTE: This frame changed the hash after it held still, see vkBackgroundCacheSettling
+	b8								bSettling;
+	VkExtent2D						extent;
+} VulkanBackgroundCache;
+
 typedef struct VkContext
 {
 	VkInstance						instance;
 	VkAllocationCallbacks*			pAllocator;
 	VkSurfaceKHR					surface;
+	// NOTE: The surface is VK_EXT_headless_surface, nothing is shown
+	b8								bHeadless;
+	// NOTE: RendererConfig's, vkDrawImpl pushes the demo notes every frame
+	b8								bTilesDemo;
 	VulkanDevice					device;
 
-	// NOTE: Darray
-	VulkanCommandBuffer*			pGfxCommands;
 	uint32_t						framebufferWidth;
 	uint32_t						framebufferHeight;
 
@@ -175,16 +418,21 @@ typedef struct VkContext
 	uint64_t						framebufferSizeLastGeneration;
 	VulkanRenderPass				mainRenderpass;
 
-	// NOTE: Darrays
-	VkSemaphore*					pSemaphoresAvailableImage;
-	VkSemaphore*					pSemaphoresQueueComplete;
-	VulkanFence*					pFencesInFlight;
+	// NOTE: Darray, swapchain.maxFrameInFlight frames indexed by currentFrame
+	VulkanFrame*					pFrames;
+
+	// NOTE: Darray, outlives skipped frames, see vkFrameRetirePush
+	VulkanDeletion*					pRetired;
 
 	// NOTE: Holds pointers to fences which exist and are owned elsewhere.
 	VulkanFence**					ppImagesInFlight;
 
 	DrawImage						drawImage;
 	DrawImage						depthImage;
+	VulkanTransientMemory			transientMemory;
+	VulkanDynamicResolution			resolution;
+	VulkanFrameLatency				latency;
+	VulkanFrameDump					frameDump;
 
 	VkSwapchain						swapchain;
 	uint32_t						currentFrame;
@@ -201,9 +449,10 @@ typedef struct VkContext
 
 	VkDescriptorSetLayoutBinding*	pBindings;
 
+	// NOTE: Long lived sets, never reset
 	DescriptorAllocator				descriptorAllocator;
-	VulkanDescriptorPool			descriptorPool;
 
+	VkPipelineCache					pipelineCache;
 	VkPipeline						gradientComputePipeline;
 	VkPipelineLayout				gradientComputePipelineLayout;
 
@@ -211,10 +460,19 @@ typedef struct VkContext
 	VkDescriptorSetLayout			drawImageDescriptorSetLayout;
 
 	ComputeShaderFx					*pComputeShaders;
+	VulkanShaderReload				shaderReload;
+	VulkanStagingRing				stagingRing;
+	VulkanTransferQueue				transfer;
+	VulkanAsyncCompute				asyncCompute;
+	VulkanBackgroundCache			backgroundCache;
+	VulkanGpuProfiler*				pGpuProfiler;
+	VulkanBindless*					pBindless;
+
+	// NOTE: Tracy's Vulkan context, NULL without TRACY_ENABLE
+	void*							pTracyContext;
 
-	GenericPipeline					triPipeline;
-	GenericPipeline					meshPipeline;
 	GpuMeshBuffers					gpuMeshBuffers;
+	VulkanTileRenderer*				pTileRenderer;
 
 #ifdef DEBUG
 	VkDebugUtilsMessengerEXT		debugMessenger;
@@ -233,11 +491,20 @@ typedef struct GlobalContext
 
 YND VkResult vkInit(
 		OsState*							pState,
+		const RendererConfig*				pConfig,
 		void**								ppOutContext);
 
 void vkShutdown(
 		void*								pCtx);
 
+/**
+ * @brief	Records the new framebuffer size of the current context, the
+ *			swapchain is recreated by the next vkDrawImpl.
+ */
+void vkFramebufferResize(
+		uint32_t							width,
+		uint32_t							height);
+
 #endif // YVULKAN_H
 
 #endif // BACKEND_VULKAN
@@ -0,0 +1,30 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (location = 0) in vec4 inColor;
+layout (location = 1) in vec2 inUV;
+layout (location = 2) flat in uint inHitState;
+layout (location = 3) flat in uint inTextureIndex;
+layout (location = 4) flat in uint inSamplerIndex;
+
+layout (location = 0) out vec4 outFragColor;
+
+// NOTE: The bindless set, see vulkan_bindless.h
+layout (set = 0, binding = 0) uniform texture2D textures[];
+layout (set = 0, binding = 1) uniform sampler samplers[];
+
+// NOTE: VK_BINDLESS_TEXTURE_NONE
+#define TEXTURE_NONE 0
+
+void main() 
+{
+	vec4 color = inColor;
+	// NOTE: Instances in a draw pick different textures, the index is not uniform
+	if (inTextureIndex != TEXTURE_NONE)
+		color *= texture(sampler2D(textures[nonuniformEXT(inTextureIndex)], samplers[nonuniformEXT(inSamplerIndex)]), inUV);
+
+	// NOTE: Darker towards the top of the tile, hit ones light up
+	float shade = mix(0.7f, 1.0f, inUV.y);
+	float boost = inHitState != 0 ? 1.6f : 1.0f;
+	outFragColor = vec4(min(color.rgb * shade * boost, 1.0f), color.a);
+}
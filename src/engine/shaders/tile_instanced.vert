@@ -0,0 +1,52 @@
+#version 450
+#extension GL_EXT_buffer_reference : require
+
+layout (location = 0) out vec4 outColor;
+layout (location = 1) out vec2 outUV;
+layout (location = 2) flat out uint outHitState;
+layout (location = 3) flat out uint outTextureIndex;
+layout (location = 4) flat out uint outSamplerIndex;
+
+// NOTE: Same layout as TileInstance in vulkan_tiles.h
+struct TileInstance {
+
+	vec2 position;
+	vec2 size;
+	vec4 color;
+	vec4 uvRect;
+	uint lane;
+	uint hitState;
+	float time;
+	float duration;
+	uint textureIndex;
+	uint samplerIndex;
+	uint pad0;
+	uint pad1;
+};
+
+layout(buffer_reference, std430) readonly buffer InstanceBuffer{ 
+	TileInstance instances[];
+};
+
+//push constants block
+layout( push_constant ) uniform constants
+{	
+	InstanceBuffer instanceBuffer;
+	vec2 pixelToNdc;
+} PushConstants;
+
+void main() 
+{	
+	TileInstance tile = PushConstants.instanceBuffer.instances[gl_InstanceIndex];
+
+	// NOTE: Corners in the order of the rect from DefaultDataInit, (1,0) (1,1) (0,0) (0,1)
+	vec2 corner = vec2(1 - (gl_VertexIndex >> 1), gl_VertexIndex & 1);
+	vec2 pixel = tile.position + corner * tile.size;
+
+	gl_Position = vec4(pixel * PushConstants.pixelToNdc - 1.0f, 0.0f, 1.0f);
+	outColor = tile.color;
+	outUV = mix(tile.uvRect.xy, tile.uvRect.zw, corner);
+	outHitState = tile.hitState;
+	outTextureIndex = tile.textureIndex;
+	outSamplerIndex = tile.samplerIndex;
+}
@@ -0,0 +1,17 @@
+#include "mydefines.h"
+
+#ifdef YPLATFORM_WINDOWS
+
+#include "core/asyncioimpl.h"
+
+/*
+ * TODO: IoRing (Windows 11) would be the equivalent, the thread pool is used
+ * until then
+ */
+YND b8
+OsAsyncIoUringCreate(YMB uint32_t queueDepth, YMB AsyncIoBackend* pOutBackend)
+{
+	return FALSE;
+}
+
+#endif // YPLATFORM_WINDOWS
@@ -6,6 +6,10 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <io.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
 
 int
 OsFopen(FILE** pFile, const char* pFilePath, const char* pMode)
@@ -23,12 +27,104 @@ OsFread(void* pBuffer, size_t bufferSize, size_t elementSize, size_t elementCoun
 	return errcode;
 }
 
+int64_t
+OsFileSize(FILE* pStream)
+{
+	return _filelengthi64(_fileno(pStream));
+}
+
+/*
+ * NOTE: ReadFile with an OVERLAPPED offset on a synchronous handle does not move
+ * a shared cursor the way _fseeki64 + fread would
+ */
+int64_t
+OsFreadAt(FILE* pStream, void* pBuffer, uint64_t size, uint64_t offset)
+{
+	HANDLE handle = (HANDLE)_get_osfhandle(_fileno(pStream));
+	uint64_t count = 0;
+	while (count < size)
+	{
+		OVERLAPPED overlapped = {0};
+		uint64_t position = offset + count;
+		overlapped.Offset = (DWORD)(position & 0xFFFFFFFF);
+		overlapped.OffsetHigh = (DWORD)(position >> 32);
+		uint64_t remaining = size - count;
+		DWORD toRead = remaining > 0x40000000 ? 0x40000000 : (DWORD)remaining;
+		DWORD bytesRead = 0;
+		if (!ReadFile(handle, (char*)pBuffer + count, toRead, &bytesRead, &overlapped))
+		{
+			if (GetLastError() == ERROR_HANDLE_EOF)
+				break;
+			return -1;
+		}
+		if (bytesRead == 0)
+			break;
+		count += bytesRead;
+	}
+	return (int64_t)count;
+}
+
 int
 OsFclose(FILE* pStream)
 {
 	return fclose(pStream);
 }
 
+/* NOTE: rename() refuses to replace an existing file on windows */
+YND b8
+OsFileRename(const char* pSource, const char* pDest)
+{
+	if (!MoveFileExA(pSource, pDest, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+	{
+		YERROR("MoveFileEx %s: %lu", pDest, GetLastError());
+		return FALSE;
+	}
+	return TRUE;
+}
+
+YND b8
+OsFileMap(const char* pFilePath, OsMappedFile* pOutFile)
+{
+	HANDLE file = CreateFileA(pFilePath, GENERIC_READ, FILE_SHARE_READ, NULL,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return FALSE;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return FALSE;
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (!mapping)
+	{
+		YERROR("CreateFileMapping %s: %lu", pFilePath, GetLastError());
+		return FALSE;
+	}
+	void* pData = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!pData)
+	{
+		YERROR("MapViewOfFile %s: %lu", pFilePath, GetLastError());
+		CloseHandle(mapping);
+		return FALSE;
+	}
+	pOutFile->pData = pData;
+	pOutFile->size = (uint64_t)size.QuadPart;
+	pOutFile->pInternal = mapping;
+	return TRUE;
+}
+
+void
+OsFileUnmap(OsMappedFile* pFile)
+{
+	if (pFile->pData)
+		UnmapViewOfFile(pFile->pData);
+	if (pFile->pInternal)
+		CloseHandle(pFile->pInternal);
+	*pFile = (OsMappedFile){0};
+}
+
 int
 OsStrError(char *pBuffer, size_t bufSize, int errnum)
 {
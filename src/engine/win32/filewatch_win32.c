@@ -0,0 +1,124 @@
+#include "mydefines.h"
+
+#ifdef YPLATFORM_WINDOWS
+
+#include "core/filewatch.h"
+#include "core/ymemory.h"
+#include "core/logger.h"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#define WATCH_BUFFER_SIZE 8192
+
+typedef struct Win32FileWatch
+{
+	HANDLE		directory;
+	OVERLAPPED	overlapped;
+	b8			bPending;
+	DWORD		length;
+	DWORD		offset;
+	/* NOTE: FILE_NOTIFY_INFORMATION has to be DWORD aligned */
+	DWORD		pBuffer[WATCH_BUFFER_SIZE / sizeof(DWORD)];
+} Win32FileWatch;
+
+static b8
+WatchIssue(Win32FileWatch* pWatch)
+{
+	pWatch->length = 0;
+	pWatch->offset = 0;
+	ResetEvent(pWatch->overlapped.hEvent);
+	DWORD filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME;
+	pWatch->bPending = ReadDirectoryChangesW(pWatch->directory, pWatch->pBuffer, WATCH_BUFFER_SIZE,
+			FALSE, filter, NULL, &pWatch->overlapped, NULL) != 0;
+	if (!pWatch->bPending)
+		YERROR("ReadDirectoryChangesW: %lu", GetLastError());
+	return pWatch->bPending;
+}
+
+YND b8
+OsFileWatchCreate(const char* pDirectory, OsFileWatch* pOutWatch)
+{
+	*pOutWatch = (OsFileWatch){0};
+	HANDLE directory = CreateFileA(pDirectory, FILE_LIST_DIRECTORY,
+			FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+			FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+	if (directory == INVALID_HANDLE_VALUE)
+	{
+		YERROR("CreateFile %s: %lu", pDirectory, GetLastError());
+		return FALSE;
+	}
+	Win32FileWatch* pWatch = yAlloc(sizeof(Win32FileWatch), MEMORY_TAG_IO);
+	pWatch->directory = directory;
+	pWatch->overlapped.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+	if (!pWatch->overlapped.hEvent || !WatchIssue(pWatch))
+	{
+		if (pWatch->overlapped.hEvent)
+			CloseHandle(pWatch->overlapped.hEvent);
+		CloseHandle(directory);
+		yFree(pWatch, 1, MEMORY_TAG_IO);
+		return FALSE;
+	}
+	pOutWatch->pInternal = pWatch;
+	return TRUE;
+}
+
+void
+OsFileWatchDestroy(OsFileWatch* pWatch)
+{
+	Win32FileWatch* pInternal = pWatch->pInternal;
+	if (!pInternal)
+		return ;
+	if (pInternal->bPending)
+	{
+		DWORD unused;
+		CancelIoEx(pInternal->directory, &pInternal->overlapped);
+		GetOverlappedResult(pInternal->directory, &pInternal->overlapped, &unused, TRUE);
+	}
+	CloseHandle(pInternal->overlapped.hEvent);
+	CloseHandle(pInternal->directory);
+	yFree(pInternal, 1, MEMORY_TAG_IO);
+	pWatch->pInternal = NULL;
+}
+
+YND b8
+OsFileWatchNext(OsFileWatch* pWatch, uint32_t timeoutMs, char* pOutName, uint32_t nameSize)
+{
+	Win32FileWatch* pInternal = pWatch->pInternal;
+	while (1)
+	{
+		while (pInternal->offset < pInternal->length)
+		{
+			const FILE_NOTIFY_INFORMATION* pInfo = (const FILE_NOTIFY_INFORMATION*)
+				((const char*)pInternal->pBuffer + pInternal->offset);
+			pInternal->offset = pInfo->NextEntryOffset ? pInternal->offset + pInfo->NextEntryOffset : pInternal->length;
+			if (pInfo->Action != FILE_ACTION_ADDED
+					&& pInfo->Action != FILE_ACTION_MODIFIED
+					&& pInfo->Action != FILE_ACTION_RENAMED_NEW_NAME)
+				continue;
+			int length = WideCharToMultiByte(CP_UTF8, 0, pInfo->FileName, pInfo->FileNameLength / sizeof(WCHAR),
+					pOutName, nameSize - 1, NULL, NULL);
+			if (length <= 0)
+				continue;
+			pOutName[length] = 0;
+			return TRUE;
+		}
+		if (!pInternal->bPending && !WatchIssue(pInternal))
+			return FALSE;
+		if (WaitForSingleObject(pInternal->overlapped.hEvent, timeoutMs) != WAIT_OBJECT_0)
+			return FALSE;
+
+		/*
+		 * NOTE: The next read is only issued once this buffer is drained, the
+		 * handle keeps queuing changes in between. 0 bytes means it overflowed.
+		 */
+		DWORD length = 0;
+		pInternal->bPending = FALSE;
+		if (!GetOverlappedResult(pInternal->directory, &pInternal->overlapped, &length, FALSE))
+			length = 0;
+		pInternal->length = length;
+		pInternal->offset = 0;
+	}
+}
+
+#endif // YPLATFORM_WINDOWS
@@ -0,0 +1,133 @@
+#include "mydefines.h"
+
+#ifdef YPLATFORM_WINDOWS
+
+#include "core/ythread.h"
+#include "core/ymemory.h"
+#include "core/logger.h"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+typedef struct ThreadStart
+{
+	HANDLE			handle;
+	pfnThreadStart	pfnStart;
+	void*			pData;
+} ThreadStart;
+
+static DWORD WINAPI
+ThreadEntry(LPVOID pArg)
+{
+	ThreadStart* pStart = (ThreadStart*)pArg;
+	return (DWORD)pStart->pfnStart(pStart->pData);
+}
+
+YND b8
+OsThreadCreate(pfnThreadStart pfnStart, void* pData, YThread* pOutThread)
+{
+	ThreadStart* pStart = yAlloc(sizeof(ThreadStart), MEMORY_TAG_JOB);
+	pStart->pfnStart = pfnStart;
+	pStart->pData = pData;
+
+	pStart->handle = CreateThread(NULL, 0, ThreadEntry, pStart, 0, NULL);
+	if (!pStart->handle)
+	{
+		YERROR("CreateThread: %lu", GetLastError());
+		yFree(pStart, 1, MEMORY_TAG_JOB);
+		pOutThread->pInternal = NULL;
+		return FALSE;
+	}
+	pOutThread->pInternal = pStart;
+	return TRUE;
+}
+
+void
+OsThreadJoin(YThread* pThread)
+{
+	ThreadStart* pStart = (ThreadStart*)pThread->pInternal;
+	if (!pStart)
+		return ;
+	WaitForSingleObject(pStart->handle, INFINITE);
+	CloseHandle(pStart->handle);
+	yFree(pStart, 1, MEMORY_TAG_JOB);
+	pThread->pInternal = NULL;
+}
+
+YND uint32_t
+OsProcessorCount(void)
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+}
+
+YND b8
+OsMutexCreate(YMutex* pOutMutex)
+{
+	CRITICAL_SECTION* pSection = yAlloc(sizeof(CRITICAL_SECTION), MEMORY_TAG_JOB);
+	InitializeCriticalSection(pSection);
+	pOutMutex->pInternal = pSection;
+	return TRUE;
+}
+
+void
+OsMutexDestroy(YMutex* pMutex)
+{
+	if (!pMutex->pInternal)
+		return ;
+	DeleteCriticalSection(pMutex->pInternal);
+	yFree((CRITICAL_SECTION*)pMutex->pInternal, 1, MEMORY_TAG_JOB);
+	pMutex->pInternal = NULL;
+}
+
+void
+OsMutexLock(YMutex* pMutex)
+{
+	EnterCriticalSection(pMutex->pInternal);
+}
+
+void
+OsMutexUnlock(YMutex* pMutex)
+{
+	LeaveCriticalSection(pMutex->pInternal);
+}
+
+YND b8
+OsConditionCreate(YCondition* pOutCondition)
+{
+	CONDITION_VARIABLE* pCondition = yAlloc(sizeof(CONDITION_VARIABLE), MEMORY_TAG_JOB);
+	InitializeConditionVariable(pCondition);
+	pOutCondition->pInternal = pCondition;
+	return TRUE;
+}
+
+void
+OsConditionDestroy(YCondition* pCondition)
+{
+	/* NOTE: CONDITION_VARIABLE has nothing to release */
+	if (!pCondition->pInternal)
+		return ;
+	yFree((CONDITION_VARIABLE*)pCondition->pInternal, 1, MEMORY_TAG_JOB);
+	pCondition->pInternal = NULL;
+}
+
+void
+OsConditionWait(YCondition* pCondition, YMutex* pMutex)
+{
+	SleepConditionVariableCS(pCondition->pInternal, pMutex->pInternal, INFINITE);
+}
+
+void
+OsConditionSignal(YCondition* pCondition)
+{
+	WakeConditionVariable(pCondition->pInternal);
+}
+
+void
+OsConditionBroadcast(YCondition* pCondition)
+{
+	WakeAllConditionVariable(pCondition->pInternal);
+}
+
+#endif // YPLATFORM_WINDOWS
@@ -91,8 +91,12 @@ OsInit(OsState *pOsState, AppConfig appConfig)
     // If initially minimized, use SW_MINIMIZE : SW_SHOWMINNOACTIVE;
     // If initially maximized, use SW_SHOWMAXIMIZED : SW_MAXIMIZE
     ShowWindow(pState->hWindow, showWindowCommandFlag);
+    return TRUE;
+}
 
-    // Clock setup
+YND b8
+OsClockInit(void)
+{
     LARGE_INTEGER frequency;
     if (!QueryPerformanceFrequency(&frequency))
 	{
@@ -318,6 +322,28 @@ OsSwapBuffers(OsState* pOsState)
 	return SwapBuffers(pState->glCtx);
 }
 
+YND b8
+OsPresentPixels(OsState* pOsState, const uint32_t* pPixels, uint32_t width, uint32_t height)
+{
+	InternalState *pState = (InternalState *) pOsState->pInternalState;
+	/* NOTE: Negative height, rows go top to bottom like the software renderer writes them */
+	BITMAPINFO info = {0};
+	info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	info.bmiHeader.biWidth = (LONG)width;
+	info.bmiHeader.biHeight = -(LONG)height;
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 32;
+	info.bmiHeader.biCompression = BI_RGB;
+
+	HDC hdc = GetDC(pState->hWindow);
+	if (!hdc)
+		return FALSE;
+	int lines = StretchDIBits(hdc, 0, 0, (int)pState->windowWidth, (int)pState->windowHeight,
+			0, 0, (int)width, (int)height, pPixels, &info, DIB_RGB_COLORS, SRCCOPY);
+	ReleaseDC(pState->hWindow, hdc);
+	return lines != 0;
+}
+
 void
 OsFramebufferGetDimensions(OsState *pOsState, uint32_t* pWidth, uint32_t* pHeight)
 {
@@ -6,6 +6,8 @@
 #include "core/darray_debug.h"
 #include "core/darray.h"
 
+#include "profiler.h"
+
 b8 gRunning = TRUE;
 
 /* TODO: Make it a function that looks config file for the folder ? */
@@ -15,10 +17,13 @@ const char *gppShaderFilePath[] = {
 	"./build/obj/engine/shaders/sky.comp.spv",
 };
 uint32_t gFilePathSize = COUNT_OF(gppShaderFilePath);
+/* NOTE: Built by `make pack`, entries are looked up with the paths above */
+const char *gpAssetPackPath = "./build/assets.ypk";
 int32_t gShaderFileIndex = 0;
 
 const char* __asan_default_options() { return "detect_leaks=0"; }
 #include "test.h"
+#include "bench.h"
 
 AppConfig gAppConfig = { .pAppName = "TileTimeRythm", .x = 100, .y = 100, .w = 1500, .h = 900, };
 OsState gOsState = {0};
@@ -26,19 +31,27 @@ OsState gOsState = {0};
 /* FIXME: Bug in DarrayLength - DarrayGetCapacity !! */
 /* FIXME: xmm0 registry bug alignment is wrong */
 
-#ifndef TESTING
+#if !defined(TESTING) && !defined(YBENCH)
 
 int
 main(int argc, char **ppArgv)
 {
-	RendererType	defaultType	= RENDERER_TYPE_VULKAN;
+	RendererConfig config = {.type = RENDERER_TYPE_VULKAN, .bVsync = TRUE, .bAsyncCompute = TRUE};
 
-	ArgvCheck(argc, ppArgv, &defaultType);
-	RendererConfig config = {.type = defaultType};
+	ArgvCheck(argc, ppArgv, &config);
 	gAppConfig.pRendererConfig = &config;
+	config.width	= gAppConfig.w;
+	config.height	= gAppConfig.h;
 
-	if (!OsInit(&gOsState, gAppConfig))
+	/* NOTE: Headless runs have no window, nothing to pump either, but still a clock */
+	if (!OsClockInit())
+		exit(1);
+	if (!config.bHeadless && !OsInit(&gOsState, gAppConfig))
 		exit(1);
+	if (!JobSystemInit(0) || !AsyncIoInit(64, ASYNC_IO_BACKEND_DEFAULT))
+		exit(1);
+	if (!PackMount(gpAssetPackPath))
+		YINFO("No asset pack at %s, loading loose files", gpAssetPackPath);
 
 	AddEventCallbackAndInit();
 	InputInitialize();
@@ -49,27 +62,47 @@ main(int argc, char **ppArgv)
 	f64	deltaFrameTime	= 0.0f;
 	f64	startFrameTime	= 0.0f;
 	f64	endFrameTime	= 0.0f;
+	uint32_t frameCount = 0;
 
 	while (gRunning)
 	{
 		deltaFrameTime	= endFrameTime - startFrameTime;
 		startFrameTime	= OsGetAbsoluteTime(NANOSECONDS);
 
-		OsPumpMessages(&gOsState);
+		/* NOTE: Before the messages are pumped, the input read below is as fresh as it gets */
+		if (!gAppConfig.bSuspended)
+			YuFrameLatencyWait(gAppConfig.pRenderer);
+
+		if (!config.bHeadless)
+		{
+			TracyCZoneN(pumpCtx, "OsPumpMessages", 1);
+			OsPumpMessages(&gOsState);
+			TracyCZoneEnd(pumpCtx);
+		}
+		AsyncIoPoll();
 		if (!gAppConfig.bSuspended)
 		{
+			TracyCZoneN(inputCtx, "InputUpdate", 1);
 			InputUpdate(deltaFrameTime);
+			TracyCZoneEnd(inputCtx);
 			YU_ASSERT(YuDraw(&gOsState, gAppConfig.pRenderer));
 		}
+		MemoryPlot();
+		if (config.headlessFrames && ++frameCount >= config.headlessFrames)
+			gRunning = FALSE;
 
 		endFrameTime	= OsGetAbsoluteTime(NANOSECONDS);
 	}
 	YuShutdown(gAppConfig.pRenderer);
+	PackUnmount();
 	InputShutdown();
 	EventShutdown();
-	OsShutdown(&gOsState);
+	AsyncIoShutdown();
+	JobSystemShutdown();
+	if (!config.bHeadless)
+		OsShutdown(&gOsState);
 	GetLeaks();
 	SystemMemoryUsagePrint();
 	return 0;
 }
-#endif // TESTING
+#endif // !TESTING && !YBENCH
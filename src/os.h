@@ -86,6 +86,12 @@ void OsWrite(
 void OsSleep(
 		uint64_t							ms);
 
+/**
+ * @brief	Sets up OsGetAbsoluteTime, independent of OsInit so headless runs
+ *			without a window still time their frames. Call it first.
+ */
+YND b8 OsClockInit(void);
+
 YND f64 OsGetAbsoluteTime(
 		SECOND_UNIT							unit);
 
@@ -102,4 +108,14 @@ YND b8 OsCreateGlContext(
 YND b8 OsSwapBuffers(
 		OsState*							pOsState);
 
+/**
+ * @brief	Shows a top to bottom XRGB8888 frame in the window, used by the
+ *			software renderer.
+ */
+YND b8 OsPresentPixels(
+		OsState*							pOsState,
+		const uint32_t*						pPixels,
+		uint32_t							width,
+		uint32_t							height);
+
 #endif // OS_H
@@ -7,6 +7,7 @@
 #	define TracyCFrameMark
 #	define TracyCZoneN(a, b, c)
 #	define TracyCZoneEnd(a)
+#	define TracyCPlot(a, b)
 #endif
 
 #endif // PROFILER_H
@@ -0,0 +1,261 @@
+/*
+ * NOTE: Standalone asset packer, see core/pack.h for the layout.
+ * usage: ypack -o <out.ypk> [-c none|lz4|zstd] <files...>
+ * Built and run by `make pack`, does not link against the engine.
+ */
+#include "core/pack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef YLZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+#ifdef YZSTD
+#include <zstd.h>
+#endif
+
+typedef struct PackInput
+{
+	const char*		pPath;
+	char			pName[PACK_MAX_NAME];
+	uint32_t		nameLength;
+	uint64_t		hash;
+	char*			pData;
+	uint64_t		size;
+	uint64_t		rawSize;
+	uint32_t		compression;
+} PackInput;
+
+static uint64_t
+AlignUp(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static char*
+FileReadAll(const char* pPath, uint64_t* pOutSize)
+{
+	FILE* pFile = fopen(pPath, "rb");
+	if (!pFile)
+		return NULL;
+	fseek(pFile, 0, SEEK_END);
+	long size = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+	char* pData = malloc(size > 0 ? size : 1);
+	if (size > 0 && fread(pData, 1, size, pFile) != (size_t)size)
+	{
+		free(pData);
+		fclose(pFile);
+		return NULL;
+	}
+	fclose(pFile);
+	*pOutSize = (uint64_t)size;
+	return pData;
+}
+
+/*
+ * NOTE: Compressed blobs are only kept when they save at least an eighth,
+ * anything else stays raw so the engine can use it straight from the mapping.
+ */
+static void
+BlobCompress(PackInput* pInput, PackCompression compression)
+{
+	pInput->rawSize = pInput->size;
+	pInput->compression = PACK_COMPRESSION_NONE;
+	if (compression == PACK_COMPRESSION_NONE || pInput->size < 256)
+		return ;
+
+	char* pCompressed = NULL;
+	uint64_t compressedSize = 0;
+#ifdef YLZ4
+	if (compression == PACK_COMPRESSION_LZ4)
+	{
+		int bound = LZ4_compressBound((int)pInput->size);
+		pCompressed = malloc(bound);
+		compressedSize = LZ4_compress_HC(pInput->pData, pCompressed, (int)pInput->size, bound, LZ4HC_CLEVEL_MAX);
+	}
+#endif
+#ifdef YZSTD
+	if (compression == PACK_COMPRESSION_ZSTD)
+	{
+		size_t bound = ZSTD_compressBound(pInput->size);
+		pCompressed = malloc(bound);
+		size_t result = ZSTD_compress(pCompressed, bound, pInput->pData, pInput->size, 19);
+		compressedSize = ZSTD_isError(result) ? 0 : result;
+	}
+#endif
+	if (compressedSize == 0 || compressedSize > pInput->size - pInput->size / 8)
+	{
+		free(pCompressed);
+		return ;
+	}
+	free(pInput->pData);
+	pInput->pData = pCompressed;
+	pInput->size = compressedSize;
+	pInput->compression = compression;
+}
+
+static int
+Usage(void)
+{
+	fprintf(stderr, "usage: ypack -o <out.ypk> [-c none|lz4|zstd] <files...>\n");
+	return 1;
+}
+
+int
+main(int argc, char** ppArgv)
+{
+	const char* pOutPath = NULL;
+	PackCompression compression = PACK_COMPRESSION_NONE;
+	int first = 1;
+	for (; first < argc && ppArgv[first][0] == '-'; first++)
+	{
+		if (!strcmp(ppArgv[first], "-o") && first + 1 < argc)
+			pOutPath = ppArgv[++first];
+		else if (!strcmp(ppArgv[first], "-c") && first + 1 < argc)
+		{
+			const char* pMode = ppArgv[++first];
+			if (!strcmp(pMode, "lz4"))
+				compression = PACK_COMPRESSION_LZ4;
+			else if (!strcmp(pMode, "zstd"))
+				compression = PACK_COMPRESSION_ZSTD;
+			else if (strcmp(pMode, "none"))
+				return Usage();
+		}
+		else
+			return Usage();
+	}
+	if (!pOutPath)
+		return Usage();
+#ifndef YLZ4
+	if (compression == PACK_COMPRESSION_LZ4)
+	{
+		fprintf(stderr, "ypack: built without LZ4_USE, storing raw\n");
+		compression = PACK_COMPRESSION_NONE;
+	}
+#endif
+#ifndef YZSTD
+	if (compression == PACK_COMPRESSION_ZSTD)
+	{
+		fprintf(stderr, "ypack: built without ZSTD_USE, storing raw\n");
+		compression = PACK_COMPRESSION_NONE;
+	}
+#endif
+
+	uint32_t inputCount = (uint32_t)(argc - first);
+	PackInput* pInputs = calloc(inputCount ? inputCount : 1, sizeof(PackInput));
+	uint32_t tableSize = 1;
+	while (tableSize < inputCount * 2)
+		tableSize <<= 1;
+	PackEntry* pTable = calloc(tableSize, sizeof(PackEntry));
+	PackInput** ppSlotInputs = calloc(tableSize, sizeof(PackInput*));
+	uint64_t stringsSize = 0;
+
+	for (uint32_t i = 0; i < inputCount; i++)
+	{
+		PackInput* pInput = &pInputs[i];
+		pInput->pPath = ppArgv[first + i];
+		pInput->nameLength = PackNameNormalize(pInput->pPath, pInput->pName, PACK_MAX_NAME);
+		pInput->pData = FileReadAll(pInput->pPath, &pInput->size);
+		if (!pInput->nameLength || !pInput->pData)
+		{
+			fprintf(stderr, "ypack: cannot read %s\n", pInput->pPath);
+			return 1;
+		}
+		pInput->hash = PackNameHash(pInput->pName, pInput->nameLength);
+		BlobCompress(pInput, compression);
+		stringsSize += pInput->nameLength;
+	}
+
+	PackHeader header = {
+		.magic			= PACK_MAGIC,
+		.version		= PACK_VERSION,
+		.entryCount		= inputCount,
+		.tableSize		= tableSize,
+		.tableOffset	= sizeof(PackHeader),
+		.stringsOffset	= sizeof(PackHeader) + (uint64_t)tableSize * sizeof(PackEntry),
+		.stringsSize	= stringsSize,
+	};
+
+	uint64_t offset = AlignUp(header.stringsOffset + stringsSize, PACK_ALIGNMENT);
+	uint32_t nameOffset = 0;
+	uint64_t rawTotal = 0;
+	for (uint32_t i = 0; i < inputCount; i++)
+	{
+		PackInput* pInput = &pInputs[i];
+		uint32_t slot = (uint32_t)(pInput->hash & (tableSize - 1));
+		while (pTable[slot].hash != 0)
+		{
+			if (!strcmp(ppSlotInputs[slot]->pName, pInput->pName))
+			{
+				fprintf(stderr, "ypack: duplicate entry %s\n", pInput->pName);
+				return 1;
+			}
+			slot = (slot + 1) & (tableSize - 1);
+		}
+		ppSlotInputs[slot] = pInput;
+		pTable[slot] = (PackEntry){
+			.hash			= pInput->hash,
+			.offset			= offset,
+			.size			= pInput->size,
+			.rawSize		= pInput->rawSize,
+			.nameOffset		= nameOffset,
+			.nameLength		= pInput->nameLength,
+			.compression	= pInput->compression,
+		};
+		nameOffset += pInput->nameLength;
+		offset = AlignUp(offset + pInput->size, PACK_ALIGNMENT);
+		rawTotal += pInput->rawSize;
+	}
+	header.fileSize = offset;
+
+	/* NOTE: Written next to the target then renamed, a running game never maps a half written pack */
+	char pTempPath[PACK_MAX_NAME + 8];
+	snprintf(pTempPath, sizeof(pTempPath), "%s.tmp", pOutPath);
+	FILE* pOut = fopen(pTempPath, "wb");
+	if (!pOut)
+	{
+		fprintf(stderr, "ypack: cannot write %s\n", pTempPath);
+		return 1;
+	}
+	fwrite(&header, sizeof(header), 1, pOut);
+	fwrite(pTable, sizeof(PackEntry), tableSize, pOut);
+	for (uint32_t i = 0; i < inputCount; i++)
+		fwrite(pInputs[i].pName, 1, pInputs[i].nameLength, pOut);
+
+	uint64_t written = header.stringsOffset + stringsSize;
+	static const char pZeroes[PACK_ALIGNMENT] = {0};
+	for (uint32_t i = 0; i < inputCount; i++)
+	{
+		uint64_t aligned = AlignUp(written, PACK_ALIGNMENT);
+		fwrite(pZeroes, 1, aligned - written, pOut);
+		fwrite(pInputs[i].pData, 1, pInputs[i].size, pOut);
+		written = aligned + pInputs[i].size;
+		free(pInputs[i].pData);
+	}
+	fwrite(pZeroes, 1, header.fileSize - written, pOut);
+	if (fclose(pOut) != 0)
+	{
+		fprintf(stderr, "ypack: write failed\n");
+		remove(pTempPath);
+		return 1;
+	}
+#ifdef YPLATFORM_WINDOWS
+	/* NOTE: rename does not replace on Windows */
+	remove(pOutPath);
+#endif
+	if (rename(pTempPath, pOutPath) != 0)
+	{
+		fprintf(stderr, "ypack: cannot rename %s\n", pTempPath);
+		return 1;
+	}
+	printf("ypack: %u entries, %llu bytes of assets, %llu bytes packed -> %s\n", inputCount,
+			(unsigned long long)rawTotal, (unsigned long long)header.fileSize, pOutPath);
+	free(ppSlotInputs);
+	free(pTable);
+	free(pInputs);
+	return 0;
+}
@@ -8,6 +8,9 @@
 #include "core/input.h"
 #include "core/ymemory.h"
 #include "core/logger.h"
+#include "core/job.h"
+#include "core/asyncio.h"
+#include "core/pack.h"
 
 extern AppConfig gAppConfig;
 extern OsState gOsState;
@@ -17,7 +20,7 @@ void AddEventCallbackAndInit(void);
 void ArgvCheck(
 		int									argc,
 		char**								ppArgv,
-		RendererType*						pType);
+		RendererConfig*						pConfig);
 
 b8 _OnEvent(
 		uint16_t							code,